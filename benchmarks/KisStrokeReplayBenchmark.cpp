@@ -0,0 +1,178 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeReplayBenchmark.h"
+
+#include <simpletest.h>
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KisGlobalResourcesInterface.h>
+
+#include "KisPart.h"
+#include "KisDocument.h"
+#include "kis_image.h"
+#include "kis_layer_utils.h"
+#include "kis_paint_layer.h"
+#include "kis_resources_snapshot.h"
+#include "KisAsynchronousStrokeUpdateHelper.h"
+#include "KisFreehandStrokeRecorder.h"
+#include "strokes/freehand_stroke.h"
+#include "strokes/KisFreehandStrokeInfo.h"
+
+namespace {
+
+const QRect DEFAULT_IMAGE_RECT(0, 0, 4000, 4000);
+
+KisNodeSP findPaintedNode(KisImageSP image, const QString &name, KisNodeSP *fallbackNode)
+{
+    KisNodeSP node = KisLayerUtils::findNodeByName(image->root(), name);
+
+    if (!node || !node->paintDevice() || !node->isEditable()) {
+        if (!*fallbackNode) {
+            *fallbackNode = new KisPaintLayer(image, "replay", OPACITY_OPAQUE_U8);
+
+            image->barrierLock();
+            image->addNode(*fallbackNode);
+            image->unlock();
+        }
+
+        node = *fallbackNode;
+    }
+
+    return node;
+}
+
+qint64 replayStroke(KisImageSP image, KisNodeSP node,
+                    const KisFreehandStrokeRecorder::Stroke &stroke)
+{
+    KisResourcesSnapshotSP resources = new KisResourcesSnapshot(image, node);
+    resources->setBrush(stroke.preset);
+    resources->setFGColorOverride(stroke.fgColor);
+    resources->setBGColorOverride(stroke.bgColor);
+    resources->setOpacity(stroke.opacity);
+
+    KisDistanceInitInfo startDistInfo = stroke.startDistInfo;
+    KisDistanceInformation startDist = startDistInfo.makeDistInfo();
+
+    QVector<KisFreehandStrokeInfo*> strokeInfos;
+    for (int i = 0; i < stroke.numStrokeInfos; i++) {
+        strokeInfos << new KisFreehandStrokeInfo(startDist);
+    }
+
+    KisStrokeStrategy *strategy =
+        new FreehandStrokeStrategy(resources,
+                                   strokeInfos,
+                                   kundo2_noi18n("stroke-replay"),
+                                   FreehandStrokeStrategy::SupportsContinuedInterstrokeData |
+                                   FreehandStrokeStrategy::SupportsTimedMergeId);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    KisStrokeId strokeId = image->startStroke(strategy);
+
+    Q_FOREACH (const KisFreehandStrokeRecorder::Job &job, stroke.jobs) {
+        FreehandStrokeStrategy::Data *data = 0;
+
+        switch (job.type) {
+        case KisFreehandStrokeRecorder::Job::Point:
+            data = new FreehandStrokeStrategy::Data(job.strokeInfoId, job.pi1);
+            break;
+        case KisFreehandStrokeRecorder::Job::Line:
+            data = new FreehandStrokeStrategy::Data(job.strokeInfoId, job.pi1, job.pi2);
+            break;
+        case KisFreehandStrokeRecorder::Job::Curve:
+            data = new FreehandStrokeStrategy::Data(job.strokeInfoId,
+                                                    job.pi1, job.control1,
+                                                    job.control2, job.pi2);
+            break;
+        }
+
+        image->addJob(strokeId, data);
+    }
+
+    if (stroke.cancelled) {
+        image->cancelStroke(strokeId);
+    } else {
+        image->addJob(strokeId, new KisAsynchronousStrokeUpdateHelper::UpdateData(true));
+        image->endStroke(strokeId);
+    }
+
+    image->waitForDone();
+
+    return timer.elapsed();
+}
+
+}
+
+void KisStrokeReplayBenchmark::benchmarkReplay()
+{
+    const QString recordFile = qEnvironmentVariable("KRITA_STROKE_REPLAY_FILE");
+    if (recordFile.isEmpty()) {
+        QSKIP("Set KRITA_STROKE_REPLAY_FILE to a file recorded with KRITA_STROKE_RECORD_FILE");
+    }
+
+    bool loadedRecording = false;
+    QVector<KisFreehandStrokeRecorder::Stroke> strokes =
+        KisFreehandStrokeRecorder::load(recordFile,
+                                        KisGlobalResourcesInterface::instance(),
+                                        &loadedRecording);
+    QVERIFY(loadedRecording);
+
+    QScopedPointer<KisDocument> doc(KisPart::instance()->createDocument());
+    KisImageSP image;
+
+    const QString imageFile = qEnvironmentVariable("KRITA_STROKE_REPLAY_IMAGE");
+    if (!imageFile.isEmpty()) {
+        QVERIFY(doc->loadNativeFormat(imageFile));
+        image = doc->image();
+    } else {
+        const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+        image = new KisImage(0, DEFAULT_IMAGE_RECT.width(), DEFAULT_IMAGE_RECT.height(),
+                             cs, "stroke replay benchmark");
+    }
+
+    image->initialRefreshGraph();
+
+    KisNodeSP fallbackNode;
+
+    QVector<qint64> latencies;
+    qint64 totalLatency = 0;
+    int totalJobs = 0;
+
+    for (int i = 0; i < strokes.size(); i++) {
+        const KisFreehandStrokeRecorder::Stroke &stroke = strokes[i];
+
+        KisNodeSP node = findPaintedNode(image, stroke.nodeName, &fallbackNode);
+        const qint64 latency = replayStroke(image, node, stroke);
+
+        qDebug() << "Stroke" << i
+                 << "preset:" << stroke.preset->name()
+                 << "jobs:" << stroke.jobs.size()
+                 << "latency:" << latency << "ms";
+
+        latencies << latency;
+        totalLatency += latency;
+        totalJobs += stroke.jobs.size();
+    }
+
+    if (!latencies.isEmpty()) {
+        std::sort(latencies.begin(), latencies.end());
+
+        qDebug() << "Strokes:" << latencies.size()
+                 << "Jobs:" << totalJobs
+                 << "Total:" << totalLatency << "ms"
+                 << "Median:" << latencies[latencies.size() / 2] << "ms"
+                 << "Max:" << latencies.last() << "ms";
+    }
+}
+
+SIMPLE_TEST_MAIN(KisStrokeReplayBenchmark)
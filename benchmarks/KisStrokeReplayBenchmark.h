@@ -0,0 +1,31 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKEREPLAYBENCHMARK_H
+#define KISSTROKEREPLAYBENCHMARK_H
+
+#include <simpletest.h>
+
+/**
+ * Replays the freehand strokes recorded by KisFreehandStrokeRecorder
+ * against an image and reports the latency of every stroke.
+ *
+ * The recording is passed in KRITA_STROKE_REPLAY_FILE environment
+ * variable, the image in KRITA_STROKE_REPLAY_IMAGE. If no image is
+ * passed, the strokes are painted on an empty one.
+ *
+ * The jobs are pushed into the strokes queue as fast as possible,
+ * ignoring the recorded timings, so that the result would depend on
+ * the rendering speed only, not on the speed of the user's hand.
+ */
+class KisStrokeReplayBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchmarkReplay();
+};
+
+#endif // KISSTROKEREPLAYBENCHMARK_H
@@ -28,6 +28,10 @@
 #include <KoCompositeOpAlphaDarken.h>
 #include <KoCompositeOpOver.h>
 #include <KoCompositeOpCopy2.h>
+#include <KoCompositeOpGeneric.h>
+#include <KoCompositeOpFunctions.h>
+#include <KoColorSpaceBlendingPolicy.h>
+#include <KoCompositeOpRegistry.h>
 #include <KoOptimizedCompositeOpFactory.h>
 #include <KoAlphaDarkenParamsWrapper.h>
 
@@ -505,6 +509,85 @@ void benchmarkCompositeOp(const KoCompositeOp *op, const QString &postfix)
     benchmarkCompositeOp(op, false, 1.0, 1.0, 0, 0, ALPHA_UNIT, ALPHA_UNIT);
 }
 
+/**
+ * The separable blending modes that have an optimized implementation
+ * in KoOptimizedCompositeOpFactory, created with the generic ops
+ */
+template<class Traits>
+QVector<KoCompositeOp*> createLegacyGenericSCOps(const KoColorSpace *cs)
+{
+    using Arg = typename Traits::channels_type;
+    using Policy = KoAdditiveBlendingPolicy<Traits>;
+
+    QVector<KoCompositeOp*> ops;
+    ops << new KoCompositeOpGenericSC<Traits, &cfMultiply<Arg>, Policy>(cs, COMPOSITE_MULT, KoCompositeOp::categoryArithmetic());
+    ops << new KoCompositeOpGenericSC<Traits, &cfScreen<Arg>, Policy>(cs, COMPOSITE_SCREEN, KoCompositeOp::categoryLight());
+    ops << new KoCompositeOpGenericSCFunctor<Traits, CFOverlay<Arg>, Policy>(cs, COMPOSITE_OVERLAY, KoCompositeOp::categoryMix());
+    ops << new KoCompositeOpGenericSCFunctor<Traits, CFSoftLight<Arg>, Policy>(cs, COMPOSITE_SOFT_LIGHT_PHOTOSHOP, KoCompositeOp::categoryLight());
+    return ops;
+}
+
+QVector<KoCompositeOp*> createOptimizedGenericSCOps32(const KoColorSpace *cs)
+{
+    QVector<KoCompositeOp*> ops;
+    ops << KoOptimizedCompositeOpFactory::createMultiplyOp32(cs);
+    ops << KoOptimizedCompositeOpFactory::createScreenOp32(cs);
+    ops << KoOptimizedCompositeOpFactory::createOverlayOp32(cs);
+    ops << KoOptimizedCompositeOpFactory::createSoftLightOp32(cs);
+    return ops;
+}
+
+QVector<KoCompositeOp*> createOptimizedGenericSCOpsU64(const KoColorSpace *cs)
+{
+    QVector<KoCompositeOp*> ops;
+    ops << KoOptimizedCompositeOpFactory::createMultiplyOpU64(cs);
+    ops << KoOptimizedCompositeOpFactory::createScreenOpU64(cs);
+    ops << KoOptimizedCompositeOpFactory::createOverlayOpU64(cs);
+    ops << KoOptimizedCompositeOpFactory::createSoftLightOpU64(cs);
+    return ops;
+}
+
+QVector<KoCompositeOp*> createOptimizedGenericSCOps128(const KoColorSpace *cs)
+{
+    QVector<KoCompositeOp*> ops;
+    ops << KoOptimizedCompositeOpFactory::createMultiplyOp128(cs);
+    ops << KoOptimizedCompositeOpFactory::createScreenOp128(cs);
+    ops << KoOptimizedCompositeOpFactory::createOverlayOp128(cs);
+    ops << KoOptimizedCompositeOpFactory::createSoftLightOp128(cs);
+    return ops;
+}
+
+void compareGenericSCOps(QVector<KoCompositeOp*> actOps, QVector<KoCompositeOp*> expOps)
+{
+    QCOMPARE(actOps.size(), expOps.size());
+
+    for (int i = 0; i < actOps.size(); i++) {
+        QCOMPARE(actOps[i]->id(), expOps[i]->id());
+
+        const bool resultMask = compareTwoOps(true, actOps[i], expOps[i]);
+        const bool resultNoMask = compareTwoOps(false, actOps[i], expOps[i]);
+
+        if (!resultMask || !resultNoMask) {
+            qDebug() << "Failed op:" << actOps[i]->id();
+        }
+
+        QVERIFY(resultMask);
+        QVERIFY(resultNoMask);
+    }
+
+    qDeleteAll(actOps);
+    qDeleteAll(expOps);
+}
+
+void benchmarkGenericSCOps(QVector<KoCompositeOp*> ops, const QString &postfix)
+{
+    Q_FOREACH (const KoCompositeOp *op, ops) {
+        benchmarkCompositeOp(op, postfix);
+    }
+
+    qDeleteAll(ops);
+}
+
 #if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) && XSIMD_UNIVERSAL_BUILD_PASS
 
 template <typename channels_type>
@@ -885,6 +968,27 @@ void KisCompositionBenchmark::compareRgbF32CopyOps()
     delete opAct;
 }
 
+void KisCompositionBenchmark::compareRgbU8GenericSCOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    compareGenericSCOps(createOptimizedGenericSCOps32(cs),
+                        createLegacyGenericSCOps<KoBgrU8Traits>(cs));
+}
+
+void KisCompositionBenchmark::compareRgbU16GenericSCOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    compareGenericSCOps(createOptimizedGenericSCOpsU64(cs),
+                        createLegacyGenericSCOps<KoBgrU16Traits>(cs));
+}
+
+void KisCompositionBenchmark::compareRgbF32GenericSCOps()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    compareGenericSCOps(createOptimizedGenericSCOps128(cs),
+                        createLegacyGenericSCOps<KoRgbF32Traits>(cs));
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenLegacy()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -1013,6 +1117,42 @@ void KisCompositionBenchmark::testRgbF32CompositeCopyOptimized()
     delete op;
 }
 
+void KisCompositionBenchmark::testRgb8CompositeGenericSCLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    benchmarkGenericSCOps(createLegacyGenericSCOps<KoBgrU8Traits>(cs), "Legacy");
+}
+
+void KisCompositionBenchmark::testRgb8CompositeGenericSCOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    benchmarkGenericSCOps(createOptimizedGenericSCOps32(cs), "Optimized");
+}
+
+void KisCompositionBenchmark::testRgb16CompositeGenericSCLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    benchmarkGenericSCOps(createLegacyGenericSCOps<KoBgrU16Traits>(cs), "Legacy");
+}
+
+void KisCompositionBenchmark::testRgb16CompositeGenericSCOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    benchmarkGenericSCOps(createOptimizedGenericSCOpsU64(cs), "Optimized");
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeGenericSCLegacy()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    benchmarkGenericSCOps(createLegacyGenericSCOps<KoRgbF32Traits>(cs), "RGBF32 Legacy");
+}
+
+void KisCompositionBenchmark::testRgbF32CompositeGenericSCOptimized()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F32", "");
+    benchmarkGenericSCOps(createOptimizedGenericSCOps128(cs), "RGBF32 Optimized");
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenReal_Aligned()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
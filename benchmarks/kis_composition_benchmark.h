@@ -47,6 +47,10 @@ private Q_SLOTS:
     void compareRgbU16CopyOps();
     void compareRgbF32CopyOps();
 
+    void compareRgbU8GenericSCOps();
+    void compareRgbU16GenericSCOps();
+    void compareRgbF32GenericSCOps();
+
     void testRgb8CompositeAlphaDarkenLegacy();
     void testRgb8CompositeAlphaDarkenOptimized();
 
@@ -71,6 +75,15 @@ private Q_SLOTS:
     void testRgbF32CompositeCopyLegacy();
     void testRgbF32CompositeCopyOptimized();
 
+    void testRgb8CompositeGenericSCLegacy();
+    void testRgb8CompositeGenericSCOptimized();
+
+    void testRgb16CompositeGenericSCLegacy();
+    void testRgb16CompositeGenericSCOptimized();
+
+    void testRgbF32CompositeGenericSCLegacy();
+    void testRgbF32CompositeGenericSCOptimized();
+
     void testRgb8CompositeAlphaDarkenReal_Aligned();
     void testRgb8CompositeOverReal_Aligned();
 
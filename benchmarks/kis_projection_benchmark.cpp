@@ -9,11 +9,14 @@
 #include "kis_benchmark_values.h"
 
 #include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
 
 #include <kis_group_layer.h>
 #include <kis_paint_device.h>
 #include <KisDocument.h>
 #include <kis_image.h>
+#include <kis_paint_layer.h>
 #include <KisPart.h>
 
 void KisProjectionBenchmark::initTestCase()
@@ -46,5 +49,41 @@ void KisProjectionBenchmark::benchmarkLoading()
     }
 }
 
+/**
+ * Emulates the projection updates coming from a stroke of
+ * overlapping dabs. The neighbouring dab updates intersect, so
+ * only their non-intersecting parts can be merged in parallel.
+ */
+void KisProjectionBenchmark::benchmarkMultiDabStrokeUpdates()
+{
+    const QRect imageRect(0, 0, 4096, 4096);
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "stroke updates");
+
+    const int numLayers = 8;
+    KisPaintLayerSP topLayer;
+
+    for (int i = 0; i < numLayers; i++) {
+        KisPaintLayerSP layer = new KisPaintLayer(image, QString("layer %1").arg(i), OPACITY_OPAQUE_U8);
+        layer->paintDevice()->fill(imageRect, KoColor(QColor(32 * i, 255 - 32 * i, 128, 128), cs));
+        image->addNode(layer, image->root());
+        topLayer = layer;
+    }
+
+    image->initialRefreshGraph();
+
+    const int dabSize = 160;
+    const int dabSpacing = 40;
+    const int numDabs = 96;
+
+    QBENCHMARK {
+        for (int i = 0; i < numDabs; i++) {
+            const QPoint center(256 + i * dabSpacing, 256 + i * dabSpacing / 2);
+            topLayer->setDirty(QRect(center - QPoint(dabSize / 2, dabSize / 2), QSize(dabSize, dabSize)));
+        }
+
+        image->waitForDone();
+    }
+}
 
 SIMPLE_TEST_MAIN(KisProjectionBenchmark)
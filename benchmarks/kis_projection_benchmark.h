@@ -20,6 +20,7 @@ private Q_SLOTS:
 
     void benchmarkProjection();
     void benchmarkLoading();
+    void benchmarkMultiDabStrokeUpdates();
 };
 
 #endif
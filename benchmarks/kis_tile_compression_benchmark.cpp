@@ -0,0 +1,194 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_tile_compression_benchmark.h"
+
+#include <simpletest.h>
+#include <QElapsedTimer>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <kis_paint_device.h>
+#include <kis_datamanager.h>
+
+#include "tiles3/kis_tile.h"
+#include "tiles3/kis_tile_data.h"
+#include "tiles3/swap/kis_tile_compressor_2.h"
+#include "tiles3/swap/kis_compression_factory.h"
+
+#define NUM_CYCLES 5
+
+namespace {
+
+QVector<KisTileSP> collectTiles(KisPaintDeviceSP dev)
+{
+    KisDataManagerSP dm = dev->dataManager();
+
+    // the image is loaded at (0, 0), so we can use simple division
+    const QRect rc = dev->exactBounds();
+    KIS_ASSERT(rc.left() >= 0 && rc.top() >= 0);
+
+    QVector<KisTileSP> tiles;
+
+    for (int row = rc.top() / KisTileData::HEIGHT; row <= rc.bottom() / KisTileData::HEIGHT; row++) {
+        for (int col = rc.left() / KisTileData::WIDTH; col <= rc.right() / KisTileData::WIDTH; col++) {
+            tiles.append(dm->getTile(col, row, false));
+        }
+    }
+
+    return tiles;
+}
+
+struct TileBuffer {
+    QByteArray data;
+    qint32 size = 0;
+};
+
+void reportSpeed(const QString &title, const QString &codec, int pixelSize,
+                 qint64 rawBytes, qint64 compressedBytes, qint64 nsecs)
+{
+    const qreal megabytesPerSec =
+        nsecs > 0 ? qreal(rawBytes) / (1 << 20) / (qreal(nsecs) / 1e9) : 0.0;
+
+    qDebug() << qPrintable(title)
+             << qPrintable(QString("%1 (%2 bytes/px):").arg(codec).arg(pixelSize))
+             << qPrintable(QString("%1 MB/s,").arg(megabytesPerSec, 0, 'f', 1))
+             << qPrintable(QString("ratio %1").arg(qreal(compressedBytes) / rawBytes, 0, 'f', 3));
+}
+
+KisPaintDeviceSP deviceForPixelSize(int pixelSize, KisPaintDeviceSP u8, KisPaintDeviceSP f32)
+{
+    return pixelSize == 4 ? u8 : f32;
+}
+
+}
+
+void KisTileCompressionBenchmark::initTestCase()
+{
+    QImage image(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    QVERIFY(!image.isNull());
+
+    m_deviceU8 = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    m_deviceU8->convertFromQImage(image, 0, 0, 0);
+
+    m_deviceF32 = new KisPaintDevice(*m_deviceU8);
+    m_deviceF32->convertTo(KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), 0));
+}
+
+void KisTileCompressionBenchmark::benchmarkCompression_data()
+{
+    QTest::addColumn<QString>("codec");
+    QTest::addColumn<int>("pixelSize");
+
+    Q_FOREACH (const QString &codec, KisCompressionFactory::availableCompressions()) {
+        QTest::newRow(QString("%1-u8").arg(codec).toLatin1()) << codec << 4;
+        QTest::newRow(QString("%1-f32").arg(codec).toLatin1()) << codec << 16;
+    }
+}
+
+void KisTileCompressionBenchmark::benchmarkCompression()
+{
+    QFETCH(QString, codec);
+    QFETCH(int, pixelSize);
+
+    KisPaintDeviceSP dev = deviceForPixelSize(pixelSize, m_deviceU8, m_deviceF32);
+    QVector<KisTileSP> tiles = collectTiles(dev);
+
+    KisTileCompressor2 compressor(codec);
+    QCOMPARE(compressor.compressionName(), codec);
+
+    QByteArray buffer;
+    qint64 rawBytes = 0;
+    qint64 compressedBytes = 0;
+    qint64 nsecs = 0;
+
+    QBENCHMARK_ONCE {
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < NUM_CYCLES; i++) {
+            Q_FOREACH (KisTileSP tile, tiles) {
+                tile->lockForRead();
+
+                const qint32 bufferSize = compressor.tileDataBufferSize(tile->tileData());
+                if (buffer.size() < bufferSize) {
+                    buffer.resize(bufferSize);
+                }
+
+                qint32 bytesWritten = 0;
+                compressor.compressTileData(tile->tileData(), (quint8*)buffer.data(), bufferSize, bytesWritten);
+                tile->unlockForRead();
+
+                rawBytes += bufferSize - 1;
+                compressedBytes += bytesWritten;
+            }
+        }
+
+        nsecs = timer.nsecsElapsed();
+    }
+
+    reportSpeed("Compression", codec, pixelSize, rawBytes, compressedBytes, nsecs);
+}
+
+void KisTileCompressionBenchmark::benchmarkDecompression_data()
+{
+    benchmarkCompression_data();
+}
+
+void KisTileCompressionBenchmark::benchmarkDecompression()
+{
+    QFETCH(QString, codec);
+    QFETCH(int, pixelSize);
+
+    KisPaintDeviceSP dev = deviceForPixelSize(pixelSize, m_deviceU8, m_deviceF32);
+    KisPaintDeviceSP dstDev = new KisPaintDevice(dev->colorSpace());
+    QVector<KisTileSP> tiles = collectTiles(dev);
+
+    KisTileCompressor2 compressor(codec);
+
+    QVector<TileBuffer> compressedTiles;
+    qint64 rawBytes = 0;
+    qint64 compressedBytes = 0;
+
+    Q_FOREACH (KisTileSP tile, tiles) {
+        TileBuffer buffer;
+
+        tile->lockForRead();
+        buffer.data.resize(compressor.tileDataBufferSize(tile->tileData()));
+        compressor.compressTileData(tile->tileData(), (quint8*)buffer.data.data(), buffer.data.size(), buffer.size);
+        tile->unlockForRead();
+
+        compressedBytes += buffer.size;
+        compressedTiles.append(buffer);
+    }
+
+    KisTileSP dstTile = dstDev->dataManager()->getTile(0, 0, true);
+    qint64 nsecs = 0;
+
+    QBENCHMARK_ONCE {
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < NUM_CYCLES; i++) {
+            Q_FOREACH (const TileBuffer &buffer, compressedTiles) {
+                dstTile->lockForWrite();
+                const bool result =
+                    compressor.decompressTileData((quint8*)buffer.data.data(), buffer.size, dstTile->tileData());
+                dstTile->unlockForWrite();
+
+                KIS_SAFE_ASSERT_RECOVER_NOOP(result);
+
+                rawBytes += buffer.data.size() - 1;
+            }
+        }
+
+        nsecs = timer.nsecsElapsed();
+    }
+
+    reportSpeed("Decompression", codec, pixelSize, rawBytes, compressedBytes * NUM_CYCLES, nsecs);
+}
+
+SIMPLE_TEST_MAIN(KisTileCompressionBenchmark)
@@ -0,0 +1,36 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_TILE_COMPRESSION_BENCHMARK_H
+#define KIS_TILE_COMPRESSION_BENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+/**
+ * Compares the codecs of KisCompressionFactory on the tiles of a
+ * real image, reporting compression/decompression throughput in MB/s
+ * and the compression ratio for every codec and pixel size.
+ */
+class KisTileCompressionBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkCompression_data();
+    void benchmarkCompression();
+
+    void benchmarkDecompression_data();
+    void benchmarkDecompression();
+
+private:
+    KisPaintDeviceSP m_deviceU8;
+    KisPaintDeviceSP m_deviceF32;
+};
+
+#endif /* KIS_TILE_COMPRESSION_BENCHMARK_H */
@@ -0,0 +1,101 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_update_queue_benchmark.h"
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_image.h"
+#include "kis_paint_layer.h"
+#include "kis_simple_update_queue.h"
+
+
+const int NUM_RECTS = 10000;
+const QRect IMAGE_RECT(0, 0, 16000, 16000);
+
+void KisUpdateQueueBenchmark::initTestCase()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    m_image = new KisImage(0, IMAGE_RECT.width(), IMAGE_RECT.height(), cs, "update queue benchmark");
+
+    m_layer = new KisPaintLayer(m_image, "layer", OPACITY_OPAQUE_U8);
+
+    m_image->barrierLock();
+    m_image->addNode(m_layer);
+    m_image->unlock();
+}
+
+void KisUpdateQueueBenchmark::cleanupTestCase()
+{
+    m_layer = 0;
+    m_image = 0;
+}
+
+void KisUpdateQueueBenchmark::benchmarkAddSparseRects()
+{
+    /**
+     * The rects don't intersect, so none of them is merged and every
+     * new rect has to look for its merge candidates among all the
+     * pending jobs
+     */
+    QVector<QRect> rects;
+    for (int i = 0; i < NUM_RECTS; i++) {
+        rects << QRect((i % 100) * 160, (i / 100) * 160, 16, 16);
+    }
+
+    QBENCHMARK {
+        KisSimpleUpdateQueue queue;
+
+        Q_FOREACH (const QRect &rc, rects) {
+            queue.addUpdateJob(m_layer, rc, IMAGE_RECT, 0);
+        }
+
+        QCOMPARE(queue.sizeMetric(), NUM_RECTS);
+    }
+}
+
+void KisUpdateQueueBenchmark::benchmarkAddOverlappingRects()
+{
+    /**
+     * Every rect overlaps the previous one, so the rects are merged
+     * into patch-sized jobs
+     */
+    QVector<QRect> rects;
+    for (int i = 0; i < NUM_RECTS; i++) {
+        rects << QRect((i % 1000) * 16, (i / 1000) * 16, 24, 24);
+    }
+
+    QBENCHMARK {
+        KisSimpleUpdateQueue queue;
+
+        Q_FOREACH (const QRect &rc, rects) {
+            queue.addUpdateJob(m_layer, rc, IMAGE_RECT, 0);
+        }
+    }
+}
+
+void KisUpdateQueueBenchmark::benchmarkOptimize()
+{
+    QVector<QRect> rects;
+    for (int i = 0; i < NUM_RECTS; i++) {
+        rects << QRect((i % 100) * 160, (i / 100) * 160, 16, 16);
+    }
+
+    QBENCHMARK {
+        KisSimpleUpdateQueue queue;
+
+        Q_FOREACH (const QRect &rc, rects) {
+            queue.addUpdateJob(m_layer, rc, IMAGE_RECT, 0);
+        }
+
+        for (int i = 0; i < 100; i++) {
+            queue.optimize();
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisUpdateQueueBenchmark)
@@ -0,0 +1,35 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_UPDATE_QUEUE_BENCHMARK_H
+#define KIS_UPDATE_QUEUE_BENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+
+/**
+ * Measures the cost of adding lots of small update rects into
+ * KisSimpleUpdateQueue, like a filter or a transform does when it
+ * emits its dirty rects patch by patch.
+ */
+class KisUpdateQueueBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkAddSparseRects();
+    void benchmarkAddOverlappingRects();
+    void benchmarkOptimize();
+
+private:
+    KisImageSP m_image;
+    KisNodeSP m_layer;
+};
+
+#endif /* KIS_UPDATE_QUEUE_BENCHMARK_H */
@@ -0,0 +1,168 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAdaptiveSchedulingController.h"
+
+#include <kis_assert.h>
+
+
+const qint64 KisAdaptiveSchedulingController::SAMPLING_INTERVAL = 50000;
+
+namespace {
+
+/**
+ * The jobs shorter than that (in microseconds) are considered to be
+ * comparable with the cost of waking up a thread
+ */
+const qreal SMALL_JOB_DURATION = 250.0;
+
+const qreal LOW_UTILIZATION = 0.3;
+const qreal HIGH_UTILIZATION = 0.7;
+
+/**
+ * The weight of the new sample in the smoothed values
+ */
+const qreal SMOOTHING_FACTOR = 0.5;
+
+const int MIN_ACTIVE_THREADS = 2;
+const qreal MIN_BALANCING_FACTOR = 0.25;
+
+qreal smoothValue(qreal oldValue, qreal newValue)
+{
+    return oldValue + SMOOTHING_FACTOR * (newValue - oldValue);
+}
+
+}
+
+KisAdaptiveSchedulingController::KisAdaptiveSchedulingController(int maxThreads, qreal defaultBalancingRatio)
+    : m_maxThreads(qMax(1, maxThreads)),
+      m_activeThreadsLimit(m_maxThreads),
+      m_defaultBalancingRatio(defaultBalancingRatio)
+{
+}
+
+void KisAdaptiveSchedulingController::setMaxThreads(int value)
+{
+    m_maxThreads = qMax(1, value);
+    m_activeThreadsLimit = m_maxThreads;
+}
+
+int KisAdaptiveSchedulingController::maxThreads() const
+{
+    return m_maxThreads;
+}
+
+void KisAdaptiveSchedulingController::setDefaultBalancingRatio(qreal value)
+{
+    m_defaultBalancingRatio = value;
+    m_balancingFactor = 1.0;
+}
+
+qreal KisAdaptiveSchedulingController::defaultBalancingRatio() const
+{
+    return m_defaultBalancingRatio;
+}
+
+int KisAdaptiveSchedulingController::minThreads() const
+{
+    return qMin(MIN_ACTIVE_THREADS, m_maxThreads);
+}
+
+bool KisAdaptiveSchedulingController::addSample(const Sample &sample)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(sample.elapsedTime > 0, false);
+
+    const int pendingJobs = sample.updatesQueueSize + sample.strokesQueueSize;
+
+    if (!pendingJobs && !sample.numRunningJobs && !sample.numFinishedJobs) {
+        return notifyQueuesDrained();
+    }
+
+    if (sample.numFinishedJobs > 0) {
+        const qreal duration = qreal(sample.busyTime) / sample.numFinishedJobs;
+        m_averageJobDuration =
+            m_averageJobDuration < 0 ? duration : smoothValue(m_averageJobDuration, duration);
+    }
+
+    const qreal utilization =
+        qBound(0.0, qreal(sample.busyTime) / (qreal(sample.elapsedTime) * m_activeThreadsLimit), 1.0);
+    m_utilization = smoothValue(m_utilization, utilization);
+
+    const bool jobsAreSmall =
+        m_averageJobDuration >= 0 && m_averageJobDuration < SMALL_JOB_DURATION;
+    const int numSpareThreads = m_activeThreadsLimit - sample.numRunningJobs;
+
+    int newLimit = m_activeThreadsLimit;
+
+    if (pendingJobs >= 2 * m_maxThreads && !jobsAreSmall) {
+        newLimit = m_maxThreads;
+    } else if (pendingJobs > numSpareThreads &&
+               (m_utilization > HIGH_UTILIZATION || !jobsAreSmall)) {
+        newLimit++;
+    } else if (jobsAreSmall && m_utilization < LOW_UTILIZATION) {
+        newLimit--;
+    }
+
+    newLimit = qBound(minThreads(), newLimit, m_maxThreads);
+
+    qreal newBalancingFactor = m_balancingFactor;
+
+    if (sample.strokesQueueSize > 0 &&
+        sample.updatesQueueSize > newLimit &&
+        sample.updatesQueueSize > m_lastUpdatesQueueSize) {
+
+        newBalancingFactor = qMax(MIN_BALANCING_FACTOR, 0.5 * m_balancingFactor);
+    } else if (!sample.updatesQueueSize) {
+        newBalancingFactor = qMin(1.0, 2.0 * m_balancingFactor);
+    }
+
+    m_lastUpdatesQueueSize = sample.updatesQueueSize;
+
+    const bool changed =
+        newLimit != m_activeThreadsLimit ||
+        newBalancingFactor != m_balancingFactor;
+
+    m_activeThreadsLimit = newLimit;
+    m_balancingFactor = newBalancingFactor;
+
+    return changed;
+}
+
+bool KisAdaptiveSchedulingController::notifyQueuesDrained()
+{
+    m_averageJobDuration = -1.0;
+    m_utilization = 0.0;
+    m_lastUpdatesQueueSize = 0;
+
+    const bool changed =
+        m_activeThreadsLimit != m_maxThreads ||
+        m_balancingFactor != 1.0;
+
+    m_activeThreadsLimit = m_maxThreads;
+    m_balancingFactor = 1.0;
+
+    return changed;
+}
+
+int KisAdaptiveSchedulingController::activeThreadsLimit() const
+{
+    return m_activeThreadsLimit;
+}
+
+qreal KisAdaptiveSchedulingController::balancingRatio() const
+{
+    return m_balancingFactor * m_defaultBalancingRatio;
+}
+
+qreal KisAdaptiveSchedulingController::averageJobDuration() const
+{
+    return m_averageJobDuration;
+}
+
+qreal KisAdaptiveSchedulingController::utilization() const
+{
+    return m_utilization;
+}
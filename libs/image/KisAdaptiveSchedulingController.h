@@ -0,0 +1,131 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISADAPTIVESCHEDULINGCONTROLLER_H
+#define KISADAPTIVESCHEDULINGCONTROLLER_H
+
+#include <QtGlobal>
+
+#include "kritaimage_export.h"
+
+/**
+ * A feedback controller that adjusts the number of threads the
+ * updater context is allowed to use and the balancing ratio between
+ * the strokes and the updates queues of KisUpdateScheduler.
+ *
+ * The scheduler feeds the controller with the samples of its load:
+ * the number of running jobs, the depths of the queues and the time
+ * the jobs spent executing since the previous sample. From that the
+ * controller estimates the average duration of a job and the
+ * utilization of the active threads:
+ *
+ * * when the jobs are tiny and the threads are mostly idle, waking up
+ *   lots of threads costs more than the jobs themselves, so the
+ *   number of active threads is decreased step by step;
+ *
+ * * when the queues contain more work than the active threads can
+ *   take, the number is increased: right up to the maximum when the
+ *   backlog is big (e.g. on a full refresh), step by step otherwise;
+ *
+ * * when the updates queue keeps growing while there are strokes in
+ *   the queue, the projection is lagging behind the stroke, so the
+ *   balancing ratio is decreased to let the merge jobs in. It returns
+ *   back to the default value when the updates queue drains.
+ *
+ * When the scheduler runs out of work, it calls notifyQueuesDrained()
+ * and the controller starts the next burst from the defaults.
+ *
+ * The controller doesn't access the scheduler itself. It is not
+ * thread-safe, so the samples should be added by one thread at a
+ * time.
+ */
+class KRITAIMAGE_EXPORT KisAdaptiveSchedulingController
+{
+public:
+    struct Sample {
+        int numRunningJobs = 0;
+        int updatesQueueSize = 0;
+        int strokesQueueSize = 0;
+
+        /// the number of jobs finished since the previous sample
+        int numFinishedJobs = 0;
+        /// the time spent in the finished jobs, in microseconds
+        qint64 busyTime = 0;
+        /// the time since the previous sample, in microseconds
+        qint64 elapsedTime = 0;
+    };
+
+    /**
+     * The minimal interval between the samples, in microseconds
+     */
+    static const qint64 SAMPLING_INTERVAL;
+
+public:
+    KisAdaptiveSchedulingController(int maxThreads, qreal defaultBalancingRatio);
+
+    /**
+     * Sets the number of threads available in the updater context
+     * and resets the active threads limit to it
+     */
+    void setMaxThreads(int value);
+    int maxThreads() const;
+
+    /**
+     * Sets the ratio set by the user and resets the current ratio
+     * to it
+     */
+    void setDefaultBalancingRatio(qreal value);
+    qreal defaultBalancingRatio() const;
+
+    /**
+     * Updates the estimations with \p sample
+     *
+     * @return true if activeThreadsLimit() or balancingRatio() has
+     *         changed
+     */
+    bool addSample(const Sample &sample);
+
+    /**
+     * Should be called when the queues of the scheduler are empty
+     * and all the jobs have finished. The next burst of work will
+     * probably be of a different kind, so the estimations of the
+     * previous one are forgotten and the active threads limit and
+     * the balancing ratio are returned to their default values.
+     *
+     * @return true if activeThreadsLimit() or balancingRatio() has
+     *         changed
+     */
+    bool notifyQueuesDrained();
+
+    int activeThreadsLimit() const;
+    qreal balancingRatio() const;
+
+    /**
+     * Smoothed average duration of a job, in microseconds
+     */
+    qreal averageJobDuration() const;
+
+    /**
+     * Smoothed portion of time the active threads were busy, [0, 1]
+     */
+    qreal utilization() const;
+
+private:
+    int minThreads() const;
+
+private:
+    int m_maxThreads;
+    int m_activeThreadsLimit;
+
+    qreal m_defaultBalancingRatio;
+    qreal m_balancingFactor = 1.0;
+    int m_lastUpdatesQueueSize = 0;
+
+    qreal m_averageJobDuration = -1.0;
+    qreal m_utilization = 0.0;
+};
+
+#endif // KISADAPTIVESCHEDULINGCONTROLLER_H
@@ -0,0 +1,157 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBelowStackCache.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+
+#include <KoColorSpace.h>
+
+#include "kis_node.h"
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+
+
+const int KisBelowStackCache::MIN_CACHED_NODES = 2;
+
+struct KisBelowStackCache::Private
+{
+    QMutex mutex;
+
+    KisPaintDeviceSP cacheDevice;
+    QRegion validRegion;
+
+    KisNodeWSP filthyChild;
+    QVector<KisNodeWSP> belowNodes;
+
+    /**
+     * Incremented every time the key or the device changes, so that
+     * a store() racing with a reset() would not mark stale data as
+     * valid
+     */
+    int generation = 0;
+
+    bool keyMatches(KisNodeSP filthy, const QVector<KisNodeSP> &nodes) const {
+        if (!filthyChild.isValid() || filthyChild != filthy.data()) return false;
+        if (belowNodes.size() != nodes.size()) return false;
+
+        for (int i = 0; i < nodes.size(); i++) {
+            if (!belowNodes[i].isValid() || belowNodes[i] != nodes[i].data()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void resetKey(KisNodeSP filthy, const QVector<KisNodeSP> &nodes) {
+        filthyChild = filthy;
+
+        belowNodes.clear();
+        belowNodes.reserve(nodes.size());
+        Q_FOREACH (KisNodeSP node, nodes) {
+            belowNodes.append(node);
+        }
+
+        validRegion = QRegion();
+        generation++;
+    }
+};
+
+KisBelowStackCache::KisBelowStackCache()
+    : m_d(new Private)
+{
+}
+
+KisBelowStackCache::~KisBelowStackCache()
+{
+}
+
+bool KisBelowStackCache::tryFetch(KisNodeSP filthyChild, const QVector<KisNodeSP> &belowNodes,
+                                  const QRect &rect, KisPaintDeviceSP dst)
+{
+    KisPaintDeviceSP cacheDevice;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        if (!m_d->keyMatches(filthyChild, belowNodes) ||
+            !m_d->cacheDevice ||
+            *m_d->cacheDevice->colorSpace() != *dst->colorSpace()) {
+
+            m_d->resetKey(filthyChild, belowNodes);
+            return false;
+        }
+
+        if (!(QRegion(rect) - m_d->validRegion).isEmpty()) {
+            return false;
+        }
+
+        cacheDevice = m_d->cacheDevice;
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), cacheDevice, dst, rect);
+    return true;
+}
+
+void KisBelowStackCache::store(KisNodeSP filthyChild, const QVector<KisNodeSP> &belowNodes,
+                               const QRect &rect, KisPaintDeviceSP src)
+{
+    KisPaintDeviceSP cacheDevice;
+    int generation = 0;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        if (!m_d->keyMatches(filthyChild, belowNodes)) return;
+
+        if (!m_d->cacheDevice ||
+            *m_d->cacheDevice->colorSpace() != *src->colorSpace()) {
+
+            m_d->cacheDevice = new KisPaintDevice(src->colorSpace());
+            m_d->cacheDevice->setDefaultPixel(src->defaultPixel());
+            m_d->validRegion = QRegion();
+            m_d->generation++;
+        }
+
+        cacheDevice = m_d->cacheDevice;
+        generation = m_d->generation;
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), src, cacheDevice, rect);
+
+    QMutexLocker l(&m_d->mutex);
+    if (generation == m_d->generation) {
+        m_d->validRegion += rect;
+    }
+}
+
+void KisBelowStackCache::invalidate(const QRect &rect)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->validRegion -= rect;
+}
+
+void KisBelowStackCache::reset()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->resetKey(0, QVector<KisNodeSP>());
+    m_d->cacheDevice = 0;
+}
+
+QRegion KisBelowStackCache::validRegion() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->validRegion;
+}
+
+KisNodeSP KisBelowStackCache::filthyChild() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->filthyChild.isValid() ? KisNodeSP(m_d->filthyChild) : KisNodeSP();
+}
@@ -0,0 +1,91 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBELOWSTACKCACHE_H
+#define KISBELOWSTACKCACHE_H
+
+#include <QScopedPointer>
+#include <QVector>
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class QRegion;
+
+/**
+ * A cache of the composite of the layers placed below the currently
+ * updated child of a group layer (the "backdrop" of the filthy node).
+ *
+ * When the user paints on a layer, KisAsyncMerger recomposes the
+ * whole group for every update patch, even though all the layers
+ * below the painted one haven't changed. The cache keeps this
+ * composite in a separate device, so that the merger can copy it
+ * into the group's original instead of blending all the lower layers
+ * once again.
+ *
+ * The cache is keyed by the filthy child and the list of the children
+ * below it. Every recomposition of the group with a different key
+ * drops the cache and starts collecting the new one. Recompositions
+ * that cannot use the cache (LoD, varying need rects, non-trivial
+ * subtree walkers) invalidate the processed area only.
+ *
+ * The walkers running in parallel never have intersecting access
+ * rects, so the pixel data can be read and written without locking;
+ * only the key and the valid region are guarded with a mutex.
+ */
+class KRITAIMAGE_EXPORT KisBelowStackCache
+{
+public:
+    /**
+     * The backdrop of fewer nodes is blended directly, it is not
+     * worth an extra copy
+     */
+    static const int MIN_CACHED_NODES;
+
+public:
+    KisBelowStackCache();
+    ~KisBelowStackCache();
+
+    /**
+     * Copies the cached backdrop of \p filthyChild into \p dst.
+     *
+     * @return true if the cache contains the whole \p rect for the
+     *         passed key. When the key doesn't match, the cache is
+     *         reset to the new key and false is returned.
+     */
+    bool tryFetch(KisNodeSP filthyChild, const QVector<KisNodeSP> &belowNodes,
+                  const QRect &rect, KisPaintDeviceSP dst);
+
+    /**
+     * Saves \p rect of \p src as the backdrop of \p filthyChild.
+     * Does nothing if the cache has been reset to a different key in
+     * the meantime.
+     */
+    void store(KisNodeSP filthyChild, const QVector<KisNodeSP> &belowNodes,
+               const QRect &rect, KisPaintDeviceSP src);
+
+    /**
+     * Marks \p rect as dirty, e.g. when one of the nodes below the
+     * filthy one is updated
+     */
+    void invalidate(const QRect &rect);
+
+    /**
+     * Drops the whole cache, e.g. when the group is moved or its
+     * color space is changed
+     */
+    void reset();
+
+    QRegion validRegion() const;
+    KisNodeSP filthyChild() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISBELOWSTACKCACHE_H
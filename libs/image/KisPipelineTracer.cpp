@@ -0,0 +1,304 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPipelineTracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGlobalStatic>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <kis_debug.h>
+#include "kis_node.h"
+
+
+const int KisPipelineTracer::DEFAULT_CAPACITY = 1 << 16;
+
+Q_GLOBAL_STATIC(KisPipelineTracer, s_instance)
+
+namespace {
+
+const int MAX_NAME_SIZE = 64;
+
+/**
+ * A slot of the ring buffer. The sequence number works like a
+ * seqlock: it is odd while the slot is being written and equals
+ * 2 * (index + 1) when the event with \p index is complete.
+ */
+struct Slot {
+    std::atomic<quint64> sequence {0};
+
+    KisPipelineTracer::Category category = KisPipelineTracer::Merge;
+    char name[MAX_NAME_SIZE];
+    int nameSize = 0;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    int levelOfDetail = 0;
+    int threadId = 0;
+    qint64 start = 0;
+    qint64 end = 0;
+};
+
+int currentThreadTraceId()
+{
+    static std::atomic<int> s_lastThreadId {0};
+    thread_local int threadId = ++s_lastThreadId;
+    return threadId;
+}
+
+QString categoryName(KisPipelineTracer::Category category)
+{
+    switch (category) {
+    case KisPipelineTracer::Merge:
+        return "merge";
+    case KisPipelineTracer::MergeLeaf:
+        return "merge-leaf";
+    case KisPipelineTracer::Mask:
+        return "mask";
+    case KisPipelineTracer::StrokeJob:
+        return "stroke-job";
+    case KisPipelineTracer::SpontaneousJob:
+        return "spontaneous-job";
+    case KisPipelineTracer::Stroke:
+        return "stroke";
+    }
+
+    return "unknown";
+}
+
+}
+
+struct KisPipelineTracer::Private
+{
+    Private(int _capacity)
+    {
+        capacity = 1;
+        while (capacity < _capacity) {
+            capacity <<= 1;
+        }
+
+        slots.reset(new Slot[capacity]);
+        timer.start();
+    }
+
+    std::atomic<bool> enabled {false};
+    std::atomic<quint64> writeIndex {0};
+
+    QScopedArrayPointer<Slot> slots;
+    int capacity = 0;
+
+    QElapsedTimer timer;
+    QString exitTraceFile;
+};
+
+KisPipelineTracer::KisPipelineTracer(int capacity)
+    : m_d(new Private(capacity))
+{
+    m_d->exitTraceFile = qEnvironmentVariable("KRITA_PIPELINE_TRACE_FILE");
+
+    if (!m_d->exitTraceFile.isEmpty()) {
+        setEnabled(true);
+    }
+}
+
+KisPipelineTracer::~KisPipelineTracer()
+{
+    if (!m_d->exitTraceFile.isEmpty()) {
+        exportChromeTrace(m_d->exitTraceFile);
+    }
+}
+
+KisPipelineTracer* KisPipelineTracer::instance()
+{
+    return s_instance;
+}
+
+bool KisPipelineTracer::isEnabled() const
+{
+    return m_d->enabled.load(std::memory_order_relaxed);
+}
+
+void KisPipelineTracer::setEnabled(bool value)
+{
+    m_d->enabled.store(value, std::memory_order_relaxed);
+}
+
+qint64 KisPipelineTracer::timestamp() const
+{
+    return m_d->timer.nsecsElapsed() / 1000;
+}
+
+void KisPipelineTracer::addEvent(Category category, const QString &name,
+                                 const QRect &rect, int levelOfDetail,
+                                 qint64 start, qint64 end)
+{
+    const quint64 index = m_d->writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = m_d->slots[int(index & quint64(m_d->capacity - 1))];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const QByteArray utf8Name = name.toUtf8();
+    slot.nameSize = qMin(utf8Name.size(), MAX_NAME_SIZE);
+    std::memcpy(slot.name, utf8Name.constData(), size_t(slot.nameSize));
+
+    slot.category = category;
+    slot.x = rect.x();
+    slot.y = rect.y();
+    slot.width = rect.width();
+    slot.height = rect.height();
+    slot.levelOfDetail = levelOfDetail;
+    slot.threadId = currentThreadTraceId();
+    slot.start = start;
+    slot.end = end;
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+QVector<KisPipelineTracer::Event> KisPipelineTracer::events() const
+{
+    QVector<Event> result;
+    result.reserve(int(qMin(m_d->writeIndex.load(), quint64(m_d->capacity))));
+
+    for (int i = 0; i < m_d->capacity; i++) {
+        const Slot &slot = m_d->slots[i];
+
+        const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        if (!sequence || sequence & 0x1) continue;
+
+        Event event;
+        char name[MAX_NAME_SIZE];
+        const int nameSize = qBound(0, slot.nameSize, MAX_NAME_SIZE);
+        std::memcpy(name, slot.name, size_t(nameSize));
+
+        event.category = slot.category;
+        event.rect = QRect(slot.x, slot.y, slot.width, slot.height);
+        event.levelOfDetail = slot.levelOfDetail;
+        event.threadId = slot.threadId;
+        event.start = slot.start;
+        event.end = slot.end;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+        event.name = QString::fromUtf8(name, nameSize);
+        result.append(event);
+    }
+
+    std::sort(result.begin(), result.end(),
+              [] (const Event &lhs, const Event &rhs) {
+                  return lhs.start < rhs.start;
+              });
+
+    return result;
+}
+
+void KisPipelineTracer::clear()
+{
+    for (int i = 0; i < m_d->capacity; i++) {
+        m_d->slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+QByteArray KisPipelineTracer::toChromeTrace() const
+{
+    QJsonArray traceEvents;
+
+    Q_FOREACH (const Event &event, events()) {
+        QJsonObject args;
+        args["lod"] = event.levelOfDetail;
+
+        if (!event.rect.isEmpty()) {
+            args["rect"] = QString("%1,%2 %3x%4")
+                .arg(event.rect.x()).arg(event.rect.y())
+                .arg(event.rect.width()).arg(event.rect.height());
+        }
+
+        QJsonObject object;
+        object["name"] = event.name;
+        object["cat"] = categoryName(event.category);
+        object["ph"] = "X";
+        object["ts"] = double(event.start);
+        object["dur"] = double(event.end - event.start);
+        object["pid"] = 1;
+        object["tid"] = event.threadId;
+        object["args"] = args;
+
+        traceEvents.append(object);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool KisPipelineTracer::exportChromeTrace(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnImage << "KisPipelineTracer: failed to open" << fileName;
+        return false;
+    }
+
+    file.write(toChromeTrace());
+    return true;
+}
+
+/*********************************************************************/
+/*                  KisPipelineTracer::Scope                         */
+/*********************************************************************/
+
+KisPipelineTracer::Scope::Scope(Category category, const QString &name,
+                                const QRect &rect, int levelOfDetail)
+    : m_category(category),
+      m_rect(rect),
+      m_levelOfDetail(levelOfDetail),
+      m_start(-1)
+{
+    KisPipelineTracer *tracer = KisPipelineTracer::instance();
+
+    if (tracer && tracer->isEnabled()) {
+        m_name = name;
+        m_start = tracer->timestamp();
+    }
+}
+
+KisPipelineTracer::Scope::Scope(Category category, KisNodeSP node,
+                                const QRect &rect, int levelOfDetail)
+    : m_category(category),
+      m_rect(rect),
+      m_levelOfDetail(levelOfDetail),
+      m_start(-1)
+{
+    KisPipelineTracer *tracer = KisPipelineTracer::instance();
+
+    if (tracer && tracer->isEnabled()) {
+        m_name = node ? node->name() : QString();
+        m_start = tracer->timestamp();
+    }
+}
+
+KisPipelineTracer::Scope::~Scope()
+{
+    if (m_start < 0) return;
+
+    KisPipelineTracer *tracer = KisPipelineTracer::instance();
+
+    if (tracer) {
+        tracer->addEvent(m_category, m_name, m_rect, m_levelOfDetail,
+                         m_start, tracer->timestamp());
+    }
+}
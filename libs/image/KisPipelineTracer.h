@@ -0,0 +1,124 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPIPELINETRACER_H
+#define KISPIPELINETRACER_H
+
+#include <QScopedPointer>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+/**
+ * Records the jobs of the projection pipeline (merge jobs, the layers
+ * they compose, stroke jobs and strokes) for a later inspection in a
+ * trace viewer.
+ *
+ * The events are written into a fixed-size lock-free ring buffer, so
+ * recording doesn't serialize the updater threads; when the buffer
+ * overflows, the oldest events are overwritten. The buffer can be
+ * exported in Chrome trace-event JSON format, which is understood by
+ * chrome://tracing, Perfetto and similar tools.
+ *
+ * Tracing is disabled by default. It can be enabled with
+ * setEnabled() or by setting KRITA_PIPELINE_TRACE_FILE environment
+ * variable. In the latter case the trace is written into the passed
+ * file on application exit.
+ */
+class KRITAIMAGE_EXPORT KisPipelineTracer
+{
+public:
+    enum Category {
+        Merge = 0,
+        MergeLeaf,
+        Mask,
+        StrokeJob,
+        SpontaneousJob,
+        Stroke
+    };
+
+    struct Event {
+        Category category = Merge;
+        QString name;
+        QRect rect;
+        int levelOfDetail = 0;
+        int threadId = 0;
+        /// in microseconds since the tracer creation
+        qint64 start = 0;
+        qint64 end = 0;
+    };
+
+    /**
+     * Records the time spent in the current scope. Does nothing if the
+     * tracing was disabled on construction of the scope.
+     */
+    class KRITAIMAGE_EXPORT Scope
+    {
+    public:
+        Scope(Category category, const QString &name,
+              const QRect &rect = QRect(), int levelOfDetail = 0);
+
+        /**
+         * The name of the node is fetched only when the tracing is
+         * enabled
+         */
+        Scope(Category category, KisNodeSP node,
+              const QRect &rect, int levelOfDetail);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        Category m_category;
+        QString m_name;
+        QRect m_rect;
+        int m_levelOfDetail;
+        qint64 m_start;
+    };
+
+public:
+    explicit KisPipelineTracer(int capacity = DEFAULT_CAPACITY);
+    ~KisPipelineTracer();
+
+    static KisPipelineTracer* instance();
+
+    /**
+     * A cheap check to be done before preparing the event data
+     */
+    bool isEnabled() const;
+    void setEnabled(bool value);
+
+    /**
+     * Current time in the tracer's clock
+     */
+    qint64 timestamp() const;
+
+    void addEvent(Category category, const QString &name,
+                  const QRect &rect, int levelOfDetail,
+                  qint64 start, qint64 end);
+
+    /**
+     * Returns the events currently present in the buffer sorted by
+     * their start time. Events being written right now are skipped.
+     */
+    QVector<Event> events() const;
+
+    void clear();
+
+    QByteArray toChromeTrace() const;
+    bool exportChromeTrace(const QString &fileName) const;
+
+    static const int DEFAULT_CAPACITY;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISPIPELINETRACER_H
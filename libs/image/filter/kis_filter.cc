@@ -50,6 +50,8 @@ void KisFilter::process(const KisPaintDeviceSP src,
     if (applyRect.isEmpty()) return;
     QRect needRect = neededRect(applyRect, config, src->defaultBounds()->currentLevelOfDetail());
 
+    src->prefetchRect(needRect);
+
     KisPaintDeviceSP temporary;
     KisTransaction *transaction = 0;
 
@@ -27,6 +27,8 @@
 #include "kis_clone_layer.h"
 #include "kis_processing_information.h"
 #include "kis_busy_progress_indicator.h"
+#include "KisBelowStackCache.h"
+#include "KisPipelineTracer.h"
 
 
 #include "kis_merge_walker.h"
@@ -192,6 +194,10 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
 
         QRect applyRect = item.m_applyRect;
 
+        KisPipelineTracer::Scope traceScope(KisPipelineTracer::MergeLeaf,
+                                            currentLeaf->node(), applyRect,
+                                            walker.levelOfDetail());
+
         if (currentLeaf->isRoot()) {
             currentLeaf->projectionPlane()->recalculate(applyRect, walker.startNode(), item.m_renderFlags);
             continue;
@@ -212,6 +218,10 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
 
         if (!m_currentProjection) {
             setupProjection(currentLeaf, applyRect, useTempProjections);
+
+            if (tryUseBelowStackCache(walker, item, useTempProjections)) {
+                continue;
+            }
         }
 
         KisUpdateOriginalVisitor originalVisitor(applyRect,
@@ -326,6 +336,85 @@ bool KisAsyncMerger::compositeWithProjection(KisProjectionLeafSP leaf, const QRe
     return true;
 }
 
+bool KisAsyncMerger::tryUseBelowStackCache(KisBaseRectsWalker &walker,
+                                           const KisBaseRectsWalker::JobItem &firstItem,
+                                           bool useTempProjection)
+{
+    KisProjectionLeafSP parentLeaf = firstItem.m_leaf->parent();
+    KisGroupLayer *group = parentLeaf ? qobject_cast<KisGroupLayer*>(parentLeaf->node().data()) : 0;
+    if (!group) return false;
+
+    KisBelowStackCache *cache = group->belowStackCache();
+    const QRect &rect = firstItem.m_applyRect;
+
+    /**
+     * The group is going to be recomposed in a way we cannot cache,
+     * so just make sure the stale backdrop is not used afterwards
+     */
+    if (!m_currentProjection || useTempProjection ||
+        walker.levelOfDetail() > 0 ||
+        !(firstItem.m_position & KisMergeWalker::N_BELOW_FILTHY)) {
+
+        cache->invalidate(rect);
+        return false;
+    }
+
+    auto isSibling = [parentLeaf, &rect] (const KisBaseRectsWalker::JobItem &item) {
+        KisProjectionLeafSP parent = item.m_leaf->parent();
+        return parent && parent->node() == parentLeaf->node() && item.m_applyRect == rect;
+    };
+
+    KisMergeWalker::LeafStack &leafStack = walker.leafStack();
+
+    /**
+     * The stack is popped from its end, so all the nodes below the
+     * filthy one come first and the filthy node follows them.
+     */
+    QVector<KisBaseRectsWalker::JobItem> belowItems;
+    belowItems << firstItem;
+
+    int filthyIndex = leafStack.size() - 1;
+    for (; filthyIndex >= 0; filthyIndex--) {
+        const KisBaseRectsWalker::JobItem &item = leafStack[filthyIndex];
+        if (!(item.m_position & KisMergeWalker::N_BELOW_FILTHY) || !isSibling(item)) break;
+
+        belowItems << item;
+    }
+
+    if (filthyIndex < 0 ||
+        leafStack[filthyIndex].m_position & KisMergeWalker::N_BELOW_FILTHY ||
+        !isSibling(leafStack[filthyIndex]) ||
+        belowItems.size() < KisBelowStackCache::MIN_CACHED_NODES) {
+
+        cache->invalidate(rect);
+        return false;
+    }
+
+    KisNodeSP filthyChild = leafStack[filthyIndex].m_leaf->node();
+
+    QVector<KisNodeSP> belowNodes;
+    belowNodes.reserve(belowItems.size());
+    Q_FOREACH (const KisBaseRectsWalker::JobItem &item, belowItems) {
+        belowNodes << item.m_leaf->node();
+    }
+
+    leafStack.resize(filthyIndex + 1);
+
+    if (cache->tryFetch(filthyChild, belowNodes, rect, m_currentProjection)) {
+        DEBUG_NODE_ACTION("Fetching backdrop", "N_BELOW_FILTHY", leafStack.top().m_leaf, rect);
+        return true;
+    }
+
+    Q_FOREACH (const KisBaseRectsWalker::JobItem &item, belowItems) {
+        DEBUG_NODE_ACTION("Updating", "N_BELOW_FILTHY", item.m_leaf, rect);
+        compositeWithProjection(item.m_leaf, rect);
+    }
+
+    cache->store(filthyChild, belowNodes, rect, m_currentProjection);
+
+    return true;
+}
+
 void KisAsyncMerger::doNotifyClones(KisBaseRectsWalker &walker) {
     KisBaseRectsWalker::CloneNotificationsVector &vector =
         walker.cloneNotifications();
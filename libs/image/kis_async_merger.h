@@ -9,9 +9,9 @@
 #include "kritaimage_export.h"
 #include "kis_types.h"
 #include "KisRenderPassFlags.h"
+#include "kis_base_rects_walker.h"
 
 class QRect;
-class KisBaseRectsWalker;
 
 class KRITAIMAGE_EXPORT KisAsyncMerger
 {
@@ -24,6 +24,9 @@ private:
     inline void writeProjection(KisProjectionLeafSP topmostLeaf, bool useTempProjection, const QRect &rect);
     inline bool compositeWithProjection(KisProjectionLeafSP leaf, const QRect &rect);
     inline void doNotifyClones(KisBaseRectsWalker &walker);
+    inline bool tryUseBelowStackCache(KisBaseRectsWalker &walker,
+                                      const KisBaseRectsWalker::JobItem &firstItem,
+                                      bool useTempProjection);
 
 private:
     /**
@@ -155,6 +155,14 @@ public:
         return ACTUAL_DATAMGR::region();
     }
 
+    /**
+     * Returns the extents of the tiles changed since \p epoch, see
+     * KisTile::advanceWriteEpoch()
+     */
+    QVector<QRect> tileRectsChangedSince(quint64 epoch) const {
+        return ACTUAL_DATAMGR::tileRectsChangedSince(epoch);
+    }
+
 public:
 
     /**
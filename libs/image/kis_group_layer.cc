@@ -27,6 +27,7 @@
 #include "kis_layer_properties_icons.h"
 #include <kis_projection_leaf.h>
 #include <kis_abstract_projection_plane.h>
+#include "KisBelowStackCache.h"
 
 
 struct Q_DECL_HIDDEN KisGroupLayer::Private
@@ -44,6 +45,7 @@ public:
     qint32 x;
     qint32 y;
     bool passThroughMode;
+    KisBelowStackCache belowStackCache;
 
     std::tuple<KisPaintDeviceSP, bool> originalImpl() const;
 };
@@ -192,6 +194,8 @@ void KisGroupLayer::resetCache(const KoColorSpace *colorSpace)
 
     Q_ASSERT(colorSpace);
 
+    m_d->belowStackCache.reset();
+
     if (!m_d->paintDevice) {
 
         KisPaintDeviceSP dev = new KisPaintDevice(this, colorSpace, new KisDefaultBounds(image()));
@@ -309,6 +313,7 @@ bool KisGroupLayer::projectionIsValid() const
 void KisGroupLayer::setDefaultProjectionColor(KoColor color)
 {
     m_d->paintDevice->setDefaultPixel(color);
+    m_d->belowStackCache.reset();
 }
 
 KoColor KisGroupLayer::defaultProjectionColor() const
@@ -327,6 +332,7 @@ void KisGroupLayer::setPassThroughMode(bool value)
     if (m_d->passThroughMode == value) return;
 
     m_d->passThroughMode = value;
+    m_d->belowStackCache.reset();
     if (m_d->passThroughMode) {
         resetCache(colorSpace());
     }
@@ -378,6 +384,7 @@ qint32 KisGroupLayer::y() const
 void KisGroupLayer::setX(qint32 x)
 {
     m_d->x = x;
+    m_d->belowStackCache.reset();
     if(m_d->paintDevice) {
         m_d->paintDevice->setX(x);
     }
@@ -386,11 +393,17 @@ void KisGroupLayer::setX(qint32 x)
 void KisGroupLayer::setY(qint32 y)
 {
     m_d->y = y;
+    m_d->belowStackCache.reset();
     if(m_d->paintDevice) {
         m_d->paintDevice->setY(y);
     }
 }
 
+KisBelowStackCache* KisGroupLayer::belowStackCache() const
+{
+    return &m_d->belowStackCache;
+}
+
 struct ExtentPolicy
 {
     inline QRect operator() (const KisNode *node) {
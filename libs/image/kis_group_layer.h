@@ -11,6 +11,7 @@
 #include "kis_types.h"
 
 class KoColorSpace;
+class KisBelowStackCache;
 
 /**
  * A KisLayer that bundles child layers into a single layer.
@@ -105,6 +106,13 @@ public:
     QRect calculateChildrenTightUserVisibleBounds() const;
     QRect calculateChildrenLooseUserVisibleBounds() const;
 
+    /**
+     * The composite of the children placed below the currently
+     * updated one. It is used by KisAsyncMerger to avoid blending
+     * the unchanged lower layers for every update of the upper one.
+     */
+    KisBelowStackCache* belowStackCache() const;
+
 protected:
     KisLayer* onlyMeaningfulChild() const;
     KisPaintDeviceSP tryObligeChild() const;
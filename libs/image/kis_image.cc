@@ -195,7 +195,12 @@ public:
             });
         }
 
-        connect(q, SIGNAL(sigImageModified()), KisMemoryStatisticsServer::instance(), SLOT(notifyImageChanged()));
+        connect(q, &KisImage::sigImageModified, q, [this] () {
+            KisMemoryStatisticsServer::instance()->notifyImageContentChanged(q);
+        });
+        connect(animationInterface, &KisImageAnimationInterface::sigUiTimeChanged, q, [this] () {
+            KisMemoryStatisticsServer::instance()->notifyImageFrameChanged(q);
+        });
         connect(undoStore.data(), SIGNAL(historyStateChanged()), &signalRouter, SLOT(emitImageModifiedNotification()));
     }
 
@@ -325,10 +330,14 @@ KisImage::KisImage(KisUndoStore *undoStore, qint32 width, qint32 height, const K
 
     setObjectName(name);
     setRootLayer(new KisGroupLayer(this, "root", OPACITY_OPAQUE_U8));
+
+    KisMemoryStatisticsServer::instance()->registerImage(this);
 }
 
 KisImage::~KisImage()
 {
+    KisMemoryStatisticsServer::instance()->unregisterImage(this);
+
     /**
      * Request the tools to end currently running strokes
      */
@@ -564,6 +573,8 @@ KisImage::KisImage(const KisImage& rhs, KisUndoStore *undoStore, bool exactCopy)
     connect(this, SIGNAL(sigInternalStopIsolatedModeRequested()), SLOT(stopIsolatedMode()));
 
     copyFromImageImpl(rhs, CONSTRUCT | (exactCopy ? EXACT_COPY : 0));
+
+    KisMemoryStatisticsServer::instance()->registerImage(this);
 }
 
 void KisImage::aboutToAddANode(KisNode *parent, int index)
@@ -1301,7 +1312,8 @@ void KisImage::convertLayerColorSpace(KisNodeSP node,
     applicator.applyVisitor(
         new KisConvertColorSpaceProcessingVisitor(
             srcColorSpace, dstColorSpace,
-            renderingIntent, conversionFlags),
+            renderingIntent, conversionFlags,
+            applicator.runnableJobsInterface()),
         KisStrokeJobData::CONCURRENT);
 
     applicator.end();
@@ -1365,7 +1377,8 @@ void KisImage::KisImagePrivate::convertImageColorSpaceImpl(const KoColorSpace *d
     applicator.applyVisitor(
                 new KisConvertColorSpaceProcessingVisitor(
                     srcColorSpace, dstColorSpace,
-                    renderingIntent, conversionFlags),
+                    renderingIntent, conversionFlags,
+                    applicator.runnableJobsInterface()),
                 KisStrokeJobData::CONCURRENT);
 
     applicator.applyCommand(
@@ -1411,7 +1424,8 @@ void KisImage::unifyLayersColorSpace()
                 new KisConvertColorSpaceProcessingVisitor(
                     m_d->colorSpace, m_d->colorSpace,
                     KoColorConversionTransformation::internalRenderingIntent(),
-                    KoColorConversionTransformation::internalConversionFlags()),
+                    KoColorConversionTransformation::internalConversionFlags(),
+                    applicator.runnableJobsInterface()),
                 KisStrokeJobData::CONCURRENT);
 
     applicator.end();
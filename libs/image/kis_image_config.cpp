@@ -22,6 +22,7 @@
 #include <QDir>
 
 #include "kis_global.h"
+#include "tiles3/swap/kis_compression_factory.h"
 #include <cmath>
 #include <QTemporaryFile>
 
@@ -137,6 +138,17 @@ void KisImageConfig::setSchedulerBalancingRatio(qreal value)
     m_config.writeEntry("schedulerBalancingRatio", value);
 }
 
+bool KisImageConfig::adaptiveScheduling(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("adaptiveScheduling", true) : true;
+}
+
+void KisImageConfig::setAdaptiveScheduling(bool value)
+{
+    m_config.writeEntry("adaptiveScheduling", value);
+}
+
 int KisImageConfig::maxSwapSize(bool requestDefault) const
 {
     return !requestDefault ?
@@ -168,6 +180,45 @@ void KisImageConfig::setSwapWindowSize(int value)
     m_config.writeEntry("swapWindowSize", value);
 }
 
+QString KisImageConfig::swapCompressionType(bool requestDefault) const
+{
+    const QString defaultValue =
+        KisCompressionFactory::isAvailable(KisCompressionFactory::LZ4) ?
+            KisCompressionFactory::LZ4 : KisCompressionFactory::LZF;
+
+    return !requestDefault ?
+        m_config.readEntry("swapCompressionType", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setSwapCompressionType(const QString &value)
+{
+    m_config.writeEntry("swapCompressionType", value);
+}
+
+QString KisImageConfig::tileFileCompressionType(bool requestDefault) const
+{
+    const QString defaultValue = KisCompressionFactory::LZF;
+
+    return !requestDefault ?
+        m_config.readEntry("tileFileCompressionType", defaultValue) : defaultValue;
+}
+
+void KisImageConfig::setTileFileCompressionType(const QString &value)
+{
+    m_config.writeEntry("tileFileCompressionType", value);
+}
+
+bool KisImageConfig::mapUncompressedTileFiles(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("mapUncompressedTileFiles", false) : false;
+}
+
+void KisImageConfig::setMapUncompressedTileFiles(bool value)
+{
+    m_config.writeEntry("mapUncompressedTileFiles", value);
+}
+
 int KisImageConfig::tilesHardLimit() const
 {
     qreal hp = qreal(memoryHardLimitPercent()) / 100.0;
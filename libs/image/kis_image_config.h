@@ -37,6 +37,16 @@ public:
     qreal schedulerBalancingRatio() const;
     void setSchedulerBalancingRatio(qreal value);
 
+    /**
+     * If enabled, the update scheduler adjusts the number of active
+     * threads and the balancing ratio to the current load, see
+     * KisAdaptiveSchedulingController. Otherwise, all the
+     * maxNumberOfThreads() threads are used and the balancing ratio
+     * is taken from schedulerBalancingRatio().
+     */
+    bool adaptiveScheduling(bool requestDefault = false) const;
+    void setAdaptiveScheduling(bool value);
+
     int maxSwapSize(bool requestDefault = false) const;
     void setMaxSwapSize(int value);
 
@@ -46,6 +56,30 @@ public:
     int swapWindowSize() const;
     void setSwapWindowSize(int value);
 
+    /**
+     * Id of the codec used for compressing tiles in the swap file,
+     * see KisCompressionFactory for the list of ids
+     */
+    QString swapCompressionType(bool requestDefault = false) const;
+    void setSwapCompressionType(const QString &value);
+
+    /**
+     * Id of the codec used for compressing layer tiles saved into
+     * .kra files. Please take into account that the files saved
+     * with non-LZF codecs cannot be opened by older versions of Krita.
+     */
+    QString tileFileCompressionType(bool requestDefault = false) const;
+    void setTileFileCompressionType(const QString &value);
+
+    /**
+     * If enabled, the tiles saved without compression (codec "NONE")
+     * are mapped into memory directly from the file when the layer
+     * is loaded from a plain file (e.g. a directory-based store).
+     * The file must not be modified while the document is open.
+     */
+    bool mapUncompressedTileFiles(bool requestDefault = false) const;
+    void setMapUncompressedTileFiles(bool value);
+
     int tilesHardLimit() const; // MiB
     int tilesSoftLimit() const; // MiB
     int poolLimit() const; // MiB
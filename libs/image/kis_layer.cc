@@ -48,6 +48,7 @@
 #include "kis_layer_properties_icons.h"
 #include "kis_layer_utils.h"
 #include "kis_projection_leaf.h"
+#include "KisPipelineTracer.h"
 #include "KisSafeNodeProjectionStore.h"
 
 
@@ -711,6 +712,9 @@ QRect KisLayer::applyMasks(const KisPaintDeviceSP source,
                     applyRects.isEmpty() ? needRect : applyRects.top();
                     
                 PositionToFilthy maskPosition = calculatePositionToFilthy(mask, filthyNode, const_cast<KisLayer*>(this));
+
+                KisPipelineTracer::Scope traceScope(KisPipelineTracer::Mask, mask, maskApplyRect,
+                                                    destination->defaultBounds()->currentLevelOfDetail());
                 mask->apply(destination, maskApplyRect, maskNeedRect, maskPosition, flags);
             }
             Q_ASSERT(applyRects.isEmpty());
@@ -730,7 +734,12 @@ QRect KisLayer::applyMasks(const KisPaintDeviceSP source,
 
             Q_FOREACH (const KisEffectMaskSP& mask, masks) {
                 PositionToFilthy maskPosition = calculatePositionToFilthy(mask, filthyNode, const_cast<KisLayer*>(this));
-                mask->apply(tempDevice, maskApplyRect, maskNeedRect, maskPosition, flags);
+
+                {
+                    KisPipelineTracer::Scope traceScope(KisPipelineTracer::Mask, mask, maskApplyRect,
+                                                        tempDevice->defaultBounds()->currentLevelOfDetail());
+                    mask->apply(tempDevice, maskApplyRect, maskNeedRect, maskPosition, flags);
+                }
 
                 if (!applyRects.isEmpty()) {
                     maskNeedRect = maskApplyRect;
@@ -8,10 +8,14 @@
 
 #include <QGlobalStatic>
 #include <QApplication>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
 
 #include "kis_image.h"
 #include "kis_image_config.h"
 #include "kis_signal_compressor.h"
+#include "kis_spontaneous_job.h"
 
 #include "tiles3/kis_tile_data_store.h"
 
@@ -20,11 +24,33 @@ Q_GLOBAL_STATIC(KisMemoryStatisticsServer, s_instance)
 struct Q_DECL_HIDDEN KisMemoryStatisticsServer::Private
 {
     Private(KisMemoryStatisticsServer *q)
-        : updateCompressor(1000 /* ms */, KisSignalCompressor::POSTPONE, q)
+        : updateCompressor(1000 /* ms */, KisSignalCompressor::POSTPONE, q),
+          evictionCompressor(3000 /* ms */, KisSignalCompressor::FIRST_INACTIVE, q)
     {
     }
 
     KisSignalCompressor updateCompressor;
+    KisSignalCompressor evictionCompressor;
+
+    struct ImageMemory {
+        qint64 memorySize = 0;
+        qint64 swappedSize = 0;
+    };
+
+    QMutex imagesLock;
+    QList<KisImage*> images;
+    KisImage *activeImage = 0;
+    QHash<KisImage*, ImageMemory> imagesMemory;
+
+    /**
+     * The images whose content (or activity) has changed since the
+     * last update of their eviction priorities, the images that have
+     * only switched the current frame, and the images whose update
+     * job is still running.
+     */
+    QSet<KisImage*> changedImages;
+    QSet<KisImage*> frameChangedImages;
+    QSet<KisImage*> updatingImages;
 };
 
 
@@ -38,6 +64,7 @@ KisMemoryStatisticsServer::KisMemoryStatisticsServer()
      */
     moveToThread(qApp->thread());
     connect(&m_d->updateCompressor, SIGNAL(timeout()), SIGNAL(sigUpdateMemoryStatistics()));
+    connect(&m_d->evictionCompressor, SIGNAL(timeout()), SLOT(updateEvictionPriorities()));
 }
 
 KisMemoryStatisticsServer::~KisMemoryStatisticsServer()
@@ -123,6 +150,88 @@ qint64 calculateNodeMemoryHiBound(KisNodeSP node,
                                           lodSize);
 }
 
+void updateNodeEvictionPriorityStep(KisNodeSP node,
+                                    bool isActiveImage,
+                                    bool framesOnly,
+                                    QSet<KisPaintDevice*> &devices,
+                                    qint64 &memorySize,
+                                    qint64 &swappedSize)
+{
+    auto updateDevice = [&] (KisPaintDeviceSP dev) {
+        if (dev && !devices.contains(dev.data())) {
+            devices.insert(dev.data());
+
+            qint64 deviceMemorySize = 0;
+            qint64 deviceSwappedSize = 0;
+
+            dev->updateEvictionPriority(isActiveImage, framesOnly, deviceMemorySize, deviceSwappedSize);
+
+            memorySize += deviceMemorySize;
+            swappedSize += deviceSwappedSize;
+        }
+    };
+
+    updateDevice(node->paintDevice());
+    updateDevice(node->original());
+    updateDevice(node->projection());
+
+    node = node->firstChild();
+    while (node) {
+        updateNodeEvictionPriorityStep(node, isActiveImage, framesOnly, devices,
+                                       memorySize, swappedSize);
+        node = node->nextSibling();
+    }
+}
+
+/**
+ * Walks all the tile data of a single image in the context of its
+ * update scheduler, so that the GUI thread is not blocked for the
+ * duration of the walk
+ */
+class KisUpdateEvictionPrioritiesJob : public KisSpontaneousJob
+{
+public:
+    KisUpdateEvictionPrioritiesJob(KisImage *image, KisNodeSP root, bool isActiveImage, bool framesOnly)
+        : m_image(image),
+          m_root(root),
+          m_isActiveImage(isActiveImage),
+          m_framesOnly(framesOnly)
+    {
+    }
+
+    bool overrides(const KisSpontaneousJob *otherJob) override {
+        Q_UNUSED(otherJob);
+        // the server never starts two jobs for the same image
+        return false;
+    }
+
+    void run() override {
+        QSet<KisPaintDevice*> devices;
+        qint64 memorySize = 0;
+        qint64 swappedSize = 0;
+
+        updateNodeEvictionPriorityStep(m_root, m_isActiveImage, m_framesOnly,
+                                       devices, memorySize, swappedSize);
+
+        KisMemoryStatisticsServer::instance()->
+            finishEvictionPrioritiesUpdate(m_image, !m_framesOnly, memorySize, swappedSize);
+    }
+
+    int levelOfDetail() const override {
+        return 0;
+    }
+
+    QString debugName() const override {
+        return "KisUpdateEvictionPrioritiesJob";
+    }
+
+private:
+    // used as a key only, the image may already be unregistered
+    KisImage *m_image;
+    KisNodeSP m_root;
+    bool m_isActiveImage;
+    bool m_framesOnly;
+};
 
 KisMemoryStatisticsServer::Statistics
 KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
@@ -145,6 +254,27 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
 
     stats.swapSize = tileStats.swapSize;
 
+    stats.allocatorReservedSize = tileStats.allocatorReservedSize;
+    stats.allocatorUsedSize = tileStats.allocatorUsedSize;
+    stats.allocatorHugePageSize = tileStats.allocatorHugePageSize;
+
+    stats.deduplicatedSize = tileStats.deduplicatedSize;
+    stats.fileMappedSize = tileStats.fileMappedSize;
+
+    {
+        QMutexLocker l(&m_d->imagesLock);
+
+        for (auto it = m_d->imagesMemory.constBegin(); it != m_d->imagesMemory.constEnd(); ++it) {
+            if (it.key() == image.data()) {
+                stats.imageMemorySize = it->memorySize;
+                stats.imageSwappedSize = it->swappedSize;
+            } else {
+                stats.backgroundImagesMemorySize += it->memorySize;
+                stats.backgroundImagesSwappedSize += it->swappedSize;
+            }
+        }
+    }
+
     KisImageConfig cfg(true);
 
     stats.tilesHardLimit = cfg.tilesHardLimit() * MiB;
@@ -155,6 +285,154 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     return stats;
 }
 
+void KisMemoryStatisticsServer::registerImage(KisImage *image)
+{
+    QMutexLocker l(&m_d->imagesLock);
+    m_d->images.append(image);
+
+    // picked up by the next update of the priorities
+    m_d->changedImages.insert(image);
+}
+
+void KisMemoryStatisticsServer::unregisterImage(KisImage *image)
+{
+    QMutexLocker l(&m_d->imagesLock);
+    m_d->images.removeOne(image);
+    m_d->imagesMemory.remove(image);
+    m_d->changedImages.remove(image);
+    m_d->frameChangedImages.remove(image);
+    m_d->updatingImages.remove(image);
+
+    if (m_d->activeImage == image) {
+        m_d->activeImage = 0;
+    }
+}
+
+void KisMemoryStatisticsServer::setActiveImage(KisImageSP image)
+{
+    {
+        QMutexLocker l(&m_d->imagesLock);
+        if (m_d->activeImage == image.data()) return;
+
+        /**
+         * When no image was active, all of them were treated as
+         * active ones, so all of them should be updated
+         */
+        if (!m_d->activeImage || !image) {
+            Q_FOREACH (KisImage *registeredImage, m_d->images) {
+                m_d->changedImages.insert(registeredImage);
+            }
+        } else {
+            m_d->changedImages.insert(m_d->activeImage);
+            m_d->changedImages.insert(image.data());
+        }
+
+        m_d->activeImage = image.data();
+    }
+
+    m_d->evictionCompressor.start();
+}
+
+void KisMemoryStatisticsServer::notifyImageContentChanged(KisImage *image)
+{
+    {
+        QMutexLocker l(&m_d->imagesLock);
+        if (!m_d->images.contains(image)) return;
+        m_d->changedImages.insert(image);
+    }
+
+    m_d->evictionCompressor.start();
+
+    /**
+     * The global numbers of the store can be shown right away, the
+     * per-image sizes are updated when the priorities pass is done
+     */
+    notifyImageChanged();
+}
+
+void KisMemoryStatisticsServer::notifyImageFrameChanged(KisImage *image)
+{
+    {
+        QMutexLocker l(&m_d->imagesLock);
+        if (!m_d->images.contains(image)) return;
+        m_d->frameChangedImages.insert(image);
+    }
+
+    m_d->evictionCompressor.start();
+}
+
+void KisMemoryStatisticsServer::updateEvictionPriorities()
+{
+    QMutexLocker l(&m_d->imagesLock);
+
+    Q_FOREACH (KisImage *image, m_d->images) {
+        const bool contentChanged = m_d->changedImages.contains(image);
+        const bool frameChanged = m_d->frameChangedImages.contains(image);
+
+        if (!contentChanged && !frameChanged) continue;
+
+        /**
+         * The image will be processed when its current job finishes,
+         * see finishEvictionPrioritiesUpdate()
+         */
+        if (m_d->updatingImages.contains(image)) continue;
+
+        m_d->changedImages.remove(image);
+        m_d->frameChangedImages.remove(image);
+
+        KisNodeSP root = image->root();
+        if (!root) continue;
+
+        /**
+         * When no image is marked as active (e.g. in batch mode),
+         * all the images are treated equally
+         */
+        const bool isActiveImage = !m_d->activeImage || image == m_d->activeImage;
+
+        /**
+         * The image cannot be destroyed while we are holding the lock,
+         * because its destructor unregisters it first
+         */
+        m_d->updatingImages.insert(image);
+        image->addSpontaneousJob(
+            new KisUpdateEvictionPrioritiesJob(image, root, isActiveImage, !contentChanged));
+    }
+}
+
+void KisMemoryStatisticsServer::finishEvictionPrioritiesUpdate(KisImage *image, bool updateSizes,
+                                                               qint64 memorySize, qint64 swappedSize)
+{
+    bool hasPendingUpdates = false;
+
+    {
+        QMutexLocker l(&m_d->imagesLock);
+
+        m_d->updatingImages.remove(image);
+
+        if (updateSizes && m_d->images.contains(image)) {
+            Private::ImageMemory &memory = m_d->imagesMemory[image];
+            memory.memorySize = memorySize;
+            memory.swappedSize = swappedSize;
+        }
+
+        hasPendingUpdates =
+            m_d->changedImages.contains(image) ||
+            m_d->frameChangedImages.contains(image);
+    }
+
+    /**
+     * We are called from a worker thread of the image's scheduler,
+     * the compressor lives in the GUI thread
+     */
+    if (hasPendingUpdates) {
+        QMetaObject::invokeMethod(&m_d->evictionCompressor, "start", Qt::QueuedConnection);
+    }
+
+    if (updateSizes) {
+        Q_EMIT sigUpdateMemoryStatistics();
+    }
+}
+
 void KisMemoryStatisticsServer::tryForceUpdateMemoryStatisticsWhileIdle()
 {
     KisTileDataStore::instance()->tryForceUpdateMemoryStatisticsWhileIdle();
@@ -34,6 +34,18 @@ public:
 
               swapSize(0),
 
+              allocatorReservedSize(0),
+              allocatorUsedSize(0),
+              allocatorHugePageSize(0),
+
+              deduplicatedSize(0),
+              fileMappedSize(0),
+
+              imageMemorySize(0),
+              imageSwappedSize(0),
+              backgroundImagesMemorySize(0),
+              backgroundImagesSwappedSize(0),
+
               totalMemoryLimit(0),
               tilesHardLimit(0),
               tilesSoftLimit(0),
@@ -53,6 +65,24 @@ public:
 
         qint64 swapSize;
 
+        qint64 allocatorReservedSize;
+        qint64 allocatorUsedSize;
+        qint64 allocatorHugePageSize;
+
+        qint64 deduplicatedSize;
+        qint64 fileMappedSize;
+
+        /**
+         * The tile data of the requested image that is present in
+         * memory and in the swap, and the same for all the other
+         * (background) images. Updated together with the eviction
+         * priorities, see updateEvictionPriorities().
+         */
+        qint64 imageMemorySize;
+        qint64 imageSwappedSize;
+        qint64 backgroundImagesMemorySize;
+        qint64 backgroundImagesSwappedSize;
+
         qint64 totalMemoryLimit;
         qint64 tilesHardLimit;
         qint64 tilesSoftLimit;
@@ -68,13 +98,52 @@ public:
 
     Statistics fetchMemoryStatistics(KisImageSP image) const;
 
+    /**
+     * Every image registers itself in the server on construction, so
+     * that its data could be accounted and prioritized for eviction
+     */
+    void registerImage(KisImage *image);
+    void unregisterImage(KisImage *image);
+
+    /**
+     * Sets the image the user is working with. The data of all the
+     * other images is swapped out first when the memory is low.
+     */
+    void setActiveImage(KisImageSP image);
+
+    /**
+     * Schedule the update of the eviction priorities of \p image,
+     * either fully, when its content has changed, or only of the
+     * frames switched by the animation playback. The updates are
+     * compressed and done for the changed images only. A content
+     * change also schedules sigUpdateMemoryStatistics().
+     */
+    void notifyImageContentChanged(KisImage *image);
+    void notifyImageFrameChanged(KisImage *image);
+
 public Q_SLOTS:
     void notifyImageChanged();
     void tryForceUpdateMemoryStatisticsWhileIdle();
 
+    /**
+     * Marks the tile data of the changed images with the eviction
+     * priorities (see KisTileData::EvictionPriority) and recalculates
+     * their memory statistics: the data of the background images goes
+     * to the swap first, then the inactive frames of the active image,
+     * then its history.
+     *
+     * The tiles are walked by a spontaneous job in the update scheduler
+     * of every image, never more than one job per image at a time.
+     */
+    void updateEvictionPriorities();
+
 Q_SIGNALS:
     void sigUpdateMemoryStatistics();
 
+private:
+    friend class KisUpdateEvictionPrioritiesJob;
+    void finishEvictionPrioritiesUpdate(KisImage *image, bool updateSizes,
+                                        qint64 memorySize, qint64 swappedSize);
 
 private:
     struct Private;
@@ -13,6 +13,8 @@
 #include <QImage>
 #include <QList>
 #include <QHash>
+#include <QMap>
+#include <QSet>
 #include <QIODevice>
 #include <qmath.h>
 #include <KisRegion.h>
@@ -43,6 +45,7 @@
 #include "tiles3/kis_hline_iterator.h"
 #include "tiles3/kis_vline_iterator.h"
 #include "tiles3/kis_random_accessor.h"
+#include "tiles3/kis_tile.h"
 
 #include "kis_default_bounds.h"
 
@@ -102,6 +105,10 @@ public:
                            KoColorConversionTransformation::ConversionFlags conversionFlags,
                            KUndo2Command *parentCommand,
                            KoUpdater *progressUpdater);
+    KUndo2Command* prepareConvertColorSpace(const KoColorSpace *dstColorSpace,
+                                            KoColorConversionTransformation::Intent renderingIntent,
+                                            KoColorConversionTransformation::ConversionFlags conversionFlags,
+                                            QVector<KisRunnableStrokeJobData*> &jobs);
     bool assignProfile(const KoColorProfile * profile, KUndo2Command *parentCommand);
 
     KUndo2Command* reincarnateWithDetachedHistory(bool copyContent);
@@ -155,6 +162,7 @@ public:
 
         m_lodData.reset();
         m_externalFrameData.reset();
+        resetLodPlaneCache();
 
         if (!m_frames.isEmpty()) {
             m_frames.clear();
@@ -415,10 +423,12 @@ public:
     void uploadFrameData(DataSP srcData, DataSP dstData);
 
     struct LodDataStructImpl;
-    LodDataStruct* createLodDataStruct(int lod);
+    LodDataStruct* createLodDataStruct(int lod, const LodSyncPoint &syncPoint);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
     KisRegion regionForLodSyncing() const;
+    KisRegion regionForLodSyncing(int lod, LodSyncPoint *syncPoint) const;
+    LodSyncPoint captureLodSyncPoint() const;
 
     void updateLodDataManager(KisDataManager *srcDataManager,
                               KisDataManager *dstDataManager, const QPoint &srcOffset, const QPoint &dstOffset,
@@ -450,6 +460,11 @@ public:
             lodData += estimateDataSize(m_lodData.data());
         }
 
+        QMutexLocker l(&m_lodPlaneCacheLock);
+        Q_FOREACH (const LodPlaneCache &cache, m_lodPlaneCaches) {
+            lodData += estimateDataSize(cache.plane.data());
+        }
+
         if (m_externalFrameData) {
             temporaryData += estimateDataSize(m_externalFrameData.data());
         }
@@ -459,6 +474,86 @@ public:
         }
     }
 
+    void updateEvictionPriority(bool isActiveImage, bool framesOnly, qint64 &memorySize, qint64 &swappedSize) const {
+        memorySize = 0;
+        swappedSize = 0;
+
+        const KisTileData::EvictionPriority inactivePriority =
+            isActiveImage ? KisTileData::INACTIVE_FRAME : KisTileData::BACKGROUND_IMAGE;
+        const KisTileData::EvictionPriority activePriority =
+            isActiveImage ? KisTileData::EVICT_LAST : KisTileData::BACKGROUND_IMAGE;
+
+        const Data *currentData = contentChannel ? currentFrameData().data() : m_data.data();
+
+        if (framesOnly &&
+            m_evictionPrioritiesValid &&
+            m_evictionIsActiveImage == isActiveImage) {
+
+            if (m_evictionActiveData == currentData) return;
+
+            /**
+             * Only the frame that has just become inactive and the new
+             * current frame need to be retagged. The old frame might
+             * have been removed meanwhile, so look it up among the
+             * alive ones.
+             */
+            qint64 unusedMemorySize = 0;
+            qint64 unusedSwappedSize = 0;
+
+            Q_FOREACH (DataSP value, m_frames.values()) {
+                if (value.data() == m_evictionActiveData) {
+                    value->dataManager()->setEvictionPriority(inactivePriority, unusedMemorySize, unusedSwappedSize);
+                    break;
+                }
+            }
+
+            if (currentData) {
+                currentData->dataManager()->setEvictionPriority(activePriority, unusedMemorySize, unusedSwappedSize);
+            }
+
+            m_evictionActiveData = currentData;
+            return;
+        }
+
+        m_evictionActiveData = currentData;
+        m_evictionIsActiveImage = isActiveImage;
+        m_evictionPrioritiesValid = true;
+
+        auto updateData = [&] (const Data *data, KisTileData::EvictionPriority priority) {
+            qint64 dataMemorySize = 0;
+            qint64 dataSwappedSize = 0;
+
+            data->dataManager()->setEvictionPriority(priority, dataMemorySize, dataSwappedSize);
+
+            memorySize += dataMemorySize;
+            swappedSize += dataSwappedSize;
+        };
+
+        if (m_data) {
+            updateData(m_data.data(), m_data.data() == currentData ? activePriority : inactivePriority);
+        }
+
+        if (m_lodData) {
+            updateData(m_lodData.data(), activePriority);
+        }
+
+        {
+            QMutexLocker l(&m_lodPlaneCacheLock);
+            Q_FOREACH (const LodPlaneCache &cache, m_lodPlaneCaches) {
+                updateData(cache.plane.data(), inactivePriority);
+            }
+        }
+
+        if (m_externalFrameData) {
+            updateData(m_externalFrameData.data(), inactivePriority);
+        }
+
+        Q_FOREACH (DataSP value, m_frames.values()) {
+            if (value == m_data) continue;
+            updateData(value.data(), value.data() == currentData ? activePriority : inactivePriority);
+        }
+    }
+
 
 private:
 
@@ -583,6 +678,41 @@ private:
 
     void transferFromData(Data *data, KisPaintDeviceSP targetDevice);
 
+    /**
+     * The state of the source data a LoD plane has been generated
+     * from. The tiles of the source changed after writeEpoch, and the
+     * tiles that are not present in \p tiles anymore, should be
+     * regenerated to bring the plane up to date.
+     */
+    struct LodSourceState {
+        KisWeakSharedPtr<KisDataManager> dataManager;
+        QPoint offset;
+        quint64 writeEpoch = 0;
+        QVector<QRect> tiles;
+    };
+
+    /**
+     * A LoD plane generated during the last sync of its level of detail
+     */
+    struct LodPlaneCache {
+        DataSP plane;
+        LodSourceState source;
+    };
+
+    const LodPlaneCache* validLodPlaneCache(Data *srcData, int lod) const;
+
+    void resetLodPlaneCache() {
+        QMutexLocker l(&m_lodPlaneCacheLock);
+        m_lodPlaneCaches.clear();
+    }
+
+    /**
+     * Drops the planes generated from another source than \p srcData,
+     * e.g. from another animation frame or before the device has been
+     * moved. They can never be reused, but keep their tiles alive.
+     */
+    void dropStaleLodPlaneCaches(Data *srcData);
+
     struct Q_DECL_HIDDEN StrategyPolicy;
     typedef KisSequentialIteratorBase<ReadOnlyIteratorPolicy<StrategyPolicy>, StrategyPolicy> InternalSequentialConstIterator;
     typedef KisSequentialIteratorBase<WritableIteratorPolicy<StrategyPolicy>, StrategyPolicy> InternalSequentialIterator;
@@ -596,8 +726,27 @@ private:
     mutable QScopedPointer<Data> m_externalFrameData;
     mutable QMutex m_dataSwitchLock;
 
+    /**
+     * The chain of LoD planes generated during the last sync of every
+     * level of detail. Unlike m_lodData, they are never painted on, so
+     * the next sync can start from a copy of the plane and regenerate
+     * only the changed tiles of the source. Keeping all the levels
+     * makes switching between them, e.g. on zooming the canvas in and
+     * out, as cheap as syncing the same level again.
+     */
+    QMap<int, LodPlaneCache> m_lodPlaneCaches;
+    mutable QMutex m_lodPlaneCacheLock;
+
     FramesHash m_frames;
     int m_nextFreeFrameId;
+
+    /**
+     * The state of the device at the last full update of the eviction
+     * priorities, so that a frame switch could retag only two frames
+     */
+    mutable const Data *m_evictionActiveData = 0;
+    mutable bool m_evictionIsActiveImage = false;
+    mutable bool m_evictionPrioritiesValid = false;
 };
 
 const KisDefaultBoundsSP KisPaintDevice::Private::transitionalDefaultBounds = new KisDefaultBounds();
@@ -676,22 +825,146 @@ struct KisPaintDevice::Private::StrategyPolicy {
 struct KisPaintDevice::Private::LodDataStructImpl : public KisPaintDevice::LodDataStruct {
     LodDataStructImpl(Data *_lodData) : lodData(_lodData) {}
     QScopedPointer<Data> lodData;
+    LodSourceState source;
 };
 
+namespace {
+inline qint64 tileKey(const QRect &tileRect) {
+    return (qint64(tileRect.x()) << 32) | quint32(tileRect.y());
+}
+}
+
+const KisPaintDevice::Private::LodPlaneCache*
+KisPaintDevice::Private::validLodPlaneCache(Data *srcData, int lod) const
+{
+    // m_lodPlaneCacheLock is expected to be held by the caller
+
+    auto it = m_lodPlaneCaches.constFind(lod);
+    if (it == m_lodPlaneCaches.constEnd()) return 0;
+
+    const LodPlaneCache &cache = *it;
+    Data *plane = cache.plane.data();
+    KisDataManager *srcDataManager = srcData->dataManager().data();
+
+    /**
+     * We compare color spaces as pure pointers, because they must be
+     * exactly the same, since they come from the common source.
+     */
+    const bool isValid =
+        cache.source.dataManager.isValid() &&
+        cache.source.dataManager == srcDataManager &&
+        cache.source.offset == QPoint(srcData->x(), srcData->y()) &&
+        plane->levelOfDetail() == lod &&
+        plane->colorSpace() == srcData->colorSpace() &&
+        !memcmp(plane->dataManager()->defaultPixel(),
+                srcDataManager->defaultPixel(),
+                srcDataManager->pixelSize());
+
+    return isValid ? &cache : 0;
+}
+
+void KisPaintDevice::Private::dropStaleLodPlaneCaches(Data *srcData)
+{
+    // m_lodPlaneCacheLock is expected to be held by the caller
+
+    auto it = m_lodPlaneCaches.begin();
+    while (it != m_lodPlaneCaches.end()) {
+        if (!validLodPlaneCache(srcData, it.key())) {
+            it = m_lodPlaneCaches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 KisRegion KisPaintDevice::Private::regionForLodSyncing() const
 {
     Data *srcData = currentNonLodData();
     return srcData->dataManager()->region().translated(srcData->x(), srcData->y());
 }
 
-KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod)
+KisPaintDevice::LodSyncPoint KisPaintDevice::Private::captureLodSyncPoint() const
+{
+    Data *srcData = currentNonLodData();
+
+    /**
+     * The epoch is advanced before the tiles are listed, so a tile
+     * written concurrently will be either regenerated by the current
+     * sync or marked as changed for the next one.
+     */
+    LodSyncPoint syncPoint;
+    syncPoint.writeEpoch = KisTile::advanceWriteEpoch();
+    syncPoint.tiles = srcData->dataManager()->tileRectsChangedSince(0);
+    return syncPoint;
+}
+
+KisRegion KisPaintDevice::Private::regionForLodSyncing(int lod, LodSyncPoint *syncPoint) const
+{
+    Data *srcData = currentNonLodData();
+
+    QMutexLocker l(&m_lodPlaneCacheLock);
+
+    *syncPoint = captureLodSyncPoint();
+
+    const LodPlaneCache *cache = validLodPlaneCache(srcData, lod);
+    if (!cache) {
+        return regionForLodSyncing();
+    }
+
+    KisDataManager *srcDataManager = srcData->dataManager().data();
+
+    QVector<QRect> rects =
+        srcDataManager->tileRectsChangedSince(cache->source.writeEpoch);
+
+    /**
+     * The tiles removed from the source since the last sync should be
+     * reset to the default pixel in the plane as well
+     */
+    QSet<qint64> currentTiles;
+    Q_FOREACH (const QRect &rc, syncPoint->tiles) {
+        currentTiles.insert(tileKey(rc));
+    }
+
+    Q_FOREACH (const QRect &rc, cache->source.tiles) {
+        if (!currentTiles.contains(tileKey(rc))) {
+            rects << rc;
+        }
+    }
+
+    return KisRegion(std::move(rects)).translated(srcData->x(), srcData->y());
+}
+
+KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod, const LodSyncPoint &syncPoint)
 {
     KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
 
     Data *srcData = currentNonLodData();
 
-    Data *lodData = new Data(q, srcData, false);
-    LodDataStruct *lodStruct = new LodDataStructImpl(lodData);
+    Data *lodData = 0;
+
+    {
+        QMutexLocker l(&m_lodPlaneCacheLock);
+
+        const LodPlaneCache *cache = validLodPlaneCache(srcData, newLod);
+
+        if (cache) {
+            // the copy shares the tiles with the cache until written
+            lodData = new Data(q, cache->plane.data(), true);
+        }
+
+        dropStaleLodPlaneCaches(srcData);
+    }
+
+    if (!lodData) {
+        lodData = new Data(q, srcData, false);
+    }
+
+    LodDataStructImpl *lodStruct = new LodDataStructImpl(lodData);
+
+    lodStruct->source.dataManager = srcData->dataManager();
+    lodStruct->source.offset = QPoint(srcData->x(), srcData->y());
+    lodStruct->source.writeEpoch = syncPoint.writeEpoch;
+    lodStruct->source.tiles = syncPoint.tiles;
 
     int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
     int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
@@ -843,6 +1116,11 @@ void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
 
     m_lodData->prepareClone(dst->lodData.data());
     m_lodData->dataManager()->bitBltRough(dst->lodData->dataManager(), dst->lodData->dataManager()->extent());
+
+    QMutexLocker l(&m_lodPlaneCacheLock);
+    LodPlaneCache &cache = m_lodPlaneCaches[dst->lodData->levelOfDetail()];
+    cache.plane = toQShared(new Data(q, dst->lodData.data(), true));
+    cache.source = dst->source;
 }
 
 void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targetDevice)
@@ -928,9 +1206,10 @@ void KisPaintDevice::Private::testingFetchLodDevice(KisPaintDeviceSP targetDevic
 class KisPaintDevice::Private::DeviceChangeProfileCommand : public KUndo2Command
 {
 public:
-    DeviceChangeProfileCommand(KisPaintDeviceSP device, KUndo2Command *parent = 0)
+    DeviceChangeProfileCommand(KisPaintDeviceSP device, KUndo2Command *parent = 0, bool skipFirstRedo = true)
         : KUndo2Command(parent),
-          m_device(device)
+          m_device(device),
+          m_firstRun(skipFirstRedo)
     {
     }
 
@@ -960,14 +1239,14 @@ protected:
     KisPaintDeviceSP m_device;
 
 private:
-    bool m_firstRun {true};
+    bool m_firstRun;
 };
 
 class KisPaintDevice::Private::DeviceChangeColorSpaceCommand : public DeviceChangeProfileCommand
 {
 public:
-    DeviceChangeColorSpaceCommand(KisPaintDeviceSP device, KUndo2Command *parent = 0)
-        : DeviceChangeProfileCommand(device, parent)
+    DeviceChangeColorSpaceCommand(KisPaintDeviceSP device, KUndo2Command *parent = 0, bool skipFirstRedo = true)
+        : DeviceChangeProfileCommand(device, parent, skipFirstRedo)
     {
     }
 
@@ -998,6 +1277,27 @@ void KisPaintDevice::Private::convertColorSpace(const KoColorSpace *dstColorSpac
     q->emitColorSpaceChanged();
 }
 
+KUndo2Command* KisPaintDevice::Private::prepareConvertColorSpace(const KoColorSpace *dstColorSpace,
+                                                                 KoColorConversionTransformation::Intent renderingIntent,
+                                                                 KoColorConversionTransformation::ConversionFlags conversionFlags,
+                                                                 QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    /**
+     * Unlike in convertColorSpace(), nothing is changed at this stage,
+     * so the first redo of the command should not be skipped
+     */
+    KUndo2Command *mainCommand = new DeviceChangeColorSpaceCommand(q, 0, false);
+
+    QList<Data*> dataObjects = allDataObjects();
+    Q_FOREACH (Data *data, dataObjects) {
+        if (!data) continue;
+
+        data->prepareConvertDataColorSpace(dstColorSpace, renderingIntent, conversionFlags, mainCommand, jobs);
+    }
+
+    return mainCommand;
+}
+
 bool KisPaintDevice::Private::assignProfile(const KoColorProfile * profile, KUndo2Command *parentCommand)
 {
     if (!profile) return false;
@@ -1190,6 +1490,11 @@ void KisPaintDevice::estimateMemoryStats(qint64 &imageData, qint64 &temporaryDat
     m_d->estimateMemoryStats(imageData, temporaryData, lodData);
 }
 
+void KisPaintDevice::updateEvictionPriority(bool isActiveImage, bool framesOnly, qint64 &memorySize, qint64 &swappedSize) const
+{
+    m_d->updateEvictionPriority(isActiveImage, framesOnly, memorySize, swappedSize);
+}
+
 void KisPaintDevice::setParentNode(KisNodeWSP parent)
 {
     KIS_SAFE_ASSERT_RECOVER_NOOP(!m_d->parent || !parent);
@@ -1559,11 +1864,13 @@ bool KisPaintDevice::read(QIODevice *stream)
 
 void KisPaintDevice::emitColorSpaceChanged()
 {
+    m_d->resetLodPlaneCache();
     Q_EMIT colorSpaceChanged(m_d->colorSpace());
 }
 
 void KisPaintDevice::emitProfileChanged()
 {
+    m_d->resetLodPlaneCache();
     Q_EMIT profileChanged(m_d->colorSpace()->profile());
 }
 
@@ -1576,6 +1883,14 @@ void KisPaintDevice::convertTo(const KoColorSpace *dstColorSpace,
     m_d->convertColorSpace(dstColorSpace, renderingIntent, conversionFlags, parentCommand, progressUpdater);
 }
 
+KUndo2Command* KisPaintDevice::prepareConvertTo(const KoColorSpace *dstColorSpace,
+                                                KoColorConversionTransformation::Intent renderingIntent,
+                                                KoColorConversionTransformation::ConversionFlags conversionFlags,
+                                                QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    return m_d->prepareConvertColorSpace(dstColorSpace, renderingIntent, conversionFlags, jobs);
+}
+
 bool KisPaintDevice::setProfile(const KoColorProfile * profile, KUndo2Command *parentCommand)
 {
     return m_d->assignProfile(profile, parentCommand);
@@ -1998,6 +2313,11 @@ void KisPaintDevice::readBytes(quint8 *data, const QRect &rect) const
     m_d->currentStrategy()->readBytes(data, rect);
 }
 
+void KisPaintDevice::prefetchRect(const QRect &rect) const
+{
+    m_d->dataManager()->prefetchRect(rect);
+}
+
 void KisPaintDevice::writeBytes(const quint8 *data, qint32 x, qint32 y, qint32 w, qint32 h)
 {
     writeBytes(data, QRect(x, y, w, h));
@@ -2149,9 +2469,19 @@ KisRegion KisPaintDevice::regionForLodSyncing() const
     return m_d->regionForLodSyncing();
 }
 
+KisRegion KisPaintDevice::regionForLodSyncing(int lod, LodSyncPoint *syncPoint) const
+{
+    return m_d->regionForLodSyncing(lod, syncPoint);
+}
+
 KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod)
 {
-    return m_d->createLodDataStruct(lod);
+    return m_d->createLodDataStruct(lod, m_d->captureLodSyncPoint());
+}
+
+KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod, const LodSyncPoint &syncPoint)
+{
+    return m_d->createLodDataStruct(lod, syncPoint);
 }
 
 void KisPaintDevice::updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect)
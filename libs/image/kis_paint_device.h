@@ -43,6 +43,7 @@ class KisRasterKeyframeChannel;
 class KisPaintDeviceFramesInterface;
 
 class KisInterstrokeData;
+class KisRunnableStrokeJobData;
 using KisInterstrokeDataSP = QSharedPointer<KisInterstrokeData>;
 
 typedef KisSharedPtr<KisDataManager> KisDataManagerSP;
@@ -482,6 +483,25 @@ public:
                    KUndo2Command *parentCommand = nullptr,
                    KoUpdater *progressUpdater = nullptr);
 
+    /**
+     * Prepares conversion of the paint device to a different colorspace,
+     * which is split into \p jobs. The jobs convert the pixel data into
+     * a separate storage, so they can be executed concurrently, e.g. in a
+     * stroke. The device itself is not changed until the returned command
+     * is redone, which should happen only after all the jobs are completed.
+     * Undoing the command returns the device back into the old colorspace.
+     *
+     * Every job creates its own color conversion transformation, so the
+     * jobs don't share the transformations with each other.
+     *
+     * @return the command that switches the device into the converted
+     *         data, owned by the caller
+     */
+    KUndo2Command* prepareConvertTo(const KoColorSpace *dstColorSpace,
+                                    KoColorConversionTransformation::Intent renderingIntent,
+                                    KoColorConversionTransformation::ConversionFlags conversionFlags,
+                                    QVector<KisRunnableStrokeJobData*> &jobs);
+
     /**
      * Changes the profile of the colorspace of this paint device to the given
      * profile. If the given profile is 0, nothing happens.
@@ -827,8 +847,32 @@ public:
 
     void estimateMemoryStats(qint64 &imageData, qint64 &temporaryData, qint64 &lodData) const;
 
+    /**
+     * Tells the swapper which data of the device should be evicted
+     * first. The data of the background images is evicted before the
+     * data of the active image, and the inactive frames of the
+     * active image before its current frame. Returns the amount of
+     * the device's data present in memory and in the swap (in bytes).
+     *
+     * If \p framesOnly is true, the content of the device is known to
+     * be unchanged since the last call, so only the frames that have
+     * been switched are retagged and the sizes are not calculated.
+     *
+     * \see KisMemoryStatisticsServer::updateEvictionPriorities()
+     */
+    void updateEvictionPriority(bool isActiveImage, bool framesOnly, qint64 &memorySize, qint64 &swappedSize) const;
+
 public:
 
+    /**
+     * Hint the paint device that the pixels in \p rect are going to
+     * be read soon, e.g. by an iterator. If some of the tiles of the
+     * device have been swapped out to disk, they are loaded back in
+     * background, so that the iteration doesn't stall on the swap.
+     * The call doesn't block and may be safely skipped.
+     */
+    void prefetchRect(const QRect &rect) const;
+
     KisHLineIteratorSP createHLineIteratorNG(qint32 x, qint32 y, qint32 w);
     KisHLineConstIteratorSP createHLineConstIteratorNG(qint32 x, qint32 y, qint32 w) const;
 
@@ -917,8 +961,46 @@ public:
         virtual ~LodDataStruct();
     };
 
+    /**
+     * The state of the device captured together with the region
+     * returned by regionForLodSyncing(int, LodSyncPoint*)
+     */
+    struct LodSyncPoint {
+        quint64 writeEpoch = 0;
+        QVector<QRect> tiles;
+    };
+
     KisRegion regionForLodSyncing() const;
+
+    /**
+     * Returns the region of the device that should be regenerated to
+     * bring a LoD plane of level \p lod up to date. The device keeps a
+     * copy of the plane uploaded by the last uploadLodDataStruct() call
+     * for every level of detail and createLodDataStruct() starts from
+     * it, so only the tiles
+     * changed since that sync need to be passed to updateLodDataStruct().
+     * When there is no such plane or it cannot be reused (different
+     * color space, offset or animation frame), the whole
+     * regionForLodSyncing() is returned.
+     *
+     * The state of the device the region is calculated for is saved
+     * into \p syncPoint, which should be passed to
+     * createLodDataStruct(). The changes made to the device after this
+     * call are not lost then: they are picked up by the next sync.
+     */
+    KisRegion regionForLodSyncing(int lod, LodSyncPoint *syncPoint) const;
+
+    /**
+     * Creates a LoD plane, which should be regenerated in the whole
+     * regionForLodSyncing()
+     */
     LodDataStruct* createLodDataStruct(int lod);
+
+    /**
+     * Creates a LoD plane, which should be regenerated in the region
+     * returned by the regionForLodSyncing() call that filled \p syncPoint
+     */
+    LodDataStruct* createLodDataStruct(int lod, const LodSyncPoint &syncPoint);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
 
@@ -8,10 +8,16 @@
 #ifndef __KIS_PAINT_DEVICE_DATA_H
 #define __KIS_PAINT_DEVICE_DATA_H
 
+#include <QMap>
+
 #include "KisInterstrokeData.h"
+#include "KisRunnableStrokeJobData.h"
+#include "KisRunnableStrokeJobUtils.h"
 #include "KisSequentialIteratorProgress.h"
 #include "KoAlwaysInline.h"
+#include "kis_algebra_2d.h"
 #include "kis_command_utils.h"
+#include "krita_utils.h"
 #include "kundo2command.h"
 
 struct DirectDataAccessPolicy {
@@ -223,6 +229,103 @@ public:
         }
     }
 
+    /**
+     * Same as convertDataColorSpace(), but the pixel data is converted
+     * by \p jobs, which can be executed concurrently. The jobs write
+     * into a new data manager, so the data itself is switched into the
+     * new color space only by the first redo() of the command added
+     * into \p parentCommand. It should happen after all the jobs are
+     * completed.
+     */
+    void prepareConvertDataColorSpace(const KoColorSpace *dstColorSpace,
+                                      KoColorConversionTransformation::Intent renderingIntent,
+                                      KoColorConversionTransformation::ConversionFlags conversionFlags,
+                                      KUndo2Command *parentCommand,
+                                      QVector<KisRunnableStrokeJobData*> &jobs)
+    {
+        using InternalSequentialConstIterator =
+            KisSequentialIteratorBase<ReadOnlyIteratorPolicy<DirectDataAccessPolicy>, DirectDataAccessPolicy>;
+        using InternalSequentialIterator =
+            KisSequentialIteratorBase<WritableIteratorPolicy<DirectDataAccessPolicy>, DirectDataAccessPolicy>;
+
+        KIS_SAFE_ASSERT_RECOVER_RETURN(parentCommand);
+
+        if (m_colorSpace == dstColorSpace || *m_colorSpace == *dstColorSpace) {
+            return;
+        }
+
+        const KoColorSpace *srcColorSpace = m_colorSpace;
+        KisDataManagerSP srcDataManager = m_dataManager;
+
+        const int dstPixelSize = dstColorSpace->pixelSize();
+        QScopedArrayPointer<quint8> dstDefaultPixel(new quint8[dstPixelSize]);
+        memset(dstDefaultPixel.data(), 0, dstPixelSize);
+        srcColorSpace->convertPixelsTo(srcDataManager->defaultPixel(), dstDefaultPixel.data(), dstColorSpace, 1, renderingIntent, conversionFlags);
+
+        KisDataManagerSP dstDataManager = new KisDataManager(dstPixelSize, dstDefaultPixel.data());
+
+        /**
+         * Group the existing tiles into patches, so that every job has
+         * enough pixels to pay off creation of its own transformation.
+         * The tiles that don't exist in the source data manager are not
+         * created in the destination one.
+         *
+         * The rects of region() are merged, so a solid area of tiles would
+         * become a single rect and a single job. Group the separate tiles
+         * instead.
+         */
+        const QSize patchSize = KritaUtils::optimalPatchSize();
+        QMap<QPair<int, int>, QVector<QRect>> patches;
+
+        Q_FOREACH (const QRect &rc, srcDataManager->tileRectsChangedSince(0)) {
+            const QPair<int, int> key(KisAlgebra2D::divideFloor(rc.y(), patchSize.height()),
+                                      KisAlgebra2D::divideFloor(rc.x(), patchSize.width()));
+            patches[key].append(rc);
+        }
+
+        for (auto it = patches.constBegin(); it != patches.constEnd(); ++it) {
+            const QVector<QRect> rects = it.value();
+
+            KritaUtils::addJobConcurrent(jobs,
+                [srcDataManager, dstDataManager, srcColorSpace, dstColorSpace,
+                 renderingIntent, conversionFlags, rects] () {
+
+                    /**
+                     * Each job owns a separate copy of the transformation,
+                     * so the threads don't share any state of the color
+                     * engine while converting.
+                     */
+                    QScopedPointer<KoColorConversionTransformation> transform(
+                        srcColorSpace->createColorConverter(dstColorSpace, renderingIntent, conversionFlags));
+
+                    Q_FOREACH (const QRect &rc, rects) {
+                        // the data managers are not connected to the device cache yet
+                        InternalSequentialConstIterator srcIt(DirectDataAccessPolicy(srcDataManager.data(), nullptr), rc);
+                        InternalSequentialIterator dstIt(DirectDataAccessPolicy(dstDataManager.data(), nullptr), rc);
+
+                        int nConseqPixels = srcIt.nConseqPixels();
+
+                        // since we are accessing data managers directly, the columns are always aligned
+                        KIS_SAFE_ASSERT_RECOVER_NOOP(srcIt.nConseqPixels() == dstIt.nConseqPixels());
+
+                        while(srcIt.nextPixels(nConseqPixels) &&
+                              dstIt.nextPixels(nConseqPixels)) {
+
+                            nConseqPixels = srcIt.nConseqPixels();
+
+                            transform->transform(srcIt.rawDataConst(), dstIt.rawData(), nConseqPixels);
+                        }
+                    }
+                });
+        }
+
+        // becomes owned by the parent, its first redo() switches the data
+        new ChangeColorSpaceCommand(this,
+                                    srcDataManager, dstDataManager,
+                                    srcColorSpace, dstColorSpace,
+                                    parentCommand);
+    }
+
     void reincarnateWithDetachedHistory(bool copyContent, KUndo2Command *parentCommand) {
         struct SwitchDataManager : public KUndo2Command
         {
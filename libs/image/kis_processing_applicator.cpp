@@ -299,6 +299,8 @@ KisProcessingApplicator::KisProcessingApplicator(KisImageWSP image,
 
     strategy->setMacroId(macroId);
 
+    m_runnableJobsInterface = strategy->runnableJobsInterface();
+
     m_strokeId = m_image->startStroke(strategy);
     if(!m_emitSignals.isEmpty()) {
         applyCommand(new EmitImageSignalsCommand(m_image, m_emitSignals, false), KisStrokeJobData::BARRIER);
@@ -324,6 +326,11 @@ const KisStrokeId KisProcessingApplicator::getStroke() const
     return m_strokeId;
 }
 
+KisRunnableStrokeJobsInterface* KisProcessingApplicator::runnableJobsInterface() const
+{
+    return m_runnableJobsInterface;
+}
+
 std::future<bool>&& KisProcessingApplicator::successfullyCompletedFuture()
 {
     KIS_ASSERT(m_successfullyCompletedFuture.valid());
@@ -18,6 +18,8 @@
 
 #include "kritaimage_export.h"
 
+class KisRunnableStrokeJobsInterface;
+
 class KRITAIMAGE_EXPORT KisProcessingApplicator
 {
 public:
@@ -82,6 +84,17 @@ public:
      */
     const KisStrokeId getStroke() const;
 
+    /**
+     * Returns the interface for adding runnable jobs into the underlying
+     * stroke. A visitor or a command may use it to split its work into
+     * concurrent jobs. The added jobs are executed before all the jobs
+     * that are still waiting in the applicator's queue.
+     *
+     * The interface is valid only while the stroke is running, that is,
+     * it should be used from the jobs of the stroke itself.
+     */
+    KisRunnableStrokeJobsInterface* runnableJobsInterface() const;
+
     /**
      * A future that notifies the caller when the whole processing
      * stroke has been completed. The returned value shows if the
@@ -114,6 +127,7 @@ private:
     ProcessingFlags m_flags;
     KisImageSignalVector m_emitSignals;
     KisStrokeId m_strokeId;
+    KisRunnableStrokeJobsInterface *m_runnableJobsInterface;
     bool m_finalSignalsEmitted;
     QSharedPointer<bool> m_sharedAllFramesToken;
     std::future<bool> m_successfullyCompletedFuture;
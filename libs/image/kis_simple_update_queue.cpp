@@ -8,6 +8,10 @@
 
 #include <QMutexLocker>
 #include <QVector>
+#include <QRegion>
+#include <QSet>
+
+#include <algorithm>
 
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
@@ -41,8 +45,145 @@
 #endif /* ENABLE_ACCUMULATOR */
 
 
+const qint32 KisSimpleUpdateQueue::MIN_SUBTASK_SIZE = 128;
+const qint64 KisSimpleUpdateQueue::MIN_FREE_PART_AREA = 64 * 64;
+
+namespace {
+
+const int TILE_SIZE = 64;
+const int TILE_ALIGNMENT_MASK = ~(TILE_SIZE - 1);
+
+inline qint64 rectArea(const QRect &rc)
+{
+    return qint64(rc.width()) * rc.height();
+}
+
+/**
+ * Grows the rect to the grid of the tiles of the projection
+ */
+QRect alignToTiles(const QRect &rc)
+{
+    return QRect(QPoint(rc.left() & TILE_ALIGNMENT_MASK, rc.top() & TILE_ALIGNMENT_MASK),
+                 QPoint(rc.right() | ~TILE_ALIGNMENT_MASK, rc.bottom() | ~TILE_ALIGNMENT_MASK));
+}
+
+/**
+ * Two non-intersecting rects form a rect when joined
+ */
+inline bool canBeJoined(const QRect &rc1, const QRect &rc2)
+{
+    return rectArea(rc1 | rc2) == rectArea(rc1) + rectArea(rc2);
+}
+
+/**
+ * Splits \p rc minus \p freeRect into (at most) four rects. Either the
+ * top and the bottom rects span the whole width of \p rc, or the left
+ * and the right ones span its whole height.
+ */
+QVector<QRect> remainderRects(const QRect &rc, const QRect &freeRect, bool horizontalBands)
+{
+    QVector<QRect> rects;
+
+    if (horizontalBands) {
+        rects << QRect(QPoint(rc.left(), rc.top()), QPoint(rc.right(), freeRect.top() - 1));
+        rects << QRect(QPoint(rc.left(), freeRect.bottom() + 1), rc.bottomRight());
+        rects << QRect(QPoint(rc.left(), freeRect.top()), QPoint(freeRect.left() - 1, freeRect.bottom()));
+        rects << QRect(QPoint(freeRect.right() + 1, freeRect.top()), QPoint(rc.right(), freeRect.bottom()));
+    } else {
+        rects << QRect(QPoint(rc.left(), rc.top()), QPoint(freeRect.left() - 1, rc.bottom()));
+        rects << QRect(QPoint(freeRect.right() + 1, rc.top()), rc.bottomRight());
+        rects << QRect(QPoint(freeRect.left(), rc.top()), QPoint(freeRect.right(), freeRect.top() - 1));
+        rects << QRect(QPoint(freeRect.left(), freeRect.bottom() + 1), QPoint(freeRect.right(), rc.bottom()));
+    }
+
+    rects.erase(std::remove_if(rects.begin(), rects.end(),
+                               [] (const QRect &rect) { return rect.isEmpty(); }),
+                rects.end());
+
+    return rects;
+}
+
+bool intersectsAny(const QRect &rc, const QVector<QRect> &rects)
+{
+    return std::any_of(rects.begin(), rects.end(),
+                       [rc] (const QRect &rect) { return rect.intersects(rc); });
+}
+
+/**
+ * Moves one row (or column) of tiles of \p freeRect into the adjacent
+ * \p remainder
+ */
+void moveTilesToRemainder(QRect &freeRect, QRect &remainder)
+{
+    if (remainder.right() < freeRect.left()) {
+        freeRect.setLeft(freeRect.left() + TILE_SIZE);
+        remainder.setRight(freeRect.left() - 1);
+    } else if (remainder.left() > freeRect.right()) {
+        freeRect.setRight(freeRect.right() - TILE_SIZE);
+        remainder.setLeft(freeRect.right() + 1);
+    } else if (remainder.bottom() < freeRect.top()) {
+        freeRect.setTop(freeRect.top() + TILE_SIZE);
+        remainder.setBottom(freeRect.top() - 1);
+    } else {
+        freeRect.setBottom(freeRect.bottom() - TILE_SIZE);
+        remainder.setTop(freeRect.bottom() + 1);
+    }
+}
+
+/**
+ * Folds the remainders smaller than \p minArea into their neighbours:
+ * into another remainder, into the free rect (when the remainder
+ * doesn't touch the \p busyRects) or, otherwise, grows the remainder
+ * by a row of tiles taken from the free rect. Returns false if some
+ * remainders cannot be folded or the free rect becomes too small.
+ */
+bool foldSmallRemainders(QRect &freeRect, QVector<QRect> &remainders,
+                         const QVector<QRect> &busyRects, qint64 minArea)
+{
+    bool folded = true;
+
+    while (folded) {
+        folded = false;
+
+        for (int i = 0; i < remainders.size(); i++) {
+            QRect &remainder = remainders[i];
+            if (rectArea(remainder) >= minArea) continue;
+
+            auto neighbour =
+                std::find_if(remainders.begin(), remainders.end(),
+                             [&remainder] (const QRect &rect) {
+                                 return &rect != &remainder && canBeJoined(rect, remainder);
+                             });
+
+            if (neighbour != remainders.end()) {
+                *neighbour |= remainder;
+                remainders.remove(i);
+            } else if (!canBeJoined(freeRect, remainder)) {
+                // some other remainder may become its neighbour later
+                continue;
+            } else if (!intersectsAny(remainder, busyRects)) {
+                freeRect |= remainder;
+                remainders.remove(i);
+            } else {
+                moveTilesToRemainder(freeRect, remainder);
+                if (rectArea(freeRect) < minArea) return false;
+            }
+
+            // the joined rects should be checked again
+            folded = true;
+            break;
+        }
+    }
+
+    return std::none_of(remainders.begin(), remainders.end(),
+                        [minArea] (const QRect &rect) { return rectArea(rect) < minArea; });
+}
+
+}
+
 KisSimpleUpdateQueue::KisSimpleUpdateQueue()
-    : m_overrideLevelOfDetail(-1)
+    : m_nextSequenceNumber(0),
+      m_overrideLevelOfDetail(-1)
 {
     updateSettings();
 }
@@ -68,6 +209,9 @@ void KisSimpleUpdateQueue::updateSettings()
     m_maxCollectAlpha = config.maxCollectAlpha();
     m_maxMergeAlpha = config.maxMergeAlpha();
     m_maxMergeCollectAlpha = config.maxMergeCollectAlpha();
+
+    // the cells of the index depend on the patch size
+    rebuildIndex();
 }
 
 int KisSimpleUpdateQueue::overrideLevelOfDetail() const
@@ -75,16 +219,197 @@ int KisSimpleUpdateQueue::overrideLevelOfDetail() const
     return m_overrideLevelOfDetail;
 }
 
-void KisSimpleUpdateQueue::processQueue(KisUpdaterContext &updaterContext)
+void KisSimpleUpdateQueue::processQueue(KisUpdaterContext &updaterContext, bool canSplitJobs)
 {
     updaterContext.lock();
 
+    if (canSplitJobs) {
+        splitJobsForSpareThreads(updaterContext);
+    }
+
     while(updaterContext.hasSpareThread() &&
           processOneJob(updaterContext));
 
     updaterContext.unlock();
 }
 
+bool KisSimpleUpdateQueue::tryStartFreePartOfJob(KisUpdaterContext &updaterContext,
+                                                 KisMutableWalkersListIterator &iter,
+                                                 KisBaseRectsWalkerSP item)
+{
+    const QRect rc = item->requestedRect();
+
+    /**
+     * If some layer needs the pixels outside the requested rect,
+     * the parts of the walker would depend on each other. And if some
+     * layer changes or needs more than it is asked for, the access rect
+     * of the part is not known until its walker is built.
+     */
+    if (!rc.contains(item->accessRect()) ||
+        item->needRectVaries() || item->changeRectVaries()) {
+
+        return false;
+    }
+
+    /**
+     * The parts should not share any tile of the projection
+     * with the running jobs and with each other
+     */
+    QVector<QRect> busyRects;
+    Q_FOREACH (const QRect &busyRect, updaterContext.runningJobsAccessRects()) {
+        busyRects << alignToTiles(busyRect);
+    }
+
+    QRegion freeRegion(rc);
+    Q_FOREACH (const QRect &busyRect, busyRects) {
+        freeRegion -= busyRect;
+    }
+
+    QRect freeRect;
+    qint64 freeArea = 0;
+
+    for (auto it = freeRegion.begin(); it != freeRegion.end(); ++it) {
+        const qint64 area = rectArea(*it);
+        if (area > freeArea) {
+            freeArea = area;
+            freeRect = *it;
+        }
+    }
+
+    if (freeArea < MIN_FREE_PART_AREA || freeRect == rc) return false;
+
+    /**
+     * Cut the rest of the walker into horizontal or vertical bands,
+     * whichever leaves the bigger free part after folding the
+     * remainders smaller than a tile
+     */
+    QRect bestFreeRect;
+    QVector<QRect> remainders;
+
+    for (bool horizontalBands : {true, false}) {
+        QRect partRect = freeRect;
+        QVector<QRect> partRemainders = remainderRects(rc, freeRect, horizontalBands);
+
+        if (foldSmallRemainders(partRect, partRemainders, busyRects, MIN_FREE_PART_AREA) &&
+            rectArea(partRect) > rectArea(bestFreeRect)) {
+
+            bestFreeRect = partRect;
+            remainders = partRemainders;
+        }
+    }
+
+    if (bestFreeRect.isEmpty()) return false;
+    freeRect = bestFreeRect;
+
+    /**
+     * Check the free part before building the walker, it is
+     * done under the queue lock on every pass
+     */
+    if (intersectsAny(freeRect, busyRects)) return false;
+
+    KisBaseRectsWalkerSP freeWalker =
+        createWalker(item->type(), item->cropRect(), item->clonesDontInvalidateFrames());
+    freeWalker->collectRects(item->startNode(), freeRect);
+
+    if (!updaterContext.isJobAllowed(freeWalker)) return false;
+
+    /**
+     * The rest of the walker stays in the queue in place of the
+     * original one and waits for the running jobs
+     */
+    iter.remove();
+    removeFromIndex(item);
+
+    Q_FOREACH (const QRect &remainder, remainders) {
+        KisBaseRectsWalkerSP busyWalker =
+            createWalker(item->type(), item->cropRect(), item->clonesDontInvalidateFrames());
+        busyWalker->collectRects(item->startNode(), remainder);
+        iter.insert(busyWalker);
+        addToIndex(busyWalker);
+    }
+
+    updaterContext.addMergeJob(freeWalker);
+
+    return true;
+}
+
+void KisSimpleUpdateQueue::splitJobsForSpareThreads(KisUpdaterContext &updaterContext)
+{
+    QMutexLocker locker(&m_lock);
+
+    qint32 numMergeJobs;
+    qint32 numStrokeJobs;
+    updaterContext.getJobsSnapshot(numMergeJobs, numStrokeJobs);
+
+    const int numSpareThreads = updaterContext.activeThreadsLimit() - numMergeJobs - numStrokeJobs;
+    const int currentLevelOfDetail = updaterContext.currentLevelOfDetail();
+
+    while (m_updatesList.size() < numSpareThreads) {
+        int bestIndex = -1;
+        qint64 bestArea = 0;
+
+        for (int i = 0; i < m_updatesList.size(); i++) {
+            KisBaseRectsWalkerSP item = m_updatesList[i];
+            const QRect rc = item->requestedRect();
+
+            if (currentLevelOfDetail >= 0 && currentLevelOfDetail != item->levelOfDetail()) continue;
+            if (qMax(rc.width(), rc.height()) < 2 * MIN_SUBTASK_SIZE) continue;
+
+            /**
+             * If some layer of the stack needs the pixels outside the
+             * requested rect (e.g. a blur filter), the halves would
+             * intersect and could not run in parallel anyway
+             */
+            if (!rc.contains(item->accessRect())) continue;
+
+            const qint64 area = qint64(rc.width()) * rc.height();
+            if (area > bestArea && item->checksumValid()) {
+                bestArea = area;
+                bestIndex = i;
+            }
+        }
+
+        if (bestIndex < 0) break;
+
+        KisBaseRectsWalkerSP item = m_updatesList[bestIndex];
+        const QRect rc = item->requestedRect();
+
+        QRect firstRect;
+        QRect secondRect;
+
+        /**
+         * Split the longer side in the middle, aligned to the
+         * grid of the tiles (64px), so that the halves don't
+         * share any tile of the projection
+         */
+        const int tileAlignmentMask = ~(64 - 1);
+
+        if (rc.width() >= rc.height()) {
+            const int splitX = (rc.x() + rc.width() / 2) & tileAlignmentMask;
+            firstRect = QRect(rc.x(), rc.y(), splitX - rc.x(), rc.height());
+            secondRect = QRect(splitX, rc.y(), rc.right() - splitX + 1, rc.height());
+        } else {
+            const int splitY = (rc.y() + rc.height() / 2) & tileAlignmentMask;
+            firstRect = QRect(rc.x(), rc.y(), rc.width(), splitY - rc.y());
+            secondRect = QRect(rc.x(), splitY, rc.width(), rc.bottom() - splitY + 1);
+        }
+
+        KisBaseRectsWalkerSP firstWalker = createWalker(item->type(), item->cropRect(), item->clonesDontInvalidateFrames());
+        firstWalker->collectRects(item->startNode(), firstRect);
+
+        KisBaseRectsWalkerSP secondWalker = createWalker(item->type(), item->cropRect(), item->clonesDontInvalidateFrames());
+        secondWalker->collectRects(item->startNode(), secondRect);
+
+        removeFromIndex(item);
+
+        m_updatesList[bestIndex] = firstWalker;
+        m_updatesList.insert(bestIndex + 1, secondWalker);
+
+        addToIndex(firstWalker);
+        addToIndex(secondWalker);
+    }
+}
+
 bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 {
     QMutexLocker locker(&m_lock);
@@ -111,6 +436,14 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 
             updaterContext.addMergeJob(item);
             iter.remove();
+            removeFromIndex(item);
+            jobAdded = true;
+            break;
+        }
+
+        if ((currentLevelOfDetail < 0 || currentLevelOfDetail == item->levelOfDetail()) &&
+            tryStartFreePartOfJob(updaterContext, iter, item)) {
+
             jobAdded = true;
             break;
         }
@@ -191,54 +524,65 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QVector<QRect> &rects,
     Q_FOREACH (const QRect &rc, rects) {
         if (rc.isEmpty()) continue;
 
-        KisBaseRectsWalkerSP walker;
-
         if(trySplitJob(node, rc, cropRect, levelOfDetail, type, dontInvalidateFrames)) continue;
         if(tryMergeJob(node, rc, cropRect, levelOfDetail, type, dontInvalidateFrames)) continue;
 
-        if (type == KisBaseRectsWalker::UPDATE) {
-            KisMergeWalker::Flags flags = KisMergeWalker::DEFAULT;
-            if (dontInvalidateFrames) {
-                flags |= KisMergeWalker::CLONES_DONT_INVALIDATE_FRAMES;
-            }
+        KisBaseRectsWalkerSP walker = createWalker(type, cropRect, dontInvalidateFrames);
+        walker->collectRects(node, rc);
+        walkers.append(walker);
+    }
 
-            walker = new KisMergeWalker(cropRect, flags);
+    if (!walkers.isEmpty()) {
+        m_lock.lock();
+        m_updatesList.append(walkers);
+        Q_FOREACH (KisBaseRectsWalkerSP walker, walkers) {
+            addToIndex(walker);
         }
-        else if (type == KisBaseRectsWalker::FULL_REFRESH)  {
-            KisFullRefreshWalker::Flags flags = KisFullRefreshWalker::None;
-            if (dontInvalidateFrames) {
-                flags |= KisFullRefreshWalker::ClonesDontInvalidateFrames;
-            }
+        m_lock.unlock();
+    }
+}
 
-            walker = new KisFullRefreshWalker(cropRect, flags);
+KisBaseRectsWalkerSP KisSimpleUpdateQueue::createWalker(KisBaseRectsWalker::UpdateType type,
+                                                        const QRect& cropRect,
+                                                        bool dontInvalidateFrames)
+{
+    KisBaseRectsWalkerSP walker;
+
+    if (type == KisBaseRectsWalker::UPDATE) {
+        KisMergeWalker::Flags flags = KisMergeWalker::DEFAULT;
+        if (dontInvalidateFrames) {
+            flags |= KisMergeWalker::CLONES_DONT_INVALIDATE_FRAMES;
         }
-        else if (type == KisBaseRectsWalker::UPDATE_NO_FILTHY) {
-            KisMergeWalker::Flags flags = KisMergeWalker::NO_FILTHY;
-            if (dontInvalidateFrames) {
-                flags |= KisMergeWalker::CLONES_DONT_INVALIDATE_FRAMES;
-            }
 
-            walker = new KisMergeWalker(cropRect, flags);
+        walker = new KisMergeWalker(cropRect, flags);
+    }
+    else if (type == KisBaseRectsWalker::FULL_REFRESH)  {
+        KisFullRefreshWalker::Flags flags = KisFullRefreshWalker::None;
+        if (dontInvalidateFrames) {
+            flags |= KisFullRefreshWalker::ClonesDontInvalidateFrames;
         }
-        else if (type == KisBaseRectsWalker::FULL_REFRESH_NO_FILTHY)  {
-            KisFullRefreshWalker::Flags flags = KisFullRefreshWalker::NoFilthyMode;
-            if (dontInvalidateFrames) {
-                flags |= KisFullRefreshWalker::ClonesDontInvalidateFrames;
-            }
 
-            walker = new KisFullRefreshWalker(cropRect, KisFullRefreshWalker::NoFilthyMode);
+        walker = new KisFullRefreshWalker(cropRect, flags);
+    }
+    else if (type == KisBaseRectsWalker::UPDATE_NO_FILTHY) {
+        KisMergeWalker::Flags flags = KisMergeWalker::NO_FILTHY;
+        if (dontInvalidateFrames) {
+            flags |= KisMergeWalker::CLONES_DONT_INVALIDATE_FRAMES;
         }
-        /* else if(type == KisBaseRectsWalker::UNSUPPORTED) fatalKrita; */
 
-        walker->collectRects(node, rc);
-        walkers.append(walker);
+        walker = new KisMergeWalker(cropRect, flags);
     }
+    else if (type == KisBaseRectsWalker::FULL_REFRESH_NO_FILTHY)  {
+        KisFullRefreshWalker::Flags flags = KisFullRefreshWalker::NoFilthyMode;
+        if (dontInvalidateFrames) {
+            flags |= KisFullRefreshWalker::ClonesDontInvalidateFrames;
+        }
 
-    if (!walkers.isEmpty()) {
-        m_lock.lock();
-        m_updatesList.append(walkers);
-        m_lock.unlock();
+        walker = new KisFullRefreshWalker(cropRect, KisFullRefreshWalker::NoFilthyMode);
     }
+    /* else if(type == KisBaseRectsWalker::UNSUPPORTED) fatalKrita; */
+
+    return walker;
 }
 
 void KisSimpleUpdateQueue::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
@@ -320,7 +664,9 @@ bool KisSimpleUpdateQueue::tryMergeJob(KisNodeSP node, const QRect& rc,
 
     KisBaseRectsWalkerSP goodCandidate;
     KisBaseRectsWalkerSP item;
-    KisWalkersListIterator iter(m_updatesList);
+
+    const KisWalkersList candidates = findMergeCandidates(node, rc);
+    KisWalkersListIterator iter(candidates);
 
     /**
      * We add new jobs to the tail of the list,
@@ -367,7 +713,15 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
                                        const qreal maxAlpha)
 {
     KisBaseRectsWalkerSP item;
-    KisMutableWalkersListIterator iter(m_updatesList);
+
+    /**
+     * The base rect only grows while collecting, so all the rects
+     * that can be joined are among the candidates of the initial one
+     */
+    const KisWalkersList candidates = findMergeCandidates(baseWalker->startNode(), baseRect);
+    KisWalkersListIterator iter(candidates);
+
+    QSet<KisBaseRectsWalker*> joinedWalkers;
 
     while(iter.hasNext()) {
         item = iter.next();
@@ -380,12 +734,24 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
         if(item->levelOfDetail() != baseWalker->levelOfDetail()) continue;
 
         if(joinRects(baseRect, item->requestedRect(), maxAlpha)) {
-            iter.remove();
+            removeFromIndex(item);
+            joinedWalkers.insert(item.data());
         }
     }
 
+    if (!joinedWalkers.isEmpty()) {
+        m_updatesList.erase(
+            std::remove_if(m_updatesList.begin(), m_updatesList.end(),
+                           [&joinedWalkers] (KisBaseRectsWalkerSP walker) {
+                               return joinedWalkers.contains(walker.data());
+                           }),
+            m_updatesList.end());
+    }
+
     if(baseWalker->requestedRect() != baseRect) {
+        removeFromIndex(baseWalker);
         baseWalker->collectRects(baseWalker->startNode(), baseRect);
+        addToIndex(baseWalker);
     }
 }
 
@@ -418,6 +784,108 @@ bool KisSimpleUpdateQueue::joinRects(QRect& baseRect,
     return result;
 }
 
+namespace {
+inline int divFloor(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+inline qint64 cellKey(int col, int row) {
+    return (qint64(col) << 32) | quint32(row);
+}
+}
+
+qint64 KisSimpleUpdateQueue::indexCellKey(const QPoint &pt) const
+{
+    return cellKey(divFloor(pt.x(), m_patchWidth), divFloor(pt.y(), m_patchHeight));
+}
+
+void KisSimpleUpdateQueue::addToIndex(KisBaseRectsWalkerSP walker)
+{
+    IndexCells &cells = m_index[walker->startNode().data()];
+    cells[indexCellKey(walker->requestedRect().topLeft())].append({walker, m_nextSequenceNumber++});
+}
+
+void KisSimpleUpdateQueue::removeFromIndex(KisBaseRectsWalkerSP walker)
+{
+    auto nodeIt = m_index.find(walker->startNode().data());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(nodeIt != m_index.end());
+
+    auto cellIt = nodeIt->find(indexCellKey(walker->requestedRect().topLeft()));
+    KIS_SAFE_ASSERT_RECOVER_RETURN(cellIt != nodeIt->end());
+
+    QVector<IndexEntry> &entries = *cellIt;
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->walker == walker) {
+            entries.erase(it);
+            break;
+        }
+    }
+
+    if (entries.isEmpty()) {
+        nodeIt->erase(cellIt);
+
+        if (nodeIt->isEmpty()) {
+            m_index.erase(nodeIt);
+        }
+    }
+}
+
+void KisSimpleUpdateQueue::rebuildIndex()
+{
+    m_index.clear();
+
+    Q_FOREACH (KisBaseRectsWalkerSP walker, m_updatesList) {
+        addToIndex(walker);
+    }
+}
+
+KisWalkersList KisSimpleUpdateQueue::findMergeCandidates(KisNodeSP node, const QRect &rc) const
+{
+    KisWalkersList result;
+
+    auto nodeIt = m_index.constFind(node.data());
+    if (nodeIt == m_index.constEnd()) return result;
+
+    /**
+     * The union of the rects is not allowed to be bigger than a
+     * patch, so the top-left corner of a candidate cannot be
+     * further than a patch from the opposite corner of the rect
+     */
+    const QPoint minTopLeft(rc.right() - m_patchWidth + 1, rc.bottom() - m_patchHeight + 1);
+    const QPoint maxTopLeft(rc.left() + m_patchWidth - 1, rc.top() + m_patchHeight - 1);
+
+    if (minTopLeft.x() > maxTopLeft.x() || minTopLeft.y() > maxTopLeft.y()) return result;
+
+    const int firstCol = divFloor(minTopLeft.x(), m_patchWidth);
+    const int lastCol = divFloor(maxTopLeft.x(), m_patchWidth);
+    const int firstRow = divFloor(minTopLeft.y(), m_patchHeight);
+    const int lastRow = divFloor(maxTopLeft.y(), m_patchHeight);
+
+    QVector<IndexEntry> entries;
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int col = firstCol; col <= lastCol; col++) {
+            auto cellIt = nodeIt->constFind(cellKey(col, row));
+            if (cellIt != nodeIt->constEnd()) {
+                entries += *cellIt;
+            }
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [] (const IndexEntry &lhs, const IndexEntry &rhs) {
+                  return lhs.sequenceNumber < rhs.sequenceNumber;
+              });
+
+    result.reserve(entries.size());
+    Q_FOREACH (const IndexEntry &entry, entries) {
+        result.append(entry.walker);
+    }
+
+    return result;
+}
+
 KisWalkersList& KisTestableSimpleUpdateQueue::getWalkersList()
 {
     return m_updatesList;
@@ -8,6 +8,7 @@
 #define __KIS_SIMPLE_UPDATE_QUEUE_H
 
 #include <QMutex>
+#include <QHash>
 #include "kis_updater_context.h"
 #include <KisProjectionUpdateFlags.h>
 
@@ -26,7 +27,17 @@ public:
     KisSimpleUpdateQueue();
     virtual ~KisSimpleUpdateQueue();
 
-    void processQueue(KisUpdaterContext &updaterContext);
+    /**
+     * Passes the queued jobs to the spare threads of \p updaterContext.
+     *
+     * If \p canSplitJobs is true and there are fewer queued walkers than
+     * idle threads, the biggest walkers are split into tile-aligned
+     * halves beforehand, so that the idle threads would pick them up
+     * instead of waiting for a single big merge to finish. Only the
+     * walkers whose access rect does not exceed the requested rect
+     * are split, so the halves never block each other.
+     */
+    void processQueue(KisUpdaterContext &updaterContext, bool canSplitJobs = false);
 
     void addUpdateJob(KisNodeSP node, const QVector<QRect> &rects, const QRect& cropRect, int levelOfDetail, KisProjectionUpdateFlags flags);
     void addFullRefreshJob(KisNodeSP node, const QVector<QRect> &rects, const QRect& cropRect, int levelOfDetail, KisProjectionUpdateFlags flags);
@@ -54,6 +65,20 @@ protected:
 
     bool processOneJob(KisUpdaterContext &updaterContext);
 
+    /**
+     * When \p item intersects the running jobs, starts the part of it
+     * that doesn't intersect them (if it is big enough) and leaves the
+     * rest of it in the queue. All the parts are aligned to the tiles
+     * of the projection and the ones smaller than MIN_FREE_PART_AREA
+     * are folded into their neighbours. The walkers needing pixels
+     * outside their requested rects (e.g. because of filters) are not
+     * split.
+     */
+    bool tryStartFreePartOfJob(KisUpdaterContext &updaterContext, KisMutableWalkersListIterator &iter, KisBaseRectsWalkerSP item);
+
+    void splitJobsForSpareThreads(KisUpdaterContext &updaterContext);
+    KisBaseRectsWalkerSP createWalker(KisBaseRectsWalker::UpdateType type, const QRect& cropRect, bool dontInvalidateFrames);
+
     bool trySplitJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type, bool dontInvalidateFrames);
     bool tryMergeJob(KisNodeSP node, const QRect& rc, const QRect& cropRect, int levelOfDetail, KisBaseRectsWalker::UpdateType type, bool dontInvalidateFrames);
 
@@ -61,12 +86,45 @@ protected:
                      const qreal maxAlpha);
     bool joinRects(QRect& baseRect, const QRect& newRect, qreal maxAlpha);
 
+    /**
+     * The walkers of m_updatesList are indexed by their start node and
+     * by the patch-sized cell containing the top-left corner of their
+     * requested rect. Two rects are joined only when their union fits
+     * into a patch, so the merge candidates of a rect are looked up in
+     * at most 3x3 cells instead of scanning the whole queue (which is
+     * quadratic when a filter emits thousands of small rects).
+     *
+     * Every change of m_updatesList must be reflected in the index and
+     * the requested rect of a walker must not be changed while it is
+     * indexed.
+     */
+    void addToIndex(KisBaseRectsWalkerSP walker);
+    void removeFromIndex(KisBaseRectsWalkerSP walker);
+    void rebuildIndex();
+
+    /**
+     * Returns the queued walkers of \p node that could be joined with
+     * \p rc, in the order they have been added to the index
+     */
+    KisWalkersList findMergeCandidates(KisNodeSP node, const QRect &rc) const;
+
+    qint64 indexCellKey(const QPoint &pt) const;
+
 protected:
 
     mutable QMutex m_lock;
     KisWalkersList m_updatesList;
     KisSpontaneousJobsList m_spontaneousJobsList;
 
+    struct IndexEntry {
+        KisBaseRectsWalkerSP walker;
+        quint64 sequenceNumber;
+    };
+    typedef QHash<qint64, QVector<IndexEntry>> IndexCells;
+
+    QHash<KisNode*, IndexCells> m_index;
+    quint64 m_nextSequenceNumber;
+
     /**
      * Parameters of optimization
      * (loaded from a configuration file)
@@ -80,6 +138,18 @@ protected:
     qint32 m_patchWidth;
     qint32 m_patchHeight;
 
+    /**
+     * The walkers whose longer side is shorter than twice this
+     * size are not split for the idle threads
+     */
+    static const qint32 MIN_SUBTASK_SIZE;
+
+    /**
+     * The parts of a blocked walker, both the started and the
+     * queued ones, are not smaller than a tile
+     */
+    static const qint64 MIN_FREE_PART_AREA;
+
     /**
      * Maximum coefficient of work while regular optimization()
      */
@@ -274,6 +274,11 @@ qreal KisStroke::balancingRatioOverride() const
     return m_strokeStrategy->balancingRatioOverride();
 }
 
+KisStrokeStrategy::PriorityClass KisStroke::priorityClass() const
+{
+    return m_strokeStrategy->priorityClass();
+}
+
 KisStrokeJobData::Sequentiality KisStroke::nextJobSequentiality() const
 {
     return !m_jobsQueue.isEmpty() ?
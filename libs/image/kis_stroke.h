@@ -13,8 +13,8 @@
 #include <kis_types.h>
 #include "kritaimage_export.h"
 #include "kis_stroke_job.h"
+#include "kis_stroke_strategy.h"
 
-class KisStrokeStrategy;
 class KUndo2MagicString;
 
 
@@ -62,6 +62,7 @@ public:
     bool isAsynchronouslyCancellable() const;
     bool clearsRedoOnStart() const;
     qreal balancingRatioOverride() const;
+    KisStrokeStrategy::PriorityClass priorityClass() const;
 
     KisStrokeJobData::Sequentiality nextJobSequentiality() const;
 
@@ -20,6 +20,7 @@ KisStrokeStrategy::KisStrokeStrategy(const QLatin1String &id, const KUndo2MagicS
       m_needsExplicitCancel(false),
       m_forceLodModeIfPossible(false),
       m_balancingRatioOverride(-1.0),
+      m_priorityClass(PRIORITY_NORMAL),
       m_id(id),
       m_name(name),
       m_mutatedJobsInterface(0)
@@ -36,6 +37,7 @@ KisStrokeStrategy::KisStrokeStrategy(const KisStrokeStrategy &rhs)
       m_needsExplicitCancel(rhs.m_needsExplicitCancel),
       m_forceLodModeIfPossible(rhs.m_forceLodModeIfPossible),
       m_balancingRatioOverride(rhs.m_balancingRatioOverride),
+      m_priorityClass(rhs.m_priorityClass),
       m_id(rhs.m_id),
       m_name(rhs.m_name),
       m_mutatedJobsInterface(0)
@@ -248,3 +250,13 @@ void KisStrokeStrategy::setBalancingRatioOverride(qreal value)
 {
     m_balancingRatioOverride = value;
 }
+
+KisStrokeStrategy::PriorityClass KisStrokeStrategy::priorityClass() const
+{
+    return m_priorityClass;
+}
+
+void KisStrokeStrategy::setPriorityClass(PriorityClass value)
+{
+    m_priorityClass = value;
+}
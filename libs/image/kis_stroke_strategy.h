@@ -19,6 +19,17 @@ class KisStrokesQueueMutatedJobInterface;
 
 class KRITAIMAGE_EXPORT KisStrokeStrategy
 {
+public:
+    /**
+     * Defines how the stroke is ordered in the strokes queue relative
+     * to the other strokes. \see setPriorityClass()
+     */
+    enum PriorityClass {
+        PRIORITY_BACKGROUND = 0,
+        PRIORITY_NORMAL,
+        PRIORITY_INTERACTIVE
+    };
+
 public:
     KisStrokeStrategy(const QLatin1String &id, const KUndo2MagicString &name = KUndo2MagicString());
     virtual ~KisStrokeStrategy();
@@ -112,6 +123,11 @@ public:
 
     bool needsExplicitCancel() const;
 
+    /**
+     * \see setPriorityClass() for details
+     */
+    PriorityClass priorityClass() const;
+
 
     /**
      * \see setBalancingRatioOverride() for details
@@ -186,6 +202,26 @@ protected:
      */
     void setBalancingRatioOverride(qreal value);
 
+    /**
+     * Set the priority class of the stroke. Default is PRIORITY_NORMAL.
+     *
+     * PRIORITY_BACKGROUND strokes should perform purely background
+     * actions that don't modify the image (e.g. regeneration of the
+     * animation cache), so the queue is allowed to reorder them:
+     *
+     *   * a newly started stroke of a higher class is placed before
+     *     the background strokes that have not started yet
+     *
+     *   * a newly started PRIORITY_INTERACTIVE stroke also preempts
+     *     the running background stroke, if it supports suspension
+     *     (see createSuspendStrategy()). The background stroke is
+     *     suspended before the interactive stroke and resumed after
+     *     it.
+     *
+     * The order of the non-background strokes is never changed.
+     */
+    void setPriorityClass(PriorityClass value);
+
 protected:
     /**
      * Protected c-tor, used for cloning of hi-level strategies
@@ -203,6 +239,7 @@ private:
     bool m_needsExplicitCancel;
     bool m_forceLodModeIfPossible;
     qreal m_balancingRatioOverride;
+    PriorityClass m_priorityClass;
 
     QLatin1String m_id;
     KUndo2MagicString m_name;
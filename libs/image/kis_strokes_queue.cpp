@@ -16,6 +16,7 @@
 #include "kis_undo_stores.h"
 #include "kis_post_execution_undo_adapter.h"
 #include "KisCppQuirks.h"
+#include "KisPipelineTracer.h"
 
 typedef QQueue<KisStrokeSP> StrokesQueue;
 typedef QQueue<KisStrokeSP>::iterator StrokesQueueIterator;
@@ -94,6 +95,12 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
     KisPostExecutionUndoAdapter lodNPostExecutionUndoAdapter;
     KisLodPreferences lodPreferences;
 
+    /**
+     * The time when the current stroke was loaded in
+     * KisPipelineTracer's clock, -1 if the tracing is disabled
+     */
+    qint64 currentStrokeTraceStart = -1;
+
     void cancelForgettableStrokes();
     void startLod0ToNStroke(int levelOfDetail, bool forgettable);
 
@@ -103,6 +110,9 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
     StrokesQueueIterator findNewLodNPos(KisStrokeSP lodN);
     bool shouldWrapInSuspendUpdatesStroke();
 
+    bool canYieldToStroke(KisStrokeSP stroke, KisStrokeStrategy::PriorityClass priorityClass) const;
+    QList<KisStrokeSP> takeYieldingStrokes(KisStrokeStrategy::PriorityClass priorityClass);
+
     void switchDesiredLevelOfDetail(bool forced);
     bool hasUnfinishedStrokes() const;
     void tryClearUndoOnStrokeCompletion(KisStrokeSP finishingStroke);
@@ -216,6 +226,58 @@ bool KisStrokesQueue::Private::shouldWrapInSuspendUpdatesStroke()
     return true;
 }
 
+bool KisStrokesQueue::Private::canYieldToStroke(KisStrokeSP stroke,
+                                                KisStrokeStrategy::PriorityClass priorityClass) const
+{
+    if (priorityClass <= KisStrokeStrategy::PRIORITY_BACKGROUND ||
+        stroke->priorityClass() != KisStrokeStrategy::PRIORITY_BACKGROUND ||
+        stroke->type() != KisStroke::LEGACY ||
+        stroke->isCancelled()) {
+
+        return false;
+    }
+
+    if (!stroke->isInitialized()) return true;
+
+    /**
+     * Only interactive strokes are worth the suspend/resume overhead.
+     * A stroke that has already queued all its jobs and is just
+     * waiting for them to complete cannot be suspended.
+     */
+    return priorityClass >= KisStrokeStrategy::PRIORITY_INTERACTIVE &&
+        stroke->supportsSuspension() &&
+        !(stroke->isEnded() && !stroke->hasJobs());
+}
+
+QList<KisStrokeSP> KisStrokesQueue::Private::takeYieldingStrokes(KisStrokeStrategy::PriorityClass priorityClass)
+{
+    QList<KisStrokeSP> result;
+
+    while (!strokesQueue.isEmpty() &&
+           canYieldToStroke(strokesQueue.last(), priorityClass)) {
+
+        result.prepend(strokesQueue.takeLast());
+    }
+
+    if (!result.isEmpty()) {
+        /**
+         * The background strokes are legacy ones, so they close the
+         * current LoD range. If there is an open LoD range before them,
+         * moving a new stroke into it would break the LoD sync logic.
+         */
+        StrokesQueueIterator it;
+        StrokesQueueIterator end;
+        std::tie(it, end) = currentLodRange();
+
+        if (it != end) {
+            strokesQueue.append(result);
+            result.clear();
+        }
+    }
+
+    return result;
+}
+
 StrokesQueueIterator KisStrokesQueue::Private::findNewLod0Pos()
 {
     StrokesQueueIterator it;
@@ -290,6 +352,16 @@ KisStrokeId KisStrokesQueue::startStroke(KisStrokeStrategy *strokeStrategy)
         m_d->cancelForgettableStrokes();
     }
 
+    /**
+     * The background strokes in the tail of the queue are taken out
+     * and put back after the new stroke has been added, so the new
+     * stroke is started before them.
+     */
+    const QList<KisStrokeSP> yieldingStrokes =
+        m_d->takeYieldingStrokes(strokeStrategy->priorityClass());
+    const bool headIsPreempted =
+        !yieldingStrokes.isEmpty() && m_d->strokesQueue.isEmpty();
+
     if (m_d->desiredLevelOfDetail &&
         (m_d->lodPreferences.lodPreferred() || strokeStrategy->forceLodModeIfPossible()) &&
         (lodBuddyStrategy =
@@ -327,6 +399,18 @@ KisStrokeId KisStrokesQueue::startStroke(KisStrokeStrategy *strokeStrategy)
         m_d->strokesQueue.enqueue(stroke);
     }
 
+    if (headIsPreempted) {
+        /**
+         * If the preempted stroke has already started, it will be
+         * suspended by the new head of the queue and resumed when its
+         * turn comes again
+         */
+        yieldingStrokes.first()->suspendStroke(m_d->strokesQueue.head());
+        m_d->currentStrokeLoaded = false;
+    }
+
+    m_d->strokesQueue.append(yieldingStrokes);
+
     KisStrokeId id(stroke);
     strokeStrategy->setMutatedJobsInterface(this, id);
 
@@ -772,6 +856,9 @@ void KisStrokesQueue::Private::loadStroke(KisStrokeSP stroke)
     balancingRatioOverride = stroke->balancingRatioOverride();
     currentStrokeLoaded = true;
 
+    KisPipelineTracer *tracer = KisPipelineTracer::instance();
+    currentStrokeTraceStart = tracer && tracer->isEnabled() ? tracer->timestamp() : -1;
+
     /**
      * Some of the strokes can cancel their work with undoing all the
      * changes they did to the paint devices. The problem is that undo
@@ -848,6 +935,14 @@ bool KisStrokesQueue::checkStrokeState(bool hasStrokeJobsRunning,
             m_d->postSyncLod0GUIPlaneRequestForResume();
         }
 
+        KisPipelineTracer *tracer = KisPipelineTracer::instance();
+        if (m_d->currentStrokeTraceStart >= 0 && tracer) {
+            tracer->addEvent(KisPipelineTracer::Stroke, stroke->name().toString(),
+                             QRect(), stroke->worksOnLevelOfDetail(),
+                             m_d->currentStrokeTraceStart, tracer->timestamp());
+            m_d->currentStrokeTraceStart = -1;
+        }
+
         m_d->strokesQueue.dequeue(); // deleted by shared pointer
         m_d->needsExclusiveAccess = false;
         m_d->wrapAroundModeSupported = false;
@@ -77,17 +77,25 @@ void KisSyncLodCacheStrokeStrategy::createJobsData(QVector<KisStrokeJobData *> &
         updatesFacade->blockUpdates();
     });
 
-    KritaUtils::addJobBarrier(jobs, [sharedData, deviceList, levelOfDetail] () mutable {
+    QHash<KisPaintDeviceSP, KisRegion> regions;
+    QHash<KisPaintDeviceSP, KisPaintDevice::LodSyncPoint> syncPoints;
+
+    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
+        KisPaintDevice::LodSyncPoint syncPoint;
+        regions.insert(device, device->regionForLodSyncing(levelOfDetail, &syncPoint));
+        syncPoints.insert(device, syncPoint);
+    }
+
+    KritaUtils::addJobBarrier(jobs, [sharedData, deviceList, levelOfDetail, syncPoints] () mutable {
         Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-            sharedData->insert(device, toQShared(device->createLodDataStruct(levelOfDetail)));
+            sharedData->insert(device, toQShared(device->createLodDataStruct(levelOfDetail, syncPoints.value(device))));
         }
     });
 
     KritaUtils::addJobSequential(jobs, [](){});
 
     Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-        KisRegion region = device->regionForLodSyncing();
-        QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
+        QVector<QRect> rects = splitRegionIntoPatches(regions.value(device), optimalPatchSize());
 
         Q_FOREACH (const QRect &rc, rects) {
             KritaUtils::addJobConcurrent(jobs, [sharedData, device, rc] () mutable {
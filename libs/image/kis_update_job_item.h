@@ -9,6 +9,7 @@
 
 #include <atomic>
 
+#include <QElapsedTimer>
 #include <QRunnable>
 #include <QReadWriteLock>
 
@@ -17,6 +18,7 @@
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
 #include "kis_updater_context.h"
+#include "KisPipelineTracer.h"
 #include <KoAlwaysInline.h>
 
 //#define DEBUG_JOBS_SEQUENCE
@@ -80,6 +82,9 @@ private:
                 m_updaterContext->m_exclusiveJobLock.lockForRead();
             }
 
+            QElapsedTimer jobTimer;
+            jobTimer.start();
+
             if(m_atomicType == Type::MERGE) {
                 runMergeJob();
             } else {
@@ -97,10 +102,22 @@ private:
                     }
 #endif
 
+                    KisPipelineTracer *tracer = KisPipelineTracer::instance();
+                    const bool isTraced = tracer && tracer->isEnabled();
+                    const bool isStrokeJob = m_atomicType == Type::STROKE;
+
+                    KisPipelineTracer::Scope traceScope(
+                        isStrokeJob ? KisPipelineTracer::StrokeJob : KisPipelineTracer::SpontaneousJob,
+                        isTraced ? m_runnableJob->debugName() : QString(),
+                        QRect(),
+                        isTraced && isStrokeJob ? static_cast<KisStrokeJob*>(m_runnableJob)->levelOfDetail() : 0);
+
                     m_runnableJob->run();
                 }
             }
 
+            m_updaterContext->addJobStatistics(jobTimer.nsecsElapsed() / 1000);
+
             setDone();
 
             m_updaterContext->doSomeUsefulWork();
@@ -132,7 +149,13 @@ public:
 
 #endif
 
-        m_merger.startMerge(*m_walker);
+        {
+            KisPipelineTracer::Scope traceScope(KisPipelineTracer::Merge,
+                                                m_walker->startNode(),
+                                                m_walker->changeRect(),
+                                                m_walker->levelOfDetail());
+            m_merger.startMerge(*m_walker);
+        }
 
         QRect changeRect = m_walker->changeRect();
         m_updaterContext->continueUpdate(changeRect);
@@ -17,9 +17,13 @@
 
 #include "kis_queues_progress_updater.h"
 #include "KisImageConfigNotifier.h"
+#include "KisAdaptiveSchedulingController.h"
 
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QReadWriteLock>
 #include "kis_lazy_wait_condition.h"
+#include <atomic>
 #include <mutex>
 
 //#define DEBUG_BALANCING
@@ -40,7 +44,10 @@ struct Q_DECL_HIDDEN KisUpdateScheduler::Private {
         : q(_q)
         , updaterContext(KisImageConfig(true).maxNumberOfThreads(), q)
         , projectionUpdateListener(p)
-    {}
+        , adaptiveController(updaterContext.threadsLimit(), defaultBalancingRatio)
+    {
+        adaptiveTimer.start();
+    }
 
     KisUpdateScheduler *q;
 
@@ -56,12 +63,115 @@ struct Q_DECL_HIDDEN KisUpdateScheduler::Private {
     QReadWriteLock updatesStartLock;
     KisLazyWaitCondition updatesFinishedCondition;
 
+    /**
+     * The controller is fed by whichever thread processes the queues,
+     * so it is guarded by a separate lock; the threads that fail to
+     * take it just skip sampling
+     */
+    QMutex adaptiveControllerLock;
+    KisAdaptiveSchedulingController adaptiveController;
+    bool allowAdaptiveScheduling = true;
+    std::atomic<bool> adaptiveSchedulingEnabled {false};
+    std::atomic<qreal> adaptiveBalancingRatio {1.0};
+    QElapsedTimer adaptiveTimer;
+    std::atomic<qint64> lastAdaptiveSampleTime {0};
+
     qreal balancingRatio() const {
         const qreal strokeRatioOverride = strokesQueue.balancingRatioOverride();
-        return strokeRatioOverride > 0 ? strokeRatioOverride : defaultBalancingRatio;
+        return strokeRatioOverride > 0 ? strokeRatioOverride :
+            adaptiveSchedulingEnabled.load(std::memory_order_relaxed) ?
+            adaptiveBalancingRatio.load(std::memory_order_relaxed) : defaultBalancingRatio;
     }
+
+    void resetAdaptiveScheduling(bool enabled);
+    void updateAdaptiveScheduling();
+    void notifyAdaptiveSchedulingQueuesDrained();
 };
 
+void KisUpdateScheduler::Private::resetAdaptiveScheduling(bool enabled)
+{
+    QMutexLocker l(&adaptiveControllerLock);
+
+    adaptiveController.setMaxThreads(updaterContext.threadsLimit());
+    adaptiveController.setDefaultBalancingRatio(defaultBalancingRatio);
+    adaptiveBalancingRatio.store(adaptiveController.balancingRatio());
+
+    int numFinishedJobs = 0;
+    qint64 busyTime = 0;
+    updaterContext.takeJobStatistics(&numFinishedJobs, &busyTime);
+    lastAdaptiveSampleTime.store(adaptiveTimer.nsecsElapsed() / 1000);
+
+    adaptiveSchedulingEnabled.store(enabled && allowAdaptiveScheduling);
+}
+
+void KisUpdateScheduler::Private::updateAdaptiveScheduling()
+{
+    if (!adaptiveSchedulingEnabled.load(std::memory_order_relaxed)) return;
+
+    const qint64 now = adaptiveTimer.nsecsElapsed() / 1000;
+    if (now - lastAdaptiveSampleTime.load(std::memory_order_relaxed) <
+        KisAdaptiveSchedulingController::SAMPLING_INTERVAL) return;
+
+    if (!adaptiveControllerLock.tryLock()) return;
+
+    KisAdaptiveSchedulingController::Sample sample;
+    sample.elapsedTime = now - lastAdaptiveSampleTime.load(std::memory_order_relaxed);
+
+    if (sample.elapsedTime >= KisAdaptiveSchedulingController::SAMPLING_INTERVAL &&
+        adaptiveSchedulingEnabled.load(std::memory_order_relaxed)) {
+
+        qint32 numMergeJobs = 0;
+        qint32 numStrokeJobs = 0;
+        updaterContext.getJobsSnapshot(numMergeJobs, numStrokeJobs);
+
+        sample.numRunningJobs = numMergeJobs + numStrokeJobs;
+        sample.updatesQueueSize = updatesQueue.sizeMetric();
+        sample.strokesQueueSize = strokesQueue.sizeMetric();
+        updaterContext.takeJobStatistics(&sample.numFinishedJobs, &sample.busyTime);
+
+        lastAdaptiveSampleTime.store(now, std::memory_order_relaxed);
+
+        if (adaptiveController.addSample(sample)) {
+            updaterContext.setActiveThreadsLimit(adaptiveController.activeThreadsLimit());
+            adaptiveBalancingRatio.store(adaptiveController.balancingRatio(),
+                                         std::memory_order_relaxed);
+        }
+    }
+
+    adaptiveControllerLock.unlock();
+}
+
+void KisUpdateScheduler::Private::notifyAdaptiveSchedulingQueuesDrained()
+{
+    if (!adaptiveSchedulingEnabled.load(std::memory_order_relaxed)) return;
+    if (!updatesQueue.isEmpty() || !strokesQueue.isEmpty()) return;
+
+    qint32 numMergeJobs = 0;
+    qint32 numStrokeJobs = 0;
+    updaterContext.getJobsSnapshot(numMergeJobs, numStrokeJobs);
+    if (numMergeJobs || numStrokeJobs) return;
+
+    if (!adaptiveControllerLock.tryLock()) return;
+
+    if (adaptiveController.notifyQueuesDrained()) {
+        updaterContext.setActiveThreadsLimit(adaptiveController.activeThreadsLimit());
+        adaptiveBalancingRatio.store(adaptiveController.balancingRatio(),
+                                     std::memory_order_relaxed);
+    }
+
+    /**
+     * The statistics of the drained burst should not leak into the
+     * first sample of the next one
+     */
+    int numFinishedJobs = 0;
+    qint64 busyTime = 0;
+    updaterContext.takeJobStatistics(&numFinishedJobs, &busyTime);
+    lastAdaptiveSampleTime.store(adaptiveTimer.nsecsElapsed() / 1000,
+                                 std::memory_order_relaxed);
+
+    adaptiveControllerLock.unlock();
+}
+
 KisUpdateScheduler::KisUpdateScheduler(KisProjectionUpdateListener *projectionUpdateListener, QObject *parent)
     : QObject(parent),
       m_d(new Private(this, projectionUpdateListener))
@@ -94,6 +204,7 @@ void KisUpdateScheduler::setThreadsLimit(int value)
     m_d->updaterContext.lock();
     m_d->updaterContext.setThreadsLimit(value);
     m_d->updaterContext.unlock();
+    m_d->resetAdaptiveScheduling(m_d->adaptiveSchedulingEnabled);
     unlock(false);
 }
 
@@ -283,6 +394,8 @@ void KisUpdateScheduler::updateSettings()
     m_d->updatesQueue.updateSettings();
     KisImageConfig config(true);
     m_d->defaultBalancingRatio = config.schedulerBalancingRatio();
+    m_d->adaptiveSchedulingEnabled =
+        config.adaptiveScheduling() && m_d->allowAdaptiveScheduling;
     setThreadsLimit(config.maxNumberOfThreads());
 }
 
@@ -359,6 +472,8 @@ void KisUpdateScheduler::processQueues()
 
     if(m_d->processingBlocked) return;
 
+    m_d->updateAdaptiveScheduling();
+
     if(m_d->strokesQueue.needsExclusiveAccess()) {
         DEBUG_BALANCING_METRICS("STROKES", "X");
         m_d->strokesQueue.processQueue(m_d->updaterContext,
@@ -415,7 +530,12 @@ void KisUpdateScheduler::tryProcessUpdatesQueue()
     QReadLocker locker(&m_d->updatesStartLock);
     if(m_d->updatesLockCounter) return;
 
-    m_d->updatesQueue.processQueue(m_d->updaterContext);
+    /**
+     * Split the big walkers for the idle threads only when there is
+     * no stroke waiting for them
+     */
+    m_d->updatesQueue.processQueue(m_d->updaterContext,
+                                   m_d->strokesQueue.isEmpty());
 }
 
 bool KisUpdateScheduler::haveUpdatesRunning()
@@ -442,11 +562,23 @@ void KisUpdateScheduler::doSomeUsefulWork()
 void KisUpdateScheduler::spareThreadAppeared()
 {
     processQueues();
+
+    /**
+     * The last finished job reports the drain of the queues, so the
+     * adaptive controller doesn't have to wait for an idle sample,
+     * which is never taken while the scheduler is idle
+     */
+    m_d->notifyAdaptiveSchedulingQueuesDrained();
 }
 
 KisTestableUpdateScheduler::KisTestableUpdateScheduler(KisProjectionUpdateListener *projectionUpdateListener,
                                                        qint32 threadCount)
 {
+    /**
+     * The tests expect exact number of the jobs running in
+     * the context, so the thread count should not float
+     */
+    m_d->allowAdaptiveScheduling = false;
     updateSettings();
     m_d->projectionUpdateListener = projectionUpdateListener;
 
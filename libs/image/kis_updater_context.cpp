@@ -103,6 +103,7 @@ int KisUpdaterContext::currentLevelOfDetail() const
 bool KisUpdaterContext::hasSpareThread()
 {
     bool found = false;
+    int numRunningJobs = 0;
 
     /**
      * We cannot use Q_FOREACH here since the function may
@@ -113,10 +114,11 @@ bool KisUpdaterContext::hasSpareThread()
     for (const KisUpdateJobItem *item : std::as_const(m_jobs)) {
         if(!item->isRunning()) {
             found = true;
-            break;
+        } else {
+            numRunningJobs++;
         }
     }
-    return found;
+    return found && numRunningJobs < m_activeThreadsLimit.load(std::memory_order_relaxed);
 }
 
 bool KisUpdaterContext::isJobAllowed(KisBaseRectsWalkerSP walker)
@@ -142,6 +144,19 @@ bool KisUpdaterContext::isJobAllowed(KisBaseRectsWalkerSP walker)
     return !intersects;
 }
 
+QVector<QRect> KisUpdaterContext::runningJobsAccessRects() const
+{
+    QVector<QRect> rects;
+
+    for (const KisUpdateJobItem *item : std::as_const(m_jobs)) {
+        if (item->isRunning() && !item->accessRect().isEmpty()) {
+            rects.append(item->accessRect());
+        }
+    }
+
+    return rects;
+}
+
 void KisUpdaterContext::startThread(int index)
 {
     {
@@ -263,6 +278,8 @@ void KisUpdaterContext::setThreadsLimit(int value)
     for(qint32 i = 0; i < m_jobs.size(); i++) {
         m_jobs[i] = new KisUpdateJobItem(this);
     }
+
+    m_activeThreadsLimit.store(value);
 }
 
 int KisUpdaterContext::threadsLimit() const
@@ -271,6 +288,28 @@ int KisUpdaterContext::threadsLimit() const
     return m_jobs.size();
 }
 
+void KisUpdaterContext::setActiveThreadsLimit(int value)
+{
+    m_activeThreadsLimit.store(qBound(1, value, m_jobs.size()), std::memory_order_relaxed);
+}
+
+int KisUpdaterContext::activeThreadsLimit() const
+{
+    return m_activeThreadsLimit.load(std::memory_order_relaxed);
+}
+
+void KisUpdaterContext::addJobStatistics(qint64 duration)
+{
+    m_numFinishedJobs.fetch_add(1, std::memory_order_relaxed);
+    m_jobsBusyTime.fetch_add(duration, std::memory_order_relaxed);
+}
+
+void KisUpdaterContext::takeJobStatistics(int *numFinishedJobs, qint64 *busyTime)
+{
+    *numFinishedJobs = m_numFinishedJobs.exchange(0, std::memory_order_relaxed);
+    *busyTime = m_jobsBusyTime.exchange(0, std::memory_order_relaxed);
+}
+
 void KisUpdaterContext::continueUpdate(const QRect& rc)
 {
     if (m_scheduler) m_scheduler->continueUpdate(rc);
@@ -7,6 +7,8 @@
 #ifndef __KIS_UPDATER_CONTEXT_H
 #define __KIS_UPDATER_CONTEXT_H
 
+#include <atomic>
+
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QThreadPool>
@@ -52,7 +54,8 @@ public:
 
     /**
      * Check whether there is a spare thread for running
-     * one more job
+     * one more job. The number of concurrently running
+     * jobs is limited by activeThreadsLimit().
      */
     bool hasSpareThread();
 
@@ -66,6 +69,16 @@ public:
      */
     bool isJobAllowed(KisBaseRectsWalkerSP walker);
 
+    /**
+     * Returns the access rects of all the currently running merge
+     * jobs. Used for finding the part of a blocked walker that could
+     * be started right now. It should be called with the lock held.
+     *
+     * \see isJobAllowed()
+     * \see lock()
+     */
+    QVector<QRect> runningJobsAccessRects() const;
+
     /**
      * Registers the job and starts executing it.
      * The caller must ensure that the context is locked
@@ -127,6 +140,30 @@ public:
      */
     int threadsLimit() const;
 
+    /**
+     * Limits the number of jobs allowed to run concurrently to \p value
+     * threads out of threadsLimit(). In contrast to setThreadsLimit(),
+     * it can be changed at any moment without any locks; the jobs that
+     * are already running are not affected.
+     *
+     * setThreadsLimit() resets the active limit to the full number of
+     * threads.
+     */
+    void setActiveThreadsLimit(int value);
+    int activeThreadsLimit() const;
+
+    /**
+     * Accounts \p duration microseconds of a finished job in the
+     * load statistics of the context
+     */
+    void addJobStatistics(qint64 duration);
+
+    /**
+     * Returns the number of jobs finished and the time spent in them
+     * since the previous call and resets the statistics
+     */
+    void takeJobStatistics(int *numFinishedJobs, qint64 *busyTime);
+
     void continueUpdate(const QRect& rc);
     void doSomeUsefulWork();
     void jobFinished();
@@ -158,6 +195,10 @@ protected:
     KisUpdateScheduler *m_scheduler;
     bool m_testingMode = false;
 
+    std::atomic<int> m_activeThreadsLimit {0};
+    std::atomic<int> m_numFinishedJobs {0};
+    std::atomic<qint64> m_jobsBusyTime {0};
+
 private:
 
     friend class KisUpdaterContextTest;
@@ -6,6 +6,9 @@
 
 #include "kis_convert_color_space_processing_visitor.h"
 
+#include <memory>
+#include <vector>
+
 #include "kis_external_layer_iface.h"
 
 #include "kis_do_something_command.h"
@@ -24,6 +27,10 @@
 #include "kis_time_span.h"
 #include <KoColorConversionTransformation.h>
 #include <KoUpdater.h>
+#include <KisFakeRunnableStrokeJobsExecutor.h>
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <kis_command_utils.h>
 #include <commands_new/KisChangeChannelFlagsCommand.h>
 #include <commands_new/KisChangeChannelLockFlagsCommand.h>
 #include <commands_new/KisResetGroupLayerCacheCommand.h>
@@ -32,11 +39,13 @@
 KisConvertColorSpaceProcessingVisitor::KisConvertColorSpaceProcessingVisitor(const KoColorSpace *srcColorSpace,
                                                                              const KoColorSpace *dstColorSpace,
                                                                              KoColorConversionTransformation::Intent renderingIntent,
-                                                                             KoColorConversionTransformation::ConversionFlags conversionFlags)
+                                                                             KoColorConversionTransformation::ConversionFlags conversionFlags,
+                                                                             KisRunnableStrokeJobsInterface *jobsInterface)
     : m_srcColorSpace(srcColorSpace)
     , m_dstColorSpace(dstColorSpace)
     , m_renderingIntent(renderingIntent)
     , m_conversionFlags(conversionFlags)
+    , m_jobsInterface(jobsInterface)
 {
 }
 
@@ -77,51 +86,95 @@ void KisConvertColorSpaceProcessingVisitor::visitNodeWithPaintDevice(KisNode *no
     if (!node->projectionLeaf()->isLayer()) return;
     if (*m_dstColorSpace == *node->colorSpace()) return;
 
-    bool alphaLock = false;
-    bool alphaDisabled = false;
-
-    KisLayer *layer = dynamic_cast<KisLayer*>(node);
+    KisLayerSP layer = dynamic_cast<KisLayer*>(node);
     KIS_SAFE_ASSERT_RECOVER_RETURN(layer);
 
-    KisProcessingVisitor::ProgressHelper helper(layer);
-
-    KisPaintLayer *paintLayer = 0;
-
-    KUndo2Command *parentConversionCommand = new KUndo2Command();
-
-    if (m_srcColorSpace->colorModelId() != m_dstColorSpace->colorModelId()) {
-        alphaDisabled = layer->alphaChannelDisabled();
-        new KisChangeChannelFlagsCommand(QBitArray(), layer, parentConversionCommand);
-        if ((paintLayer = dynamic_cast<KisPaintLayer*>(layer))) {
-            alphaLock = paintLayer->alphaLocked();
-            new KisChangeChannelLockFlagsCommand(QBitArray(), paintLayer, parentConversionCommand);
+    /**
+     * The original, the paint device and the projection of the layer
+     * may be represented by the same device, which should be converted
+     * only once
+     */
+    QVector<KisPaintDeviceSP> devices;
+    auto addDevice = [&devices] (KisPaintDeviceSP device) {
+        if (device && !devices.contains(device)) {
+            devices << device;
         }
-    }
+    };
 
-    if (layer->original()) {
-        layer->original()->convertTo(m_dstColorSpace, m_renderingIntent, m_conversionFlags, parentConversionCommand, helper.updater());
-    }
+    addDevice(layer->original());
 
     if (layer->paintDevice() && layer->paintDevice()->colorSpace()->colorModelId() != AlphaColorModelID) {
-        layer->paintDevice()->convertTo(m_dstColorSpace, m_renderingIntent, m_conversionFlags, parentConversionCommand, helper.updater());
+        addDevice(layer->paintDevice());
     }
 
-    if (layer->projection()) {
-        layer->projection()->convertTo(m_dstColorSpace, m_renderingIntent, m_conversionFlags, parentConversionCommand, helper.updater());
-    }
+    addDevice(layer->projection());
 
-    if (alphaDisabled) {
-        new KisChangeChannelFlagsCommand(m_dstColorSpace->channelFlags(true, false),
-                                         layer, parentConversionCommand);
-    }
+    /**
+     * The device commands are owned by the jobs until the final job
+     * passes them into the undo adapter. If the stroke is cancelled
+     * before that, they are just deleted together with the jobs.
+     */
+    using DeviceCommands = std::vector<std::unique_ptr<KUndo2Command>>;
+    std::shared_ptr<DeviceCommands> deviceCommands = std::make_shared<DeviceCommands>();
+
+    QVector<KisRunnableStrokeJobData*> jobs;
 
-    if (paintLayer && alphaLock) {
-        new KisChangeChannelLockFlagsCommand(m_dstColorSpace->channelFlags(true, false),
-                                             paintLayer, parentConversionCommand);
+    Q_FOREACH (KisPaintDeviceSP device, devices) {
+        deviceCommands->emplace_back(
+            device->prepareConvertTo(m_dstColorSpace, m_renderingIntent, m_conversionFlags, jobs));
     }
 
-    undoAdapter->addCommand(parentConversionCommand);
-    layer->invalidateFrames(KisTimeSpan::infinite(0), layer->extent());
+    const KoColorSpace *srcColorSpace = m_srcColorSpace;
+    const KoColorSpace *dstColorSpace = m_dstColorSpace;
+
+    /**
+     * The visitor is destroyed right after visiting the nodes, so the
+     * final job must not access it. The undo adapter belongs to the
+     * processing command, which is owned by the stroke's macro command.
+     */
+    KritaUtils::addJobSequential(jobs,
+        [layer, undoAdapter, srcColorSpace, dstColorSpace, deviceCommands] () mutable {
+            bool alphaLock = false;
+            bool alphaDisabled = false;
+
+            KisPaintLayerSP paintLayer;
+
+            KisCommandUtils::CompositeCommand *parentConversionCommand =
+                new KisCommandUtils::CompositeCommand();
+
+            if (srcColorSpace->colorModelId() != dstColorSpace->colorModelId()) {
+                alphaDisabled = layer->alphaChannelDisabled();
+                parentConversionCommand->addCommand(new KisChangeChannelFlagsCommand(QBitArray(), layer));
+                if ((paintLayer = dynamic_cast<KisPaintLayer*>(layer.data()))) {
+                    alphaLock = paintLayer->alphaLocked();
+                    parentConversionCommand->addCommand(new KisChangeChannelLockFlagsCommand(QBitArray(), paintLayer));
+                }
+            }
+
+            for (std::unique_ptr<KUndo2Command> &command : *deviceCommands) {
+                parentConversionCommand->addCommand(command.release());
+            }
+
+            if (alphaDisabled) {
+                parentConversionCommand->addCommand(
+                    new KisChangeChannelFlagsCommand(dstColorSpace->channelFlags(true, false), layer));
+            }
+
+            if (paintLayer && alphaLock) {
+                parentConversionCommand->addCommand(
+                    new KisChangeChannelLockFlagsCommand(dstColorSpace->channelFlags(true, false), paintLayer));
+            }
+
+            undoAdapter->addCommand(parentConversionCommand);
+            layer->invalidateFrames(KisTimeSpan::infinite(0), layer->extent());
+        });
+
+    if (m_jobsInterface) {
+        m_jobsInterface->addRunnableJobs(jobs);
+    } else {
+        KisFakeRunnableStrokeJobsExecutor executor;
+        executor.addRunnableJobs(implicitCastList<KisRunnableStrokeJobDataBase*>(jobs));
+    }
 }
 
 void KisConvertColorSpaceProcessingVisitor::visit(KisGroupLayer *layer, KisUndoAdapter *undoAdapter)
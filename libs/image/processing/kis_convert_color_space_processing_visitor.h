@@ -13,14 +13,23 @@
 #include <KoColorConversionTransformation.h>
 
 class KoColorSpace;
+class KisRunnableStrokeJobsInterface;
 
 class KRITAIMAGE_EXPORT  KisConvertColorSpaceProcessingVisitor : public KisSimpleProcessingVisitor
 {
 public:
+    /**
+     * The pixel data of the layers is converted by the concurrent jobs
+     * added into \p jobsInterface, normally the one returned by
+     * KisProcessingApplicator::runnableJobsInterface(). If \p
+     * jobsInterface is null, the jobs are executed right inside the
+     * visitor.
+     */
     KisConvertColorSpaceProcessingVisitor(const KoColorSpace *srcColorSpace,
                                           const KoColorSpace *dstColorSpace,
                                           KoColorConversionTransformation::Intent renderingIntent,
-                                          KoColorConversionTransformation::ConversionFlags conversionFlags);
+                                          KoColorConversionTransformation::ConversionFlags conversionFlags,
+                                          KisRunnableStrokeJobsInterface *jobsInterface = nullptr);
 
 private:
     void visitNodeWithPaintDevice(KisNode *node, KisUndoAdapter *undoAdapter) override;
@@ -41,6 +50,7 @@ private:
     const KoColorSpace *m_dstColorSpace;
     KoColorConversionTransformation::Intent m_renderingIntent;
     KoColorConversionTransformation::ConversionFlags m_conversionFlags;
+    KisRunnableStrokeJobsInterface *m_jobsInterface;
 };
 
 #endif /* __KIS_CONVERT_COLORSPACE_PROCESSING_VISITOR_H */
@@ -0,0 +1,154 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisAdaptiveSchedulingControllerTest.h"
+
+#include "KisAdaptiveSchedulingController.h"
+#include "kistest.h"
+
+namespace {
+
+KisAdaptiveSchedulingController::Sample makeSample(int numRunningJobs,
+                                                   int updatesQueueSize,
+                                                   int strokesQueueSize,
+                                                   int numFinishedJobs,
+                                                   qint64 jobDuration)
+{
+    KisAdaptiveSchedulingController::Sample sample;
+    sample.numRunningJobs = numRunningJobs;
+    sample.updatesQueueSize = updatesQueueSize;
+    sample.strokesQueueSize = strokesQueueSize;
+    sample.numFinishedJobs = numFinishedJobs;
+    sample.busyTime = numFinishedJobs * jobDuration;
+    sample.elapsedTime = KisAdaptiveSchedulingController::SAMPLING_INTERVAL;
+    return sample;
+}
+
+}
+
+void KisAdaptiveSchedulingControllerTest::testSmallJobsReduceThreads()
+{
+    KisAdaptiveSchedulingController controller(8, 100.0);
+    QCOMPARE(controller.activeThreadsLimit(), 8);
+
+    // a trickle of tiny dab updates
+    for (int i = 0; i < 10; i++) {
+        controller.addSample(makeSample(1, 2, 0, 20, 50));
+    }
+
+    QVERIFY(controller.averageJobDuration() < 100.0);
+    QVERIFY(controller.utilization() < 0.1);
+    QCOMPARE(controller.activeThreadsLimit(), 2);
+
+    // the threads get saturated with the same tiny jobs, so more of them are needed
+    for (int i = 0; i < 10; i++) {
+        const int numThreads = controller.activeThreadsLimit();
+        controller.addSample(makeSample(numThreads, 20, 0, numThreads * 500, 100));
+    }
+
+    QCOMPARE(controller.activeThreadsLimit(), 8);
+}
+
+void KisAdaptiveSchedulingControllerTest::testBigBacklogSaturatesThreads()
+{
+    KisAdaptiveSchedulingController controller(8, 100.0);
+
+    for (int i = 0; i < 10; i++) {
+        controller.addSample(makeSample(1, 1, 0, 20, 50));
+    }
+    QCOMPARE(controller.activeThreadsLimit(), 2);
+
+    // idle period makes the controller forget the job durations
+    QVERIFY(controller.addSample(makeSample(0, 0, 0, 0, 0)));
+    QCOMPARE(controller.averageJobDuration(), -1.0);
+    QCOMPARE(controller.activeThreadsLimit(), 8);
+
+    // a full refresh arrives
+    QVERIFY(!controller.addSample(makeSample(2, 100, 0, 0, 0)));
+    QCOMPARE(controller.activeThreadsLimit(), 8);
+
+    // the jobs are big, so the threads are kept even if they are not saturated
+    controller.addSample(makeSample(8, 90, 0, 10, 20000));
+    controller.addSample(makeSample(8, 3, 0, 10, 20000));
+    QCOMPARE(controller.activeThreadsLimit(), 8);
+}
+
+void KisAdaptiveSchedulingControllerTest::testDrainedQueuesResetController()
+{
+    KisAdaptiveSchedulingController controller(8, 100.0);
+
+    // a trickle of tiny dab updates lagging behind a stroke
+    for (int i = 0; i < 10; i++) {
+        controller.addSample(makeSample(1, 3, 1, 20, 50));
+    }
+    controller.addSample(makeSample(2, 10, 1, 20, 50));
+    QCOMPARE(controller.activeThreadsLimit(), 2);
+    QCOMPARE(controller.balancingRatio(), 50.0);
+
+    // the queues drain between two samples, so the controller
+    // never sees an idle sample
+    QVERIFY(controller.notifyQueuesDrained());
+    QCOMPARE(controller.averageJobDuration(), -1.0);
+    QCOMPARE(controller.activeThreadsLimit(), 8);
+    QCOMPARE(controller.balancingRatio(), 100.0);
+
+    // a full refresh gets all the threads right from the first sample
+    QVERIFY(!controller.addSample(makeSample(8, 100, 0, 0, 0)));
+    QCOMPARE(controller.activeThreadsLimit(), 8);
+
+    QVERIFY(!controller.notifyQueuesDrained());
+}
+
+void KisAdaptiveSchedulingControllerTest::testLaggingUpdatesLowerBalancingRatio()
+{
+    KisAdaptiveSchedulingController controller(4, 100.0);
+    QCOMPARE(controller.balancingRatio(), 100.0);
+
+    controller.addSample(makeSample(4, 10, 5, 40, 5000));
+    QCOMPARE(controller.balancingRatio(), 50.0);
+
+    controller.addSample(makeSample(4, 20, 5, 40, 5000));
+    QCOMPARE(controller.balancingRatio(), 25.0);
+
+    // the ratio is not decreased infinitely
+    controller.addSample(makeSample(4, 40, 5, 40, 5000));
+    controller.addSample(makeSample(4, 80, 5, 40, 5000));
+    QCOMPARE(controller.balancingRatio(), 25.0);
+
+    // the queue is not growing anymore
+    controller.addSample(makeSample(4, 60, 5, 40, 5000));
+    QCOMPARE(controller.balancingRatio(), 25.0);
+
+    // the updates queue has drained
+    controller.addSample(makeSample(4, 0, 5, 40, 5000));
+    QCOMPARE(controller.balancingRatio(), 50.0);
+    controller.addSample(makeSample(4, 0, 5, 40, 5000));
+    QCOMPARE(controller.balancingRatio(), 100.0);
+    controller.addSample(makeSample(4, 0, 5, 40, 5000));
+    QCOMPARE(controller.balancingRatio(), 100.0);
+}
+
+void KisAdaptiveSchedulingControllerTest::testSetMaxThreadsResetsLimit()
+{
+    KisAdaptiveSchedulingController controller(8, 100.0);
+
+    for (int i = 0; i < 10; i++) {
+        controller.addSample(makeSample(1, 1, 0, 20, 50));
+    }
+    QCOMPARE(controller.activeThreadsLimit(), 2);
+
+    controller.setMaxThreads(16);
+    QCOMPARE(controller.maxThreads(), 16);
+    QCOMPARE(controller.activeThreadsLimit(), 16);
+
+    controller.setMaxThreads(1);
+    for (int i = 0; i < 10; i++) {
+        controller.addSample(makeSample(1, 1, 0, 20, 50));
+    }
+    QCOMPARE(controller.activeThreadsLimit(), 1);
+}
+
+KISTEST_MAIN(KisAdaptiveSchedulingControllerTest)
@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISADAPTIVESCHEDULINGCONTROLLERTEST_H
+#define KISADAPTIVESCHEDULINGCONTROLLERTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisAdaptiveSchedulingControllerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testSmallJobsReduceThreads();
+    void testBigBacklogSaturatesThreads();
+    void testDrainedQueuesResetController();
+    void testLaggingUpdatesLowerBalancingRatio();
+    void testSetMaxThreadsResetsLimit();
+};
+
+#endif // KISADAPTIVESCHEDULINGCONTROLLERTEST_H
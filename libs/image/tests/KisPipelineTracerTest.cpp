@@ -0,0 +1,138 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPipelineTracerTest.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <KoColorSpaceRegistry.h>
+
+#include "KisPipelineTracer.h"
+#include "kis_image.h"
+#include "kis_paint_layer.h"
+#include "kis_group_layer.h"
+#include "kistest.h"
+
+
+void KisPipelineTracerTest::testRingBufferOverflow()
+{
+    KisPipelineTracer tracer(8);
+
+    for (int i = 0; i < 12; i++) {
+        tracer.addEvent(KisPipelineTracer::Merge, QString("job%1").arg(i),
+                        QRect(i, 0, 64, 64), 0, i * 10, i * 10 + 5);
+    }
+
+    const QVector<KisPipelineTracer::Event> events = tracer.events();
+    QCOMPARE(events.size(), 8);
+
+    for (int i = 0; i < events.size(); i++) {
+        QCOMPARE(events[i].name, QString("job%1").arg(i + 4));
+        QCOMPARE(events[i].rect, QRect(i + 4, 0, 64, 64));
+        QCOMPARE(events[i].start, qint64((i + 4) * 10));
+    }
+
+    tracer.clear();
+    QVERIFY(tracer.events().isEmpty());
+}
+
+void KisPipelineTracerTest::testChromeTraceExport()
+{
+    KisPipelineTracer tracer(16);
+
+    tracer.addEvent(KisPipelineTracer::MergeLeaf, "Layer 1", QRect(0, 0, 512, 256), 2, 100, 350);
+    tracer.addEvent(KisPipelineTracer::Stroke, "Freehand stroke", QRect(), 0, 50, 900);
+
+    const QJsonDocument doc = QJsonDocument::fromJson(tracer.toChromeTrace());
+    QVERIFY(doc.isObject());
+
+    const QJsonArray traceEvents = doc.object()["traceEvents"].toArray();
+    QCOMPARE(traceEvents.size(), 2);
+
+    const QJsonObject stroke = traceEvents[0].toObject();
+    QCOMPARE(stroke["name"].toString(), QString("Freehand stroke"));
+    QCOMPARE(stroke["cat"].toString(), QString("stroke"));
+    QCOMPARE(stroke["ph"].toString(), QString("X"));
+    QCOMPARE(stroke["ts"].toDouble(), 50.0);
+    QCOMPARE(stroke["dur"].toDouble(), 850.0);
+    QVERIFY(!stroke["args"].toObject().contains("rect"));
+
+    const QJsonObject leaf = traceEvents[1].toObject();
+    QCOMPARE(leaf["name"].toString(), QString("Layer 1"));
+    QCOMPARE(leaf["cat"].toString(), QString("merge-leaf"));
+    QCOMPARE(leaf["args"].toObject()["rect"].toString(), QString("0,0 512x256"));
+    QCOMPARE(leaf["args"].toObject()["lod"].toInt(), 2);
+}
+
+void KisPipelineTracerTest::testScope()
+{
+    KisPipelineTracer *tracer = KisPipelineTracer::instance();
+    tracer->clear();
+
+    tracer->setEnabled(false);
+
+    {
+        KisPipelineTracer::Scope scope(KisPipelineTracer::StrokeJob, "disabled");
+    }
+
+    QVERIFY(tracer->events().isEmpty());
+
+    tracer->setEnabled(true);
+
+    {
+        KisPipelineTracer::Scope scope(KisPipelineTracer::StrokeJob, "enabled", QRect(1, 2, 3, 4), 1);
+    }
+
+    tracer->setEnabled(false);
+
+    const QVector<KisPipelineTracer::Event> events = tracer->events();
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events[0].category, KisPipelineTracer::StrokeJob);
+    QCOMPARE(events[0].name, QString("enabled"));
+    QCOMPARE(events[0].rect, QRect(1, 2, 3, 4));
+    QCOMPARE(events[0].levelOfDetail, 1);
+    QVERIFY(events[0].end >= events[0].start);
+
+    tracer->clear();
+}
+
+void KisPipelineTracerTest::testMergeJobsAreTraced()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, 256, 256, cs, "tracer test");
+
+    KisPaintLayerSP layer = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8);
+    image->addNode(layer, image->rootLayer());
+    image->initialRefreshGraph();
+
+    KisPipelineTracer *tracer = KisPipelineTracer::instance();
+    tracer->clear();
+    tracer->setEnabled(true);
+
+    layer->setDirty(QRect(10, 10, 100, 100));
+    image->waitForDone();
+
+    tracer->setEnabled(false);
+
+    bool hasMergeJob = false;
+    bool hasMergeLeaf = false;
+
+    Q_FOREACH (const KisPipelineTracer::Event &event, tracer->events()) {
+        if (event.name != "paint1") continue;
+
+        hasMergeJob |= event.category == KisPipelineTracer::Merge;
+        hasMergeLeaf |= event.category == KisPipelineTracer::MergeLeaf;
+    }
+
+    QVERIFY(hasMergeJob);
+    QVERIFY(hasMergeLeaf);
+
+    tracer->clear();
+}
+
+KISTEST_MAIN(KisPipelineTracerTest)
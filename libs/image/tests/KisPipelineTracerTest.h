@@ -0,0 +1,24 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPIPELINETRACERTEST_H
+#define KISPIPELINETRACERTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisPipelineTracerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRingBufferOverflow();
+    void testChromeTraceExport();
+    void testScope();
+    void testMergeJobsAreTraced();
+};
+
+#endif // KISPIPELINETRACERTEST_H
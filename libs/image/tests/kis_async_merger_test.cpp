@@ -21,6 +21,7 @@
 #include "kis_filter_mask.h"
 #include "kis_selection.h"
 #include "kis_paint_device_debug_utils.h"
+#include "KisBelowStackCache.h"
 #include <KisGlobalResourcesInterface.h>
 
 #include "filter/kis_filter.h"
@@ -496,6 +497,90 @@ void KisAsyncMergerTest::testFilterMaskOnFilterLayer()
                                   "async_merger_test", "mask_on_adj", "initial", 3));
 }
 
+    /*
+      +-----------+
+      |root       |
+      | paint 3   |
+      | paint 2   |
+      | paint 1   |
+      +-----------+
+     */
+
+void KisAsyncMergerTest::testBelowStackCache()
+{
+    const KoColorSpace *colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, 128, 128, colorSpace, "below stack cache test");
+
+    KisPaintDeviceSP device1 = new KisPaintDevice(colorSpace);
+    device1->fill(image->bounds(), KoColor(Qt::white, colorSpace));
+    KisLayerSP paintLayer1 = new KisPaintLayer(image, "paint1", OPACITY_OPAQUE_U8, device1);
+
+    KisPaintDeviceSP device2 = new KisPaintDevice(colorSpace);
+    device2->fill(QRect(0, 0, 64, 128), KoColor(Qt::red, colorSpace));
+    KisLayerSP paintLayer2 = new KisPaintLayer(image, "paint2", 128, device2);
+
+    KisPaintDeviceSP device3 = new KisPaintDevice(colorSpace);
+    device3->fill(QRect(32, 32, 64, 64), KoColor(Qt::black, colorSpace));
+    KisLayerSP paintLayer3 = new KisPaintLayer(image, "paint3", OPACITY_OPAQUE_U8, device3);
+
+    image->addNode(paintLayer1, image->rootLayer());
+    image->addNode(paintLayer2, image->rootLayer());
+    image->addNode(paintLayer3, image->rootLayer());
+
+    image->initialRefreshGraph();
+
+    KisBelowStackCache *cache = image->rootLayer()->belowStackCache();
+    QVERIFY(cache->validRegion().isEmpty());
+
+    const QImage refImage = image->projection()->convertToQImage(0);
+
+    KisMergeWalker walker(image->bounds());
+    KisAsyncMerger merger;
+
+    walker.collectRects(paintLayer3, image->bounds());
+    merger.startMerge(walker);
+
+    QCOMPARE(cache->filthyChild(), KisNodeSP(paintLayer3));
+    QCOMPARE(cache->validRegion(), QRegion(image->bounds()));
+    QCOMPARE(image->projection()->convertToQImage(0), refImage);
+
+    /**
+     * Change the bottom layer without notifying the image: the next
+     * update of the top layer should still use the cached backdrop
+     */
+    device1->fill(image->bounds(), KoColor(Qt::blue, colorSpace));
+
+    walker.collectRects(paintLayer3, image->bounds());
+    merger.startMerge(walker);
+
+    QCOMPARE(image->projection()->convertToQImage(0), refImage);
+
+    walker.collectRects(paintLayer1, image->bounds());
+    merger.startMerge(walker);
+
+    QVERIFY(cache->validRegion().isEmpty());
+
+    const QImage changedImage = image->projection()->convertToQImage(0);
+    QVERIFY(changedImage != refImage);
+
+    walker.collectRects(paintLayer3, image->bounds());
+    merger.startMerge(walker);
+
+    QCOMPARE(cache->validRegion(), QRegion(image->bounds()));
+    QCOMPARE(image->projection()->convertToQImage(0), changedImage);
+
+    /**
+     * A single layer below is blended directly, but the backdrop
+     * of the top layer is still invalidated
+     */
+    walker.collectRects(paintLayer2, QRect(0, 0, 64, 64));
+    merger.startMerge(walker);
+
+    QCOMPARE(cache->filthyChild(), KisNodeSP(paintLayer3));
+    QCOMPARE(cache->validRegion(), QRegion(image->bounds()) - QRegion(0, 0, 64, 64));
+    QCOMPARE(image->projection()->convertToQImage(0), changedImage);
+}
+
 
 SIMPLE_TEST_MAIN(KisAsyncMergerTest)
 
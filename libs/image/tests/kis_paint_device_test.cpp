@@ -285,6 +285,61 @@ void KisPaintDeviceTest::testColorSpaceConversion()
     delete cmd;
 }
 
+#include <KisFakeRunnableStrokeJobsExecutor.h>
+#include <KisRunnableStrokeJobData.h>
+
+void KisPaintDeviceTest::testColorSpaceConversionJobs()
+{
+    QImage image(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    const KoColorSpace* srcCs = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace* dstCs = KoColorSpaceRegistry::instance()->lab16();
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(srcCs);
+    refDev->convertFromQImage(image, 0);
+    refDev->moveTo(10, 10);   // Unalign with tile boundaries
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*refDev);
+
+    refDev->convertTo(dstCs,
+                      KoColorConversionTransformation::internalRenderingIntent(),
+                      KoColorConversionTransformation::internalConversionFlags());
+
+    QVector<KisRunnableStrokeJobData*> jobs;
+    QScopedPointer<KUndo2Command> cmd(
+        dev->prepareConvertTo(dstCs,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags(),
+                              jobs));
+
+    QVERIFY(jobs.size() > 1);
+
+    KisFakeRunnableStrokeJobsExecutor executor;
+    executor.addRunnableJobs(implicitCastList<KisRunnableStrokeJobDataBase*>(jobs));
+
+    // the device is not changed until the command is executed
+    QVERIFY(*dev->colorSpace() == *srcCs);
+
+    cmd->redo();
+
+    QCOMPARE(dev->exactBounds(), refDev->exactBounds());
+    QCOMPARE(dev->pixelSize(), dstCs->pixelSize());
+    QVERIFY(*dev->colorSpace() == *dstCs);
+
+    QPoint errpoint;
+    QImage refImage = refDev->convertToQImage(0, 10, 10, image.width(), image.height());
+    QImage result = dev->convertToQImage(0, 10, 10, image.width(), image.height());
+
+    if (!TestUtil::compareQImages(errpoint, refImage, result)) {
+        QFAIL(QString("Failed to convert the device with jobs, first different pixel: %1,%2 ")
+              .arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    cmd->undo();
+
+    QCOMPARE(dev->exactBounds(), QRect(10, 10, image.width(), image.height()));
+    QCOMPARE(dev->pixelSize(), srcCs->pixelSize());
+    QVERIFY(*dev->colorSpace() == *srcCs);
+}
 
 void KisPaintDeviceTest::testRoundtripConversion()
 {
@@ -1538,6 +1593,135 @@ void KisPaintDeviceTest::testLodDevice()
                                   "lod", "lod1-offset-6-14"));
 }
 
+KisRegion incrementalSyncLodCache(KisPaintDeviceSP dev, int levelOfDetail)
+{
+    KisPaintDevice::LodSyncPoint syncPoint;
+    KisRegion region = dev->regionForLodSyncing(levelOfDetail, &syncPoint);
+    QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(levelOfDetail, syncPoint));
+
+    Q_FOREACH(QRect rect2, KritaUtils::splitRegionIntoPatches(region, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s.data(), rect2);
+    }
+
+    dev->uploadLodDataStruct(s.data());
+
+    return region;
+}
+
+QImage fullyRegeneratedLodImage(KisPaintDeviceSP dev, int levelOfDetail, const QRect &imageRect)
+{
+    KisPaintDeviceSP ref = new KisPaintDevice(dev->colorSpace());
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(dev->defaultBounds()->bounds());
+    ref->setDefaultBounds(bounds);
+    ref->makeCloneFrom(dev, dev->extent());
+
+    bounds->testingSetLevelOfDetail(levelOfDetail);
+    syncLodCache(ref, levelOfDetail);
+
+    return ref->convertToQImage(0, imageRect);
+}
+
+void KisPaintDeviceTest::testIncrementalLodSync()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(QRect(0,0,512,512));
+    dev->setDefaultBounds(bounds);
+
+    const QRect lodImageRect(0,0,256,256);
+
+    fillGradientDevice(dev, QRect(0,0,512,512));
+
+    // the first sync regenerates the whole device
+    bounds->testingSetLevelOfDetail(1);
+    QCOMPARE(incrementalSyncLodCache(dev, 1).boundingRect(), QRect(0,0,512,512));
+
+    // nothing has changed, nothing to regenerate
+    QVERIFY(incrementalSyncLodCache(dev, 1).isEmpty());
+
+    bounds->testingSetLevelOfDetail(0);
+    dev->fill(QRect(100,100,10,10), KoColor(Qt::blue, cs));
+
+    // only the changed tile is regenerated
+    bounds->testingSetLevelOfDetail(1);
+    QCOMPARE(incrementalSyncLodCache(dev, 1).boundingRect(), QRect(64,64,64,64));
+
+    QImage result = dev->convertToQImage(0, lodImageRect);
+    bounds->testingSetLevelOfDetail(0);
+    QCOMPARE(result, fullyRegeneratedLodImage(dev, 1, lodImageRect));
+
+    // painting on the LoD plane doesn't leak into the next sync
+    bounds->testingSetLevelOfDetail(1);
+    dev->fill(QRect(10,10,20,20), KoColor(Qt::green, cs));
+
+    bounds->testingSetLevelOfDetail(0);
+    dev->fill(QRect(300,300,10,10), KoColor(Qt::blue, cs));
+
+    bounds->testingSetLevelOfDetail(1);
+    QCOMPARE(incrementalSyncLodCache(dev, 1).boundingRect(), QRect(256,256,64,64));
+
+    result = dev->convertToQImage(0, lodImageRect);
+    bounds->testingSetLevelOfDetail(0);
+    QCOMPARE(result, fullyRegeneratedLodImage(dev, 1, lodImageRect));
+
+    // the first sync of another level of detail regenerates the whole device
+    bounds->testingSetLevelOfDetail(2);
+    QCOMPARE(incrementalSyncLodCache(dev, 2).boundingRect(), QRect(0,0,512,512));
+
+    // but every level keeps its own plane, so switching back is cheap
+    bounds->testingSetLevelOfDetail(0);
+    dev->fill(QRect(130,10,10,10), KoColor(Qt::blue, cs));
+
+    bounds->testingSetLevelOfDetail(1);
+    QCOMPARE(incrementalSyncLodCache(dev, 1).boundingRect(), QRect(128,0,64,64));
+
+    result = dev->convertToQImage(0, lodImageRect);
+    bounds->testingSetLevelOfDetail(0);
+    QCOMPARE(result, fullyRegeneratedLodImage(dev, 1, lodImageRect));
+
+    bounds->testingSetLevelOfDetail(2);
+    QCOMPARE(incrementalSyncLodCache(dev, 2).boundingRect(), QRect(128,0,64,64));
+
+    result = dev->convertToQImage(0, QRect(0,0,128,128));
+    bounds->testingSetLevelOfDetail(0);
+    QCOMPARE(result, fullyRegeneratedLodImage(dev, 2, QRect(0,0,128,128)));
+
+    // the changes made after the region has been calculated are not lost
+    {
+        KisPaintDevice::LodSyncPoint syncPoint;
+        KisRegion region = dev->regionForLodSyncing(1, &syncPoint);
+        QVERIFY(region.isEmpty());
+
+        bounds->testingSetLevelOfDetail(0);
+        dev->fill(QRect(200,200,10,10), KoColor(Qt::blue, cs));
+
+        bounds->testingSetLevelOfDetail(1);
+        QScopedPointer<KisPaintDevice::LodDataStruct> s(dev->createLodDataStruct(1, syncPoint));
+        dev->uploadLodDataStruct(s.data());
+    }
+
+    QCOMPARE(incrementalSyncLodCache(dev, 1).boundingRect(), QRect(192,192,64,64));
+
+    result = dev->convertToQImage(0, lodImageRect);
+    bounds->testingSetLevelOfDetail(0);
+    QCOMPARE(result, fullyRegeneratedLodImage(dev, 1, lodImageRect));
+
+    // moving the device drops the cache
+    dev->setX(20);
+
+    bounds->testingSetLevelOfDetail(2);
+    QCOMPARE(incrementalSyncLodCache(dev, 2).boundingRect(), QRect(20,0,512,512));
+
+    // converting the color space drops the cache as well
+    bounds->testingSetLevelOfDetail(0);
+    dev->convertTo(KoColorSpaceRegistry::instance()->rgb16());
+
+    bounds->testingSetLevelOfDetail(2);
+    QCOMPARE(incrementalSyncLodCache(dev, 2).boundingRect(), QRect(20,0,512,512));
+}
+
 void KisPaintDeviceTest::benchmarkLod1Generation()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
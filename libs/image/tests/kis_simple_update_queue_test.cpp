@@ -140,6 +140,133 @@ void KisSimpleUpdateQueueTest::testSplit(bool useFullRefresh)
     QVERIFY(checkWalker(walkersList[3], QRect(512,512,488,488)));
 }
 
+void KisSimpleUpdateQueueTest::testSplitForSpareThreads()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->barrierLock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    QRect dirtyRect(0,0,512,512);
+
+    QVector<KisUpdateJobItem*> jobs;
+
+    // without the permission the walker is passed as a whole
+    {
+        KisTestableSimpleUpdateQueue queue;
+        queue.addUpdateJob(paintLayer, dirtyRect, imageRect, 0);
+
+        KisTestableUpdaterContext context(4);
+        queue.processQueue(context);
+
+        jobs = context.getJobs();
+        QVERIFY(checkWalker(jobs[0]->walker(), dirtyRect));
+        QVERIFY(!jobs[1]->isRunning());
+    }
+
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    queue.addUpdateJob(paintLayer, dirtyRect, imageRect, 0);
+    QCOMPARE(walkersList.size(), 1);
+
+    KisTestableUpdaterContext context(4);
+    queue.processQueue(context, true);
+
+    jobs = context.getJobs();
+    QCOMPARE(jobs.size(), 4);
+
+    QVERIFY(checkWalker(jobs[0]->walker(), QRect(0,0,256,256)));
+    QVERIFY(checkWalker(jobs[1]->walker(), QRect(0,256,256,256)));
+    QVERIFY(checkWalker(jobs[2]->walker(), QRect(256,0,256,256)));
+    QVERIFY(checkWalker(jobs[3]->walker(), QRect(256,256,256,256)));
+
+    QVERIFY(walkersList.isEmpty());
+}
+
+void KisSimpleUpdateQueueTest::testStartFreePartOfBlockedJob()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->barrierLock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    QRect dirtyRect1(0,0,128,128);
+    QRect dirtyRect2(64,0,192,128);
+
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+    KisTestableUpdaterContext context(2);
+
+    queue.addUpdateJob(paintLayer, dirtyRect1, imageRect, 0);
+    queue.processQueue(context);
+
+    queue.addUpdateJob(paintLayer, dirtyRect2, imageRect, 0);
+    queue.processQueue(context);
+
+    QVector<KisUpdateJobItem*> jobs = context.getJobs();
+
+    // the part not intersecting the running job is started...
+    QVERIFY(checkWalker(jobs[0]->walker(), dirtyRect1));
+    QVERIFY(checkWalker(jobs[1]->walker(), QRect(128,0,128,128)));
+
+    // ... and the rest of it waits in the queue
+    QCOMPARE(walkersList.size(), 1);
+    QVERIFY(checkWalker(walkersList[0], QRect(64,0,64,128)));
+}
+
+void KisSimpleUpdateQueueTest::testFoldSmallPartsOfBlockedJob()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->barrierLock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    QRect dirtyRect1(0,0,128,128);
+    QRect dirtyRect2(120,0,136,136);
+
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+    KisTestableUpdaterContext context(2);
+
+    queue.addUpdateJob(paintLayer, dirtyRect1, imageRect, 0);
+    queue.processQueue(context);
+
+    queue.addUpdateJob(paintLayer, dirtyRect2, imageRect, 0);
+    queue.processQueue(context);
+
+    QVector<KisUpdateJobItem*> jobs = context.getJobs();
+
+    /**
+     * The 8px strips around the running job are not started or queued
+     * separately: the free one joins the started part and the busy one
+     * takes a column of tiles from it
+     */
+    QVERIFY(checkWalker(jobs[0]->walker(), dirtyRect1));
+    QVERIFY(checkWalker(jobs[1]->walker(), QRect(192,0,64,136)));
+
+    QCOMPARE(walkersList.size(), 1);
+    QVERIFY(checkWalker(walkersList[0], QRect(120,0,72,136)));
+}
+
 void KisSimpleUpdateQueueTest::testChecksum()
 {
     QRect imageRect(0,0,512,512);
@@ -278,5 +405,56 @@ void KisSimpleUpdateQueueTest::testSpontaneousJobsCompression()
     QCOMPARE(jobsList[0], job3);
 }
 
+void KisSimpleUpdateQueueTest::testMergeWithIndexedJobs()
+{
+    QRect imageRect(0,0,4096,4096);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->barrierLock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    queue.addUpdateJob(paintLayer, QRect(10,10,50,50), imageRect, 0);
+
+    // the jobs that are too far to be merged with the first one
+    for (int i = 1; i < 8; i++) {
+        queue.addUpdateJob(paintLayer, QRect(i * 512 + 10, 10, 50, 50), imageRect, 0);
+    }
+
+    QCOMPARE(walkersList.size(), 8);
+
+    // the first job is found even though it is not in the tail of the queue
+    queue.addUpdateJob(paintLayer, QRect(30,30,50,50), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 8);
+    QVERIFY(checkWalker(walkersList[0], QRect(10,10,70,70)));
+
+    // the jobs lying in the neighbouring cells of the index are merged as well
+    queue.addUpdateJob(paintLayer, QRect(505,1000,20,20), imageRect, 0);
+    queue.addUpdateJob(paintLayer, QRect(515,1000,20,20), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 9);
+    QVERIFY(checkWalker(walkersList[8], QRect(505,1000,30,20)));
+
+    // the started jobs are not merge candidates anymore
+    KisTestableUpdaterContext context(2);
+    queue.processQueue(context);
+
+    QCOMPARE(context.getJobs().size(), 2);
+    QCOMPARE(walkersList.size(), 7);
+
+    queue.addUpdateJob(paintLayer, QRect(30,30,10,10), imageRect, 0);
+
+    QCOMPARE(walkersList.size(), 8);
+    QVERIFY(checkWalker(walkersList[7], QRect(30,30,10,10)));
+}
+
 KISTEST_MAIN(KisSimpleUpdateQueueTest)
 
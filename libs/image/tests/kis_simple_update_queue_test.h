@@ -21,9 +21,13 @@ private Q_SLOTS:
     void testJobProcessing();
     void testSplitUpdate();
     void testSplitFullRefresh();
+    void testSplitForSpareThreads();
+    void testStartFreePartOfBlockedJob();
+    void testFoldSmallPartsOfBlockedJob();
     void testChecksum();
     void testMixingTypes();
     void testSpontaneousJobsCompression();
+    void testMergeWithIndexedJobs();
 };
 
 #endif /* KIS_SIMPLE_UPDATE_QUEUE_TEST_H */
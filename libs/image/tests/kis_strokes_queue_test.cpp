@@ -1126,5 +1126,144 @@ void KisStrokesQueueTest::testUniquelyConcurrentJobs()
     queue.endStroke(id1);
 }
 
+class KisPriorityTestingStrokeStrategy : public KisTestingStrokeStrategy
+{
+public:
+    KisPriorityTestingStrokeStrategy(const QLatin1String &prefix, PriorityClass priorityClass)
+        : KisTestingStrokeStrategy(prefix, false, false, false, false, true)
+    {
+        setPriorityClass(priorityClass);
+    }
+
+    KisStrokeJobStrategy* createSuspendStrategy() override {
+        return new KisNoopDabStrategy(m_prefix + "suspend");
+    }
+
+    KisStrokeJobStrategy* createResumeStrategy() override {
+        return new KisNoopDabStrategy(m_prefix + "resume");
+    }
+};
+
+void KisStrokesQueueTest::testBackgroundStrokeYieldsBeforeStart()
+{
+    KisStrokesQueue queue;
+
+    KisStrokeId id1 = queue.startStroke(
+        new KisPriorityTestingStrokeStrategy(QLatin1String("bg_"), KisStrokeStrategy::PRIORITY_BACKGROUND));
+    queue.addJob(id1, new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL));
+    queue.endStroke(id1);
+
+    KisStrokeId id2 = queue.startStroke(
+        new KisPriorityTestingStrokeStrategy(QLatin1String("nor_"), KisStrokeStrategy::PRIORITY_NORMAL));
+    queue.addJob(id2, new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL));
+    queue.endStroke(id2);
+
+    KisTestableUpdaterContext context(2);
+
+    QStringList expectedJobs;
+    expectedJobs << "nor_init" << "nor_dab" << "nor_finish"
+                 << "bg_init" << "bg_dab" << "bg_finish";
+
+    Q_FOREACH (const QString &name, expectedJobs) {
+        queue.processQueue(context, false);
+
+        QVector<KisUpdateJobItem*> jobs = context.getJobs();
+        COMPARE_NAME(jobs[0], name);
+        VERIFY_EMPTY(jobs[1]);
+
+        context.clear();
+    }
+
+    queue.processQueue(context, false);
+    QVERIFY(queue.isEmpty());
+}
+
+void KisStrokesQueueTest::testInteractiveStrokePreemptsBackground()
+{
+    KisStrokesQueue queue;
+
+    KisStrokeId id1 = queue.startStroke(
+        new KisPriorityTestingStrokeStrategy(QLatin1String("bg_"), KisStrokeStrategy::PRIORITY_BACKGROUND));
+    queue.addJob(id1, new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL));
+    queue.addJob(id1, new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL));
+    queue.endStroke(id1);
+
+    KisTestableUpdaterContext context(2);
+    QVector<KisUpdateJobItem*> jobs;
+
+    queue.processQueue(context, false);
+    jobs = context.getJobs();
+    COMPARE_NAME(jobs[0], "bg_init");
+    context.clear();
+
+    queue.processQueue(context, false);
+    jobs = context.getJobs();
+    COMPARE_NAME(jobs[0], "bg_dab");
+    context.clear();
+
+    KisStrokeId id2 = queue.startStroke(
+        new KisPriorityTestingStrokeStrategy(QLatin1String("int_"), KisStrokeStrategy::PRIORITY_INTERACTIVE));
+    queue.addJob(id2, new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL));
+    queue.endStroke(id2);
+
+    QStringList expectedJobs;
+    expectedJobs << "bg_suspend"
+                 << "int_init" << "int_dab" << "int_finish"
+                 << "bg_resume" << "bg_dab" << "bg_finish";
+
+    Q_FOREACH (const QString &name, expectedJobs) {
+        queue.processQueue(context, false);
+
+        jobs = context.getJobs();
+        COMPARE_NAME(jobs[0], name);
+        VERIFY_EMPTY(jobs[1]);
+
+        context.clear();
+    }
+
+    queue.processQueue(context, false);
+    QVERIFY(queue.isEmpty());
+}
+
+void KisStrokesQueueTest::testNormalStrokeDoesNotPreemptBackground()
+{
+    KisStrokesQueue queue;
+
+    KisStrokeId id1 = queue.startStroke(
+        new KisPriorityTestingStrokeStrategy(QLatin1String("bg_"), KisStrokeStrategy::PRIORITY_BACKGROUND));
+    queue.addJob(id1, new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL));
+    queue.endStroke(id1);
+
+    KisTestableUpdaterContext context(2);
+    QVector<KisUpdateJobItem*> jobs;
+
+    queue.processQueue(context, false);
+    jobs = context.getJobs();
+    COMPARE_NAME(jobs[0], "bg_init");
+    context.clear();
+
+    KisStrokeId id2 = queue.startStroke(
+        new KisPriorityTestingStrokeStrategy(QLatin1String("nor_"), KisStrokeStrategy::PRIORITY_NORMAL));
+    queue.addJob(id2, new KisStrokeJobData(KisStrokeJobData::SEQUENTIAL));
+    queue.endStroke(id2);
+
+    QStringList expectedJobs;
+    expectedJobs << "bg_dab" << "bg_finish"
+                 << "nor_init" << "nor_dab" << "nor_finish";
+
+    Q_FOREACH (const QString &name, expectedJobs) {
+        queue.processQueue(context, false);
+
+        jobs = context.getJobs();
+        COMPARE_NAME(jobs[0], name);
+        VERIFY_EMPTY(jobs[1]);
+
+        context.clear();
+    }
+
+    queue.processQueue(context, false);
+    QVERIFY(queue.isEmpty());
+}
+
 
 KISTEST_MAIN(KisStrokesQueueTest)
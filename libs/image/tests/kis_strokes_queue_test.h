@@ -35,6 +35,9 @@ private Q_SLOTS:
     void testLodUndoBase2();
     void testMutatedJobs();
     void testUniquelyConcurrentJobs();
+    void testBackgroundStrokeYieldsBeforeStart();
+    void testInteractiveStrokePreemptsBackground();
+    void testNormalStrokeDoesNotPreemptBackground();
 
 private:
     struct LodStrokesQueueTester;
@@ -46,9 +46,7 @@ KisHLineIterator2::KisHLineIterator2(KisDataManager *dataManager, qint32 x, qint
     m_tileWidth = m_pixelSize * KisTileData::HEIGHT;
 
     // let's preallocate first row
-    for (quint32 i = 0; i < m_tilesCacheSize; i++){
-        fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
-    }
+    fetchTilesForCache();
     m_index = 0;
     switchToTile(m_leftInLeftmostTile);
 }
@@ -188,15 +186,26 @@ void KisHLineIterator2::switchToTile(qint32 xInTile)
 }
 
 
-void KisHLineIterator2::fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row)
+void KisHLineIterator2::fetchTilesForCache()
 {
-    m_dataManager->getTilesPair(col, row, m_writable, &kti.tile, &kti.oldtile);
+    m_dataManager->getTilesPairs(QRect(m_leftCol, m_row, m_tilesCacheSize, 1),
+                                 m_writable, m_fetchedTiles, m_fetchedOldTiles);
+
+    for (quint32 i = 0; i < m_tilesCacheSize; i++) {
+        KisTileInfo &kti = m_tilesCache[i];
 
-    lockTile(kti.tile);
-    kti.data = kti.tile->data();
+        kti.tile = m_fetchedTiles[i];
+        lockTile(kti.tile);
+        kti.data = kti.tile->data();
+
+        kti.oldtile = m_fetchedOldTiles[i];
+        lockOldTile(kti.oldtile);
+        kti.oldData = kti.oldtile->data();
+    }
 
-    lockOldTile(kti.oldtile);
-    kti.oldData = kti.oldtile->data();
+    // drop the references, but keep the buffers for the next row
+    m_fetchedTiles.clear();
+    m_fetchedOldTiles.clear();
 }
 
 void KisHLineIterator2::preallocateTiles()
@@ -204,8 +213,8 @@ void KisHLineIterator2::preallocateTiles()
     for (quint32 i = 0; i < m_tilesCacheSize; ++i){
         unlockTile(m_tilesCache[i].tile);
         unlockOldTile(m_tilesCache[i].oldtile);
-        fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
     }
+    fetchTilesForCache();
 }
 
 qint32 KisHLineIterator2::x() const
@@ -67,11 +67,18 @@ private:
 
     QVector<KisTileInfo> m_tilesCache;
     quint32 m_tilesCacheSize {0};
+
+    /**
+     * Scratch buffers for getTilesPairs(), kept as members to avoid
+     * allocating them on every row switch
+     */
+    QVector<KisTileSP> m_fetchedTiles;
+    QVector<KisTileSP> m_fetchedOldTiles;
     
 private:
 
     void switchToTile(qint32 xInTile);
-    void fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row);
+    void fetchTilesForCache();
     void preallocateTiles();
 };
 #endif
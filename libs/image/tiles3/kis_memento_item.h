@@ -9,6 +9,7 @@
 
 #include <kis_shared.h>
 #include <kis_shared_ptr.h>
+#include <kis_assert.h>
 #include "kis_tile.h"
 
 
@@ -141,6 +142,33 @@ public:
         m_committedFlag = true;
     }
 
+    /**
+     * Makes the committed item use \p tileData instead of its own
+     * tile data. The content of both of them must be equal.
+     *
+     * \see KisMementoManager::replaceTileData()
+     */
+    void replaceTileData(KisTileData *tileData) {
+        KIS_SAFE_ASSERT_RECOVER_RETURN(m_committedFlag && m_tileData);
+
+        tileData->acquire();
+        tileData->setMementoed(true);
+
+        releaseTileData();
+        m_tileData = tileData;
+    }
+
+    /**
+     * Same as KisTile::markDeduplicated(), the memory is accounted
+     * till the item releases the tile data
+     */
+    void markDeduplicated() {
+        if (!m_deduplicated && m_tileData) {
+            m_deduplicated = true;
+            KisTileDataStore::instance()->registerDeduplicatedUser(m_tileData);
+        }
+    }
+
     inline KisTileSP tile(KisMementoManager *mm) {
         Q_ASSERT(m_tileData);
         return KisTileSP(new KisTile(m_col, m_row, m_tileData, mm));
@@ -196,6 +224,11 @@ public:
 protected:
     void releaseTileData() {
         if (m_tileData) {
+            if (m_deduplicated) {
+                m_deduplicated = false;
+                KisTileDataStore::instance()->releaseDeduplicatedUser(m_tileData);
+            }
+
             if (m_committedFlag) {
                 m_tileData->setMementoed(false);
                 m_tileData->release();
@@ -209,6 +242,7 @@ protected:
 protected:
     KisTileData *m_tileData {0};
     bool m_committedFlag {false};
+    bool m_deduplicated {false};
     enumType m_type {CHANGED};
 
     qint32 m_col {0};
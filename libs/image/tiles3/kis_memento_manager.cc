@@ -163,6 +163,23 @@ void KisMementoManager::registerTileDeleted(KisTile *tile)
     }
 }
 
+QVector<QPoint> KisMementoManager::uncommittedChangedTiles()
+{
+    QVector<QPoint> result;
+
+    KisMementoItemSP mi;
+    KisMementoItemHashTableIteratorConst iter(&m_index);
+
+    while ((mi = iter.tile())) {
+        if (mi->type() == KisMementoItem::CHANGED) {
+            result.append(QPoint(mi->col(), mi->row()));
+        }
+        iter.next();
+    }
+
+    return result;
+}
+
 void KisMementoManager::commit()
 {
     if (m_index.isEmpty()) {
@@ -398,6 +415,39 @@ void KisMementoManager::resetRevisionHistory(KisMementoItemList list)
     }
 }
 
+void KisMementoManager::replaceTileData(KisTileHashTable *ht, qint32 col, qint32 row,
+                                        KisTileData *oldTileData, KisTileData *newTileData)
+{
+    KisMementoItemSP replacedItem;
+
+    KisMementoItemSP mi = m_headsHashTable.getExistingTile(col, row);
+    for (; mi; mi = mi->parent()) {
+        if (mi->tileData() == oldTileData) {
+            mi->replaceTileData(newTileData);
+            replacedItem = mi;
+            break;
+        }
+    }
+
+    KisTileSP tile = ht->getExistingTile(col, row);
+
+    if (tile && tile->tileData() == oldTileData) {
+        /**
+         * The content doesn't change, so the replacement
+         * should not be seen in history, see rollback()
+         */
+        blockRegistration();
+        ht->deleteTile(col, row);
+        tile = new KisTile(col, row, newTileData, this);
+        ht->addTile(tile);
+        unblockRegistration();
+
+        tile->markDeduplicated();
+    } else if (replacedItem) {
+        replacedItem->markDeduplicated();
+    }
+}
+
 void KisMementoManager::setDefaultTileData(KisTileData *defaultTileData)
 {
     m_headsHashTable.setDefaultTileData(defaultTileData);
@@ -8,6 +8,8 @@
 #define KIS_MEMENTO_MANAGER_
 
 #include <QList>
+#include <QPoint>
+#include <QVector>
 
 #include "kis_memento_item.h"
 #include "config-hash-table-implementation.h"
@@ -69,6 +71,12 @@ public:
     void registerTileDeleted(KisTile *tile);
 
 
+    /**
+     * Returns the positions (col, row) of the tiles that have been
+     * changed, but not deleted, since the last commit()
+     */
+    QVector<QPoint> uncommittedChangedTiles();
+
     /**
      * Commits changes, made in  INDEX: appends m_index into m_revisions list
      * and owes all modified tileDatas.
@@ -102,6 +110,51 @@ public:
 
     void setDefaultTileData(KisTileData *defaultTileData);
 
+    /**
+     * Calls \p func for the tile data of every memento item stored
+     * in the history, both in the undo and in the redo parts of it
+     *
+     * LOCKING: the lock of the data manager should be held by the
+     *          caller, so that the history is not changed meanwhile
+     */
+    template <typename Func>
+    void forEachHistoricalTileData(Func func) const {
+        Q_FOREACH (const KisHistoryItem &item, m_revisions) {
+            Q_FOREACH (const KisMementoItemSP &mi, item.itemList) {
+                if (mi->tileData()) {
+                    func(mi->tileData());
+                }
+            }
+        }
+
+        Q_FOREACH (const KisHistoryItem &item, m_cancelledRevisions) {
+            Q_FOREACH (const KisMementoItemSP &mi, item.itemList) {
+                if (mi->tileData()) {
+                    func(mi->tileData());
+                }
+            }
+        }
+    }
+
+    /**
+     * Makes the tile at (\p col, \p row) of \p ht and the committed
+     * memento item of this position, if they still use \p oldTileData,
+     * use \p newTileData instead. The content of the two tile data
+     * objects must be equal, so no changes are registered in the
+     * index and the history stays the same.
+     *
+     * Only the chain of the HEAD revision is searched, the items kept
+     * for redo are left untouched.
+     *
+     * Used by the deduplication, see
+     * KisTiledDataManager::mergeDuplicateTileData()
+     *
+     * LOCKING: the lock of the data manager should be held by the
+     *          caller in write mode
+     */
+    void replaceTileData(KisTileHashTable *ht, qint32 col, qint32 row,
+                         KisTileData *oldTileData, KisTileData *newTileData);
+
     void debugPrintInfo();
 
 
@@ -12,6 +12,14 @@
 #include "kis_memento_manager.h"
 #include "kis_debug.h"
 
+namespace {
+std::atomic<quint64> s_writeEpoch {1};
+}
+
+quint64 KisTile::advanceWriteEpoch()
+{
+    return ++s_writeEpoch;
+}
 
 void KisTile::init(qint32 col, qint32 row,
                    KisTileData *defaultTileData, KisMementoManager* mm)
@@ -19,6 +27,8 @@ void KisTile::init(qint32 col, qint32 row,
     m_col = col;
     m_row = row;
     m_lockCounter = 0;
+    m_writeEpoch.store(s_writeEpoch.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
 
     m_extent = QRect(m_col * KisTileData::WIDTH, m_row * KisTileData::HEIGHT,
                      KisTileData::WIDTH, KisTileData::HEIGHT);
@@ -56,6 +66,16 @@ KisTile::KisTile(const KisTile& rhs)
     init(rhs.col(), rhs.row(), rhs.tileData(), rhs.m_mementoManager);
 }
 
+void KisTile::markDeduplicated()
+{
+    QMutexLocker locker(&m_COWMutex);
+
+    if (!m_deduplicated) {
+        m_deduplicated = true;
+        KisTileDataStore::instance()->registerDeduplicatedUser(m_tileData);
+    }
+}
+
 KisTile::~KisTile()
 {
 #ifdef DEAD_TILES_SANITY_CHECK
@@ -76,6 +96,10 @@ KisTile::~KisTile()
     }
 #endif
 
+    if (m_deduplicated) {
+        KisTileDataStore::instance()->releaseDeduplicatedUser(m_tileData);
+    }
+
     m_tileData->release();
 }
 
@@ -215,7 +239,25 @@ void KisTile::lockForRead() const
 }
 
 
-#define lazyCopying() (m_tileData->m_usersCount>1)
+KisTileData* KisTile::refAndFetchTileData() const
+{
+    /**
+     * The old tile data is released by COW only under
+     * m_swapBarrierLock (see safeReleaseOldTileData()),
+     * so holding it guarantees the pointer is still alive.
+     */
+    QMutexLocker locker(&m_swapBarrierLock);
+
+    KisTileData *td = m_tileData;
+    td->ref();
+    return td;
+}
+
+/**
+ * The tile data mapped from a file is read-only, so it is
+ * copied on the first write even if it has a single user
+ */
+#define lazyCopying() (m_tileData->m_usersCount>1 || m_tileData->isFileMapped())
 
 void KisTile::lockForWrite()
 {
@@ -225,6 +267,9 @@ void KisTile::lockForWrite()
 
     blockSwapping();
 
+    m_writeEpoch.store(s_writeEpoch.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+
     /* We are doing COW here */
     if (lazyCopying()) {
         m_COWMutex.lock();
@@ -241,6 +286,12 @@ void KisTile::lockForWrite()
             tileData->blockSwapping();
             KisTileData *oldTileData = m_tileData;
             m_tileData = tileData;
+
+            if (m_deduplicated) {
+                m_deduplicated = false;
+                KisTileDataStore::instance()->releaseDeduplicatedUser(oldTileData);
+            }
+
             safeReleaseOldTileData(oldTileData);
 
             DEBUG_COWING(tileData);
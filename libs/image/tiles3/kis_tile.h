@@ -9,6 +9,8 @@
 
 #include <QReadWriteLock>
 
+#include <atomic>
+
 #include <QMutex>
 #include <QAtomicPointer>
 
@@ -119,6 +121,39 @@ public:
         return m_tileData;
     }
 
+    /**
+     * Returns the current tile data with an extra reference held
+     * on it, so it can be safely used after the tile has been
+     * COW-ed or destroyed. The caller must deref() it when done.
+     */
+    KisTileData* refAndFetchTileData() const;
+
+    /**
+     * The value of the global write epoch at the moment the tile
+     * was created or locked for writing for the last time. It is
+     * used for tracking the changed areas of the data manager, see
+     * KisTiledDataManager::tileRectsChangedSince().
+     */
+    inline quint64 writeEpoch() const {
+        return m_writeEpoch.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Starts a new write epoch and returns its value. All the tiles
+     * created or locked for writing after this call will have their
+     * writeEpoch() greater or equal to the returned value.
+     */
+    static quint64 advanceWriteEpoch();
+
+    /**
+     * Marks the tile as the one that has got its tile data through
+     * the deduplication. The store accounts the shared memory till
+     * the tile COWs the data or is destroyed.
+     *
+     * \see KisTileDataStore::registerDeduplicatedUser()
+     */
+    void markDeduplicated();
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
@@ -148,6 +183,13 @@ private:
 
     QAtomicPointer<KisMementoManager> m_mementoManager;
 
+    std::atomic<quint64> m_writeEpoch;
+
+    /**
+     * Set by markDeduplicated(), guarded by m_COWMutex
+     */
+    bool m_deduplicated = false;
+
     /**
      * This is a special mutex for guarding copy-on-write
      * operations. We do not use lockless way here as it'll
@@ -11,45 +11,12 @@
 
 #include <kis_debug.h>
 
-#include <boost/pool/singleton_pool.hpp>
 #include "kis_tile_data_store_iterators.h"
-
-// BPP == bytes per pixel
-#define TILE_SIZE_4BPP (4 * __TILE_DATA_WIDTH * __TILE_DATA_HEIGHT)
-#define TILE_SIZE_8BPP (8 * __TILE_DATA_WIDTH * __TILE_DATA_HEIGHT)
-
-typedef boost::singleton_pool<KisTileData, TILE_SIZE_4BPP, boost::default_user_allocator_new_delete, boost::details::pool::default_mutex, 256, 4096> BoostPool4BPP;
-typedef boost::singleton_pool<KisTileData, TILE_SIZE_8BPP, boost::default_user_allocator_new_delete, boost::details::pool::default_mutex, 128, 2048> BoostPool8BPP;
+#include "kis_tile_data_slab_allocator.h"
 
 const qint32 KisTileData::WIDTH = __TILE_DATA_WIDTH;
 const qint32 KisTileData::HEIGHT = __TILE_DATA_HEIGHT;
 
-SimpleCache KisTileData::m_cache;
-
-SimpleCache::~SimpleCache()
-{
-    clear();
-}
-
-void SimpleCache::clear()
-{
-    QWriteLocker l(&m_cacheLock);
-    quint8 *ptr = 0;
-
-    while (m_4Pool.pop(ptr)) {
-        BoostPool4BPP::free(ptr);
-    }
-
-    while (m_8Pool.pop(ptr)) {
-        BoostPool8BPP::free(ptr);
-    }
-
-    while (m_16Pool.pop(ptr)) {
-        free(ptr);
-    }
-}
-
-
 KisTileData::KisTileData(qint32 pixelSize, const quint8 *defPixel, KisTileDataStore *store, bool checkFreeMemory)
     : m_state(NORMAL),
       m_mementoFlag(0),
@@ -97,6 +64,19 @@ KisTileData::KisTileData(const KisTileData& rhs, bool checkFreeMemory)
 }
 
 
+KisTileData::KisTileData(qint32 pixelSize, quint8 *mappedData, KisTileFileMappingSP mapping, KisTileDataStore *store)
+    : m_state(NORMAL),
+      m_fileMapping(mapping),
+      m_mementoFlag(0),
+      m_age(0),
+      m_data(mappedData),
+      m_usersCount(0),
+      m_refCount(0),
+      m_pixelSize(pixelSize),
+      m_store(store)
+{
+}
+
 KisTileData::~KisTileData()
 {
     releaseMemory();
@@ -113,7 +93,10 @@ void KisTileData::fillWithPixel(const quint8 *defPixel)
 
 void KisTileData::releaseMemory()
 {
-    if (m_data) {
+    if (m_fileMapping) {
+        m_fileMapping = 0;
+        m_data = 0;
+    } else if (m_data) {
         freeData(m_data, m_pixelSize);
         m_data = 0;
     }
@@ -134,39 +117,31 @@ void KisTileData::allocateMemory()
 
 quint8* KisTileData::allocateData(const qint32 pixelSize)
 {
-    quint8 *ptr = 0;
-
-    if (!m_cache.pop(pixelSize, ptr)) {
-        switch (pixelSize) {
-        case 4:
-            ptr = (quint8*)BoostPool4BPP::malloc();
-            break;
-        case 8:
-            ptr = (quint8*)BoostPool8BPP::malloc();
-            break;
-        default:
-            ptr = (quint8*) malloc(pixelSize * WIDTH * HEIGHT);
-            break;
-        }
+    KisTileDataSlabAllocator *allocator = KisTileDataSlabAllocator::instance();
+
+    /**
+     * On application shutdown the allocator may already be
+     * destroyed while some static paint devices are still alive.
+     * Serve them from the general heap, freeData() will just leak
+     * these buffers to the OS.
+     */
+    if (!allocator) {
+        return static_cast<quint8*>(malloc(pixelSize * WIDTH * HEIGHT));
     }
 
-    return ptr;
+    return allocator->allocate(pixelSize);
 }
 
 void KisTileData::freeData(quint8* ptr, const qint32 pixelSize)
 {
-    if (!m_cache.push(pixelSize, ptr)) {
-        switch (pixelSize) {
-        case 4:
-            BoostPool4BPP::free(ptr);
-            break;
-        case 8:
-            BoostPool8BPP::free(ptr);
-            break;
-        default:
-            free(ptr);
-            break;
-        }
+    KisTileDataSlabAllocator *allocator = KisTileDataSlabAllocator::instance();
+
+    /**
+     * On application shutdown the allocator may already be
+     * destroyed, the memory is going to be released by the OS
+     */
+    if (allocator) {
+        allocator->free(ptr, pixelSize);
     }
 }
 
@@ -198,9 +173,7 @@ void KisTileData::releaseInternalPools()
             }
 
             // check if the tile data has actually been pooled
-            if (item->m_pixelSize != 4 &&
-                item->m_pixelSize != 8 &&
-                item->m_pixelSize != 16) {
+            if (item->m_pixelSize > KisTileDataSlabAllocator::MAX_PIXEL_SIZE) {
 
                 continue;
             }
@@ -221,10 +194,13 @@ void KisTileData::releaseInternalPools()
         }
 
         if (!failedToLock) {
-            // purge the pools memory
-            m_cache.clear();
-            BoostPool4BPP::purge_memory();
-            BoostPool8BPP::purge_memory();
+            Q_FOREACH (KisTileData *item, dataObjects) {
+                freeData(item->m_data, item->m_pixelSize);
+                item->m_data = 0;
+            }
+
+            // return the emptied slabs to the system
+            KisTileDataSlabAllocator::instance()->releaseFreeMemory();
 
             auto it = dataObjects.begin();
             auto chunkIt = memoryChunks.constBegin();
@@ -107,6 +107,10 @@ inline bool KisTileData::historical() const {
     return mementoed() && numUsers() <= 1;
 }
 
+inline bool KisTileData::isFileMapped() const {
+    return !m_fileMapping.isNull();
+}
+
 inline int KisTileData::age() const {
     return m_age;
 }
@@ -117,6 +121,13 @@ inline void KisTileData::markOld() {
     m_age++;
 }
 
+inline KisTileData::EvictionPriority KisTileData::evictionPriority() const {
+    return m_evictionPriority;
+}
+inline void KisTileData::setEvictionPriority(EvictionPriority value) {
+    m_evictionPriority = value;
+}
+
 inline qint32 KisTileData::numUsers() const {
     return m_usersCount;
 }
@@ -13,6 +13,7 @@
 
 #include "kis_lockless_stack.h"
 #include "swap/kis_chunk_allocator.h"
+#include "swap/kis_tile_file_mapping.h"
 
 class KisTileData;
 class KisTileDataStore;
@@ -31,57 +32,6 @@ typedef KisTileDataList::iterator KisTileDataListIterator;
 typedef KisTileDataList::const_iterator KisTileDataListConstIterator;
 
 
-class SimpleCache
-{
-public:
-    SimpleCache() = default;
-    ~SimpleCache();
-
-    bool push(int pixelSize, quint8 *&ptr)
-    {
-        QReadLocker l(&m_cacheLock);
-        switch (pixelSize) {
-        case 4:
-            m_4Pool.push(ptr);
-            break;
-        case 8:
-            m_8Pool.push(ptr);
-            break;
-        case 16:
-            m_16Pool.push(ptr);
-            break;
-        default:
-            return false;
-        }
-
-        return true;
-    }
-
-    bool pop(int pixelSize, quint8 *&ptr)
-    {
-        QReadLocker l(&m_cacheLock);
-        switch (pixelSize) {
-        case 4:
-            return m_4Pool.pop(ptr);
-        case 8:
-            return m_8Pool.pop(ptr);
-        case 16:
-            return m_16Pool.pop(ptr);
-        default:
-            return false;
-        }
-    }
-
-    void clear();
-
-private:
-    QReadWriteLock m_cacheLock;
-    KisLocklessStack<quint8*> m_4Pool;
-    KisLocklessStack<quint8*> m_8Pool;
-    KisLocklessStack<quint8*> m_16Pool;
-};
-
-
 /**
  * Stores actual tile's data
  */
@@ -93,6 +43,14 @@ public:
 private:
     KisTileData(const KisTileData& rhs, bool checkFreeMemory = true);
 
+    /**
+     * Creates a tile data whose pixels are not copied, but are
+     * accessed directly in the memory-mapped file. Such tile data
+     * is never changed: the first write to it is done through COW
+     * (see KisTile::lockForWrite())
+     */
+    KisTileData(qint32 pixelSize, quint8 *mappedData, KisTileFileMappingSP mapping, KisTileDataStore *store);
+
 public:
     ~KisTileData();
 
@@ -102,6 +60,19 @@ public:
         SWAPPED
     };
 
+    /**
+     * Shows how eagerly the swapper should evict the tile data.
+     * The tile data of the current frame of the active image are
+     * evicted last, the tile data of the background images first.
+     *
+     * \see KisMemoryStatisticsServer::updateEvictionPriorities()
+     */
+    enum EvictionPriority {
+        EVICT_LAST = 0,
+        INACTIVE_FRAME,
+        BACKGROUND_IMAGE
+    };
+
     /**
      * Information about data stored
      */
@@ -166,6 +137,13 @@ public:
     inline void resetAge();
     inline void markOld();
 
+    /**
+     * The eviction class of the tile data. It is a hint only, so it
+     * is written and read without any locking.
+     */
+    inline EvictionPriority evictionPriority() const;
+    inline void setEvictionPriority(EvictionPriority value);
+
     /**
      * Returns number of tiles (or memento items),
      * referencing the tile data.
@@ -180,6 +158,12 @@ public:
      */
     inline bool historical() const;
 
+    /**
+     * Returns true if the pixels of the tile data are mapped
+     * from a file and, therefore, must not be written to
+     */
+    inline bool isFileMapped() const;
+
     /**
      * Used for swapping purposes only.
      * Frees the memory occupied by the tile data.
@@ -245,6 +229,22 @@ private:
      */
     int m_tileNumber = -1;
 
+    /**
+     * The hash of the content of the tile data, valid only when
+     * m_deduplicationIndexed is set, that is when the tile data has
+     * been processed by the pooler. All three fields are written under
+     * the deduplication lock of the store.
+     *
+     * If the pooler has found another tile data with exactly the same
+     * content, m_duplicateOf points to it. The link holds one user of
+     * that tile data, so it stays read-only till this one is freed.
+     *
+     * \see KisTileDataStore::indexTileDataForDeduplication()
+     */
+    quint64 m_contentHash = 0;
+    bool m_deduplicationIndexed = false;
+    KisTileData *m_duplicateOf = 0;
+
 private:
     /**
      * The chunk of the swap file, that corresponds
@@ -252,6 +252,13 @@ private:
      */
     KisChunk m_swapChunk;
 
+    /**
+     * The file m_data is mapped from, if any. Such tile data
+     * is not registered in the store and is never swapped out,
+     * the system pages it in and out itself.
+     */
+    KisTileFileMappingSP m_fileMapping;
+
 
     /**
      * The flag is set by KisMementoItem to show this
@@ -270,6 +277,11 @@ private:
     //FIXME: make memory aligned
     int m_age;
 
+    /**
+     * \see EvictionPriority
+     */
+    EvictionPriority m_evictionPriority = EVICT_LAST;
+
 
     /**
      * The primitive for controlling swapping of the tile.
@@ -305,7 +317,6 @@ private:
     //qint32 m_timeStamp;
 
     KisTileDataStore *m_store;
-    static SimpleCache m_cache;
 
 public:
     static const qint32 WIDTH;
@@ -18,6 +18,7 @@ const qint32 KisTileDataPooler::MAX_NUM_CLONES = 16;
 const qint32 KisTileDataPooler::MAX_TIMEOUT = 60000; // 01m00s
 const qint32 KisTileDataPooler::MIN_TIMEOUT = 100; // 00m00.100s
 const qint32 KisTileDataPooler::TIMEOUT_FACTOR = 2;
+const qint32 KisTileDataPooler::MAX_DEDUPLICATION_HASHES = 256;
 
 //#define DEBUG_POOLER
 
@@ -188,13 +189,14 @@ void KisTileDataPooler::run()
         KisTileDataStoreReverseIterator *iter = m_store->beginReverseIteration();
         QList<KisTileData*> beggars;
         QList<KisTileData*> donors;
+        QList<KisTileData*> unindexed;
         qint32 memoryOccupied;
 
         qint32 statRealMemory;
         qint32 statHistoricalMemory;
 
 
-        getLists(iter, beggars, donors,
+        getLists(iter, beggars, donors, unindexed,
                  memoryOccupied,
                  statRealMemory,
                  statHistoricalMemory);
@@ -202,12 +204,22 @@ void KisTileDataPooler::run()
         m_lastCycleHadWork =
             processLists(beggars, donors, memoryOccupied);
 
+        /**
+         * Keep the tile data alive until it is hashed
+         */
+        Q_FOREACH (KisTileData *td, unindexed) {
+            td->ref();
+        }
+
         m_lastPoolMemoryMetric = memoryOccupied;
         m_lastRealMemoryMetric = statRealMemory;
         m_lastHistoricalMemoryMetric = statHistoricalMemory;
 
         m_store->endIteration(iter);
 
+        indexForDeduplication(unindexed);
+        m_lastCycleHadWork |= !unindexed.isEmpty();
+
         DEBUG_TILE_STATISTICS();
         DEBUG_SIMPLE_ACTION("cycle finished");
     }
@@ -220,13 +232,14 @@ void KisTileDataPooler::forceUpdateMemoryStats()
     KisTileDataStoreReverseIterator *iter = m_store->beginReverseIteration();
     QList<KisTileData*> beggars;
     QList<KisTileData*> donors;
+    QList<KisTileData*> unindexed;
     qint32 memoryOccupied;
 
     qint32 statRealMemory;
     qint32 statHistoricalMemory;
 
 
-    getLists(iter, beggars, donors,
+    getLists(iter, beggars, donors, unindexed,
              memoryOccupied,
              statRealMemory,
              statHistoricalMemory);
@@ -285,6 +298,7 @@ template<class Iter>
 void KisTileDataPooler::getLists(Iter *iter,
                                  QList<KisTileData*> &beggars,
                                  QList<KisTileData*> &donors,
+                                 QList<KisTileData*> &unindexed,
                                  qint32 &memoryOccupied,
                                  qint32 &statRealMemory,
                                  qint32 &statHistoricalMemory)
@@ -317,6 +331,12 @@ void KisTileDataPooler::getLists(Iter *iter,
 
         memoryOccupied += clonesMetric(item);
 
+        if (item->mementoed() && !item->m_deduplicationIndexed &&
+            unindexed.size() < MAX_DEDUPLICATION_HASHES) {
+
+            unindexed.append(item);
+        }
+
         // statistics gathering
         if (item->historical()) {
             statHistoricalMemory += item->pixelSize();
@@ -330,6 +350,25 @@ void KisTileDataPooler::getLists(Iter *iter,
                 donors, canDonorMemoryTotal);
 }
 
+/**
+ * Hashes the content of the mementoed tile data and matches it against
+ * the data hashed before, so that the data managers could merge the
+ * identical tiles on their next commit. The number of the tiles hashed
+ * per cycle is limited, the rest of them will be processed in the
+ * following cycles.
+ *
+ * The hashing is done after the iteration has been finished, so the
+ * store is not blocked while we read the data. The tile data objects
+ * are referenced by the caller and dereferenced here.
+ */
+void KisTileDataPooler::indexForDeduplication(QList<KisTileData*> &unindexed)
+{
+    Q_FOREACH (KisTileData *td, unindexed) {
+        m_store->indexTileDataForDeduplication(td);
+        td->deref();
+    }
+}
+
 qint32 KisTileDataPooler::tryGetMemory(QList<KisTileData*> &donors,
                                        qint32 memoryMetric)
 {
@@ -46,6 +46,7 @@ protected:
     static const qint32 MAX_TIMEOUT;
     static const qint32 MIN_TIMEOUT;
     static const qint32 TIMEOUT_FACTOR;
+    static const qint32 MAX_DEDUPLICATION_HASHES;
 
     void waitForWork();
     qint32 numClonesNeeded(KisTileData *td) const;
@@ -63,10 +64,13 @@ protected:
     template<class Iter>
         void getLists(Iter *iter, QList<KisTileData*> &beggars,
                       QList<KisTileData*> &donors,
+                      QList<KisTileData*> &unindexed,
                       qint32 &memoryOccupied,
                       qint32 &statRealMemory,
                       qint32 &statHistoricalMemory);
 
+    void indexForDeduplication(QList<KisTileData*> &unindexed);
+
     bool processLists(QList<KisTileData*> &beggars,
                       QList<KisTileData*> &donors,
                       qint32 &memoryOccupied);
@@ -0,0 +1,451 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_tile_data_slab_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#include <QGlobalStatic>
+#include <QHash>
+#include <QMutex>
+#include <QThreadStorage>
+#include <QVector>
+
+#ifdef Q_OS_WIN
+#include <malloc.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+#include "kis_tile_data_interface.h"
+#include "kis_assert.h"
+
+Q_GLOBAL_STATIC(KisTileDataSlabAllocator, s_instance)
+
+const qint32 KisTileDataSlabAllocator::MAX_PIXEL_SIZE = 64;
+const qint32 KisTileDataSlabAllocator::SLAB_SIZE = 2 * 1024 * 1024;
+
+namespace {
+
+/**
+ * The thread cache of a size class is limited by this amount of bytes
+ * and by MAX_CACHED_BLOCKS blocks, whichever is smaller
+ */
+const qint32 THREAD_CACHE_BYTES = 256 * 1024;
+const int MAX_CACHED_BLOCKS = 16;
+
+/**
+ * The number of completely free slabs a size class keeps before
+ * returning them to the system
+ */
+const int MAX_EMPTY_SLABS = 1;
+
+inline qint32 blockSizeForPixelSize(qint32 pixelSize)
+{
+    return pixelSize * __TILE_DATA_WIDTH * __TILE_DATA_HEIGHT;
+}
+
+/**
+ * Free blocks of a slab form an intrusive singly-linked list:
+ * the first bytes of a free block store the pointer to the next one.
+ */
+inline quint8*& nextFreeBlock(quint8 *block)
+{
+    return *reinterpret_cast<quint8**>(block);
+}
+
+struct Slab
+{
+    quint8 *base = 0;
+    quint8 *freeHead = 0;
+    int numFree = 0;
+    int numBlocks = 0;
+    int availableIndex = -1;
+    bool hugePages = false;
+};
+
+quint8* allocateSlabMemory(bool *hugePages)
+{
+    void *ptr = 0;
+    *hugePages = false;
+
+#ifdef Q_OS_WIN
+    ptr = _aligned_malloc(KisTileDataSlabAllocator::SLAB_SIZE, KisTileDataSlabAllocator::SLAB_SIZE);
+#else
+    if (posix_memalign(&ptr, KisTileDataSlabAllocator::SLAB_SIZE, KisTileDataSlabAllocator::SLAB_SIZE)) {
+        ptr = 0;
+    }
+#endif
+
+#if defined(Q_OS_LINUX) && defined(MADV_HUGEPAGE)
+    if (ptr) {
+        *hugePages = !madvise(ptr, KisTileDataSlabAllocator::SLAB_SIZE, MADV_HUGEPAGE);
+    }
+#endif
+
+    return static_cast<quint8*>(ptr);
+}
+
+void freeSlabMemory(quint8 *ptr)
+{
+#ifdef Q_OS_WIN
+    _aligned_free(ptr);
+#else
+    ::free(ptr);
+#endif
+}
+
+}
+
+struct KisTileDataSlabAllocator::ThreadCache
+{
+    struct Bin {
+        quint8 *blocks[MAX_CACHED_BLOCKS];
+        int size = 0;
+    };
+
+    ThreadCache(KisTileDataSlabAllocator::Private *_d) : d(_d) {}
+    ~ThreadCache();
+
+    KisTileDataSlabAllocator::Private *d;
+    Bin bins[MAX_PIXEL_SIZE + 1];
+};
+
+struct KisTileDataSlabAllocator::Private
+{
+    struct SizeClass {
+        QMutex lock;
+        qint32 blockSize = 0;
+        int blocksPerSlab = 0;
+        int cacheCapacity = 0;
+        int numEmptySlabs = 0;
+        QHash<quintptr, Slab*> slabs;
+        QVector<Slab*> availableSlabs;
+    };
+
+    Private();
+    ~Private();
+
+    ThreadCache* threadCache();
+
+    bool refill(SizeClass &sc, ThreadCache::Bin &bin, int numBlocks);
+    void drain(SizeClass &sc, ThreadCache::Bin &bin, int numBlocks);
+
+    quint8* allocateBlockLocked(SizeClass &sc);
+    void freeBlockLocked(SizeClass &sc, quint8 *ptr);
+
+    Slab* createSlabLocked(SizeClass &sc);
+    void destroySlabLocked(SizeClass &sc, Slab *slab);
+
+    void addAvailableLocked(SizeClass &sc, Slab *slab);
+    void removeAvailableLocked(SizeClass &sc, Slab *slab);
+
+    SizeClass sizeClasses[MAX_PIXEL_SIZE + 1];
+    QThreadStorage<ThreadCache*> threadCaches;
+
+    std::atomic<qint64> numSlabs {0};
+    std::atomic<qint64> numHugePageSlabs {0};
+    std::atomic<qint64> heapSize {0};
+    std::atomic<qint64> usedSize {0};
+    std::atomic<qint64> threadCacheSize {0};
+};
+
+KisTileDataSlabAllocator::ThreadCache::~ThreadCache()
+{
+    for (int pixelSize = 1; pixelSize <= MAX_PIXEL_SIZE; pixelSize++) {
+        Bin &bin = bins[pixelSize];
+        if (bin.size) {
+            d->drain(d->sizeClasses[pixelSize], bin, bin.size);
+        }
+    }
+}
+
+KisTileDataSlabAllocator::Private::Private()
+{
+    for (int pixelSize = 1; pixelSize <= MAX_PIXEL_SIZE; pixelSize++) {
+        SizeClass &sc = sizeClasses[pixelSize];
+        sc.blockSize = blockSizeForPixelSize(pixelSize);
+        sc.blocksPerSlab = SLAB_SIZE / sc.blockSize;
+        sc.cacheCapacity = qBound(2, THREAD_CACHE_BYTES / sc.blockSize, MAX_CACHED_BLOCKS);
+    }
+}
+
+KisTileDataSlabAllocator::Private::~Private()
+{
+    /**
+     * QThreadStorage doesn't delete the data of the alive threads
+     * on destruction, so drain the cache of the current thread
+     * manually. The caches of other threads are just forgotten.
+     */
+    threadCaches.setLocalData(0);
+
+    /**
+     * The slabs may still be referenced by the tile data objects that
+     * have leaked or are going to be destroyed after us on the
+     * application shutdown, so the slabs are freed only when they are
+     * not used anymore.
+     */
+    for (int pixelSize = 1; pixelSize <= MAX_PIXEL_SIZE; pixelSize++) {
+        SizeClass &sc = sizeClasses[pixelSize];
+
+        Q_FOREACH (Slab *slab, sc.slabs) {
+            if (slab->numFree == slab->numBlocks) {
+                freeSlabMemory(slab->base);
+            }
+            delete slab;
+        }
+    }
+}
+
+KisTileDataSlabAllocator::ThreadCache* KisTileDataSlabAllocator::Private::threadCache()
+{
+    if (!threadCaches.hasLocalData()) {
+        threadCaches.setLocalData(new ThreadCache(this));
+    }
+    return threadCaches.localData();
+}
+
+bool KisTileDataSlabAllocator::Private::refill(SizeClass &sc, ThreadCache::Bin &bin, int numBlocks)
+{
+    QMutexLocker l(&sc.lock);
+
+    for (int i = 0; i < numBlocks; i++) {
+        quint8 *ptr = allocateBlockLocked(sc);
+        if (!ptr) break;
+
+        bin.blocks[bin.size++] = ptr;
+        threadCacheSize += sc.blockSize;
+    }
+
+    return bin.size > 0;
+}
+
+void KisTileDataSlabAllocator::Private::drain(SizeClass &sc, ThreadCache::Bin &bin, int numBlocks)
+{
+    QMutexLocker l(&sc.lock);
+
+    for (int i = 0; i < numBlocks && bin.size > 0; i++) {
+        freeBlockLocked(sc, bin.blocks[--bin.size]);
+        threadCacheSize -= sc.blockSize;
+    }
+}
+
+quint8* KisTileDataSlabAllocator::Private::allocateBlockLocked(SizeClass &sc)
+{
+    if (sc.availableSlabs.isEmpty() && !createSlabLocked(sc)) {
+        return 0;
+    }
+
+    Slab *slab = sc.availableSlabs.last();
+
+    if (slab->numFree == slab->numBlocks) {
+        sc.numEmptySlabs--;
+    }
+
+    quint8 *ptr = slab->freeHead;
+    slab->freeHead = nextFreeBlock(ptr);
+    slab->numFree--;
+
+    if (!slab->numFree) {
+        removeAvailableLocked(sc, slab);
+    }
+
+    return ptr;
+}
+
+void KisTileDataSlabAllocator::Private::freeBlockLocked(SizeClass &sc, quint8 *ptr)
+{
+    const quintptr base = reinterpret_cast<quintptr>(ptr) & ~quintptr(SLAB_SIZE - 1);
+    Slab *slab = sc.slabs.value(base, 0);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(slab);
+
+    nextFreeBlock(ptr) = slab->freeHead;
+    slab->freeHead = ptr;
+    slab->numFree++;
+
+    if (slab->numFree == 1) {
+        addAvailableLocked(sc, slab);
+    }
+
+    if (slab->numFree == slab->numBlocks) {
+        if (sc.numEmptySlabs >= MAX_EMPTY_SLABS) {
+            destroySlabLocked(sc, slab);
+        } else {
+            sc.numEmptySlabs++;
+        }
+    }
+}
+
+Slab* KisTileDataSlabAllocator::Private::createSlabLocked(SizeClass &sc)
+{
+    bool hugePages = false;
+    quint8 *base = allocateSlabMemory(&hugePages);
+    if (!base) return 0;
+
+    Slab *slab = new Slab();
+    slab->base = base;
+    slab->numBlocks = sc.blocksPerSlab;
+    slab->numFree = sc.blocksPerSlab;
+    slab->hugePages = hugePages;
+
+    // build the free list in the address order
+    for (int i = sc.blocksPerSlab - 1; i >= 0; i--) {
+        quint8 *block = base + i * sc.blockSize;
+        nextFreeBlock(block) = slab->freeHead;
+        slab->freeHead = block;
+    }
+
+    sc.slabs.insert(reinterpret_cast<quintptr>(base), slab);
+    sc.numEmptySlabs++;
+    addAvailableLocked(sc, slab);
+
+    numSlabs++;
+    if (hugePages) {
+        numHugePageSlabs++;
+    }
+
+    return slab;
+}
+
+void KisTileDataSlabAllocator::Private::destroySlabLocked(SizeClass &sc, Slab *slab)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(slab->numFree == slab->numBlocks);
+
+    removeAvailableLocked(sc, slab);
+    sc.slabs.remove(reinterpret_cast<quintptr>(slab->base));
+
+    numSlabs--;
+    if (slab->hugePages) {
+        numHugePageSlabs--;
+    }
+
+    freeSlabMemory(slab->base);
+    delete slab;
+}
+
+void KisTileDataSlabAllocator::Private::addAvailableLocked(SizeClass &sc, Slab *slab)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(slab->availableIndex < 0);
+
+    slab->availableIndex = sc.availableSlabs.size();
+    sc.availableSlabs.append(slab);
+}
+
+void KisTileDataSlabAllocator::Private::removeAvailableLocked(SizeClass &sc, Slab *slab)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(slab->availableIndex >= 0);
+
+    Slab *lastSlab = sc.availableSlabs.last();
+    sc.availableSlabs[slab->availableIndex] = lastSlab;
+    lastSlab->availableIndex = slab->availableIndex;
+    sc.availableSlabs.removeLast();
+
+    slab->availableIndex = -1;
+}
+
+
+KisTileDataSlabAllocator::KisTileDataSlabAllocator()
+    : m_d(new Private())
+{
+}
+
+KisTileDataSlabAllocator::~KisTileDataSlabAllocator()
+{
+}
+
+KisTileDataSlabAllocator* KisTileDataSlabAllocator::instance()
+{
+    return s_instance;
+}
+
+quint8* KisTileDataSlabAllocator::allocate(qint32 pixelSize)
+{
+    if (pixelSize <= 0 || pixelSize > MAX_PIXEL_SIZE) {
+        const qint32 size = blockSizeForPixelSize(pixelSize);
+        quint8 *ptr = static_cast<quint8*>(::malloc(size));
+        if (ptr) {
+            m_d->heapSize += size;
+            m_d->usedSize += size;
+        }
+        return ptr;
+    }
+
+    Private::SizeClass &sc = m_d->sizeClasses[pixelSize];
+    ThreadCache::Bin &bin = m_d->threadCache()->bins[pixelSize];
+
+    if (!bin.size && !m_d->refill(sc, bin, qMax(1, sc.cacheCapacity / 2))) {
+        return 0;
+    }
+
+    m_d->threadCacheSize -= sc.blockSize;
+    m_d->usedSize += sc.blockSize;
+
+    return bin.blocks[--bin.size];
+}
+
+void KisTileDataSlabAllocator::free(quint8 *ptr, qint32 pixelSize)
+{
+    if (!ptr) return;
+
+    if (pixelSize <= 0 || pixelSize > MAX_PIXEL_SIZE) {
+        const qint32 size = blockSizeForPixelSize(pixelSize);
+        ::free(ptr);
+        m_d->heapSize -= size;
+        m_d->usedSize -= size;
+        return;
+    }
+
+    Private::SizeClass &sc = m_d->sizeClasses[pixelSize];
+    ThreadCache::Bin &bin = m_d->threadCache()->bins[pixelSize];
+
+    if (bin.size >= sc.cacheCapacity) {
+        m_d->drain(sc, bin, qMax(1, sc.cacheCapacity / 2));
+    }
+
+    bin.blocks[bin.size++] = ptr;
+
+    m_d->threadCacheSize += sc.blockSize;
+    m_d->usedSize -= sc.blockSize;
+}
+
+void KisTileDataSlabAllocator::releaseFreeMemory()
+{
+    ThreadCache *cache = m_d->threadCache();
+
+    for (int pixelSize = 1; pixelSize <= MAX_PIXEL_SIZE; pixelSize++) {
+        Private::SizeClass &sc = m_d->sizeClasses[pixelSize];
+        ThreadCache::Bin &bin = cache->bins[pixelSize];
+
+        if (bin.size) {
+            m_d->drain(sc, bin, bin.size);
+        }
+
+        QMutexLocker l(&sc.lock);
+
+        Q_FOREACH (Slab *slab, sc.availableSlabs) {
+            if (slab->numFree == slab->numBlocks) {
+                m_d->destroySlabLocked(sc, slab);
+            }
+        }
+        sc.numEmptySlabs = 0;
+    }
+}
+
+KisTileDataSlabAllocator::Statistics KisTileDataSlabAllocator::statistics() const
+{
+    Statistics stats;
+
+    stats.numSlabs = m_d->numSlabs;
+    stats.reservedSize = stats.numSlabs * SLAB_SIZE + m_d->heapSize;
+    stats.usedSize = m_d->usedSize;
+    stats.threadCacheSize = m_d->threadCacheSize;
+    stats.hugePageSize = m_d->numHugePageSlabs * SLAB_SIZE;
+
+    return stats;
+}
@@ -0,0 +1,91 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_TILE_DATA_SLAB_ALLOCATOR_H
+#define KIS_TILE_DATA_SLAB_ALLOCATOR_H
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+
+/**
+ * A segregated-fit allocator for pixel buffers of KisTileData.
+ *
+ * Every pixel size up to MAX_PIXEL_SIZE has its own size class. The
+ * blocks of a size class are cut from fixed-size slabs of SLAB_SIZE
+ * bytes, aligned to SLAB_SIZE, so that the owning slab of a block can
+ * be found by masking its address. On Linux the slabs are advised to
+ * be backed with transparent huge pages.
+ *
+ * Every thread keeps a small cache of free blocks for every size
+ * class, so the common allocate/free pairs in the tile engine don't
+ * touch any shared lock. The caches are refilled and drained in
+ * batches.
+ *
+ * When a slab becomes completely free, it is returned to the system
+ * (except a single spare slab per size class to avoid thrashing), so
+ * the resident memory of the application follows the actual amount of
+ * the tile data instead of its historical peak.
+ *
+ * Pixel sizes larger than MAX_PIXEL_SIZE are served by the general
+ * heap.
+ */
+class KRITAIMAGE_EXPORT KisTileDataSlabAllocator
+{
+public:
+    struct Statistics {
+        /// memory requested from the system, including the heap fallback
+        qint64 reservedSize = 0;
+        /// memory owned by the alive tile data objects
+        qint64 usedSize = 0;
+        /// free blocks kept in the per-thread caches
+        qint64 threadCacheSize = 0;
+        /// the part of reservedSize that is advised for huge pages
+        qint64 hugePageSize = 0;
+        qint64 numSlabs = 0;
+    };
+
+public:
+    KisTileDataSlabAllocator();
+    ~KisTileDataSlabAllocator();
+
+    /**
+     * The allocator used by KisTileData. Returns null when the
+     * application is being shut down.
+     */
+    static KisTileDataSlabAllocator* instance();
+
+    /**
+     * Allocates a pixel buffer for a tile with pixels of \p pixelSize
+     * bytes. Returns null if the system is out of memory.
+     */
+    quint8* allocate(qint32 pixelSize);
+
+    /**
+     * Frees the buffer allocated by allocate() with the same
+     * \p pixelSize
+     */
+    void free(quint8 *ptr, qint32 pixelSize);
+
+    /**
+     * Drains the cache of the calling thread and returns all the
+     * completely free slabs to the system
+     */
+    void releaseFreeMemory();
+
+    Statistics statistics() const;
+
+    static const qint32 MAX_PIXEL_SIZE;
+    static const qint32 SLAB_SIZE;
+
+private:
+    struct Private;
+    struct ThreadCache;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KIS_TILE_DATA_SLAB_ALLOCATOR_H
@@ -15,6 +15,7 @@
 #include "kis_debug.h"
 
 #include "kis_tile_data_store_iterators.h"
+#include "kis_tile_data_slab_allocator.h"
 
 Q_GLOBAL_STATIC(KisTileDataStore, s_instance)
 
@@ -59,16 +60,21 @@ KisTileDataStore::KisTileDataStore()
     : m_pooler(this),
       m_swapper(this),
       m_numTiles(0),
+      m_numSwappedTiles(0),
       m_memoryMetric(0),
       m_counter(1),
-      m_clockIndex(1)
+      m_clockIndex(1),
+      m_deduplicatedMetric(0),
+      m_fileMappedMetric(0)
 {
     m_pooler.start();
     m_swapper.start();
+    m_prefetcher.start();
 }
 
 KisTileDataStore::~KisTileDataStore()
 {
+    m_prefetcher.terminatePrefetcher();
     m_pooler.terminatePooler();
     m_swapper.terminateSwapper();
 
@@ -100,6 +106,21 @@ KisTileDataStore::MemoryStatistics KisTileDataStore::memoryStatistics()
 
     stats.swapSize = m_swappedStore.totalSwapMemoryUsed();
 
+    KisTileDataSlabAllocator *allocator = KisTileDataSlabAllocator::instance();
+    if (allocator) {
+        const KisTileDataSlabAllocator::Statistics allocatorStats = allocator->statistics();
+        stats.allocatorReservedSize = allocatorStats.reservedSize;
+        stats.allocatorUsedSize = allocatorStats.usedSize;
+        stats.allocatorHugePageSize = allocatorStats.hugePageSize;
+    } else {
+        stats.allocatorReservedSize = 0;
+        stats.allocatorUsedSize = 0;
+        stats.allocatorHugePageSize = 0;
+    }
+
+    stats.deduplicatedSize = qint64(m_deduplicatedMetric.loadAcquire()) * metricCoeff;
+    stats.fileMappedSize = qint64(m_fileMappedMetric.loadAcquire()) * metricCoeff;
+
     return stats;
 }
 
@@ -171,6 +192,13 @@ KisTileData *KisTileDataStore::allocTileData(qint32 pixelSize, const quint8 *def
     return td;
 }
 
+KisTileData *KisTileDataStore::createFileMappedTileData(qint32 pixelSize, quint8 *data, KisTileFileMappingSP mapping)
+{
+    KisTileData *td = new KisTileData(pixelSize, data, mapping, this);
+    m_fileMappedMetric += pixelSize;
+    return td;
+}
+
 KisTileData *KisTileDataStore::duplicateTileData(KisTileData *rhs)
 {
     KisTileData *td = 0;
@@ -196,11 +224,34 @@ void KisTileDataStore::freeTileData(KisTileData *td)
 
     DEBUG_FREE_ACTION(td);
 
+    if (td->isFileMapped()) {
+        m_fileMappedMetric -= td->pixelSize();
+        delete td;
+        return;
+    }
+
     m_iteratorLock.lockForRead();
+
+    KisTileData *duplicateOf = 0;
+
+    if (td->m_deduplicationIndexed) {
+        QMutexLocker locker(&m_deduplicationLock);
+
+        auto it = m_deduplicationIndex.find(td->m_contentHash);
+        if (it != m_deduplicationIndex.end() && it.value() == td) {
+            m_deduplicationIndex.erase(it);
+        }
+        td->m_deduplicationIndexed = false;
+
+        duplicateOf = td->m_duplicateOf;
+        td->m_duplicateOf = 0;
+    }
+
     td->m_swapLock.lockForWrite();
 
     if (!td->data()) {
         m_swappedStore.forgetTileData(td);
+        m_numSwappedTiles.deref();
     } else {
         unregisterTileDataImp(td);
     }
@@ -209,6 +260,14 @@ void KisTileDataStore::freeTileData(KisTileData *td)
     m_iteratorLock.unlock();
 
     delete td;
+
+    /**
+     * Releasing the duplicate may free it as well, so do that
+     * only when all the locks are released
+     */
+    if (duplicateOf) {
+        duplicateOf->release();
+    }
 }
 
 void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
@@ -244,6 +303,7 @@ void KisTileDataStore::ensureTileDataLoaded(KisTileData *td)
             td->m_swapLock.lockForWrite();
 
             m_swappedStore.swapInTileData(td);
+            m_numSwappedTiles.deref();
             registerTileDataImp(td);
 
             td->m_swapLock.unlock();
@@ -271,6 +331,7 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     if (td->data()) {
         if (m_swappedStore.trySwapOutTileData(td)) {
             unregisterTileDataImp(td);
+            m_numSwappedTiles.ref();
             result = true;
         }
     }
@@ -279,6 +340,177 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     return result;
 }
 
+qint64 KisTileDataStore::trySwapTileData(const QVector<KisTileData*> &tiles)
+{
+    /**
+     * This function is called with m_listLock acquired
+     */
+
+    QVector<KisTileData*> lockedTiles;
+    lockedTiles.reserve(tiles.size());
+
+    Q_FOREACH (KisTileData *td, tiles) {
+        if (!td->m_swapLock.tryLockForWrite()) continue;
+
+        if (td->data()) {
+            lockedTiles.append(td);
+        } else {
+            td->m_swapLock.unlock();
+        }
+    }
+
+    QVector<bool> swappedOut;
+    m_swappedStore.trySwapOutTileData(lockedTiles, swappedOut);
+
+    qint64 freedMetric = 0;
+
+    for (int i = 0; i < lockedTiles.size(); i++) {
+        KisTileData *td = lockedTiles[i];
+
+        if (swappedOut[i]) {
+            unregisterTileDataImp(td);
+            m_numSwappedTiles.ref();
+            freedMetric += td->pixelSize();
+        }
+
+        td->m_swapLock.unlock();
+    }
+
+    return freedMetric;
+}
+
+quint64 KisTileDataStore::contentHash(KisTileData *td)
+{
+    const int size = KisTileData::WIDTH * KisTileData::HEIGHT * td->pixelSize();
+
+    quint64 hash = qHashBits(td->data(), size, 0);
+    hash = (hash << 32) ^ qHashBits(td->data(), size, td->pixelSize());
+    return hash;
+}
+
+void KisTileDataStore::indexTileDataForDeduplication(KisTileData *td)
+{
+    if (td->m_deduplicationIndexed || !td->mementoed()) return;
+
+    /**
+     * The swapper may be writing the data out right now, in such
+     * a case just leave the tile for the next cycle
+     */
+    if (!td->m_swapLock.tryLockForRead()) return;
+
+    if (!td->data()) {
+        td->m_swapLock.unlock();
+        return;
+    }
+
+    const quint64 hash = contentHash(td);
+
+    KisTileData *candidate = 0;
+
+    {
+        QMutexLocker locker(&m_deduplicationLock);
+
+        if (td->m_deduplicationIndexed) {
+            td->m_swapLock.unlock();
+            return;
+        }
+
+        candidate = m_deduplicationIndex.value(hash, 0);
+
+        if (!candidate) {
+            m_deduplicationIndex.insert(hash, td);
+
+            td->m_contentHash = hash;
+            td->m_deduplicationIndexed = true;
+            td->m_swapLock.unlock();
+            return;
+        }
+
+        /**
+         * The candidate may already be on its way to freeTileData(),
+         * waiting for our lock. Reference it only if it is still alive.
+         */
+        int refCount;
+        do {
+            refCount = candidate->m_refCount.loadAcquire();
+            if (!refCount || candidate->pixelSize() != td->pixelSize()) {
+                candidate = 0;
+                break;
+            }
+        } while (!candidate->m_refCount.testAndSetOrdered(refCount, refCount + 1));
+    }
+
+    if (candidate) {
+        candidate->acquire();
+        candidate->deref();
+
+        /**
+         * The mementoed data is read-only: every writer has to COW it.
+         * Now we are one of its users, so it will stay read-only even
+         * if the memento drops it in the meantime.
+         */
+        bool isDuplicate = candidate->mementoed();
+
+        if (isDuplicate) {
+            const int size = KisTileData::WIDTH * KisTileData::HEIGHT * td->pixelSize();
+
+            candidate->blockSwapping();
+            isDuplicate = !memcmp(candidate->data(), td->data(), size);
+            candidate->unblockSwapping();
+        }
+
+        if (!isDuplicate) {
+            candidate->release();
+            candidate = 0;
+        }
+    }
+
+    td->m_swapLock.unlock();
+
+    /**
+     * If the content is already present in the index, we keep the
+     * old entry, but still mark the tile data as processed to avoid
+     * hashing it again in the next cycles of the pooler
+     */
+    QMutexLocker locker(&m_deduplicationLock);
+
+    td->m_contentHash = hash;
+    td->m_duplicateOf = candidate;
+    td->m_deduplicationIndexed = true;
+}
+
+bool KisTileDataStore::isIndexedForDeduplication(KisTileData *td)
+{
+    QMutexLocker locker(&m_deduplicationLock);
+    return td->m_deduplicationIndexed;
+}
+
+KisTileData* KisTileDataStore::acquireDuplicateTileData(KisTileData *td)
+{
+    QMutexLocker locker(&m_deduplicationLock);
+
+    /**
+     * The link holds a user of the duplicate, so it cannot
+     * be freed while we are acquiring it
+     */
+    KisTileData *duplicate = td->m_duplicateOf;
+    if (duplicate) {
+        duplicate->acquire();
+    }
+
+    return duplicate;
+}
+
+void KisTileDataStore::registerDeduplicatedUser(KisTileData *td)
+{
+    m_deduplicatedMetric.fetchAndAddOrdered(td->pixelSize());
+}
+
+void KisTileDataStore::releaseDeduplicatedUser(KisTileData *td)
+{
+    m_deduplicatedMetric.fetchAndSubOrdered(td->pixelSize());
+}
+
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 {
     m_iteratorLock.lockForWrite();
@@ -360,6 +592,7 @@ void KisTileDataStore::debugClear()
     m_counter = 1;
     m_clockIndex = 1;
     m_numTiles = 0;
+    m_numSwappedTiles = 0;
     m_memoryMetric = 0;
 }
 
@@ -370,6 +603,31 @@ void KisTileDataStore::testingRereadConfig()
     kickPooler();
 }
 
+void KisTileDataStore::testingWaitForPrefetch()
+{
+    m_prefetcher.testingWaitForIdle();
+}
+
+void KisTileDataStore::testingIndexTileDataForDeduplication()
+{
+    QVector<KisTileData*> tiles;
+
+    KisTileDataStoreIterator *iter = beginIteration();
+
+    while (iter->hasNext()) {
+        KisTileData *td = iter->next();
+        td->ref();
+        tiles.append(td);
+    }
+
+    endIteration(iter);
+
+    Q_FOREACH (KisTileData *td, tiles) {
+        indexTileDataForDeduplication(td);
+        td->deref();
+    }
+}
+
 void KisTileDataStore::testingSuspendPooler()
 {
     m_pooler.terminatePooler();
@@ -11,10 +11,13 @@
 #include "kritaimage_export.h"
 
 #include <QReadWriteLock>
+#include <QMutex>
+#include <QHash>
 #include "kis_tile_data_interface.h"
 
 #include "kis_tile_data_pooler.h"
 #include "swap/kis_tile_data_swapper.h"
+#include "swap/kis_tile_data_prefetcher.h"
 #include "swap/kis_swapped_data_store.h"
 #include "3rdparty/lock_free_map/concurrent_map.h"
 
@@ -42,6 +45,31 @@ public:
         qint64 poolSize;
 
         qint64 swapSize;
+
+        /**
+         * Memory reserved by KisTileDataSlabAllocator from the
+         * system for the pixel buffers, the part of it actually
+         * used by the tile data and the part of it backed by huge
+         * pages
+         */
+        qint64 allocatorReservedSize;
+        qint64 allocatorUsedSize;
+        qint64 allocatorHugePageSize;
+
+        /**
+         * Memory released by merging the identical tile data into
+         * shared instances. Only the merges still in effect are
+         * counted, that is the ones whose tile (or memento item)
+         * still uses the shared instance.
+         */
+        qint64 deduplicatedSize;
+
+        /**
+         * The size of the tile data mapped directly from the
+         * files. It is not a part of totalMemorySize, because the
+         * system loads and unloads these pages itself.
+         */
+        qint64 fileMappedSize;
     };
 
     MemoryStatistics memoryStatistics();
@@ -64,6 +92,14 @@ public:
         return m_numTiles.loadAcquire();
     }
 
+    /**
+     * Returns the number of tiles present in the swap file only
+     */
+    inline qint32 numTilesSwapped() const
+    {
+        return m_numSwappedTiles.loadAcquire();
+    }
+
     inline void checkFreeMemory()
     {
         m_swapper.checkFreeMemory();
@@ -91,6 +127,13 @@ public:
         return allocTileData(pixelSize, defPixel);
     }
 
+    /**
+     * Creates a tile data whose pixels are stored at \p data inside
+     * the memory-mapped file \p mapping. The tile data is not
+     * registered in the store, so it is neither pooled nor swapped.
+     */
+    KisTileData* createFileMappedTileData(qint32 pixelSize, quint8 *data, KisTileFileMappingSP mapping);
+
     // Called by The Memento Manager after every commit
     inline void kickPooler()
     {
@@ -107,6 +150,82 @@ public:
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Try swap out a batch of tile data objects. The tiles are
+     * compressed in parallel (see KisSwappedDataStore). The tiles
+     * that are being accessed at the moment are skipped.
+     *
+     * \return the metric of the memory freed by the swap-out
+     */
+    qint64 trySwapTileData(const QVector<KisTileData*> &tiles);
+
+    /**
+     * Defragment the swap file
+     * \see KisSwappedDataStore::compact()
+     */
+    inline void compactSwap()
+    {
+        m_swappedStore.compact();
+    }
+
+    /**
+     * Asynchronously load the swapped-out \p tiles back into memory.
+     * The store takes the ownership of one reference of every tile
+     * data in the list, the caller should ref() them beforehand.
+     *
+     * \see KisTiledDataManager::prefetchRect()
+     */
+    inline void prefetchTileData(const QVector<KisTileData*> &tiles)
+    {
+        m_prefetcher.prefetch(tiles);
+    }
+
+    /**
+     * Adds the tile data to the content-hash index used for
+     * deduplication. Only the tile data that cannot be changed
+     * anymore, that is the data owned by committed mementos, is
+     * accepted. Called by the pooler.
+     *
+     * If the index already has a tile data with the same hash, the
+     * contents are compared and, when equal, \p td is linked to that
+     * tile data, so that the data manager could replace it on its next
+     * commit (see acquireDuplicateTileData()).
+     *
+     * The data that is swapped out at the moment is skipped, it
+     * is not worth loading it back just for hashing.
+     *
+     * PRECONDITIONS: the caller holds a reference to \p td
+     *                m_iteratorLock is *unlocked*
+     */
+    void indexTileDataForDeduplication(KisTileData *td);
+
+    /**
+     * Returns true if the pooler has already processed \p td, that
+     * is acquireDuplicateTileData() gives the final answer for it
+     */
+    bool isIndexedForDeduplication(KisTileData *td);
+
+    /**
+     * Returns the tile data the pooler has found to have exactly the
+     * same content as \p td. The returned tile data is acquired, so the
+     * caller can replace \p td with it. Returns null if there is no
+     * such tile data. Nothing is hashed or compared here.
+     */
+    KisTileData* acquireDuplicateTileData(KisTileData *td);
+
+    /**
+     * Accounts \p td as shared through the deduplication. Called by
+     * the tile (or the memento item) that has got \p td instead of
+     * its own copy of the data.
+     */
+    void registerDeduplicatedUser(KisTileData *td);
+
+    /**
+     * Called by the same tile (or memento item) when it stops
+     * using \p td, that is when it COWs the data or is destroyed
+     */
+    void releaseDeduplicatedUser(KisTileData *td);
+
 
     /**
      * WARN: The following three method are only for usage
@@ -139,6 +258,8 @@ private:
     inline void unregisterTileDataImp(KisTileData *td);
     void freeRegisteredTiles();
 
+    static quint64 contentHash(KisTileData *td);
+
     friend class DeadlockyThread;
     friend class KisLowMemoryTests;
     void debugSwapAll();
@@ -147,12 +268,15 @@ private:
     friend class KisTiledDataManagerTest;
     void testingSuspendPooler();
     void testingResumePooler();
+    void testingIndexTileDataForDeduplication();
 
     friend class KisLowMemoryBenchmark;
     void testingRereadConfig();
+    void testingWaitForPrefetch();
 private:
     KisTileDataPooler m_pooler;
     KisTileDataSwapper m_swapper;
+    KisTileDataPrefetcher m_prefetcher;
 
     friend class KisTileDataStoreTest;
     friend class KisTileDataPoolerTest;
@@ -164,11 +288,24 @@ private:
      * metric = num_bytes / (KisTileData::WIDTH * KisTileData::HEIGHT)
      */
     QAtomicInt m_numTiles;
+    QAtomicInt m_numSwappedTiles;
     QAtomicInt m_memoryMetric;
     QAtomicInt m_counter;
     QAtomicInt m_clockIndex;
     ConcurrentMap<int, KisTileData*> m_tileDataMap;
     QReadWriteLock m_iteratorLock;
+
+    /**
+     * Maps the content hash to the mementoed tile data having this
+     * content. The entries are removed in freeTileData(), so every
+     * pointer in the index is valid while m_deduplicationLock is held.
+     * When both locks are needed, m_iteratorLock is taken first.
+     */
+    QMutex m_deduplicationLock;
+    QHash<quint64, KisTileData*> m_deduplicationIndex;
+    QAtomicInt m_deduplicatedMetric;
+
+    QAtomicInt m_fileMappedMetric;
 };
 
 template<typename T>
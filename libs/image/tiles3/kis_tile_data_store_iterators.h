@@ -61,6 +61,17 @@ public:
         return m_store->trySwapTileData(td);
     }
 
+    inline qint64 trySwapOut(const QVector<KisTileData*> &tiles)
+    {
+        Q_FOREACH (KisTileData *td, tiles) {
+            if (td == m_iterator.getValue()) {
+                m_iterator.next();
+            }
+        }
+
+        return m_store->trySwapTileData(tiles);
+    }
+
 private:
     ConcurrentMap<int, KisTileData*> &m_map;
     ConcurrentMap<int, KisTileData*>::Iterator m_iterator;
@@ -136,6 +147,17 @@ public:
         return m_store->trySwapTileData(td);
     }
 
+    inline qint64 trySwapOut(const QVector<KisTileData*> &tiles)
+    {
+        Q_FOREACH (KisTileData *td, tiles) {
+            if (td == m_iterator.getValue()) {
+                m_iterator.next();
+            }
+        }
+
+        return m_store->trySwapTileData(tiles);
+    }
+
 private:
     friend class KisTileDataStore;
     inline int getFinalPosition()
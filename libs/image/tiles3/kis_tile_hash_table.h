@@ -8,6 +8,8 @@
 #ifndef KIS_TILEHASHTABLE_H_
 #define KIS_TILEHASHTABLE_H_
 
+#include <QVector>
+
 #include "kis_tile.h"
 
 
@@ -70,6 +72,22 @@ public:
      *                     and it is not a lazily created default wrapper tile
      */
     TileTypeSP getReadOnlyTileLazy(qint32 col, qint32 row, bool &existingTile);
+
+    /**
+     * Fetches all the tiles of \p tileRect (in tile coordinates) in a
+     * single pass over the table and stores them in \p tiles in the
+     * row-major order. The positions where no tile exists are filled
+     * with detached tiles referencing the default tile data, the same
+     * way getReadOnlyTileLazy() does.
+     */
+    void getReadOnlyTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles);
+
+    /**
+     * Same as getReadOnlyTilesLazy(), but the missing tiles are created
+     * and attached to the table, the same way getTileLazy() does. The
+     * positions of the created tiles are appended to \p newTiles.
+     */
+    void getTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles, QVector<QPoint> &newTiles);
     void addTile(TileTypeSP tile);
     bool deleteTile(TileTypeSP tile);
     bool deleteTile(qint32 col, qint32 row);
@@ -7,6 +7,9 @@
 #ifndef KIS_TILEHASHTABLE_2_H
 #define KIS_TILEHASHTABLE_2_H
 
+#include <QVector>
+#include <QPoint>
+
 #include "kis_shared.h"
 #include "kis_shared_ptr.h"
 #include "3rdparty/lock_free_map/concurrent_map.h"
@@ -82,6 +85,22 @@ public:
      *                     and it is not a lazily created default wrapper tile
      */
     TileTypeSP getReadOnlyTileLazy(qint32 col, qint32 row, bool &existingTile);
+
+    /**
+     * Fetches all the tiles of \p tileRect (in tile coordinates) in a
+     * single pass over the table and stores them in \p tiles in the
+     * row-major order. The positions where no tile exists are filled
+     * with detached tiles referencing the default tile data, the same
+     * way getReadOnlyTileLazy() does.
+     */
+    void getReadOnlyTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles);
+
+    /**
+     * Same as getReadOnlyTilesLazy(), but the missing tiles are created
+     * and attached to the table, the same way getTileLazy() does. The
+     * positions of the created tiles are appended to \p newTiles.
+     */
+    void getTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles, QVector<QPoint> &newTiles);
     void addTile(TileTypeSP tile);
     bool deleteTile(TileTypeSP tile);
     bool deleteTile(qint32 col, qint32 row);
@@ -175,6 +194,29 @@ private:
         m_map.getGC().update();
     }
 
+    /**
+     * Fetches the existing tiles of \p tileRect under a single lock
+     * of the raw pointers. The missing tiles are left null.
+     */
+    inline void fetchExistingTiles(const QRect &tileRect, QVector<TileTypeSP> &tiles)
+    {
+        tiles.resize(tileRect.width() * tileRect.height());
+
+        m_map.getGC().lockRawPointerAccess();
+
+        int i = 0;
+        for (qint32 row = tileRect.top(); row <= tileRect.bottom(); row++) {
+            for (qint32 col = tileRect.left(); col <= tileRect.right(); col++, i++) {
+                const quint32 idx = calculateHashSafe(col, row);
+                tiles[i] = idx ? m_map.get(idx) : 0;
+            }
+        }
+
+        m_map.getGC().unlockRawPointerAccess();
+
+        m_map.getGC().update();
+    }
+
     inline bool erase(quint32 idx)
     {
         m_map.getGC().lockRawPointerAccess();
@@ -433,6 +475,43 @@ typename KisTileHashTableTraits2<T>::TileTypeSP KisTileHashTableTraits2<T>::getR
     return tile;
 }
 
+template <class T>
+void KisTileHashTableTraits2<T>::getReadOnlyTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles)
+{
+    fetchExistingTiles(tileRect, tiles);
+
+    QReadLocker locker(&m_defaultPixelDataLock);
+
+    int i = 0;
+    for (qint32 row = tileRect.top(); row <= tileRect.bottom(); row++) {
+        for (qint32 col = tileRect.left(); col <= tileRect.right(); col++, i++) {
+            if (!tiles[i]) {
+                tiles[i] = new TileType(col, row, m_defaultTileData, 0);
+            }
+        }
+    }
+}
+
+template <class T>
+void KisTileHashTableTraits2<T>::getTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles, QVector<QPoint> &newTiles)
+{
+    fetchExistingTiles(tileRect, tiles);
+
+    int i = 0;
+    for (qint32 row = tileRect.top(); row <= tileRect.bottom(); row++) {
+        for (qint32 col = tileRect.left(); col <= tileRect.right(); col++, i++) {
+            if (!tiles[i]) {
+                bool newTile = false;
+                tiles[i] = getTileLazy(col, row, newTile);
+
+                if (newTile) {
+                    newTiles.append(QPoint(col, row));
+                }
+            }
+        }
+    }
+}
+
 template <class T>
 void KisTileHashTableTraits2<T>::addTile(TileTypeSP tile)
 {
@@ -263,6 +263,56 @@ KisTileHashTableTraits<T>::getReadOnlyTileLazy(qint32 col, qint32 row, bool &exi
     return tile;
 }
 
+template<class T>
+void KisTileHashTableTraits<T>::getReadOnlyTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles)
+{
+    tiles.resize(tileRect.width() * tileRect.height());
+
+    QReadLocker locker(&m_lock);
+
+    int i = 0;
+    for (qint32 row = tileRect.top(); row <= tileRect.bottom(); row++) {
+        for (qint32 col = tileRect.left(); col <= tileRect.right(); col++, i++) {
+            tiles[i] = getTile(col, row, calculateHash(col, row));
+
+            if (!tiles[i]) {
+                tiles[i] = new TileType(col, row, m_defaultTileData, 0);
+            }
+        }
+    }
+}
+
+template<class T>
+void KisTileHashTableTraits<T>::getTilesLazy(const QRect &tileRect, QVector<TileTypeSP> &tiles, QVector<QPoint> &newTiles)
+{
+    tiles.resize(tileRect.width() * tileRect.height());
+
+    {
+        QReadLocker locker(&m_lock);
+
+        int i = 0;
+        for (qint32 row = tileRect.top(); row <= tileRect.bottom(); row++) {
+            for (qint32 col = tileRect.left(); col <= tileRect.right(); col++, i++) {
+                tiles[i] = getTile(col, row, calculateHash(col, row));
+            }
+        }
+    }
+
+    int i = 0;
+    for (qint32 row = tileRect.top(); row <= tileRect.bottom(); row++) {
+        for (qint32 col = tileRect.left(); col <= tileRect.right(); col++, i++) {
+            if (!tiles[i]) {
+                bool newTile = false;
+                tiles[i] = getTileLazy(col, row, newTile);
+
+                if (newTile) {
+                    newTiles.append(QPoint(col, row));
+                }
+            }
+        }
+    }
+}
+
 template<class T>
 void KisTileHashTableTraits<T>::addTile(TileTypeSP tile)
 {
@@ -6,6 +6,7 @@
  *  SPDX-License-Identifier: GPL-2.0-or-later
  */
 
+#include <QHash>
 #include <QRect>
 #include <QVector>
 
@@ -18,6 +19,7 @@
 #include "swap/kis_tile_compressor_factory.h"
 
 #include "kis_paint_device_writer.h"
+#include "kis_image_config.h"
 
 #include "kis_global.h"
 
@@ -79,6 +81,10 @@ KisTiledDataManager::~KisTiledDataManager()
     delete m_hashTable;
     delete m_mementoManager;
 
+    Q_FOREACH (const DeduplicationCandidate &candidate, m_deduplicationCandidates) {
+        candidate.tileData->deref();
+    }
+
     delete[] m_defaultPixel;
 }
 
@@ -117,7 +123,8 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
     KisTileSP tile;
 
     KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(CURRENT_VERSION);
+        KisTileCompressorFactory::create(CURRENT_VERSION,
+                                         KisImageConfig(true).tileFileCompressionType());
 
     while ((tile = iter.tile())) {
         retval = compressor->writeTile(tile, store);
@@ -649,6 +656,168 @@ void KisTiledDataManager::recalculateExtent()
     m_extentManager.replaceTileStats(indexes);
 }
 
+void KisTiledDataManager::shareChangedTileData()
+{
+    mergeDuplicateTileData();
+
+    const QVector<QPoint> changedTiles = m_mementoManager->uncommittedChangedTiles();
+    if (changedTiles.isEmpty()) return;
+
+    const qint32 pixelSize = this->pixelSize();
+    const qint32 tileDataSize = KisTileData::WIDTH * KisTileData::HEIGHT * pixelSize;
+
+    QHash<QByteArray, KisTileData*> uniformTileData;
+
+    Q_FOREACH (const QPoint &index, changedTiles) {
+        KisTileSP tile = m_hashTable->getExistingTile(index.x(), index.y());
+        if (!tile) continue;
+
+        QByteArray color;
+
+        tile->lockForRead();
+
+        /**
+         * The tile data shared by several tiles has already been
+         * collapsed or cloned with bitBlt, there is nothing to win
+         */
+        if (tile->tileData()->numUsers() <= 1) {
+            const quint8 *data = tile->data();
+
+            /**
+             * The data is equal to itself shifted by one pixel if and
+             * only if all the pixels are equal
+             */
+            if (!memcmp(data, data + pixelSize, tileDataSize - pixelSize)) {
+                color = QByteArray((const char*)data, pixelSize);
+            } else {
+                KisTileData *td = tile->tileData();
+                td->ref();
+                m_deduplicationCandidates.append({index, td});
+            }
+        }
+
+        tile->unlockForRead();
+
+        if (color.isEmpty()) continue;
+
+        /**
+         * The tiles of the default color are not removed, otherwise
+         * the extent of the device would change
+         */
+        KisTileData *td = uniformTileData.value(color, 0);
+        if (!td) {
+            if (!memcmp(color.constData(), m_defaultPixel, pixelSize)) {
+                td = m_hashTable->refAndFetchDefaultTileData();
+                td->acquire();
+                td->deref();
+                uniformTileData.insert(color, td);
+            } else {
+                /**
+                 * The first tile of the color lends its own tile data
+                 * to the others, so nothing is allocated. The data is
+                 * also queued for the deduplication, so that the pooler
+                 * could merge it with the same color committed earlier.
+                 */
+                td = tile->tileData();
+                td->acquire();
+                uniformTileData.insert(color, td);
+
+                td->ref();
+                m_deduplicationCandidates.append({index, td});
+                continue;
+            }
+        }
+
+        const bool wasDeleted = m_hashTable->deleteTile(index.x(), index.y());
+        if (wasDeleted) {
+            m_extentManager.notifyTileRemoved(index.x(), index.y());
+        }
+
+        KisTileSP sharedTile = KisTileSP(new KisTile(index.x(), index.y(), td, m_mementoManager));
+        m_hashTable->addTile(sharedTile);
+        m_extentManager.notifyTileAdded(index.x(), index.y());
+    }
+
+    Q_FOREACH (KisTileData *td, uniformTileData) {
+        td->release();
+    }
+}
+
+void KisTiledDataManager::mergeDuplicateTileData()
+{
+    if (m_deduplicationCandidates.isEmpty()) return;
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    QVector<DeduplicationCandidate> pendingCandidates;
+
+    Q_FOREACH (const DeduplicationCandidate &candidate, m_deduplicationCandidates) {
+        KisTileData *td = candidate.tileData;
+
+        if (!store->isIndexedForDeduplication(td)) {
+            /**
+             * The pooler processes only the data kept in history, the
+             * data that has left it (e.g. the history has been purged)
+             * will never be indexed
+             */
+            if (td->mementoed()) {
+                pendingCandidates.append(candidate);
+            } else {
+                td->deref();
+            }
+            continue;
+        }
+
+        KisTileData *duplicate = store->acquireDuplicateTileData(td);
+        if (duplicate) {
+            m_mementoManager->replaceTileData(m_hashTable,
+                                              candidate.index.x(), candidate.index.y(),
+                                              td, duplicate);
+            duplicate->release();
+        }
+
+        td->deref();
+    }
+
+    m_deduplicationCandidates = pendingCandidates;
+}
+
+void KisTiledDataManager::getTilesPairs(const QRect &tileRect, bool writable, QVector<KisTileSP> &tiles, QVector<KisTileSP> &oldTiles)
+{
+    if (writable) {
+        QVector<QPoint> newTiles;
+        m_hashTable->getTilesLazy(tileRect, tiles, newTiles);
+
+        Q_FOREACH (const QPoint &index, newTiles) {
+            m_extentManager.notifyTileAdded(index.x(), index.y());
+        }
+    } else {
+        m_hashTable->getReadOnlyTilesLazy(tileRect, tiles);
+    }
+
+    oldTiles.resize(tiles.size());
+
+    int i = 0;
+    for (qint32 row = tileRect.top(); row <= tileRect.bottom(); row++) {
+        for (qint32 col = tileRect.left(); col <= tileRect.right(); col++, i++) {
+            bool unused;
+            KisTileSP oldTile = m_mementoManager->getCommittedTile(col, row, unused);
+            oldTiles[i] = oldTile ? oldTile : tiles[i];
+        }
+    }
+}
+
+void KisTiledDataManager::setTileDataImpl(qint32 col, qint32 row, KisTileData *td)
+{
+    const bool wasDeleted = m_hashTable->deleteTile(col, row);
+    if (wasDeleted) {
+        m_extentManager.notifyTileRemoved(col, row);
+    }
+
+    KisTileSP tile = KisTileSP(new KisTile(col, row, td, m_mementoManager));
+    m_hashTable->addTile(tile);
+    m_extentManager.notifyTileAdded(col, row);
+}
+
 void KisTiledDataManager::extent(qint32 &x, qint32 &y, qint32 &w, qint32 &h) const
 {
     QRect rect = extent();
@@ -675,6 +844,23 @@ KisRegion KisTiledDataManager::region() const
     return KisRegion(std::move(rects));
 }
 
+QVector<QRect> KisTiledDataManager::tileRectsChangedSince(quint64 epoch) const
+{
+    QVector<QRect> rects;
+
+    KisTileHashTableConstIterator iter(m_hashTable);
+    KisTileSP tile;
+
+    while ((tile = iter.tile())) {
+        if (tile->writeEpoch() >= epoch) {
+            rects << tile->extent();
+        }
+        iter.next();
+    }
+
+    return rects;
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
@@ -776,6 +962,80 @@ qint32 KisTiledDataManager::rowStride(qint32 x, qint32 y) const
     return KisTileData::WIDTH * pixelSize();
 }
 
+void KisTiledDataManager::prefetchRect(const QRect &rect) const
+{
+    // the usual case: nothing is swapped out, don't walk the tiles at all
+    if (!KisTileDataStore::instance()->numTilesSwapped()) return;
+
+    const QRect workRect = rect & extent();
+    if (workRect.isEmpty()) return;
+
+    const qint32 firstColumn = xToCol(workRect.left());
+    const qint32 lastColumn = xToCol(workRect.right());
+    const qint32 firstRow = yToRow(workRect.top());
+    const qint32 lastRow = yToRow(workRect.bottom());
+
+    QVector<KisTileData*> swappedTiles;
+
+    for (qint32 row = firstRow; row <= lastRow; ++row) {
+        for (qint32 column = firstColumn; column <= lastColumn; ++column) {
+            KisTileSP tile = m_hashTable->getExistingTile(column, row);
+            if (!tile) continue;
+
+            KisTileData *td = tile->refAndFetchTileData();
+
+            if (!td->data()) {
+                swappedTiles.append(td);
+            } else {
+                td->deref();
+            }
+        }
+    }
+
+    KisTileDataStore::instance()->prefetchTileData(swappedTiles);
+}
+
+void KisTiledDataManager::setEvictionPriority(KisTileData::EvictionPriority priority, qint64 &memorySize, qint64 &swappedSize) const
+{
+    QReadLocker locker(&m_lock);
+
+    memorySize = 0;
+    swappedSize = 0;
+
+    auto accountTileData = [&] (KisTileData *td) {
+        const qint64 size = qint64(KisTileData::WIDTH) * KisTileData::HEIGHT * td->pixelSize();
+
+        if (td->data()) {
+            memorySize += size;
+        } else {
+            swappedSize += size;
+        }
+    };
+
+    KisTileHashTableConstIterator iter(m_hashTable);
+    KisTileSP tile;
+
+    while ((tile = iter.tile())) {
+        KisTileData *td = tile->refAndFetchTileData();
+        td->setEvictionPriority(priority);
+        accountTileData(td);
+        td->deref();
+        iter.next();
+    }
+
+    /**
+     * The history of the device is evicted together with its
+     * current data. The data shared with the current tiles has
+     * already been accounted above.
+     */
+    m_mementoManager->forEachHistoricalTileData([&] (KisTileData *td) {
+        td->setEvictionPriority(priority);
+        if (td->historical()) {
+            accountTileData(td);
+        }
+    });
+}
+
 void KisTiledDataManager::releaseInternalPools()
 {
     KisTileData::releaseInternalPools();
@@ -102,6 +102,14 @@ public:
         }
     }
 
+    /**
+     * A bulk version of getTilesPair(). Fetches the tiles and the old
+     * tiles of \p tileRect (in tile coordinates) in one pass over the
+     * hash table and stores them in the row-major order. Used by the
+     * line iterators to avoid looking up the tiles one-by-one.
+     */
+    void getTilesPairs(const QRect &tileRect, bool writable, QVector<KisTileSP> &tiles, QVector<KisTileSP> &oldTiles);
+
     inline KisTileSP getTile(qint32 col, qint32 row, bool writable) {
         if (writable) {
             bool newTile;
@@ -133,6 +141,7 @@ public:
 
     KisMementoSP getMemento() {
         QWriteLocker locker(&m_lock);
+        mergeDuplicateTileData();
         KisMementoSP memento = m_mementoManager->getMemento();
         memento->saveOldDefaultPixel(m_defaultPixel, m_pixelSize);
         return memento;
@@ -149,6 +158,8 @@ public:
             memento->saveNewDefaultPixel(m_defaultPixel, m_pixelSize);
         }
 
+        shareChangedTileData();
+
         m_mementoManager->commit();
     }
 
@@ -216,6 +227,18 @@ public:
 
     KisRegion region() const;
 
+    /**
+     * Returns the extents of the tiles created or locked for writing
+     * after KisTile::advanceWriteEpoch() has returned \p epoch. The
+     * result is conservative: a tile locked for writing is reported
+     * even if its data hasn't actually been changed. Passing 0 returns
+     * all the tiles of the data manager.
+     *
+     * Unlike region(), the returned rects are not merged, each of them
+     * corresponds to exactly one tile.
+     */
+    QVector<QRect> tileRectsChangedSince(quint64 epoch) const;
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -331,6 +354,27 @@ public:
      */
     qint32 rowStride(qint32 x, qint32 y) const;
 
+    /**
+     * Hint the data manager that the tiles covering \p rect are
+     * going to be read soon. The tiles that are currently swapped
+     * out are loaded back into memory asynchronously by
+     * KisTileDataStore, so the following iteration over the rect
+     * doesn't have to wait for the disk. The call doesn't block
+     * and is a no-op when no tiles are swapped out at all.
+     */
+    void prefetchRect(const QRect &rect) const;
+
+    /**
+     * Marks the tile data of all the tiles of the data manager and
+     * of its undo history with eviction \p priority for the swapper
+     * and accounts their memory: \p memorySize gets the size of the
+     * data present in memory and \p swappedSize the size of the
+     * swapped out data (both in bytes).
+     *
+     * \see KisMemoryStatisticsServer::updateEvictionPriorities()
+     */
+    void setEvictionPriority(KisTileData::EvictionPriority priority, qint64 &memorySize, qint64 &swappedSize) const;
+
 private:
     KisTileHashTable *m_hashTable;
     KisMementoManager *m_mementoManager;
@@ -338,6 +382,17 @@ private:
     qint32 m_pixelSize;
     KisTiledExtentManager m_extentManager;
 
+    /**
+     * The committed tile data waiting for the pooler to find its
+     * duplicate, see mergeDuplicateTileData(). Every tile data in
+     * the queue is referenced. Guarded by m_lock.
+     */
+    struct DeduplicationCandidate {
+        QPoint index;
+        KisTileData *tileData;
+    };
+    QVector<DeduplicationCandidate> m_deduplicationCandidates;
+
     mutable QReadWriteLock m_lock;
 
 private:
@@ -372,6 +427,47 @@ private:
 
     void recalculateExtent();
 
+    /**
+     * Finds the tiles changed in the current transaction that can
+     * share their tile data with other tiles and replaces them with
+     * the tiles referencing the shared data:
+     *
+     * 1) the tiles whose pixels are all the same share the tile data
+     *    of the first tile of this color (or the default tile data of
+     *    the manager if the color is the default pixel)
+     *
+     * 2) the other tiles are queued for the deduplication: the pooler
+     *    hashes their tile data in the background and looks for the
+     *    same content kept in history (of any device, frame or layer).
+     *    The matches found are applied by mergeDuplicateTileData() on
+     *    one of the following commits, so nothing is hashed here.
+     *
+     * Writing into such a tile detaches it through the usual
+     * copy-on-write in KisTile::lockForWrite().
+     *
+     * LOCKING: m_lock should be held in write mode by the caller
+     */
+    void shareChangedTileData();
+
+    /**
+     * Replaces the queued tile data the pooler has already found a
+     * duplicate for with that duplicate, both in the tiles and in the
+     * history, see KisMementoManager::replaceTileData(). The tile data
+     * that hasn't been processed by the pooler yet stays in the queue.
+     *
+     * LOCKING: m_lock should be held in write mode by the caller
+     */
+    void mergeDuplicateTileData();
+
+    /**
+     * Replaces the tile at (\p col, \p row) with a tile referencing
+     * \p td. Used by the tile compressors for installing the tile
+     * data mapped from a file.
+     *
+     * LOCKING: m_lock should be held in write mode by the caller
+     */
+    void setTileDataImpl(qint32 col, qint32 row, KisTileData *td);
+
     quint8* duplicatePixel(qint32 num, const quint8 *pixel);
 
     template<bool useOldSrcData>
@@ -50,10 +50,8 @@ KisVLineIterator2::KisVLineIterator2(KisDataManager *dataManager, qint32 x, qint
 
     m_tileSize = m_lineStride * KisTileData::HEIGHT;
 
-    // let's preallocate first row
-    for (int i = 0; i < m_tilesCacheSize; i++){
-        fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i);
-    }
+    // let's preallocate first column
+    fetchTilesForCache();
     m_index = 0;
     switchToTile(m_topInTopmostTile);
 }
@@ -191,15 +189,26 @@ void KisVLineIterator2::switchToTile(qint32 yInTile)
 }
 
 
-void KisVLineIterator2::fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint32 row)
+void KisVLineIterator2::fetchTilesForCache()
 {
-    m_dataManager->getTilesPair(col, row, m_writable, &kti.tile, &kti.oldtile);
+    m_dataManager->getTilesPairs(QRect(m_column, m_topRow, 1, m_tilesCacheSize),
+                                 m_writable, m_fetchedTiles, m_fetchedOldTiles);
+
+    for (int i = 0; i < m_tilesCacheSize; i++) {
+        KisTileInfo &kti = m_tilesCache[i];
 
-    lockTile(kti.tile);
-    kti.data = kti.tile->data();
+        kti.tile = m_fetchedTiles[i];
+        lockTile(kti.tile);
+        kti.data = kti.tile->data();
+
+        kti.oldtile = m_fetchedOldTiles[i];
+        lockOldTile(kti.oldtile);
+        kti.oldData = kti.oldtile->data();
+    }
 
-    lockOldTile(kti.oldtile);
-    kti.oldData = kti.oldtile->data();
+    // drop the references, but keep the buffers for the next column
+    m_fetchedTiles.clear();
+    m_fetchedOldTiles.clear();
 }
 
 void KisVLineIterator2::preallocateTiles()
@@ -207,8 +216,8 @@ void KisVLineIterator2::preallocateTiles()
     for (int i = 0; i < m_tilesCacheSize; ++i){
         unlockTile(m_tilesCache[i].tile);
         unlockOldTile(m_tilesCache[i].oldtile);
-        fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i );
     }
+    fetchTilesForCache();
 }
 
 qint32 KisVLineIterator2::x() const
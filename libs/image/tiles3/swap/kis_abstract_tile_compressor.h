@@ -90,6 +90,10 @@ protected:
     inline qint32 pixelSize(KisTiledDataManager *dm) {
         return dm->pixelSize();
     }
+
+    inline void setTileData(KisTiledDataManager *dm, qint32 col, qint32 row, KisTileData *td) {
+        dm->setTileDataImpl(col, row, td);
+    }
 };
 
 #endif /* __KIS_ABSTRACT_TILE_COMPRESSOR_H */
@@ -10,12 +10,9 @@
 
 #define GAP_SIZE(low, high) ((high) - (low) > 0 ? (high) - (low) - 1 : 0)
 
-#define HAS_NEXT(list,iter) ((iter)!=(list).end())
 #define HAS_PREVIOUS(list,iter) ((iter)!=(list).begin())
 
-#define PEEK_NEXT(iter) (*(iter))
 #define PEEK_PREVIOUS(iter) (*((iter)-1))
-#define WRAP_PREVIOUS_CHUNK_DATA(iter) (KisChunk((iter)-1))
 
 
 KisChunkAllocator::KisChunkAllocator(quint64 slabSize, quint64 storeSize)
@@ -23,8 +20,10 @@ KisChunkAllocator::KisChunkAllocator(quint64 slabSize, quint64 storeSize)
     m_storeMaxSize = storeSize;
     m_storeSlabSize = slabSize;
 
-    m_iterator = m_list.begin();
     m_storeSize = m_storeSlabSize;
+    m_allocatedSize = 0;
+    addGap(0, m_storeSize, m_list.end());
+
     INIT_FAIL_COUNTER();
 }
 
@@ -34,40 +33,30 @@ KisChunkAllocator::~KisChunkAllocator()
 
 KisChunk KisChunkAllocator::getChunk(quint64 size)
 {
-    KisChunkDataListIterator startPosition = m_iterator;
-    START_COUNTING();
-
     forever {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+        /**
+         * Best fit: the smallest gap that can hold the chunk,
+         * the lowest one if there are several of them
+         */
+        auto it = m_gapsBySize.lower_bound(std::make_pair(size, quint64(0)));
 
-        if(m_iterator == m_list.end())
-            break;
+        if (it != m_gapsBySize.end()) {
+            const quint64 gapSize = it->first;
+            const quint64 gapBegin = it->second;
+            KisChunkDataListIterator next = m_gapsByBegin[gapBegin].next;
 
-        m_iterator++;
-        REGISTER_STEP();
-    }
+            removeGap(gapBegin);
+            KisChunkDataListIterator chunk = m_list.insert(next, KisChunkData(gapBegin, size));
+            addGap(gapBegin + size, gapBegin + gapSize, next);
 
-    REGISTER_FAIL();
-    m_iterator = m_list.begin();
+            m_allocatedSize += size;
 
-    forever {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
-
-        if(m_iterator == m_list.end() || m_iterator == startPosition)
-            break;
-
-        m_iterator++;
-        REGISTER_STEP();
-    }
+            return KisChunk(chunk);
+        }
 
-    REGISTER_FAIL();
-    m_iterator = m_list.end();
+        REGISTER_FAIL();
 
-    while ((m_storeSize += m_storeSlabSize) <= m_storeMaxSize) {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+        if (!growStore()) break;
     }
 
     qFatal("KisChunkAllocator: out of swap space");
@@ -76,40 +65,120 @@ KisChunk KisChunkAllocator::getChunk(quint64 size)
     return KisChunk(m_list.end());
 }
 
-bool KisChunkAllocator::tryInsertChunk(KisChunkDataList &list,
-                                       KisChunkDataListIterator &iterator,
-                                       quint64 size)
+void KisChunkAllocator::freeChunk(KisChunk chunk)
 {
-    bool result = false;
-    quint64 highBound = m_storeSize;
-    quint64 lowBound = 0;
-    quint64 shift = 0;
+    KisChunkDataListIterator position = chunk.position();
+    Q_ASSERT(position->m_begin == chunk.begin());
 
-    if(HAS_NEXT(list, iterator))
-        highBound = PEEK_NEXT(iterator).m_begin;
+    const quint64 gapBegin = endOfPreviousChunk(position);
 
-    if(HAS_PREVIOUS(list, iterator)) {
-        lowBound = PEEK_PREVIOUS(iterator).m_end;
-        shift = 1;
-    }
+    removeGap(gapBegin);
+    removeGap(position->m_end + 1);
 
-    if(GAP_SIZE(lowBound, highBound) >= size) {
-        list.insert(iterator, KisChunkData(lowBound + shift, size));
-        result = true;
-    }
+    m_allocatedSize -= position->size();
 
-    return result;
+    KisChunkDataListIterator next = m_list.erase(position);
+    const quint64 gapEnd = next != m_list.end() ? next->m_begin : m_storeSize;
+
+    addGap(gapBegin, gapEnd, next);
 }
 
-void KisChunkAllocator::freeChunk(KisChunk chunk)
+quint64 KisChunkAllocator::usedSize() const
+{
+    return !m_list.isEmpty() ? m_list.last().m_end + 1 : 0;
+}
+
+qreal KisChunkAllocator::fragmentation() const
+{
+    const quint64 used = usedSize();
+    return used ? qreal(used - m_allocatedSize) / used : 0.0;
+}
+
+bool KisChunkAllocator::findRelocation(KisChunk *chunk, quint64 *newBegin) const
+{
+    if (m_gapsByBegin.empty()) return false;
+
+    auto it = m_gapsByBegin.begin();
+
+    // the tail of the store is always the last gap
+    if (it->second.next == m_list.end()) return false;
+
+    *chunk = KisChunk(it->second.next);
+    *newBegin = it->first;
+
+    return true;
+}
+
+void KisChunkAllocator::relocateChunk(KisChunk chunk, quint64 newBegin)
+{
+    KisChunkDataListIterator position = chunk.position();
+    const quint64 size = position->size();
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(endOfPreviousChunk(position) == newBegin);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(newBegin < position->m_begin);
+
+    removeGap(newBegin);
+    removeGap(position->m_end + 1);
+
+    KisChunkDataListIterator next = position;
+    ++next;
+    const quint64 gapEnd = next != m_list.end() ? next->m_begin : m_storeSize;
+
+    position->setChunk(newBegin, size);
+    addGap(newBegin + size, gapEnd, next);
+}
+
+quint64 KisChunkAllocator::shrinkStore()
 {
-    if(m_iterator != m_list.end() && m_iterator == chunk.position()) {
-        m_iterator = m_list.erase(m_iterator);
-        return;
+    const quint64 used = usedSize();
+    const quint64 newStoreSize =
+        qMax(m_storeSlabSize,
+             (used + m_storeSlabSize - 1) / m_storeSlabSize * m_storeSlabSize);
+
+    if (newStoreSize < m_storeSize) {
+        removeGap(used);
+        m_storeSize = newStoreSize;
+        addGap(used, m_storeSize, m_list.end());
     }
 
-    Q_ASSERT(chunk.position()->m_begin == chunk.begin());
-    m_list.erase(chunk.position());
+    return m_storeSize;
+}
+
+bool KisChunkAllocator::growStore()
+{
+    if (m_storeSize + m_storeSlabSize > m_storeMaxSize) return false;
+
+    const quint64 tailBegin = usedSize();
+
+    removeGap(tailBegin);
+    m_storeSize += m_storeSlabSize;
+    addGap(tailBegin, m_storeSize, m_list.end());
+
+    return true;
+}
+
+void KisChunkAllocator::addGap(quint64 begin, quint64 end, KisChunkDataListIterator next)
+{
+    if (end <= begin) return;
+
+    const quint64 size = end - begin;
+
+    m_gapsByBegin[begin] = Gap{size, next};
+    m_gapsBySize.insert(std::make_pair(size, begin));
+}
+
+void KisChunkAllocator::removeGap(quint64 begin)
+{
+    auto it = m_gapsByBegin.find(begin);
+    if (it == m_gapsByBegin.end()) return;
+
+    m_gapsBySize.erase(std::make_pair(it->second.size, begin));
+    m_gapsByBegin.erase(it);
+}
+
+quint64 KisChunkAllocator::endOfPreviousChunk(KisChunkDataListIterator iterator)
+{
+    return HAS_PREVIOUS(m_list, iterator) ? PEEK_PREVIOUS(iterator).m_end + 1 : 0;
 }
 
 
@@ -152,6 +221,18 @@ bool KisChunkAllocator::sanityCheck(bool pleaseCrash)
         }
     }
 
+    quint64 totalGapsSize = 0;
+    for (auto it = m_gapsByBegin.begin(); it != m_gapsByBegin.end(); ++it) {
+        totalGapsSize += it->second.size;
+    }
+
+    if (totalGapsSize + m_allocatedSize != m_storeSize ||
+        m_gapsByBegin.size() != m_gapsBySize.size()) {
+
+        warnKrita << "The index of free space is inconsistent!";
+        failed = true;
+    }
+
     if(failed && pleaseCrash)
         qFatal("KisChunkAllocator: sanity check failed!");
 
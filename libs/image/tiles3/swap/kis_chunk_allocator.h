@@ -7,6 +7,10 @@
 #ifndef __KIS_CHUNK_LIST_H
 #define __KIS_CHUNK_LIST_H
 
+#include <map>
+#include <set>
+#include <utility>
+
 #include <QLinkedList>
 #include "kritaimage_export.h"
 
@@ -113,6 +117,15 @@ private:
 };
 
 
+/**
+ * Allocates chunks of the swap file.
+ *
+ * The allocated chunks are kept in a list sorted by their offset. The
+ * free space between them (the gaps) is indexed twice: by the size of
+ * the gap, to find the best fitting gap in logarithmic time, and by
+ * its offset, to merge the neighbouring gaps on freeing and to find
+ * the holes for compaction.
+ */
 class KRITAIMAGE_EXPORT KisChunkAllocator
 {
 public:
@@ -127,25 +140,78 @@ public:
     KisChunk getChunk(quint64 size);
     void freeChunk(KisChunk chunk);
 
+    /**
+     * The size of the store, that is, the offset of the end of the
+     * last allocated slab
+     */
+    inline quint64 storeSize() const {
+        return m_storeSize;
+    }
+
+    inline quint64 slabSize() const {
+        return m_storeSlabSize;
+    }
+
+    /**
+     * The offset of the end of the last allocated chunk
+     */
+    quint64 usedSize() const;
+
+    /**
+     * The share of the used part of the store that is
+     * occupied by holes
+     */
+    qreal fragmentation() const;
+
+    /**
+     * Compaction support. Finds the first chunk which has a hole
+     * before it and the offset it should be moved to. Returns false
+     * if the store has no holes, except its tail.
+     *
+     * The caller should copy the data of the chunk to the new
+     * position and then call relocateChunk(). All the KisChunk
+     * objects referring the chunk stay valid after relocation.
+     */
+    bool findRelocation(KisChunk *chunk, quint64 *newBegin) const;
+    void relocateChunk(KisChunk chunk, quint64 newBegin);
+
+    /**
+     * Release the unused slabs at the end of the store.
+     * \return the new size of the store
+     */
+    quint64 shrinkStore();
+
     void debugChunks();
     bool sanityCheck(bool pleaseCrash = true);
     qreal debugFragmentation(bool toStderr = true);
 
 private:
-    bool tryInsertChunk(KisChunkDataList &list,
-                        KisChunkDataListIterator &iterator,
-                        quint64 size);
+    struct Gap {
+        quint64 size;
+        KisChunkDataListIterator next;
+    };
+
+    void addGap(quint64 begin, quint64 end, KisChunkDataListIterator next);
+    void removeGap(quint64 begin);
+    bool growStore();
+    quint64 endOfPreviousChunk(KisChunkDataListIterator iterator);
 
 private:
     quint64 m_storeMaxSize;
     quint64 m_storeSlabSize;
 
-
     KisChunkDataList m_list;
-    KisChunkDataListIterator m_iterator;
     quint64 m_storeSize;
+    quint64 m_allocatedSize;
+
+    /**
+     * Gaps indexed by their offset ([begin, begin + size)) and
+     * by their size ((size, begin) pairs)
+     */
+    std::map<quint64, Gap> m_gapsByBegin;
+    std::set<std::pair<quint64, quint64>> m_gapsBySize;
+
     DECLARE_FAIL_COUNTER()
 };
 
 #endif /* __KIS_CHUNK_ALLOCATOR_H */
-
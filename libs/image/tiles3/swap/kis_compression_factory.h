@@ -0,0 +1,54 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_COMPRESSION_FACTORY_H
+#define __KIS_COMPRESSION_FACTORY_H
+
+#include "kritaimage_export.h"
+#include <QStringList>
+
+class KisAbstractCompression;
+
+/**
+ * Registry of the codecs available for compressing tile data.
+ *
+ * The id of a codec is written into the header of every tile
+ * saved into a .kra file (see KisTileCompressor2), so the ids
+ * must never change and must be not longer than
+ * KisCompressionFactory::MAX_ID_LENGTH characters.
+ */
+class KRITAIMAGE_EXPORT KisCompressionFactory
+{
+public:
+    static const QString LZF;
+    static const QString LZ4;
+    static const QString ZSTD;
+    static const QString NONE;
+
+    static const int MAX_ID_LENGTH = 5;
+
+    /**
+     * Creates a codec with \p id. Returns nullptr if the codec is
+     * unknown or Krita was built without its support. The caller
+     * takes the ownership of the object.
+     */
+    static KisAbstractCompression* create(const QString &id);
+
+    /**
+     * Returns true if a codec with \p id can be created
+     */
+    static bool isAvailable(const QString &id);
+
+    /**
+     * Returns ids of all codecs supported by this build
+     */
+    static QStringList availableCompressions();
+
+private:
+    KisCompressionFactory();
+};
+
+#endif /* __KIS_COMPRESSION_FACTORY_H */
@@ -65,6 +65,21 @@ quint8* KisMemoryWindow::getWriteChunkPtr(const KisChunkData &writeChunk)
     return m_writeWindowEx.calculatePointer(writeChunk);
 }
 
+bool KisMemoryWindow::truncate(quint64 size)
+{
+    if (!m_valid || (quint64)m_file.size() <= size) return true;
+
+    for (MappingWindow *window : {&m_readWindowEx, &m_writeWindowEx}) {
+        if (window->window) {
+            m_file.unmap(window->window);
+            window->window = 0;
+        }
+        window->chunk.setChunk(0, 0);
+    }
+
+    return m_file.resize(size);
+}
+
 bool KisMemoryWindow::adjustWindow(const KisChunkData &requestedChunk,
                                    MappingWindow *adjustingWindow,
                                    MappingWindow *otherWindow)
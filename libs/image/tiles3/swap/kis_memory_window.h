@@ -35,6 +35,13 @@ public:
     quint8* getReadChunkPtr(const KisChunkData &readChunk);
     quint8* getWriteChunkPtr(const KisChunkData &writeChunk);
 
+    /**
+     * Shrinks the swap file to \p size bytes, if it is bigger. All
+     * the mappings are released, so the pointers returned by
+     * getReadChunkPtr() and getWriteChunkPtr() become invalid.
+     */
+    bool truncate(quint64 size);
+
 private:
     struct MappingWindow {
         MappingWindow(quint64 _defaultSize)
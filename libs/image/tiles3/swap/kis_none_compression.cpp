@@ -0,0 +1,39 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_none_compression.h"
+
+#include <string.h>
+
+
+KisNoneCompression::KisNoneCompression()
+{
+}
+
+KisNoneCompression::~KisNoneCompression()
+{
+}
+
+qint32 KisNoneCompression::compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    if (inputLength > outputLength) return 0;
+
+    memcpy(output, input, inputLength);
+    return inputLength;
+}
+
+qint32 KisNoneCompression::decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength)
+{
+    if (inputLength > outputLength) return 0;
+
+    memcpy(output, input, inputLength);
+    return inputLength;
+}
+
+qint32 KisNoneCompression::outputBufferSize(qint32 dataSize)
+{
+    return dataSize;
+}
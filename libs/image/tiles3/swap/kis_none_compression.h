@@ -0,0 +1,31 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_NONE_COMPRESSION_H
+#define __KIS_NONE_COMPRESSION_H
+
+#include "kis_abstract_compression.h"
+
+/**
+ * A codec that doesn't compress anything. The "compressed" data is
+ * never smaller than the source, so KisTileCompressor2 stores every
+ * tile raw, in the same layout as it has in memory. Such tiles can
+ * be mapped into memory directly from the file, without any copying
+ * (see KisTileFileMapping).
+ */
+class KRITAIMAGE_EXPORT KisNoneCompression : public KisAbstractCompression
+{
+public:
+    KisNoneCompression();
+    ~KisNoneCompression() override;
+
+    qint32 compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+    qint32 decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+
+    qint32 outputBufferSize(qint32 dataSize) override;
+};
+
+#endif /* __KIS_NONE_COMPRESSION_H */
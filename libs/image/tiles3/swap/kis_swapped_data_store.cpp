@@ -11,8 +11,73 @@
 
 #include "kis_tile_compressor_2.h"
 
+#include <QRunnable>
+
 //#define COMPRESSOR_VERSION 2
 
+/**
+ * Batches smaller than this are compressed in the calling thread,
+ * since waking up the workers costs more than compressing a few tiles
+ */
+static const int MIN_PARALLEL_BATCH_SIZE = 8;
+
+/**
+ * The swap file is compacted only when the holes take more than this
+ * share of it and, at the same time, more than a slab of the store
+ */
+static const qreal COMPACTION_FRAGMENTATION_THRESHOLD = 0.25;
+
+/**
+ * The number of chunks relocated under a single lock of the store
+ */
+static const int COMPACTION_STEP_SIZE = 64;
+
+const quint64 KisSwappedDataStore::COMPACTION_MAX_BYTES = 64 * MiB;
+
+struct KisSwappedDataStore::CompressedTile
+{
+    QByteArray buffer;
+    qint32 size = 0;
+};
+
+class KisSwappedDataStore::CompressionJob : public QRunnable
+{
+public:
+    CompressionJob(KisAbstractTileCompressor *compressor,
+                   const QVector<KisTileData*> &tiles,
+                   QVector<CompressedTile> &compressedTiles,
+                   int begin, int end)
+        : m_compressor(compressor),
+          m_tiles(tiles),
+          m_compressedTiles(compressedTiles),
+          m_begin(begin),
+          m_end(end)
+    {
+    }
+
+    void run() override {
+        for (int i = m_begin; i < m_end; i++) {
+            KisTileData *td = m_tiles[i];
+            CompressedTile &result = m_compressedTiles[i];
+
+            const qint32 expectedBufferSize = m_compressor->tileDataBufferSize(td);
+            if (result.buffer.size() < expectedBufferSize) {
+                result.buffer.resize(expectedBufferSize);
+            }
+
+            m_compressor->compressTileData(td, (quint8*) result.buffer.data(),
+                                           result.buffer.size(), result.size);
+        }
+    }
+
+private:
+    KisAbstractTileCompressor *m_compressor;
+    const QVector<KisTileData*> &m_tiles;
+    QVector<CompressedTile> &m_compressedTiles;
+    int m_begin;
+    int m_end;
+};
+
 KisSwappedDataStore::KisSwappedDataStore()
     : m_totalSwapMemoryUsed(0)
 {
@@ -24,12 +89,21 @@ KisSwappedDataStore::KisSwappedDataStore()
     m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize);
     m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
 
-    // FIXME: use a factory after the patch is committed
-    m_compressor = new KisTileCompressor2();
+    m_compressor = new KisTileCompressor2(config.swapCompressionType());
+
+    const int numWorkers = qMax(1, config.maxNumberOfThreads());
+    m_compressionPool.setMaxThreadCount(numWorkers);
+
+    for (int i = 0; i < numWorkers; i++) {
+        m_workerCompressors << new KisTileCompressor2(config.swapCompressionType());
+    }
 }
 
 KisSwappedDataStore::~KisSwappedDataStore()
 {
+    m_compressionPool.waitForDone();
+    qDeleteAll(m_workerCompressors);
+
     delete m_compressor;
     delete m_swapSpace;
     delete m_allocator;
@@ -61,13 +135,92 @@ bool KisSwappedDataStore::trySwapOutTileData(KisTileData *td)
     qint32 bytesWritten;
     m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
 
-    KisChunk chunk = m_allocator->getChunk(bytesWritten);
+    return commitSwapChunk(td, (quint8*) m_buffer.data(), bytesWritten);
+}
+
+int KisSwappedDataStore::trySwapOutTileData(const QVector<KisTileData*> &tiles, QVector<bool> &swappedOut)
+{
+    swappedOut.fill(false, tiles.size());
+    if (tiles.isEmpty()) return 0;
+
+    /**
+     * The compression step doesn't touch the allocator and the swap
+     * file, so it is done without holding m_lock. The workers' state
+     * is protected by a separate lock.
+     */
+    QMutexLocker batchLocker(&m_batchLock);
+
+    QVector<CompressedTile> compressedTiles(tiles.size());
+    compressTilesParallel(tiles, compressedTiles);
+
+    /**
+     * The single writer: allocate chunks and commit the data
+     */
+    QMutexLocker locker(&m_lock);
+
+    int numSwappedOut = 0;
+
+    for (int i = 0; i < tiles.size(); i++) {
+        KisTileData *td = tiles[i];
+        Q_ASSERT(td->data());
+
+        const CompressedTile &compressed = compressedTiles[i];
+
+        if (commitSwapChunk(td, (const quint8*) compressed.buffer.constData(), compressed.size)) {
+            swappedOut[i] = true;
+            numSwappedOut++;
+        }
+    }
+
+    return numSwappedOut;
+}
+
+void KisSwappedDataStore::compressTilesParallel(const QVector<KisTileData*> &tiles,
+                                                QVector<CompressedTile> &compressedTiles)
+{
+    const int numWorkers =
+        tiles.size() >= MIN_PARALLEL_BATCH_SIZE ?
+            qMin(m_workerCompressors.size(), tiles.size()) : 1;
+
+    if (numWorkers <= 1) {
+        CompressionJob job(m_workerCompressors.first(), tiles, compressedTiles, 0, tiles.size());
+        job.run();
+        return;
+    }
+
+    const int tilesPerWorker = tiles.size() / numWorkers;
+    const int extraTiles = tiles.size() % numWorkers;
+
+    int begin = 0;
+
+    for (int i = 0; i < numWorkers; i++) {
+        const int end = begin + tilesPerWorker + (i < extraTiles ? 1 : 0);
+
+        CompressionJob *job =
+            new CompressionJob(m_workerCompressors[i], tiles, compressedTiles, begin, end);
+        job->setAutoDelete(true);
+        m_compressionPool.start(job);
+
+        begin = end;
+    }
+
+    m_compressionPool.waitForDone();
+}
+
+bool KisSwappedDataStore::commitSwapChunk(KisTileData *td, const quint8 *data, qint32 size)
+{
+    /**
+     * LOCKING: m_lock should be held by the caller
+     */
+
+    KisChunk chunk = m_allocator->getChunk(size);
     quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
     if (!ptr) {
         qWarning() << "swap out of tile failed";
+        m_allocator->freeChunk(chunk);
         return false;
     }
-    memcpy(ptr, m_buffer.data(), bytesWritten);
+    memcpy(ptr, data, size);
 
     td->releaseMemory();
     td->setSwapChunk(chunk);
@@ -106,6 +259,94 @@ void KisSwappedDataStore::forgetTileData(KisTileData *td)
     td->setSwapChunk(KisChunk());
 }
 
+int KisSwappedDataStore::compact(quint64 maxBytesMoved)
+{
+    {
+        QMutexLocker locker(&m_lock);
+
+        const qreal fragmentation = m_allocator->fragmentation();
+        const quint64 wastedSize = fragmentation * m_allocator->usedSize();
+
+        if (fragmentation < COMPACTION_FRAGMENTATION_THRESHOLD ||
+            wastedSize < m_allocator->slabSize()) {
+
+            shrinkSwapFile();
+            return 0;
+        }
+    }
+
+    int numChunksMoved = 0;
+    quint64 bytesMoved = 0;
+    bool finished = false;
+
+    while (!finished && bytesMoved < maxBytesMoved) {
+        QMutexLocker locker(&m_lock);
+
+        for (int i = 0; i < COMPACTION_STEP_SIZE; i++) {
+            KisChunk chunk;
+            quint64 newBegin = 0;
+
+            if (!m_allocator->findRelocation(&chunk, &newBegin) ||
+                !moveSwapChunk(chunk, newBegin)) {
+
+                finished = true;
+                break;
+            }
+
+            m_allocator->relocateChunk(chunk, newBegin);
+
+            bytesMoved += chunk.size();
+            numChunksMoved++;
+        }
+    }
+
+    QMutexLocker locker(&m_lock);
+    shrinkSwapFile();
+
+    return numChunksMoved;
+}
+
+bool KisSwappedDataStore::moveSwapChunk(KisChunk chunk, quint64 newBegin)
+{
+    /**
+     * LOCKING: m_lock should be held by the caller
+     *
+     * The source and the destination may overlap in the file, and
+     * remapping one window may invalidate the other one, so the data
+     * is copied through the intermediate buffer.
+     */
+
+    const qint32 size = chunk.size();
+
+    quint8 *src = m_swapSpace->getReadChunkPtr(chunk);
+    if (!src) return false;
+
+    if (m_buffer.size() < size) {
+        m_buffer.resize(size);
+    }
+    memcpy(m_buffer.data(), src, size);
+
+    quint8 *dst = m_swapSpace->getWriteChunkPtr(KisChunkData(newBegin, size));
+    if (!dst) return false;
+
+    memcpy(dst, m_buffer.constData(), size);
+
+    return true;
+}
+
+void KisSwappedDataStore::shrinkSwapFile()
+{
+    /**
+     * LOCKING: m_lock should be held by the caller
+     */
+
+    const quint64 storeSize = m_allocator->shrinkStore();
+
+    if (!m_swapSpace->truncate(storeSize)) {
+        qWarning() << "failed to truncate the swap file";
+    }
+}
+
 qint64 KisSwappedDataStore::totalSwapMemoryUsed() const
 {
     return m_totalSwapMemoryUsed;
@@ -11,11 +11,14 @@
 
 #include <QMutex>
 #include <QByteArray>
+#include <QVector>
+#include <QThreadPool>
 
 
 class QMutex;
 class KisTileData;
 class KisAbstractTileCompressor;
+class KisChunk;
 class KisChunkAllocator;
 class KisMemoryWindow;
 
@@ -38,6 +41,23 @@ public:
      */
     bool trySwapOutTileData(KisTileData *td);
 
+    /**
+     * Swap out a batch of tile data objects. The tiles are compressed
+     * in parallel by a pool of worker threads, each having its own
+     * compressor, and then a single writer (the calling thread)
+     * allocates the chunks in the swap file and commits the data.
+     *
+     * \p swappedOut is resized to the size of \p tiles and its
+     * elements are set to true for the tiles that have been swapped
+     * out successfully.
+     *
+     * \return the number of swapped out tiles
+     *
+     * LOCKING: the locks on all the tile data objects should be
+     *          taken by the caller before making a call.
+     */
+    int trySwapOutTileData(const QVector<KisTileData*> &tiles, QVector<bool> &swappedOut);
+
     /**
      * Restore the data of a \a td basing on information
      * stored in the swap file.
@@ -59,15 +79,50 @@ public:
      */
     qint64 totalSwapMemoryUsed() const;
 
+    /**
+     * Defragment the swap file: move the swapped-out chunks toward
+     * the beginning of the file and truncate its unused tail. The
+     * relocation is skipped if the file is not fragmented enough.
+     *
+     * Not more than \p maxBytesMoved bytes are relocated per call.
+     * The work is split into small steps and the lock is released
+     * between them, so the swap-in requests don't wait for the
+     * whole pass.
+     *
+     * \return the number of relocated chunks
+     */
+    int compact(quint64 maxBytesMoved = COMPACTION_MAX_BYTES);
+
     /**
      * Some debugging output
      */
     void debugStatistics();
 
+private:
+    struct CompressedTile;
+    class CompressionJob;
+
+    void compressTilesParallel(const QVector<KisTileData*> &tiles,
+                               QVector<CompressedTile> &compressedTiles);
+    bool commitSwapChunk(KisTileData *td, const quint8 *data, qint32 size);
+    bool moveSwapChunk(KisChunk chunk, quint64 newBegin);
+    void shrinkSwapFile();
+
+public:
+    static const quint64 COMPACTION_MAX_BYTES;
+
 private:
     QByteArray m_buffer;
     KisAbstractTileCompressor *m_compressor;
 
+    /**
+     * Compressors owned by the workers of the parallel swap-out.
+     * Guarded by m_batchLock.
+     */
+    QVector<KisAbstractTileCompressor*> m_workerCompressors;
+    QThreadPool m_compressionPool;
+    QMutex m_batchLock;
+
     KisChunkAllocator *m_allocator;
     KisMemoryWindow *m_swapSpace;
 
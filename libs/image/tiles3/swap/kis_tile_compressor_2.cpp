@@ -5,24 +5,55 @@
  */
 
 #include "kis_tile_compressor_2.h"
-#include "kis_lzf_compression.h"
+#include "kis_abstract_compression.h"
+#include "kis_compression_factory.h"
+#include "kis_tile_file_mapping.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "kis_image_config.h"
 #include <QIODevice>
 #include "kis_paint_device_writer.h"
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
-const QString KisTileCompressor2::m_compressionName = "LZF";
 
-
-KisTileCompressor2::KisTileCompressor2()
+KisTileCompressor2::KisTileCompressor2(const QString &compressionName)
+    : m_compression(0),
+      m_readCompression(0),
+      m_mappedDevice(0)
 {
-    m_compression = new KisLzfCompression();
+    m_compressionName = !compressionName.isEmpty() ? compressionName : KisCompressionFactory::LZF;
+    m_compression = KisCompressionFactory::create(m_compressionName);
+
+    if (!m_compression) {
+        warnTiles << "Tile compression" << m_compressionName
+                  << "is not supported by this build, falling back to LZF";
+
+        m_compressionName = KisCompressionFactory::LZF;
+        m_compression = KisCompressionFactory::create(m_compressionName);
+    }
 }
 
 KisTileCompressor2::~KisTileCompressor2()
 {
+    delete m_readCompression;
     delete m_compression;
 }
 
+QString KisTileCompressor2::compressionName() const
+{
+    return m_compressionName;
+}
+
+bool KisTileCompressor2::switchCompression(const QString &compressionName)
+{
+    if (compressionName == m_readCompressionName) return m_readCompression;
+
+    delete m_readCompression;
+    m_readCompression = KisCompressionFactory::create(compressionName);
+    m_readCompressionName = compressionName;
+
+    return m_readCompression;
+}
+
 bool KisTileCompressor2::writeTile(KisTileSP tile, KisPaintDeviceWriter &store)
 {
     const qint32 tileDataSize = TILE_DATA_SIZE(tile->pixelSize());
@@ -63,23 +94,69 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
         qint32 dataSize = headerItems.takeFirst().toInt();
 
         Q_ASSERT(headerItems.isEmpty());
-        Q_ASSERT(compressionName == m_compressionName);
+
+        if (dataSize > m_streamingBuffer.size()) {
+            warnFile << "Corrupted tile header:" << header;
+            return false;
+        }
 
         qint32 row = yToRow(dm, y);
         qint32 col = xToCol(dm, x);
 
-        KisTileSP tile = dm->getTile(col, row, true);
+        if (dataSize == tileDataSize + 1 &&
+            tryMapTileData(stream, dm, col, row, dataSize)) {
+
+            return true;
+        }
 
         stream->read(m_streamingBuffer.data(), dataSize);
 
+        if (!switchCompression(compressionName)) {
+            warnFile << "Unsupported tile compression:" << compressionName;
+            return false;
+        }
+
+        KisTileSP tile = dm->getTile(col, row, true);
+
         tile->lockForWrite();
-        bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
+        bool res = decompressTileDataImpl(m_readCompression,
+                                          (quint8*)m_streamingBuffer.data(), dataSize,
+                                          tile->tileData());
         tile->unlockForWrite();
         return res;
     }
     return false;
 }
 
+bool KisTileCompressor2::tryMapTileData(QIODevice *stream, KisTiledDataManager *dm,
+                                        qint32 col, qint32 row, qint32 dataSize)
+{
+    if (stream != m_mappedDevice) {
+        m_mappedDevice = stream;
+        m_mapping = KisImageConfig(true).mapUncompressedTileFiles() ?
+            KisTileFileMapping::create(stream) : KisTileFileMappingSP();
+    }
+
+    if (!m_mapping) return false;
+
+    const qint64 offset = stream->pos();
+    if (offset < 0 || offset + dataSize > m_mapping->size()) return false;
+
+    quint8 *buffer = m_mapping->data(offset);
+    if (buffer[0] != RAW_DATA_FLAG) return false;
+
+    const qint32 pixelSize = this->pixelSize(dm);
+    quint8 *pixels = buffer + 1;
+
+    if (!KisTileFileMapping::isAligned(pixels, pixelSize)) return false;
+    if (!stream->seek(offset + dataSize)) return false;
+
+    KisTileData *td = KisTileDataStore::instance()->createFileMappedTileData(pixelSize, pixels, m_mapping);
+    setTileData(dm, col, row, td);
+
+    return true;
+}
+
 void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
 {
     /**
@@ -122,7 +199,7 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
     compressedBytes = m_compression->compress((quint8*)m_linearizationBuffer.data(), tileDataSize,
                                               (quint8*)m_compressionBuffer.data(), m_compressionBuffer.size());
 
-    if(compressedBytes < tileDataSize) {
+    if(compressedBytes > 0 && compressedBytes < tileDataSize) {
         buffer[0] = COMPRESSED_DATA_FLAG;
         memcpy(buffer + 1, m_compressionBuffer.data(), compressedBytes);
         bytesWritten = compressedBytes + 1;
@@ -137,6 +214,14 @@ void KisTileCompressor2::compressTileData(KisTileData *tileData,
 bool KisTileCompressor2::decompressTileData(quint8 *buffer,
                                             qint32 bufferSize,
                                             KisTileData *tileData)
+{
+    return decompressTileDataImpl(m_compression, buffer, bufferSize, tileData);
+}
+
+bool KisTileCompressor2::decompressTileDataImpl(KisAbstractCompression *compression,
+                                                quint8 *buffer,
+                                                qint32 bufferSize,
+                                                KisTileData *tileData)
 {
     const qint32 pixelSize = tileData->pixelSize();
     const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize);
@@ -145,8 +230,8 @@ bool KisTileCompressor2::decompressTileData(quint8 *buffer,
         prepareWorkBuffers(tileDataSize);
 
         qint32 bytesWritten;
-        bytesWritten = m_compression->decompress(buffer + 1, bufferSize - 1,
-                                                 (quint8*)m_linearizationBuffer.data(), tileDataSize);
+        bytesWritten = compression->decompress(buffer + 1, bufferSize - 1,
+                                               (quint8*)m_linearizationBuffer.data(), tileDataSize);
         if (bytesWritten == tileDataSize) {
             KisAbstractCompression::delinearizeColors((quint8*)m_linearizationBuffer.data(),
                                                       tileData->data(),
@@ -171,7 +256,7 @@ qint32 KisTileCompressor2::tileDataBufferSize(KisTileData *tileData)
 inline qint32 KisTileCompressor2::maxHeaderLength()
 {
     static const qint32 QINT32_LENGTH = 11;
-    static const qint32 COMPRESSION_NAME_LENGTH = 5;
+    static const qint32 COMPRESSION_NAME_LENGTH = KisCompressionFactory::MAX_ID_LENGTH;
     static const qint32 SEPARATORS_LENGTH = 4;
 
     return 3 * QINT32_LENGTH + COMPRESSION_NAME_LENGTH + SEPARATORS_LENGTH;
@@ -8,15 +8,32 @@
 #define __KIS_TILE_COMPRESSOR_2_H
 
 #include "kis_abstract_tile_compressor.h"
+#include "kis_tile_file_mapping.h"
 
 class KisAbstractCompression;
 
+/**
+ * Version 2 of the tiles stream. Every tile is written with a header
+ * containing the id of the codec used for it (see KisCompressionFactory),
+ * so the stream can be read back independently of the codec selected
+ * for writing.
+ */
 class KRITAIMAGE_EXPORT KisTileCompressor2 : public KisAbstractTileCompressor
 {
 public:
-    KisTileCompressor2();
+    /**
+     * Creates a compressor writing tiles with codec \p compressionName.
+     * If the codec is not supported by the current build, LZF is used
+     * instead.
+     */
+    KisTileCompressor2(const QString &compressionName = QString());
     ~KisTileCompressor2() override;
 
+    /**
+     * The id of the codec used for compression of the tiles
+     */
+    QString compressionName() const;
+
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
     bool readTile(QIODevice *io, KisTiledDataManager *dm) override;
 
@@ -37,6 +54,20 @@ private:
     void prepareWorkBuffers(qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
+    bool switchCompression(const QString &compressionName);
+
+    /**
+     * If \p stream is a regular file and the tile is stored raw, maps
+     * the tile data directly from the file instead of copying it.
+     * Returns false if the tile should be read in a usual way.
+     */
+    bool tryMapTileData(QIODevice *stream, KisTiledDataManager *dm,
+                        qint32 col, qint32 row, qint32 dataSize);
+
+    bool decompressTileDataImpl(KisAbstractCompression *compression,
+                                quint8 *buffer, qint32 bufferSize,
+                                KisTileData *tileData);
+
 private:
     static const qint8 RAW_DATA_FLAG = 0;
     static const qint8 COMPRESSED_DATA_FLAG = 1;
@@ -46,7 +77,23 @@ private:
     QByteArray m_compressionBuffer;
     QByteArray m_streamingBuffer;
     KisAbstractCompression *m_compression;
-    static const QString m_compressionName;
+    QString m_compressionName;
+
+    /**
+     * The stream may contain tiles written with a codec different
+     * from m_compression, so we keep a separate one for reading.
+     * It is (re)created lazily when a tile header with a new codec
+     * id is encountered.
+     */
+    KisAbstractCompression *m_readCompression;
+    QString m_readCompressionName;
+
+    /**
+     * The mapping of the file being read, created on the first
+     * readTile() call for the stream.
+     */
+    QIODevice *m_mappedDevice;
+    KisTileFileMappingSP m_mapping;
 };
 
 #endif /* __KIS_TILE_COMPRESSOR_2_H */
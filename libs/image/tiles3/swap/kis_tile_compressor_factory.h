@@ -13,13 +13,19 @@
 class KRITAIMAGE_EXPORT KisTileCompressorFactory
 {
 public:
-    static KisAbstractTileCompressorSP create(qint32 version) {
+    /**
+     * Creates a compressor for the tiles stream of \p version.
+     * \p compressionName is the id of the codec used for writing
+     * the tiles (only for version 2, see KisCompressionFactory).
+     * When reading, the codec is selected by the tile headers.
+     */
+    static KisAbstractTileCompressorSP create(qint32 version, const QString &compressionName = QString()) {
         switch(version) {
         case 1:
             return KisAbstractTileCompressorSP(new KisLegacyTileCompressor());
             break;
         case 2:
-            return KisAbstractTileCompressorSP(new KisTileCompressor2());
+            return KisAbstractTileCompressorSP(new KisTileCompressor2(compressionName));
             break;
         default:
             qFatal("Unknown version of the tiles");
@@ -0,0 +1,139 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "tiles3/swap/kis_tile_data_prefetcher.h"
+
+#include <QMutex>
+#include <QQueue>
+#include <QSemaphore>
+#include <QWaitCondition>
+
+#include "tiles3/kis_tile_data.h"
+#include "kis_debug.h"
+
+/**
+ * Limits the amount of tile data objects kept alive by the queue:
+ * 4096 tiles are 64 MiB of RGBA8 data
+ */
+const qint32 KisTileDataPrefetcher::MAX_QUEUE_SIZE = 4096;
+
+
+struct Q_DECL_HIDDEN KisTileDataPrefetcher::Private
+{
+    QMutex queueLock;
+    QQueue<KisTileData*> queue;
+    QWaitCondition queueEmptied;
+    bool isProcessing = false;
+
+    QSemaphore semaphore;
+    QAtomicInt shouldExitFlag;
+};
+
+KisTileDataPrefetcher::KisTileDataPrefetcher()
+    : QThread(),
+      m_d(new Private())
+{
+    m_d->shouldExitFlag = 0;
+}
+
+KisTileDataPrefetcher::~KisTileDataPrefetcher()
+{
+    delete m_d;
+}
+
+void KisTileDataPrefetcher::prefetch(const QVector<KisTileData*> &tiles)
+{
+    if (tiles.isEmpty()) return;
+
+    {
+        QMutexLocker l(&m_d->queueLock);
+
+        if (m_d->queue.size() + tiles.size() <= MAX_QUEUE_SIZE &&
+            !m_d->shouldExitFlag) {
+
+            Q_FOREACH (KisTileData *td, tiles) {
+                m_d->queue.enqueue(td);
+            }
+
+            m_d->semaphore.release();
+            return;
+        }
+    }
+
+    releaseTiles(tiles);
+}
+
+void KisTileDataPrefetcher::terminatePrefetcher()
+{
+    unsigned long exitTimeout = 100;
+    do {
+        m_d->shouldExitFlag = true;
+        m_d->semaphore.release();
+    } while(!wait(exitTimeout));
+
+    QVector<KisTileData*> pendingTiles;
+
+    {
+        QMutexLocker l(&m_d->queueLock);
+        pendingTiles = m_d->queue.toVector();
+        m_d->queue.clear();
+    }
+
+    releaseTiles(pendingTiles);
+}
+
+void KisTileDataPrefetcher::testingWaitForIdle()
+{
+    QMutexLocker l(&m_d->queueLock);
+
+    while (!m_d->queue.isEmpty() || m_d->isProcessing) {
+        m_d->queueEmptied.wait(&m_d->queueLock);
+    }
+}
+
+void KisTileDataPrefetcher::releaseTiles(const QVector<KisTileData*> &tiles)
+{
+    Q_FOREACH (KisTileData *td, tiles) {
+        td->deref();
+    }
+}
+
+void KisTileDataPrefetcher::run()
+{
+    while (1) {
+        m_d->semaphore.acquire();
+
+        if (m_d->shouldExitFlag)
+            return;
+
+        while (1) {
+            KisTileData *td = 0;
+
+            {
+                QMutexLocker l(&m_d->queueLock);
+
+                if (m_d->queue.isEmpty() || m_d->shouldExitFlag) {
+                    m_d->isProcessing = false;
+                    m_d->queueEmptied.wakeAll();
+                    break;
+                }
+
+                td = m_d->queue.dequeue();
+                m_d->isProcessing = true;
+            }
+
+            /**
+             * Loading goes through the usual access path, so the
+             * tile is also marked as "young" and the swapper will
+             * not push it back to disk right away.
+             */
+            td->blockSwapping();
+            td->unblockSwapping();
+
+            td->deref();
+        }
+    }
+}
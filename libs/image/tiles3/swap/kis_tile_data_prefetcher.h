@@ -0,0 +1,66 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KIS_TILE_DATA_PREFETCHER_H_
+#define KIS_TILE_DATA_PREFETCHER_H_
+
+#include <QThread>
+#include <QVector>
+
+#include "kritaimage_export.h"
+
+
+class KisTileData;
+
+/**
+ * A background thread that loads swapped-out tile data objects back
+ * into memory before they are actually accessed (read-ahead).
+ *
+ * The users enqueue the tile data objects they are going to read
+ * soon (see KisTiledDataManager::prefetchRect()), so that the first
+ * access to the tile doesn't wait for the disk and decompression in
+ * KisTileDataStore::ensureTileDataLoaded().
+ */
+class KRITAIMAGE_EXPORT KisTileDataPrefetcher : public QThread
+{
+    Q_OBJECT
+
+public:
+    KisTileDataPrefetcher();
+    ~KisTileDataPrefetcher() override;
+
+    /**
+     * Enqueue \p tiles for loading. The prefetcher takes the ownership
+     * of one reference of every tile data in the list, that is, the
+     * caller should ref() each of them beforehand. The references are
+     * released after the data is loaded.
+     *
+     * If the queue is overfull, the request is silently dropped: the
+     * prefetching is only a hint and the tiles will be loaded on the
+     * first access anyway.
+     */
+    void prefetch(const QVector<KisTileData*> &tiles);
+
+    void terminatePrefetcher();
+
+    /**
+     * Blocks until all the enqueued tile data objects are processed
+     */
+    void testingWaitForIdle();
+
+private:
+    void run() override;
+
+    void releaseTiles(const QVector<KisTileData*> &tiles);
+
+private:
+    static const qint32 MAX_QUEUE_SIZE;
+
+private:
+    struct Private;
+    Private * const m_d;
+};
+
+#endif /* KIS_TILE_DATA_PREFETCHER_H_ */
@@ -17,6 +17,7 @@
 
 const qint32 KisTileDataSwapper::TIMEOUT = -1;
 const qint32 KisTileDataSwapper::DELAY = 0.7 * SEC;
+const qint32 KisTileDataSwapper::SWAP_BATCH_SIZE = 256;
 
 //#define DEBUG_SWAPPER
 
@@ -30,6 +31,7 @@ const qint32 KisTileDataSwapper::DELAY = 0.7 * SEC;
 
 class SoftSwapStrategy;
 class AggressiveSwapStrategy;
+template <KisTileData::EvictionPriority priority> class EvictionPrioritySwapStrategy;
 
 
 struct Q_DECL_HIDDEN KisTileDataSwapper::Private
@@ -85,6 +87,13 @@ void KisTileDataSwapper::run()
         QThread::msleep(DELAY);
 
         doJob();
+
+        /**
+         * Compaction is done by the swapper thread only, the
+         * emergency swap-outs in doJob() should be as fast as
+         * possible
+         */
+        m_d->store->compactSwap();
     }
 }
 
@@ -115,12 +124,32 @@ void KisTileDataSwapper::doJob()
 
 
     if(memoryMetric > m_d->limits.softLimitThreshold()) {
-        qint32 softFree =  memoryMetric - m_d->limits.softLimit();
-        DEBUG_VALUE(softFree);
-        DEBUG_ACTION("\t pass0");
-        memoryMetric -= pass<SoftSwapStrategy>(softFree);
+        /**
+         * The data of the background images and of the inactive
+         * frames goes first, then the history of the active image
+         */
+        qint32 backgroundFree = memoryMetric - m_d->limits.softLimit();
+        DEBUG_VALUE(backgroundFree);
+        DEBUG_ACTION("\t pass0 (background images)");
+        memoryMetric -= pass<EvictionPrioritySwapStrategy<KisTileData::BACKGROUND_IMAGE>>(backgroundFree);
         DEBUG_VALUE(memoryMetric);
 
+        if(memoryMetric > m_d->limits.softLimit()) {
+            qint32 framesFree = memoryMetric - m_d->limits.softLimit();
+            DEBUG_VALUE(framesFree);
+            DEBUG_ACTION("\t pass0 (inactive frames)");
+            memoryMetric -= pass<EvictionPrioritySwapStrategy<KisTileData::INACTIVE_FRAME>>(framesFree);
+            DEBUG_VALUE(memoryMetric);
+        }
+
+        if(memoryMetric > m_d->limits.softLimit()) {
+            qint32 softFree =  memoryMetric - m_d->limits.softLimit();
+            DEBUG_VALUE(softFree);
+            DEBUG_ACTION("\t pass0");
+            memoryMetric -= pass<SoftSwapStrategy>(softFree);
+            DEBUG_VALUE(memoryMetric);
+        }
+
         if(memoryMetric > m_d->limits.hardLimitThreshold()) {
             qint32 hardFree =  memoryMetric - m_d->limits.hardLimit();
             DEBUG_VALUE(hardFree);
@@ -132,6 +161,30 @@ void KisTileDataSwapper::doJob()
 }
 
 
+template <KisTileData::EvictionPriority priority>
+class EvictionPrioritySwapStrategy
+{
+public:
+    typedef KisTileDataStoreIterator iterator;
+
+    static inline iterator* beginIteration(KisTileDataStore *store) {
+        return store->beginIteration();
+    }
+
+    static inline void endIteration(KisTileDataStore *store, iterator *iter) {
+        store->endIteration(iter);
+    }
+
+    static inline bool isInteresting(KisTileData *td) {
+        // The priorities are assigned by KisMemoryStatisticsServer
+        return td->evictionPriority() >= priority;
+    }
+
+    static inline bool swapOutFirst(KisTileData *td) {
+        return td->age() > 0;
+    }
+};
+
 class SoftSwapStrategy
 {
 public:
@@ -186,9 +239,38 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
     qint64 freedMetric = 0;
     QList<KisTileData*> additionalCandidates;
 
+    /**
+     * The tiles are swapped out in batches, so that they could be
+     * compressed in parallel by the swapped data store. The batch is
+     * flushed when it is full or when it is already enough to reach
+     * the target.
+     */
+    QVector<KisTileData*> batch;
+    qint64 batchMetric = 0;
+    batch.reserve(SWAP_BATCH_SIZE);
+
     typename strategy::iterator *iter =
         strategy::beginIteration(m_d->store);
 
+    auto flushBatch = [&] () {
+        if (!batch.isEmpty()) {
+            freedMetric += iter->trySwapOut(batch);
+            batch.clear();
+            batchMetric = 0;
+        }
+    };
+
+    auto addToBatch = [&] (KisTileData *td) {
+        batch.append(td);
+        batchMetric += td->pixelSize();
+
+        if (batch.size() >= SWAP_BATCH_SIZE ||
+            freedMetric + batchMetric >= needToFreeMetric) {
+
+            flushBatch();
+        }
+    };
+
     KisTileData *item = 0;
 
     while (iter->hasNext()) {
@@ -199,9 +281,7 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
         if (!strategy::isInteresting(item)) continue;
 
         if (strategy::swapOutFirst(item)) {
-            if (iter->trySwapOut(item)) {
-                freedMetric += item->pixelSize();
-            }
+            addToBatch(item);
         }
         else {
             item->markOld();
@@ -210,14 +290,16 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
 
     }
 
+    flushBatch();
+
     Q_FOREACH (item, additionalCandidates) {
         if (freedMetric >= needToFreeMetric) break;
 
-        if (iter->trySwapOut(item)) {
-            freedMetric += item->pixelSize();
-        }
+        addToBatch(item);
     }
 
+    flushBatch();
+
     strategy::endIteration(m_d->store, iter);
 
     return freedMetric;
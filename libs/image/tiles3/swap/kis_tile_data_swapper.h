@@ -40,6 +40,7 @@ private:
 private:
     static const qint32 TIMEOUT;
     static const qint32 DELAY;
+    static const qint32 SWAP_BATCH_SIZE;
 
 private:
     struct Private;
@@ -0,0 +1,145 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_tile_file_mapping.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QSaveFile>
+
+#include "kis_debug.h"
+
+namespace {
+struct MappingsRegistry {
+    QMutex lock;
+    QList<KisTileFileMapping*> mappings;
+};
+
+Q_GLOBAL_STATIC(MappingsRegistry, s_registry)
+}
+
+KisTileFileMapping::KisTileFileMapping(QFile *file, quint8 *data, qint64 size)
+    : m_file(file),
+      m_data(data),
+      m_size(size),
+      m_isDetached(false)
+{
+    QMutexLocker l(&s_registry->lock);
+    s_registry->mappings.append(this);
+}
+
+KisTileFileMapping::~KisTileFileMapping()
+{
+    {
+        QMutexLocker l(&s_registry->lock);
+        s_registry->mappings.removeOne(this);
+    }
+
+    m_file->unmap(m_data);
+}
+
+KisTileFileMappingSP KisTileFileMapping::create(QIODevice *device)
+{
+#ifdef Q_OS_WIN
+    /**
+     * Windows doesn't allow replacing a mapped file, so a save into
+     * the same directory store would have to overwrite it in place
+     * and the mapped tiles would change under our feet (see
+     * detachFromFiles()). Just copy the tiles.
+     */
+    Q_UNUSED(device);
+    return KisTileFileMappingSP();
+#else
+    QFileDevice *fileDevice = qobject_cast<QFileDevice*>(device);
+    if (!fileDevice || fileDevice->isSequential() || fileDevice->fileName().isEmpty()) {
+        return KisTileFileMappingSP();
+    }
+
+    /**
+     * We open the file once more, because the mapping should outlive
+     * the device, which is closed by the owner right after loading.
+     * The path is resolved, so that detachFromFile() would replace
+     * the file itself, not a symlink to it.
+     */
+    const QString fileName = QFileInfo(fileDevice->fileName()).canonicalFilePath();
+    if (fileName.isEmpty()) {
+        return KisTileFileMappingSP();
+    }
+
+    QScopedPointer<QFile> file(new QFile(fileName));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return KisTileFileMappingSP();
+    }
+
+    const qint64 size = file->size();
+    if (size <= 0) {
+        return KisTileFileMappingSP();
+    }
+
+    quint8 *data = file->map(0, size, QFileDevice::MapPrivateOption);
+    if (!data) {
+        warnTiles << "Failed to map the file into memory:" << file->fileName() << file->errorString();
+        return KisTileFileMappingSP();
+    }
+
+    return new KisTileFileMapping(file.take(), data, size);
+#endif
+}
+
+qint64 KisTileFileMapping::size() const
+{
+    return m_size;
+}
+
+quint8* KisTileFileMapping::data(qint64 offset) const
+{
+    KIS_ASSERT_RECOVER_NOOP(offset >= 0 && offset < m_size);
+    return m_data + offset;
+}
+
+bool KisTileFileMapping::isAligned(const quint8 *ptr, qint32 pixelSize)
+{
+    const quintptr alignment = qMin(pixelSize & -pixelSize, 16);
+    return !(reinterpret_cast<quintptr>(ptr) & (alignment - 1));
+}
+
+bool KisTileFileMapping::detachFromFiles()
+{
+    QMutexLocker l(&s_registry->lock);
+
+    bool result = true;
+
+    Q_FOREACH (KisTileFileMapping *mapping, s_registry->mappings) {
+        if (mapping->m_isDetached) continue;
+        result &= mapping->detachFromFile();
+    }
+
+    return result;
+}
+
+bool KisTileFileMapping::detachFromFile()
+{
+    /**
+     * The mapping is private and never written to, so its content is
+     * exactly the content of the file at loading time. QSaveFile keeps
+     * the permissions of the original file and replaces it atomically,
+     * so the file stays intact if something goes wrong.
+     */
+    QSaveFile copy(m_file->fileName());
+
+    if (!copy.open(QIODevice::WriteOnly) ||
+        copy.write(reinterpret_cast<const char*>(m_data), m_size) != m_size ||
+        !copy.commit()) {
+
+        warnTiles << "Failed to detach the mapped tiles from the file:" << m_file->fileName() << copy.errorString();
+        return false;
+    }
+
+    m_isDetached = true;
+    return true;
+}
@@ -0,0 +1,91 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_TILE_FILE_MAPPING_H
+#define __KIS_TILE_FILE_MAPPING_H
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+#include "kis_shared.h"
+#include "kis_shared_ptr.h"
+
+class QFile;
+class QIODevice;
+
+class KisTileFileMapping;
+typedef KisSharedPtr<KisTileFileMapping> KisTileFileMappingSP;
+
+/**
+ * A file mapped into memory for zero-copy loading of the tiles stored
+ * raw (see KisNoneCompression and KisTileCompressor2::readTile()).
+ *
+ * The mapping is private, so the file is never changed through it,
+ * and the pages are loaded by the system lazily, on the first access
+ * to the tile. Every tile data created over the mapping keeps a
+ * reference to it, so the file stays mapped until the last of such
+ * tiles is detached by COW or destroyed.
+ *
+ * Overwriting the file in place would change the mapped pixels, or
+ * even make them inaccessible if the file is truncated. Therefore,
+ * the code that is going to write into files the tiles could have
+ * been loaded from (e.g. saving of a layer) should call
+ * detachFromFiles() first. Windows cannot replace a mapped file, so
+ * there the mapping is not created at all.
+ */
+class KRITAIMAGE_EXPORT KisTileFileMapping : public KisShared
+{
+public:
+    ~KisTileFileMapping();
+
+    /**
+     * Maps the file behind \p device into memory. Returns null if the
+     * device is not a regular file or the system cannot map it.
+     */
+    static KisTileFileMappingSP create(QIODevice *device);
+
+    qint64 size() const;
+
+    /**
+     * Returns a pointer to the byte at \p offset of the file
+     */
+    quint8* data(qint64 offset) const;
+
+    /**
+     * Returns true if a tile with pixels of \p pixelSize bytes can be
+     * accessed at \p ptr directly, that is the pointer is aligned to
+     * the channel size the compositing code expects
+     */
+    static bool isAligned(const quint8 *ptr, qint32 pixelSize);
+
+    /**
+     * Detaches all the existing mappings from the paths of their
+     * files. Every mapped file is replaced with a copy of itself
+     * (written into a temporary file and renamed over the original),
+     * while the mapping keeps the old, now unlinked, file. After that
+     * the files can be safely overwritten in place.
+     *
+     * Each mapping is detached only once, so the call is cheap when
+     * there is nothing to detach.
+     *
+     * @return false if some of the files could not be replaced
+     */
+    static bool detachFromFiles();
+
+private:
+    KisTileFileMapping(QFile *file, quint8 *data, qint64 size);
+
+    bool detachFromFile();
+
+private:
+    QScopedPointer<QFile> m_file;
+    quint8 *m_data;
+    qint64 m_size;
+    bool m_isDetached;
+};
+
+#endif /* __KIS_TILE_FILE_MAPPING_H */
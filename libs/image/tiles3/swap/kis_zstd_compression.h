@@ -0,0 +1,41 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_ZSTD_COMPRESSION_H
+#define __KIS_ZSTD_COMPRESSION_H
+
+#include "kis_abstract_compression.h"
+#include <QScopedPointer>
+
+/**
+ * Zstandard compression. Gives much better compression ratio than
+ * LZF at a comparable decompression speed, so it suits writing
+ * layer data into .kra files.
+ *
+ * The object keeps its compression and decompression contexts
+ * between the calls, so it is not reentrant: use one object per
+ * thread, just like KisTileCompressor2 does.
+ *
+ * NOTE: unlike KisLzfCompression, \p outputLength parameters of
+ * compress() and decompress() are used and must be valid.
+ */
+class KRITAIMAGE_EXPORT KisZstdCompression : public KisAbstractCompression
+{
+public:
+    KisZstdCompression(int compressionLevel = 3);
+    ~KisZstdCompression() override;
+
+    qint32 compress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+    qint32 decompress(const quint8* input, qint32 inputLength, quint8* output, qint32 outputLength) override;
+
+    qint32 outputBufferSize(qint32 dataSize) override;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_ZSTD_COMPRESSION_H */
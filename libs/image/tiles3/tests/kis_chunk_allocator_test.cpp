@@ -27,7 +27,68 @@ void KisChunkAllocatorTest::testOperations()
 
     allocator.debugChunks();
     allocator.sanityCheck();
-    QVERIFY(qFuzzyCompare(allocator.debugFragmentation(), 1./6));
+
+    // the best fitting hole has been reused
+    QCOMPARE(chunk3.begin(), quint64(25));
+    QCOMPARE(allocator.debugFragmentation(), 0.0);
+
+    allocator.freeChunk(chunk3);
+    chunk3 = allocator.getChunk(30);
+
+    allocator.sanityCheck();
+    QVERIFY(qFuzzyCompare(allocator.debugFragmentation(), 2./13));
+}
+
+void KisChunkAllocatorTest::testCompaction()
+{
+    const quint64 slabSize = 1024;
+    KisChunkAllocator allocator(slabSize, 16 * slabSize);
+
+    QList<KisChunk> chunks;
+    for (int i = 0; i < 100; i++) {
+        chunks.append(allocator.getChunk(100));
+    }
+    QVERIFY(allocator.storeSize() >= 100 * 100);
+
+    for (int i = 0; i < chunks.size(); i++) {
+        allocator.freeChunk(chunks.takeAt(i));
+    }
+    allocator.sanityCheck();
+    QVERIFY(allocator.fragmentation() > 0.4);
+
+    QList<quint64> sizes;
+    Q_FOREACH (KisChunk chunk, chunks) {
+        sizes << chunk.size();
+    }
+
+    KisChunk chunk;
+    quint64 newBegin = 0;
+    int numRelocated = 0;
+
+    while (allocator.findRelocation(&chunk, &newBegin)) {
+        QVERIFY(newBegin < chunk.begin());
+        allocator.relocateChunk(chunk, newBegin);
+        QCOMPARE(chunk.begin(), newBegin);
+        numRelocated++;
+    }
+
+    allocator.sanityCheck();
+    QCOMPARE(numRelocated, chunks.size());
+    QCOMPARE(allocator.fragmentation(), 0.0);
+    QCOMPARE(allocator.usedSize(), quint64(chunks.size() * 100));
+
+    // the chunks kept by the users are still valid
+    for (int i = 0; i < chunks.size(); i++) {
+        QCOMPARE(chunks[i].begin(), quint64(i * 100));
+        QCOMPARE(chunks[i].size(), sizes[i]);
+    }
+
+    QCOMPARE(allocator.shrinkStore(), quint64(5 * slabSize));
+    allocator.sanityCheck();
+
+    // the tail is still usable after shrinking
+    chunks.append(allocator.getChunk(3 * slabSize));
+    allocator.sanityCheck();
 }
 
 
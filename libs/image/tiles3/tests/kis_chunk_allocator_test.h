@@ -20,6 +20,7 @@ qreal measureFragmentation(qint32 transactions, qint32 chunksAlloc,
 
 private Q_SLOTS:
     void testOperations();
+    void testCompaction();
     void testFragmentation();
 
 private:
@@ -206,4 +206,46 @@ void KisLowMemoryTests::hangingTilesTest()
     dstTile = 0;
 }
 
+void KisLowMemoryTests::prefetchSwappedTiles()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    const QRect rc(0, 0, 4 * KisTileData::WIDTH, 4 * KisTileData::HEIGHT);
+
+    QByteArray refData(rc.width() * rc.height(), 0);
+    for (int i = 0; i < refData.size(); i++) {
+        refData[i] = i % 251;
+    }
+    dm.writeBytes((const quint8*)refData.constData(), rc.x(), rc.y(), rc.width(), rc.height());
+
+    KisTileDataStore::instance()->debugSwapAll();
+
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) {
+            KisTileSP tile = dm.getTile(col, row, false);
+            QVERIFY(!tile->tileData()->data());
+        }
+    }
+
+    const int numSwappedTiles = KisTileDataStore::instance()->numTilesSwapped();
+    QVERIFY(numSwappedTiles >= 16);
+
+    dm.prefetchRect(rc);
+    KisTileDataStore::instance()->testingWaitForPrefetch();
+
+    QCOMPARE(KisTileDataStore::instance()->numTilesSwapped(), numSwappedTiles - 16);
+
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) {
+            KisTileSP tile = dm.getTile(col, row, false);
+            QVERIFY(tile->tileData()->data());
+        }
+    }
+
+    QByteArray result(refData.size(), 1);
+    dm.readBytes((quint8*)result.data(), rc.x(), rc.y(), rc.width(), rc.height());
+    QCOMPARE(result, refData);
+}
+
 SIMPLE_TEST_MAIN(KisLowMemoryTests)
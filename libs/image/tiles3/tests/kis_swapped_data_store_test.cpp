@@ -9,6 +9,8 @@
 
 #include <QRandomGenerator>
 
+#include <limits>
+
 #include "kis_debug.h"
 
 #include "kis_image_config.h"
@@ -121,5 +123,115 @@ void KisSwappedDataStoreTest::testRandomAccess()
         delete tileDataList[i];
 }
 
+void KisSwappedDataStoreTest::testBatchRoundTrip()
+{
+    const qint32 pixelSize = 1;
+    const quint8 defaultPixel = 128;
+    const qint32 NUM_TILES = 10000;
+    const qint32 BATCH_SIZE = 256;
+
+    KisImageConfig config(false);
+    config.setMaxSwapSize(4);
+    config.setSwapSlabSize(1);
+    config.setSwapWindowSize(1);
+
+
+    KisSwappedDataStore store;
+
+    QVector<KisTileData*> tileDataList;
+    for(qint32 i = 0; i < NUM_TILES; i++) {
+        KisTileData *td = new KisTileData(pixelSize, &defaultPixel, KisTileDataStore::instance());
+        memset(td->data(), COLUMN2COLOR(i), TILESIZE);
+        tileDataList.append(td);
+    }
+
+    for(qint32 i = 0; i < NUM_TILES; i += BATCH_SIZE) {
+        QVector<KisTileData*> batch = tileDataList.mid(i, BATCH_SIZE);
+        QVector<bool> swappedOut;
+
+        // FIXME: take a lock of the tile data
+        QCOMPARE(store.trySwapOutTileData(batch, swappedOut), batch.size());
+        QCOMPARE(swappedOut.size(), batch.size());
+        QVERIFY(!swappedOut.contains(false));
+    }
+
+    QCOMPARE(store.numTiles(), quint64(NUM_TILES));
+    store.debugStatistics();
+
+    for(qint32 i = 0; i < NUM_TILES; i++) {
+        KisTileData *td = tileDataList[i];
+        QVERIFY(!td->data());
+
+        // FIXME: take a lock of the tile data
+        store.swapInTileData(td);
+        QVERIFY(memoryIsFilled(COLUMN2COLOR(i), td->data(), TILESIZE));
+    }
+
+    QCOMPARE(store.numTiles(), quint64(0));
+
+    qDeleteAll(tileDataList);
+}
+
+void KisSwappedDataStoreTest::testCompaction()
+{
+    const qint32 pixelSize = 1;
+    const quint8 defaultPixel = 128;
+    const qint32 NUM_TILES = 2000;
+
+    KisImageConfig config(false);
+    config.setMaxSwapSize(16);
+    config.setSwapSlabSize(1);
+    config.setSwapWindowSize(1);
+
+    KisSwappedDataStore store;
+
+    /**
+     * Fill the tiles with noise, so that the chunks are big
+     * and the holes are noticeable
+     */
+    QRandomGenerator rng(1);
+    QVector<KisTileData*> tileDataList;
+    QVector<QByteArray> tileContents;
+
+    for(qint32 i = 0; i < NUM_TILES; i++) {
+        KisTileData *td = new KisTileData(pixelSize, &defaultPixel, KisTileDataStore::instance());
+
+        QByteArray content(TILESIZE, 0);
+        rng.fillRange(reinterpret_cast<quint32*>(content.data()), TILESIZE / 4);
+        memcpy(td->data(), content.constData(), TILESIZE);
+
+        tileDataList.append(td);
+        tileContents.append(content);
+
+        // FIXME: take a lock of the tile data
+        QVERIFY(store.trySwapOutTileData(td));
+    }
+
+    // make holes in the swap file
+    for(qint32 i = 0; i < NUM_TILES; i += 2) {
+        store.swapInTileData(tileDataList[i]);
+    }
+
+    QVERIFY(store.compact(std::numeric_limits<quint64>::max()) > 0);
+    store.debugStatistics();
+
+    // nothing to compact anymore
+    QCOMPARE(store.compact(), 0);
+
+    for(qint32 i = 0; i < NUM_TILES; i++) {
+        KisTileData *td = tileDataList[i];
+
+        if (!td->data()) {
+            store.swapInTileData(td);
+        }
+
+        QVERIFY(!memcmp(td->data(), tileContents[i].constData(), TILESIZE));
+    }
+
+    QCOMPARE(store.numTiles(), quint64(0));
+
+    qDeleteAll(tileDataList);
+}
+
 SIMPLE_TEST_MAIN(KisSwappedDataStoreTest)
 
@@ -10,6 +10,15 @@
 #include "tiles3/kis_tiled_data_manager.h"
 #include "tiles3/swap/kis_legacy_tile_compressor.h"
 #include "tiles3/swap/kis_tile_compressor_2.h"
+#include "tiles3/swap/kis_compression_factory.h"
+#include "tiles3/swap/kis_abstract_compression.h"
+#include "tiles3/swap/kis_tile_file_mapping.h"
+#include "tiles3/kis_tile_data.h"
+#include "kis_image_config.h"
+
+#include <QImage>
+#include <QTemporaryFile>
+#include <QTemporaryDir>
 
 #include "tiles_test_utils.h"
 
@@ -167,6 +176,315 @@ void KisTileCompressorsTest::testLowLevelRoundTripIncompressible2()
     delete compressor;
 }
 
+void KisTileCompressorsTest::testRoundTripCodecs_data()
+{
+    QTest::addColumn<QString>("compressionName");
+
+    Q_FOREACH (const QString &id, KisCompressionFactory::availableCompressions()) {
+        QTest::newRow(id.toLatin1()) << id;
+    }
+}
+
+void KisTileCompressorsTest::testRoundTripCodecs()
+{
+    QFETCH(QString, compressionName);
+
+    KisTileCompressor2 compressor(compressionName);
+    QCOMPARE(compressor.compressionName(), compressionName);
+
+    doRoundTrip(&compressor);
+}
+
+void KisTileCompressorsTest::testLowLevelRoundTripCodecs_data()
+{
+    testRoundTripCodecs_data();
+}
+
+void KisTileCompressorsTest::testLowLevelRoundTripCodecs()
+{
+    QFETCH(QString, compressionName);
+
+    KisTileCompressor2 compressor(compressionName);
+    doLowLevelRoundTrip(&compressor);
+}
+
+void KisTileCompressorsTest::testCodecsRoundTrip_data()
+{
+    testRoundTripCodecs_data();
+}
+
+void KisTileCompressorsTest::testCodecsRoundTrip()
+{
+    QFETCH(QString, compressionName);
+
+    QScopedPointer<KisAbstractCompression> compression(KisCompressionFactory::create(compressionName));
+    QVERIFY(compression);
+
+    const QImage referenceImage(QString(FILES_DATA_DIR) + QDir::separator() + "tile.png");
+    QVERIFY(!referenceImage.isNull());
+
+    QImage image(referenceImage);
+    const qint32 srcSize = image.byteCount();
+
+    QByteArray output(compression->outputBufferSize(srcSize), 0);
+    QByteArray linearized(srcSize, 0);
+
+    // single pass
+    qint32 compressedBytes =
+        compression->compress(image.bits(), srcSize,
+                              reinterpret_cast<quint8*>(output.data()), output.size());
+    image.fill(0);
+
+    qint32 uncompressedBytes =
+        compression->decompress(reinterpret_cast<quint8*>(output.data()), compressedBytes,
+                                image.bits(), srcSize);
+
+    QCOMPARE(uncompressedBytes, srcSize);
+    QVERIFY(referenceImage == image);
+
+    // two pass, with the linearized colors
+    KisAbstractCompression::linearizeColors(image.bits(), reinterpret_cast<quint8*>(linearized.data()),
+                                            srcSize, 4);
+
+    compressedBytes =
+        compression->compress(reinterpret_cast<quint8*>(linearized.data()), srcSize,
+                              reinterpret_cast<quint8*>(output.data()), output.size());
+    linearized.fill(0);
+
+    uncompressedBytes =
+        compression->decompress(reinterpret_cast<quint8*>(output.data()), compressedBytes,
+                                reinterpret_cast<quint8*>(linearized.data()), srcSize);
+
+    KisAbstractCompression::delinearizeColors(reinterpret_cast<quint8*>(linearized.data()), image.bits(),
+                                              srcSize, 4);
+
+    QCOMPARE(uncompressedBytes, srcSize);
+    QVERIFY(referenceImage == image);
+}
+
+void KisTileCompressorsTest::testCodecsOverflow_data()
+{
+    testRoundTripCodecs_data();
+}
+
+void KisTileCompressorsTest::testCodecsOverflow()
+{
+    QFETCH(QString, compressionName);
+
+    QScopedPointer<KisAbstractCompression> compression(KisCompressionFactory::create(compressionName));
+    QVERIFY(compression);
+
+    // the compressed png file is incompressible
+    QFile file(QString(FILES_DATA_DIR) + QDir::separator() + "tile.png");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QByteArray array = file.readAll();
+
+    const qint32 srcSize = array.size();
+    const qint32 outputSize = compression->outputBufferSize(srcSize);
+    QByteArray output(outputSize, 0);
+
+    const qint32 compressedBytes =
+        compression->compress(reinterpret_cast<quint8*>(array.data()), srcSize,
+                              reinterpret_cast<quint8*>(output.data()), outputSize);
+
+    QVERIFY(compressedBytes > 0);
+    QVERIFY(compressedBytes <= outputSize);
+
+    QByteArray result(srcSize, 0);
+    QCOMPARE(compression->decompress(reinterpret_cast<quint8*>(output.data()), compressedBytes,
+                                     reinterpret_cast<quint8*>(result.data()), srcSize),
+             srcSize);
+    QCOMPARE(result, array);
+}
+
+void KisTileCompressorsTest::testReadMixedCodecs()
+{
+    /**
+     * Every tile carries the id of its codec in the header, so
+     * a stream with tiles written by different codecs should be
+     * readable by a compressor with any default codec
+     */
+
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    dm.clear(0, 0, 64, 64, &oddPixel1);
+    dm.clear(64, 64, 64, 64, &oddPixel2);
+
+    KoStoreFake fakeStore;
+    KisFakePaintDeviceWriter writer(&fakeStore);
+
+    const QStringList codecs = KisCompressionFactory::availableCompressions();
+
+    {
+        KisTileCompressor2 compressor(codecs.last());
+        QVERIFY(compressor.writeTile(dm.getTile(0, 0, false), writer));
+    }
+
+    {
+        KisTileCompressor2 compressor(codecs.first());
+        QVERIFY(compressor.writeTile(dm.getTile(1, 1, false), writer));
+    }
+
+    fakeStore.startReading();
+    dm.clear();
+
+    KisTileCompressor2 compressor;
+    QVERIFY(compressor.readTile(fakeStore.device(), &dm));
+    QVERIFY(compressor.readTile(fakeStore.device(), &dm));
+
+    KisTileSP tile00 = dm.getTile(0, 0, false);
+    QVERIFY(memoryIsFilled(oddPixel1, tile00->data(), TILESIZE));
+
+    KisTileSP tile11 = dm.getTile(1, 1, false);
+    QVERIFY(memoryIsFilled(oddPixel2, tile11->data(), TILESIZE));
+}
+
+void KisTileCompressorsTest::testReadFileMapped()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    QByteArray data(TILESIZE, 0);
+    for (int i = 0; i < data.size(); i++) {
+        data[i] = i % 251;
+    }
+
+    quint8 oddPixel1 = 128;
+    dm.writeBytes((const quint8*)data.constData(), 0, 0, 64, 64);
+    dm.clear(64, 64, 64, 64, &oddPixel1);
+
+    KoStoreFake fakeStore;
+    KisFakePaintDeviceWriter writer(&fakeStore);
+
+    {
+        KisTileCompressor2 compressor(KisCompressionFactory::NONE);
+        QVERIFY(compressor.writeTile(dm.getTile(0, 0, false), writer));
+        QVERIFY(compressor.writeTile(dm.getTile(1, 1, false), writer));
+    }
+
+    fakeStore.startReading();
+    const QByteArray fileContent = fakeStore.device()->readAll();
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(fileContent), qint64(fileContent.size()));
+    QVERIFY(file.flush());
+    QVERIFY(file.seek(0));
+
+    const bool oldMapTiles = KisImageConfig(true).mapUncompressedTileFiles();
+    KisImageConfig(false).setMapUncompressedTileFiles(true);
+
+    dm.clear();
+
+    {
+        KisTileCompressor2 compressor;
+        QVERIFY(compressor.readTile(&file, &dm));
+        QVERIFY(compressor.readTile(&file, &dm));
+    }
+
+    KisImageConfig(false).setMapUncompressedTileFiles(oldMapTiles);
+
+    KisTileSP tile00 = dm.getTile(0, 0, false);
+    QVERIFY(tile00->tileData()->isFileMapped());
+    QVERIFY(!memcmp(tile00->data(), data.constData(), TILESIZE));
+
+    KisTileSP tile11 = dm.getTile(1, 1, false);
+    QVERIFY(tile11->tileData()->isFileMapped());
+    QVERIFY(memoryIsFilled(oddPixel1, tile11->data(), TILESIZE));
+
+    // writing copies the tile data, the file is not touched
+    quint8 oddPixel2 = 129;
+    dm.setPixel(0, 0, &oddPixel2);
+
+    tile00 = dm.getTile(0, 0, false);
+    QVERIFY(!tile00->tileData()->isFileMapped());
+    QCOMPARE(tile00->data()[0], oddPixel2);
+    QVERIFY(!memcmp(tile00->data() + 1, data.constData() + 1, TILESIZE - 1));
+
+    QVERIFY(file.seek(0));
+    QCOMPARE(file.readAll(), fileContent);
+}
+
+bool saveTileIntoDirectoryStore(const QString &path, KisTiledDataManager &dm)
+{
+    // the same as KisKraSaveVisitor does before saving a layer
+    if (!KisTileFileMapping::detachFromFiles()) return false;
+
+    QScopedPointer<KoStore> store(KoStore::createStore(path, KoStore::Write, "", KoStore::Directory));
+    if (!store->open("layer")) return false;
+
+    KisFakePaintDeviceWriter writer(store.data());
+    KisTileCompressor2 compressor(KisCompressionFactory::NONE);
+    const bool result = compressor.writeTile(dm.getTile(0, 0, false), writer);
+
+    return store->close() && result;
+}
+
+bool loadTileFromDirectoryStore(const QString &path, KisTiledDataManager &dm)
+{
+    QScopedPointer<KoStore> store(KoStore::createStore(path, KoStore::Read, "", KoStore::Directory));
+    if (!store->open("layer")) return false;
+
+    KisTileCompressor2 compressor;
+    const bool result = compressor.readTile(store->device(), &dm);
+
+    return store->close() && result;
+}
+
+void KisTileCompressorsTest::testSaveIntoFileMappedStore()
+{
+    quint8 defaultPixel = 0;
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    KisTiledDataManager dm1(1, &defaultPixel);
+    dm1.clear(0, 0, 64, 64, &oddPixel1);
+
+    KisTiledDataManager dm2(1, &defaultPixel);
+    dm2.clear(0, 0, 64, 64, &oddPixel2);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QVERIFY(saveTileIntoDirectoryStore(dir.path(), dm1));
+
+    const bool oldMapTiles = KisImageConfig(true).mapUncompressedTileFiles();
+    KisImageConfig(false).setMapUncompressedTileFiles(true);
+
+    KisTiledDataManager mappedDm(1, &defaultPixel);
+    QVERIFY(loadTileFromDirectoryStore(dir.path(), mappedDm));
+
+    KisImageConfig(false).setMapUncompressedTileFiles(oldMapTiles);
+
+    KisTileSP mappedTile = mappedDm.getTile(0, 0, false);
+#ifndef Q_OS_WIN
+    QVERIFY(mappedTile->tileData()->isFileMapped());
+#endif
+    QVERIFY(memoryIsFilled(oddPixel1, mappedTile->data(), TILESIZE));
+
+    const QString fileName = dir.filePath("layer");
+    QVERIFY(QFile::setPermissions(fileName, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ReadGroup));
+    const QFileDevice::Permissions permissions = QFile::permissions(fileName);
+
+    // save another device into the file the tile is mapped from
+    QVERIFY(saveTileIntoDirectoryStore(dir.path(), dm2));
+
+    // the file has kept its permissions
+    QCOMPARE(QFile::permissions(fileName), permissions);
+
+    // the mapped tile still has the old content...
+    QVERIFY(memoryIsFilled(oddPixel1, mappedTile->data(), TILESIZE));
+
+    // ... while the store has got the new one
+    KisTiledDataManager loadedDm(1, &defaultPixel);
+    QVERIFY(loadTileFromDirectoryStore(dir.path(), loadedDm));
+    QVERIFY(memoryIsFilled(oddPixel2, loadedDm.getTile(0, 0, false)->data(), TILESIZE));
+}
 
 SIMPLE_TEST_MAIN(KisTileCompressorsTest)
 
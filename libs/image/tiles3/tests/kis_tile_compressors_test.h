@@ -26,6 +26,18 @@ private Q_SLOTS:
     void testRoundTrip2();
     void testLowLevelRoundTrip2();
     void testLowLevelRoundTripIncompressible2();
+
+    void testRoundTripCodecs_data();
+    void testRoundTripCodecs();
+    void testLowLevelRoundTripCodecs_data();
+    void testLowLevelRoundTripCodecs();
+    void testCodecsRoundTrip_data();
+    void testCodecsRoundTrip();
+    void testCodecsOverflow_data();
+    void testCodecsOverflow();
+    void testReadMixedCodecs();
+    void testReadFileMapped();
+    void testSaveIntoFileMappedStore();
 };
 
 #endif /* KIS_TILE_COMPRESSORS_TEST_H */
@@ -0,0 +1,190 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_tile_data_slab_allocator_test.h"
+
+#include <QThread>
+#include <QRandomGenerator>
+
+#include "tiles3/kis_tile_data.h"
+#include "tiles3/kis_tile_data_slab_allocator.h"
+
+
+static qint64 blockSize(qint32 pixelSize)
+{
+    return pixelSize * KisTileData::WIDTH * KisTileData::HEIGHT;
+}
+
+void KisTileDataSlabAllocatorTest::testAllocateFree_data()
+{
+    QTest::addColumn<int>("pixelSize");
+
+    QTest::newRow("alpha8") << 1;
+    QTest::newRow("rgba8") << 4;
+    QTest::newRow("cmyka8") << 5;
+    QTest::newRow("rgba16") << 8;
+    QTest::newRow("cmyka16") << 10;
+    QTest::newRow("rgbaf32") << 16;
+    QTest::newRow("cmykaf32") << 20;
+}
+
+void KisTileDataSlabAllocatorTest::testAllocateFree()
+{
+    QFETCH(int, pixelSize);
+
+    KisTileDataSlabAllocator allocator;
+    const int numBlocks = 300;
+    const qint64 size = blockSize(pixelSize);
+
+    QVector<quint8*> blocks;
+
+    for (int i = 0; i < numBlocks; i++) {
+        quint8 *ptr = allocator.allocate(pixelSize);
+        QVERIFY(ptr);
+        memset(ptr, i % 256, size);
+        blocks << ptr;
+    }
+
+    KisTileDataSlabAllocator::Statistics stats = allocator.statistics();
+    QCOMPARE(stats.usedSize, qint64(numBlocks) * size);
+    QVERIFY(stats.reservedSize >= stats.usedSize + stats.threadCacheSize);
+    QCOMPARE(stats.reservedSize, stats.numSlabs * KisTileDataSlabAllocator::SLAB_SIZE);
+
+    // no block has been overwritten by its neighbours
+    for (int i = 0; i < numBlocks; i++) {
+        const quint8 *ptr = blocks[i];
+        QCOMPARE(int(ptr[0]), i % 256);
+        QCOMPARE(int(ptr[size - 1]), i % 256);
+    }
+
+    Q_FOREACH (quint8 *ptr, blocks) {
+        allocator.free(ptr, pixelSize);
+    }
+
+    stats = allocator.statistics();
+    QCOMPARE(stats.usedSize, qint64(0));
+
+    allocator.releaseFreeMemory();
+
+    stats = allocator.statistics();
+    QCOMPARE(stats.numSlabs, qint64(0));
+    QCOMPARE(stats.reservedSize, qint64(0));
+    QCOMPARE(stats.threadCacheSize, qint64(0));
+}
+
+void KisTileDataSlabAllocatorTest::testEmptySlabsReleased()
+{
+    KisTileDataSlabAllocator allocator;
+
+    const int pixelSize = 4;
+    const int blocksPerSlab = KisTileDataSlabAllocator::SLAB_SIZE / blockSize(pixelSize);
+    const int numBlocks = 10 * blocksPerSlab;
+
+    QVector<quint8*> blocks;
+
+    for (int i = 0; i < numBlocks; i++) {
+        blocks << allocator.allocate(pixelSize);
+    }
+
+    QVERIFY(allocator.statistics().numSlabs >= 10);
+
+    Q_FOREACH (quint8 *ptr, blocks) {
+        allocator.free(ptr, pixelSize);
+    }
+
+    /**
+     * Without an explicit release the allocator keeps only
+     * a spare slab and the slab referenced by the thread cache
+     */
+    QVERIFY(allocator.statistics().numSlabs <= 2);
+}
+
+void KisTileDataSlabAllocatorTest::testHeapFallback()
+{
+    KisTileDataSlabAllocator allocator;
+
+    const int pixelSize = KisTileDataSlabAllocator::MAX_PIXEL_SIZE + 16;
+
+    quint8 *ptr = allocator.allocate(pixelSize);
+    QVERIFY(ptr);
+    memset(ptr, 0xff, blockSize(pixelSize));
+
+    KisTileDataSlabAllocator::Statistics stats = allocator.statistics();
+    QCOMPARE(stats.numSlabs, qint64(0));
+    QCOMPARE(stats.usedSize, blockSize(pixelSize));
+    QCOMPARE(stats.reservedSize, blockSize(pixelSize));
+
+    allocator.free(ptr, pixelSize);
+
+    stats = allocator.statistics();
+    QCOMPARE(stats.usedSize, qint64(0));
+    QCOMPARE(stats.reservedSize, qint64(0));
+}
+
+void KisTileDataSlabAllocatorTest::testMultipleThreads()
+{
+    KisTileDataSlabAllocator allocator;
+
+    const int numThreads = 4;
+    const int numIterations = 20000;
+    QAtomicInt numErrors;
+
+    auto worker = [&allocator, &numErrors] (quint32 seed) {
+        QRandomGenerator rng(seed);
+        QVector<QPair<quint8*, int>> blocks;
+
+        for (int i = 0; i < numIterations; i++) {
+            if (blocks.isEmpty() || rng.bounded(3)) {
+                const int pixelSize = (rng.bounded(2)) ? 4 : 16;
+                quint8 *ptr = allocator.allocate(pixelSize);
+                *ptr = quint8(pixelSize);
+                blocks.append(qMakePair(ptr, pixelSize));
+            } else {
+                const int index = rng.bounded(blocks.size());
+                QPair<quint8*, int> block = blocks.takeAt(index);
+
+                if (*block.first != quint8(block.second)) {
+                    numErrors.ref();
+                }
+
+                allocator.free(block.first, block.second);
+            }
+
+            if (blocks.size() > 500) {
+                QPair<quint8*, int> block = blocks.takeFirst();
+                allocator.free(block.first, block.second);
+            }
+        }
+
+        for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+            allocator.free(it->first, it->second);
+        }
+    };
+
+    QVector<QThread*> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads << QThread::create(worker, quint32(i + 1));
+        threads.last()->start();
+    }
+
+    Q_FOREACH (QThread *thread, threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    QCOMPARE(int(numErrors), 0);
+
+    KisTileDataSlabAllocator::Statistics stats = allocator.statistics();
+    QCOMPARE(stats.usedSize, qint64(0));
+
+    // the threads have exited, so their caches must have been drained
+    QCOMPARE(stats.threadCacheSize, qint64(0));
+
+    allocator.releaseFreeMemory();
+    QCOMPARE(allocator.statistics().numSlabs, qint64(0));
+}
+
+SIMPLE_TEST_MAIN(KisTileDataSlabAllocatorTest)
@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_TILE_DATA_SLAB_ALLOCATOR_TEST_H
+#define KIS_TILE_DATA_SLAB_ALLOCATOR_TEST_H
+
+#include <simpletest.h>
+
+class KisTileDataSlabAllocatorTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testAllocateFree_data();
+    void testAllocateFree();
+    void testEmptySlabsReleased();
+    void testHeapFallback();
+    void testMultipleThreads();
+};
+
+#endif // KIS_TILE_DATA_SLAB_ALLOCATOR_TEST_H
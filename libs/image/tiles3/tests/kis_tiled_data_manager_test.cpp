@@ -8,8 +8,11 @@
 #include <simpletest.h>
 
 #include <QRandomGenerator>
+#include <QScopedPointer>
 
 #include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "tiles3/kis_tile_data_store_iterators.h"
 
 #include "tiles_test_utils.h"
 #include "config-limit-long-tests.h"
@@ -529,6 +532,323 @@ void KisTiledDataManagerTest::testUndoSetDefaultPixel()
     QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
 }
 
+void KisTiledDataManagerTest::testCollapseUniformTiles()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+
+    // tiles (0,0), (1,0), (0,1) and (1,1) are uniform
+    QRect uniformRect(0,0,128,128);
+    // tile (2,0) is uniform and has the default color
+    QRect defaultRect(128,0,64,64);
+    // tile (3,0) is not uniform
+    QRect noisyRect(192,0,64,64);
+
+    QRect rect = uniformRect | defaultRect | noisyRect;
+
+    QByteArray data(rect.width() * rect.height(), char(defaultPixel));
+    for (int y = 0; y < rect.height(); y++) {
+        for (int x = 0; x < rect.width(); x++) {
+            const QPoint pt(x, y);
+            quint8 value = defaultPixel;
+
+            if (uniformRect.contains(pt)) {
+                value = oddPixel1;
+            } else if (noisyRect.contains(pt)) {
+                value = (x + y) % 256;
+            }
+
+            data[y * rect.width() + x] = value;
+        }
+    }
+
+    KisMementoSP memento1 = dm.getMemento();
+    dm.writeBytes((const quint8*)data.constData(), rect.x(), rect.y(), rect.width(), rect.height());
+
+    KisTileData *noisyTileData = dm.getTile(3, 0, false)->tileData();
+
+    QVector<KisTileData*> writtenUniformTileData;
+    writtenUniformTileData << dm.getTile(0, 0, false)->tileData();
+    writtenUniformTileData << dm.getTile(1, 0, false)->tileData();
+    writtenUniformTileData << dm.getTile(0, 1, false)->tileData();
+    writtenUniformTileData << dm.getTile(1, 1, false)->tileData();
+
+    dm.commit();
+
+    KisTileData *uniformTileData = dm.getTile(0, 0, false)->tileData();
+    QCOMPARE(dm.getTile(1, 0, false)->tileData(), uniformTileData);
+    QCOMPARE(dm.getTile(0, 1, false)->tileData(), uniformTileData);
+    QCOMPARE(dm.getTile(1, 1, false)->tileData(), uniformTileData);
+    QVERIFY(memoryIsFilled(oddPixel1, uniformTileData->data(), TILESIZE));
+
+    // one of the written tiles lends its data, nothing new is allocated
+    QVERIFY(writtenUniformTileData.contains(uniformTileData));
+
+    KisTileData *defaultTileData = dm.getTile(2, 0, false)->tileData();
+    QVERIFY(defaultTileData != uniformTileData);
+    QVERIFY(memoryIsFilled(defaultPixel, defaultTileData->data(), TILESIZE));
+
+    QCOMPARE(dm.getTile(3, 0, false)->tileData(), noisyTileData);
+
+    // the content and the extent are not changed
+    QCOMPARE(dm.extent(), rect);
+
+    QByteArray result(data.size(), 1);
+    dm.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QCOMPARE(result, data);
+
+    // writing detaches the tile from the shared data
+    KisMementoSP memento2 = dm.getMemento();
+    quint8 oddPixel2 = 129;
+    dm.setPixel(10, 10, &oddPixel2);
+    dm.commit();
+
+    KisTileSP tile00 = dm.getTile(0, 0, false);
+    QVERIFY(tile00->tileData() != uniformTileData);
+    QCOMPARE(tile00->data()[10 * KisTileData::WIDTH + 10], oddPixel2);
+    QVERIFY(memoryIsFilled(oddPixel1, dm.getTile(1, 0, false)->data(), TILESIZE));
+
+    // undo is not affected
+    dm.rollback(memento2);
+    dm.rollback(memento1);
+
+    dm.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QVERIFY(memoryIsFilled(defaultPixel, (quint8*)result.data(), result.size()));
+}
+
+void KisTiledDataManagerTest::testDeduplicateTiles()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm1(1, &defaultPixel);
+    KisTiledDataManager dm2(1, &defaultPixel);
+    QScopedPointer<KisTiledDataManager> dm3(new KisTiledDataManager(1, &defaultPixel));
+
+    QRect rect(0,0,64,64);
+
+    QByteArray data(rect.width() * rect.height(), char(defaultPixel));
+    for (int y = 0; y < rect.height(); y++) {
+        for (int x = 0; x < rect.width(); x++) {
+            data[y * rect.width() + x] = (x * 3 + y) % 256;
+        }
+    }
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    const qint64 deduplicatedBefore = store->memoryStatistics().deduplicatedSize;
+
+    KisMementoSP memento1 = dm1.getMemento();
+    dm1.writeBytes((const quint8*)data.constData(), rect.x(), rect.y(), rect.width(), rect.height());
+    dm1.commit();
+
+    KisTileData *sharedTileData = dm1.getTile(0, 0, false)->tileData();
+    QVERIFY(sharedTileData->mementoed());
+
+    store->testingIndexTileDataForDeduplication();
+
+    // the same content written into other devices...
+    KisMementoSP memento2 = dm2.getMemento();
+    dm2.writeBytes((const quint8*)data.constData(), rect.x(), rect.y(), rect.width(), rect.height());
+    dm2.commit();
+
+    KisMementoSP memento3 = dm3->getMemento();
+    dm3->writeBytes((const quint8*)data.constData(), rect.x(), rect.y(), rect.width(), rect.height());
+    dm3->commit();
+
+    store->testingIndexTileDataForDeduplication();
+
+    // ... is matched by the pooler, but merged only on the next commit
+    QVERIFY(dm2.getTile(0, 0, false)->tileData() != sharedTileData);
+    QCOMPARE(store->memoryStatistics().deduplicatedSize - deduplicatedBefore, qint64(0));
+
+    dm2.commit();
+    dm3->commit();
+
+    QCOMPARE(dm2.getTile(0, 0, false)->tileData(), sharedTileData);
+    QCOMPARE(dm3->getTile(0, 0, false)->tileData(), sharedTileData);
+    QCOMPARE(store->memoryStatistics().deduplicatedSize - deduplicatedBefore, qint64(2 * TILESIZE));
+
+    QByteArray result(data.size(), 1);
+    dm2.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QCOMPARE(result, data);
+
+    // the COW in the device owning the data doesn't change the accounting
+    KisMementoSP memento4 = dm1.getMemento();
+    quint8 oddPixel = 255;
+    dm1.setPixel(20, 20, &oddPixel);
+    dm1.commit();
+
+    QVERIFY(dm1.getTile(0, 0, false)->tileData() != sharedTileData);
+    QCOMPARE(store->memoryStatistics().deduplicatedSize - deduplicatedBefore, qint64(2 * TILESIZE));
+
+    dm2.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QCOMPARE(result, data);
+
+    // a different content is not merged
+    KisMementoSP memento5 = dm2.getMemento();
+    dm2.setPixel(10, 10, &oddPixel);
+    dm2.commit();
+
+    QVERIFY(dm2.getTile(0, 0, false)->tileData() != sharedTileData);
+    QCOMPARE(dm2.getTile(0, 0, false)->data()[10 * KisTileData::WIDTH + 10], oddPixel);
+
+    // the COW has broken the sharing, so the memory is not saved anymore
+    QCOMPARE(store->memoryStatistics().deduplicatedSize - deduplicatedBefore, qint64(TILESIZE));
+
+    dm3.reset();
+    QCOMPARE(store->memoryStatistics().deduplicatedSize - deduplicatedBefore, qint64(0));
+
+    // undo is not affected
+    dm2.rollback(memento5);
+    dm2.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QCOMPARE(result, data);
+
+    dm2.rollback(memento2);
+    dm2.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QVERIFY(memoryIsFilled(defaultPixel, (quint8*)result.data(), result.size()));
+
+    dm1.rollback(memento4);
+    dm1.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QCOMPARE(result, data);
+}
+
+void KisTiledDataManagerTest::testGetTilesPairs()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    dm.clear(0, 0, 64, 64, &oddPixel1);
+    dm.clear(128, 64, 64, 64, &oddPixel1);
+
+    KisMementoSP memento1 = dm.getMemento();
+    dm.clear(128, 64, 64, 64, &oddPixel2);
+
+    const QRect tileRect(0, 0, 3, 2);
+
+    QVector<KisTileSP> tiles;
+    QVector<KisTileSP> oldTiles;
+
+    // read-only access doesn't create new tiles
+    dm.getTilesPairs(tileRect, false, tiles, oldTiles);
+
+    QCOMPARE(tiles.size(), 6);
+    QCOMPARE(oldTiles.size(), 6);
+    QCOMPARE(dm.extent(), QRect(0, 0, 192, 128));
+
+    for (int i = 0; i < tiles.size(); i++) {
+        const int col = tileRect.left() + i % tileRect.width();
+        const int row = tileRect.top() + i / tileRect.width();
+
+        KisTileSP tile;
+        KisTileSP oldTile;
+        dm.getTilesPair(col, row, false, &tile, &oldTile);
+
+        QCOMPARE(tiles[i]->tileData(), tile->tileData());
+        QCOMPARE(oldTiles[i]->tileData(), oldTile->tileData());
+    }
+
+    QVERIFY(memoryIsFilled(oddPixel1, tiles[0]->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(defaultPixel, tiles[1]->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(oddPixel2, tiles[5]->data(), TILESIZE));
+    QVERIFY(memoryIsFilled(oddPixel1, oldTiles[5]->data(), TILESIZE));
+
+    // writable access creates the missing tiles and updates the extent
+    const QRect bigTileRect(0, 0, 4, 3);
+    dm.getTilesPairs(bigTileRect, true, tiles, oldTiles);
+
+    QCOMPARE(tiles.size(), 12);
+    QCOMPARE(dm.extent(), QRect(0, 0, 256, 192));
+
+    for (int i = 0; i < tiles.size(); i++) {
+        const int col = bigTileRect.left() + i % bigTileRect.width();
+        const int row = bigTileRect.top() + i / bigTileRect.width();
+
+        QCOMPARE(tiles[i].data(), dm.getTile(col, row, false).data());
+    }
+
+    tiles.clear();
+    oldTiles.clear();
+    dm.commit();
+}
+
+void KisTiledDataManagerTest::testEvictionPriority()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    QRect rect(0,0,128,64);
+
+    QByteArray data(rect.width() * rect.height(), char(defaultPixel));
+    for (int i = 0; i < data.size(); i++) {
+        data[i] = i % 251;
+    }
+    dm.writeBytes((const quint8*)data.constData(), rect.x(), rect.y(), rect.width(), rect.height());
+
+    qint64 memorySize = 0;
+    qint64 swappedSize = 0;
+
+    dm.setEvictionPriority(KisTileData::BACKGROUND_IMAGE, memorySize, swappedSize);
+
+    QCOMPARE(memorySize, qint64(2 * TILESIZE));
+    QCOMPARE(swappedSize, qint64(0));
+    QCOMPARE(dm.getTile(0, 0, false)->tileData()->evictionPriority(), KisTileData::BACKGROUND_IMAGE);
+    QCOMPARE(dm.getTile(1, 0, false)->tileData()->evictionPriority(), KisTileData::BACKGROUND_IMAGE);
+
+    KisTileDataStore *store = KisTileDataStore::instance();
+    KisTileDataStoreIterator *iter = store->beginIteration();
+    QVERIFY(iter->trySwapOut(dm.getTile(0, 0, false)->tileData()));
+    store->endIteration(iter);
+
+    dm.setEvictionPriority(KisTileData::EVICT_LAST, memorySize, swappedSize);
+
+    QCOMPARE(memorySize, qint64(TILESIZE));
+    QCOMPARE(swappedSize, qint64(TILESIZE));
+    QCOMPARE(dm.getTile(0, 0, false)->tileData()->evictionPriority(), KisTileData::EVICT_LAST);
+
+    QByteArray result(data.size(), 1);
+    dm.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QCOMPARE(result, data);
+}
+
+void KisTiledDataManagerTest::testEvictionPriorityHistory()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    KisMementoSP memento1 = dm.getMemento();
+    dm.clear(0, 0, 64, 64, &oddPixel1);
+    dm.commit();
+
+    KisTileData *historicalTileData = dm.getTile(0, 0, false)->tileData();
+
+    KisMementoSP memento2 = dm.getMemento();
+    dm.setPixel(0, 0, &oddPixel2);
+    dm.commit();
+
+    QVERIFY(dm.getTile(0, 0, false)->tileData() != historicalTileData);
+    QVERIFY(historicalTileData->historical());
+    QCOMPARE(historicalTileData->evictionPriority(), KisTileData::EVICT_LAST);
+
+    qint64 memorySize = 0;
+    qint64 swappedSize = 0;
+
+    dm.setEvictionPriority(KisTileData::BACKGROUND_IMAGE, memorySize, swappedSize);
+
+    // the data referenced by the undo history only is covered too
+    QCOMPARE(historicalTileData->evictionPriority(), KisTileData::BACKGROUND_IMAGE);
+    QCOMPARE(dm.getTile(0, 0, false)->tileData()->evictionPriority(), KisTileData::BACKGROUND_IMAGE);
+
+    // ... and accounted only once
+    QCOMPARE(memorySize, qint64(2 * TILESIZE));
+    QCOMPARE(swappedSize, qint64(0));
+}
+
 //#include <valgrind/callgrind.h>
 
 void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
@@ -553,6 +873,24 @@ void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
     //CALLGRIND_STOP_INSTRUMENTATION;
 }
 
+void KisTiledDataManagerTest::benchmarkReadOnlyTilesLazyBulk()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    const QRect tileRect(0, 0, 64, 64);
+    dm.clear(0, 0, tileRect.width() * KisTileData::WIDTH, tileRect.height() * KisTileData::HEIGHT, &defaultPixel);
+
+    QVector<KisTileSP> tiles;
+    QVector<KisTileSP> oldTiles;
+
+    QBENCHMARK {
+        for (int row = tileRect.top(); row <= tileRect.bottom(); row++) {
+            dm.getTilesPairs(QRect(tileRect.left(), row, tileRect.width(), 1), false, tiles, oldTiles);
+        }
+    }
+}
+
 class KisSimpleClass : public KisShared
 {
     qint64 m_int;
@@ -40,8 +40,14 @@ private Q_SLOTS:
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testCollapseUniformTiles();
+    void testDeduplicateTiles();
+    void testGetTilesPairs();
+    void testEvictionPriority();
+    void testEvictionPriorityHistory();
 
     void benchmarkReadOnlyTileLazy();
+    void benchmarkReadOnlyTilesLazyBulk();
     void benchmarkSharedPointers();
 
     void benchmarkCOWNoPooler();
@@ -0,0 +1,553 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoColorConversionLut3D.h"
+
+#include <limits>
+#include <type_traits>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <ksharedconfig.h>
+#include <kconfiggroup.h>
+
+#include "KoChannelInfo.h"
+#include "KoColorSpace.h"
+#include "KoColorSpaceMaths.h"
+#include "kis_debug.h"
+
+
+namespace {
+
+const quint32 lutFileMagic = 0x4b4c5554; // "KLUT"
+const quint32 lutFileVersion = 1;
+
+const int minGridSize = 2;
+const int maxGridSize = 129;
+const int maxDstColorChannels = 8;
+
+struct ChannelLayout {
+    KoChannelInfo::enumChannelValueType valueType = KoChannelInfo::OTHER;
+    QList<KoChannelInfo*> colorChannels;
+    QVector<int> colorIndex;
+    int alphaIndex = -1;
+    int numChannels = 0;
+};
+
+bool isSupportedValueType(KoChannelInfo::enumChannelValueType valueType)
+{
+    switch (valueType) {
+    case KoChannelInfo::UINT8:
+    case KoChannelInfo::UINT16:
+    case KoChannelInfo::FLOAT32:
+        return true;
+#ifdef HAVE_OPENEXR
+    case KoChannelInfo::FLOAT16:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+/**
+ * Fetches the positions of the channels of \p cs in units of the
+ * channel type. All the channels should be of the same type and the
+ * pixel should have exactly one alpha channel.
+ */
+bool fetchChannelLayout(const KoColorSpace *cs, ChannelLayout *layout)
+{
+    const QList<KoChannelInfo*> channels = cs->channels();
+    if (channels.isEmpty()) return false;
+
+    layout->valueType = channels.first()->channelValueType();
+    if (!isSupportedValueType(layout->valueType)) return false;
+
+    const int channelSize = channels.first()->size();
+
+    Q_FOREACH (KoChannelInfo *channel, channels) {
+        if (channel->channelValueType() != layout->valueType) return false;
+
+        const int index = channel->pos() / channelSize;
+
+        if (channel->channelType() == KoChannelInfo::ALPHA) {
+            if (layout->alphaIndex >= 0) return false;
+            layout->alphaIndex = index;
+        } else {
+            layout->colorChannels << channel;
+            layout->colorIndex << index;
+        }
+    }
+
+    layout->numChannels = channels.size();
+
+    return layout->alphaIndex >= 0 &&
+        !layout->colorIndex.isEmpty() &&
+        int(cs->pixelSize()) == layout->numChannels * channelSize;
+}
+
+int integerChannelMax(KoChannelInfo::enumChannelValueType valueType)
+{
+    return valueType == KoChannelInfo::UINT8 ?
+        std::numeric_limits<quint8>::max() :
+        std::numeric_limits<quint16>::max();
+}
+
+/**
+ * Finds the number of grid intervals closest to the requested one,
+ * which divides the range of the integer channel evenly
+ */
+int adjustIntervalsToIntegerRange(int requestedIntervals, int channelMax)
+{
+    int bestIntervals = 1;
+
+    for (int intervals = 1; intervals < maxGridSize; intervals++) {
+        if (channelMax % intervals) continue;
+
+        if (qAbs(intervals - requestedIntervals) < qAbs(bestIntervals - requestedIntervals)) {
+            bestIntervals = intervals;
+        }
+    }
+
+    return bestIntervals;
+}
+
+template<typename T>
+inline T floatToChannel(float value)
+{
+    if (std::numeric_limits<T>::is_integer) {
+        return T(qBound(0.0f, value, float(std::numeric_limits<T>::max())) + 0.5f);
+    } else {
+        return T(value);
+    }
+}
+
+QString cacheFileName(const QString &cacheDirectory,
+                      const KoColorSpace *srcCs,
+                      const KoColorSpace *dstCs,
+                      const QByteArray &transformationKey,
+                      int gridSize)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(transformationKey);
+    hash.addData(srcCs->id().toLatin1());
+    hash.addData(dstCs->id().toLatin1());
+    hash.addData(QByteArray::number(gridSize));
+    hash.addData(QByteArray::number(lutFileVersion));
+
+    return QDir(cacheDirectory).filePath(QString::fromLatin1(hash.result().toHex()) + ".lut");
+}
+
+bool loadSamples(const QString &fileName, int gridSize, int numChannels, QVector<float> *samples)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    // the modification time marks the recently used tables for trimCache()
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    QDataStream stream(&file);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 fileGridSize = 0;
+    quint32 fileNumChannels = 0;
+
+    stream >> magic >> version >> fileGridSize >> fileNumChannels;
+
+    if (stream.status() != QDataStream::Ok ||
+        magic != lutFileMagic ||
+        version != lutFileVersion ||
+        int(fileGridSize) != gridSize ||
+        int(fileNumChannels) != numChannels) {
+
+        return false;
+    }
+
+    QVector<float> result(gridSize * gridSize * gridSize * numChannels);
+    const int numBytes = result.size() * int(sizeof(float));
+
+    if (stream.readRawData(reinterpret_cast<char*>(result.data()), numBytes) != numBytes) {
+        return false;
+    }
+
+    *samples = result;
+    return true;
+}
+
+void saveSamples(const QString &fileName, int gridSize, int numChannels, const QVector<float> &samples)
+{
+    if (!QDir().mkpath(QFileInfo(fileName).absolutePath())) {
+        warnPigment << "Failed to create the directory for the color conversion LUT" << fileName;
+        return;
+    }
+
+    // the file is replaced atomically, so that the other instances never
+    // read a half-written table
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnPigment << "Failed to save the color conversion LUT" << fileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << lutFileMagic << lutFileVersion << quint32(gridSize) << quint32(numChannels);
+    stream.writeRawData(reinterpret_cast<const char*>(samples.constData()),
+                        samples.size() * int(sizeof(float)));
+
+    if (!file.commit()) {
+        warnPigment << "Failed to save the color conversion LUT" << fileName;
+    }
+}
+
+/**
+ * Removes the least recently used tables from \p cacheDirectory
+ * until their total size fits into \p maxCacheSize. The table
+ * \p keptFileName is never removed.
+ */
+void trimCache(const QString &cacheDirectory, qint64 maxCacheSize, const QString &keptFileName)
+{
+    if (maxCacheSize < 0) return;
+
+    const QFileInfoList files =
+        QDir(cacheDirectory).entryInfoList({"*.lut"}, QDir::Files, QDir::Time);
+
+    const QString keptFilePath = QFileInfo(keptFileName).absoluteFilePath();
+    qint64 totalSize = 0;
+
+    Q_FOREACH (const QFileInfo &info, files) {
+        if (info.absoluteFilePath() == keptFilePath) {
+            totalSize += info.size();
+        }
+    }
+
+    // the files are sorted from the most recently used ones
+    Q_FOREACH (const QFileInfo &info, files) {
+        if (info.absoluteFilePath() == keptFilePath) continue;
+
+        if (totalSize + info.size() <= maxCacheSize) {
+            totalSize += info.size();
+        } else if (!QFile::remove(info.absoluteFilePath())) {
+            warnPigment << "Failed to remove the color conversion LUT" << info.absoluteFilePath();
+        }
+    }
+}
+
+}
+
+template<typename SrcChannel, typename DstChannel>
+class KoColorConversionLut3DImpl : public KoColorConversionLut3D
+{
+public:
+    void sampleGrid(const SampleFunction &sampleFunction) override
+    {
+        const int numNodes = m_gridSize * m_gridSize * m_gridSize;
+
+        QVector<SrcChannel> srcPixels(numNodes * m_srcNumChannels);
+        QVector<DstChannel> dstPixels(numNodes * m_dstNumChannels);
+
+        SrcChannel *srcPtr = srcPixels.data();
+
+        for (int i0 = 0; i0 < m_gridSize; i0++) {
+            for (int i1 = 0; i1 < m_gridSize; i1++) {
+                for (int i2 = 0; i2 < m_gridSize; i2++) {
+                    const int node[3] = {i0, i1, i2};
+
+                    for (int c = 0; c < 3; c++) {
+                        srcPtr[m_srcColorIndex[c]] =
+                            floatToChannel<SrcChannel>(m_srcMin[c] + node[c] / m_srcScale[c]);
+                    }
+
+                    srcPtr[m_srcAlphaIndex] = KoColorSpaceMathsTraits<SrcChannel>::unitValue;
+                    srcPtr += m_srcNumChannels;
+                }
+            }
+        }
+
+        sampleFunction(reinterpret_cast<const quint8*>(srcPixels.constData()),
+                       reinterpret_cast<quint8*>(dstPixels.data()),
+                       numNodes);
+
+        m_samples.resize(numNodes * m_numDstColorChannels);
+
+        const DstChannel *dstPtr = dstPixels.constData();
+        float *samplePtr = m_samples.data();
+
+        for (int i = 0; i < numNodes; i++) {
+            for (int k = 0; k < m_numDstColorChannels; k++) {
+                samplePtr[k] = float(dstPtr[m_dstColorIndex[k]]);
+            }
+
+            dstPtr += m_dstNumChannels;
+            samplePtr += m_numDstColorChannels;
+        }
+    }
+
+    int transform(const quint8 *src, quint8 *dst, int numPixels,
+                  int *outOfRangePixels) const override
+    {
+        const SrcChannel *srcPtr = reinterpret_cast<const SrcChannel*>(src);
+        DstChannel *dstPtr = reinterpret_cast<DstChannel*>(dst);
+
+        const float maxCoordinate = float(m_gridSize - 1);
+
+        const int stride[3] = {m_gridSize * m_gridSize * m_numDstColorChannels,
+                               m_gridSize * m_numDstColorChannels,
+                               m_numDstColorChannels};
+        const int diagonalOffset = stride[0] + stride[1] + stride[2];
+
+        float result[maxDstColorChannels];
+
+        int numOutOfRange = 0;
+
+        for (int i = 0; i < numPixels; i++, srcPtr += m_srcNumChannels, dstPtr += m_dstNumChannels) {
+            float t[3];
+            bool isInRange = true;
+
+            for (int c = 0; c < 3; c++) {
+                t[c] = (float(srcPtr[m_srcColorIndex[c]]) - m_srcMin[c]) * m_srcScale[c];
+
+                // NaN values fail both the comparisons
+                isInRange &= t[c] >= 0.0f && t[c] <= maxCoordinate;
+            }
+
+            if (!isInRange) {
+                outOfRangePixels[numOutOfRange++] = i;
+                continue;
+            }
+
+            int offset = 0;
+            float f[3];
+
+            for (int c = 0; c < 3; c++) {
+                const int index = qMin(int(t[c]), m_gridSize - 2);
+                f[c] = t[c] - index;
+                offset += index * stride[c];
+            }
+
+            /**
+             * Tetrahedral interpolation: the cell is split into six
+             * tetrahedra along its main diagonal. The path from the
+             * first corner to the last one goes along the axes in the
+             * descending order of the fractional coordinates.
+             */
+            int a, b, c;
+
+            if (f[0] >= f[1]) {
+                if (f[1] >= f[2]) {
+                    a = 0; b = 1; c = 2;
+                } else if (f[0] >= f[2]) {
+                    a = 0; b = 2; c = 1;
+                } else {
+                    a = 2; b = 0; c = 1;
+                }
+            } else {
+                if (f[2] >= f[1]) {
+                    a = 2; b = 1; c = 0;
+                } else if (f[2] >= f[0]) {
+                    a = 1; b = 2; c = 0;
+                } else {
+                    a = 1; b = 0; c = 2;
+                }
+            }
+
+            const float *c0 = m_samples.constData() + offset;
+            const float *c1 = c0 + stride[a];
+            const float *c2 = c1 + stride[b];
+            const float *c3 = c0 + diagonalOffset;
+
+            for (int k = 0; k < m_numDstColorChannels; k++) {
+                result[k] = c0[k] +
+                    f[a] * (c1[k] - c0[k]) +
+                    f[b] * (c2[k] - c1[k]) +
+                    f[c] * (c3[k] - c2[k]);
+            }
+
+            for (int k = 0; k < m_numDstColorChannels; k++) {
+                dstPtr[m_dstColorIndex[k]] = floatToChannel<DstChannel>(result[k]);
+            }
+
+            dstPtr[m_dstAlphaIndex] =
+                KoColorSpaceMaths<SrcChannel, DstChannel>::scaleToA(srcPtr[m_srcAlphaIndex]);
+        }
+
+        return numOutOfRange;
+    }
+};
+
+namespace {
+
+template<typename SrcChannel>
+KoColorConversionLut3D* createForDstType(KoChannelInfo::enumChannelValueType dstType)
+{
+    switch (dstType) {
+    case KoChannelInfo::UINT8:
+        return new KoColorConversionLut3DImpl<SrcChannel, quint8>();
+    case KoChannelInfo::UINT16:
+        return new KoColorConversionLut3DImpl<SrcChannel, quint16>();
+#ifdef HAVE_OPENEXR
+    case KoChannelInfo::FLOAT16:
+        return new KoColorConversionLut3DImpl<SrcChannel, half>();
+#endif
+    case KoChannelInfo::FLOAT32:
+        return new KoColorConversionLut3DImpl<SrcChannel, float>();
+    default:
+        return 0;
+    }
+}
+
+KoColorConversionLut3D* createForTypes(KoChannelInfo::enumChannelValueType srcType,
+                                       KoChannelInfo::enumChannelValueType dstType)
+{
+    switch (srcType) {
+    case KoChannelInfo::UINT8:
+        return createForDstType<quint8>(dstType);
+    case KoChannelInfo::UINT16:
+        return createForDstType<quint16>(dstType);
+#ifdef HAVE_OPENEXR
+    case KoChannelInfo::FLOAT16:
+        return createForDstType<half>(dstType);
+#endif
+    case KoChannelInfo::FLOAT32:
+        return createForDstType<float>(dstType);
+    default:
+        return 0;
+    }
+}
+
+bool fetchChannelLayouts(const KoColorSpace *srcCs, const KoColorSpace *dstCs,
+                         ChannelLayout *srcLayout, ChannelLayout *dstLayout)
+{
+    return fetchChannelLayout(srcCs, srcLayout) &&
+        srcLayout->colorIndex.size() == 3 &&
+        fetchChannelLayout(dstCs, dstLayout) &&
+        dstLayout->colorIndex.size() <= maxDstColorChannels;
+}
+
+}
+
+KoColorConversionLut3D::KoColorConversionLut3D()
+{
+}
+
+KoColorConversionLut3D::~KoColorConversionLut3D()
+{
+}
+
+KoColorConversionLut3D::Options KoColorConversionLut3D::options()
+{
+    static const Options options = [] () {
+        Options result;
+
+        KConfigGroup cfg = KSharedConfig::openConfig()->group("");
+        result.enabled = cfg.readEntry("useColorConversionLut3D", result.enabled);
+        result.gridSize = cfg.readEntry("colorConversionLut3DGridSize", result.gridSize);
+        result.useDiskCache = cfg.readEntry("colorConversionLut3DUseDiskCache", result.useDiskCache);
+        result.maxDiskCacheSize = cfg.readEntry("colorConversionLut3DMaxDiskCacheSize", result.maxDiskCacheSize);
+
+        return result;
+    }();
+
+    return options;
+}
+
+QString KoColorConversionLut3D::defaultCacheDirectory()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("colorconversionluts");
+}
+
+bool KoColorConversionLut3D::isSupported(const KoColorSpace *srcCs, const KoColorSpace *dstCs)
+{
+    ChannelLayout srcLayout;
+    ChannelLayout dstLayout;
+
+    return fetchChannelLayouts(srcCs, dstCs, &srcLayout, &dstLayout);
+}
+
+KoColorConversionLut3D* KoColorConversionLut3D::create(const KoColorSpace *srcCs,
+                                                       const KoColorSpace *dstCs,
+                                                       const QByteArray &transformationKey,
+                                                       int gridSize,
+                                                       SampleFunction sampleFunction,
+                                                       const QString &cacheDirectory,
+                                                       qint64 maxCacheSize)
+{
+    ChannelLayout srcLayout;
+    ChannelLayout dstLayout;
+
+    if (!fetchChannelLayouts(srcCs, dstCs, &srcLayout, &dstLayout)) return 0;
+
+    KoColorConversionLut3D *lut = createForTypes(srcLayout.valueType, dstLayout.valueType);
+    if (!lut) return 0;
+
+    const bool srcIsInteger =
+        srcLayout.valueType == KoChannelInfo::UINT8 ||
+        srcLayout.valueType == KoChannelInfo::UINT16;
+
+    int intervals = qBound(minGridSize, gridSize, maxGridSize) - 1;
+
+    if (srcIsInteger) {
+        intervals = adjustIntervalsToIntegerRange(intervals, integerChannelMax(srcLayout.valueType));
+    }
+
+    lut->m_gridSize = intervals + 1;
+
+    for (int c = 0; c < 3; c++) {
+        const KoChannelInfo *channel = srcLayout.colorChannels[c];
+
+        const double minValue = srcIsInteger ? 0.0 : channel->getUIMin();
+        const double maxValue = srcIsInteger ? integerChannelMax(srcLayout.valueType) : channel->getUIMax();
+
+        lut->m_srcColorIndex[c] = srcLayout.colorIndex[c];
+        lut->m_srcMin[c] = float(minValue);
+        lut->m_srcScale[c] = float(intervals / (maxValue - minValue));
+    }
+
+    lut->m_srcAlphaIndex = srcLayout.alphaIndex;
+    lut->m_srcNumChannels = srcLayout.numChannels;
+
+    lut->m_numDstColorChannels = dstLayout.colorIndex.size();
+    lut->m_dstColorIndex = dstLayout.colorIndex;
+    lut->m_dstAlphaIndex = dstLayout.alphaIndex;
+    lut->m_dstNumChannels = dstLayout.numChannels;
+
+    const QString fileName =
+        !cacheDirectory.isEmpty() ?
+        cacheFileName(cacheDirectory, srcCs, dstCs, transformationKey, lut->m_gridSize) :
+        QString();
+
+    if (!fileName.isEmpty() &&
+        loadSamples(fileName, lut->m_gridSize, lut->m_numDstColorChannels, &lut->m_samples)) {
+
+        lut->m_isLoadedFromCache = true;
+    } else {
+        lut->sampleGrid(sampleFunction);
+
+        if (!fileName.isEmpty()) {
+            saveSamples(fileName, lut->m_gridSize, lut->m_numDstColorChannels, lut->m_samples);
+            trimCache(cacheDirectory, maxCacheSize, fileName);
+        }
+    }
+
+    return lut;
+}
+
+int KoColorConversionLut3D::gridSize() const
+{
+    return m_gridSize;
+}
+
+bool KoColorConversionLut3D::isLoadedFromCache() const
+{
+    return m_isLoadedFromCache;
+}
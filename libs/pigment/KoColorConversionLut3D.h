@@ -0,0 +1,162 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoColorConversionLut3D_H
+#define KoColorConversionLut3D_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "kritapigment_export.h"
+
+class KoColorSpace;
+
+/**
+ * @brief A color conversion baked into a 3D lookup table
+ *
+ * Some color conversions are very expensive, e.g. the ones involving
+ * LUT-based ICC profiles of printing presses or the soft-proofing
+ * chains. When the source color space has three color channels, such
+ * a conversion can be sampled on a regular grid once and then
+ * evaluated with tetrahedral interpolation, which costs the same for
+ * any conversion.
+ *
+ * The grid covers the full range of the integer source channels and
+ * the UI range of the floating point ones. The pixels outside the
+ * grid cannot be converted with the table and are reported to the
+ * caller, which is expected to convert them with the original
+ * transformation.
+ *
+ * For integer source channels every grid node should be represented
+ * by an exact channel value, so the grid step is always an integer
+ * divisor of the channel range. That is, the actual size of the grid
+ * may differ from the requested one.
+ *
+ * The sampled tables can be stored on disk keyed by a hash of the
+ * description of the transformation, so that every expensive
+ * transformation is sampled only once.
+ */
+class KRITAPIGMENT_EXPORT KoColorConversionLut3D
+{
+public:
+    struct Options {
+        /// the tables are used only when the user asks for it explicitly,
+        /// since they are less precise than the color engine itself
+        bool enabled = false;
+        int gridSize = 52;
+        bool useDiskCache = true;
+        /// the maximal total size of the tables stored on disk, in MiB
+        int maxDiskCacheSize = 64;
+    };
+
+    /**
+     * Converts \p numPixels pixels of the source color space, used for
+     * sampling the conversion in the grid nodes
+     */
+    using SampleFunction = std::function<void(const quint8 *src, quint8 *dst, int numPixels)>;
+
+public:
+    virtual ~KoColorConversionLut3D();
+
+    /**
+     * @return the options set in the application configuration
+     */
+    static Options options();
+
+    /**
+     * @return the directory where the tables are stored by default
+     */
+    static QString defaultCacheDirectory();
+
+    /**
+     * @return true if the conversion from \p srcCs to \p dstCs can be
+     *         represented by a table
+     */
+    static bool isSupported(const KoColorSpace *srcCs, const KoColorSpace *dstCs);
+
+    /**
+     * Creates a table for the conversion from \p srcCs to \p dstCs
+     *
+     * @param transformationKey a unique description of the conversion,
+     *        i.e. the profiles, the intents and the flags
+     * @param gridSize the requested number of grid nodes per channel
+     * @param sampleFunction the conversion itself
+     * @param cacheDirectory the directory the table is loaded from or
+     *        stored to; if empty, the table is always sampled and
+     *        not stored
+     * @param maxCacheSize the maximal total size of the tables in
+     *        \p cacheDirectory, in bytes. When a new table is stored,
+     *        the least recently used ones are removed to fit into
+     *        this size. Negative value means no limit.
+     * @return null if the conversion cannot be represented by a table
+     */
+    static KoColorConversionLut3D* create(const KoColorSpace *srcCs,
+                                          const KoColorSpace *dstCs,
+                                          const QByteArray &transformationKey,
+                                          int gridSize,
+                                          SampleFunction sampleFunction,
+                                          const QString &cacheDirectory = QString(),
+                                          qint64 maxCacheSize = -1);
+
+    /**
+     * @return the actual number of grid nodes per channel
+     */
+    int gridSize() const;
+
+    /**
+     * @return true if the table has been loaded from the disk cache
+     *         instead of being sampled
+     */
+    bool isLoadedFromCache() const;
+
+    /**
+     * Converts \p numPixels pixels from \p src into \p dst. The pixels
+     * outside the grid are not written into \p dst, their indices are
+     * written into \p outOfRangePixels, which should have space for
+     * \p numPixels values.
+     *
+     * @return the number of pixels written into \p outOfRangePixels
+     */
+    virtual int transform(const quint8 *src, quint8 *dst, int numPixels,
+                          int *outOfRangePixels) const = 0;
+
+protected:
+    KoColorConversionLut3D();
+
+    /**
+     * Fills m_samples with the values of \p sampleFunction in the
+     * grid nodes
+     */
+    virtual void sampleGrid(const SampleFunction &sampleFunction) = 0;
+
+protected:
+    int m_gridSize = 0;
+    int m_numDstColorChannels = 0;
+    bool m_isLoadedFromCache = false;
+
+    /// the values of the destination color channels, the first
+    /// source color channel changes the slowest
+    QVector<float> m_samples;
+
+    /// indices of the channels in units of the channel type
+    int m_srcColorIndex[3] = {0, 0, 0};
+    int m_srcAlphaIndex = 0;
+    int m_srcNumChannels = 0;
+
+    QVector<int> m_dstColorIndex;
+    int m_dstAlphaIndex = 0;
+    int m_dstNumChannels = 0;
+
+    /// the source value of the first grid node and the number of
+    /// grid intervals per unit of the source value
+    float m_srcMin[3] = {0.0f, 0.0f, 0.0f};
+    float m_srcScale[3] = {1.0f, 1.0f, 1.0f};
+};
+
+#endif // KoColorConversionLut3D_H
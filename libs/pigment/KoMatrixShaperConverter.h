@@ -0,0 +1,168 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoMatrixShaperConverter_H
+#define KoMatrixShaperConverter_H
+
+#include <cstring>
+
+#include "KoMatrixShaperConverterBase.h"
+#include "KoMultiArchBuildSupport.h"
+
+
+template<typename _impl,
+         typename EnableDummyType = void>
+class KoMatrixShaperConverter : public KoMatrixShaperConverterBase
+{
+public:
+    KoMatrixShaperConverter(const Params &params)
+        : KoMatrixShaperConverterBase(params)
+    {
+    }
+
+    int convertRgbaF32(const quint8 *src, quint8 *dst, int numPixels,
+                       int *outOfRangePixels) const override
+    {
+        const float *srcPtr = reinterpret_cast<const float*>(src);
+        float *dstPtr = reinterpret_cast<float*>(dst);
+
+        int numOutOfRange = 0;
+
+        for (int i = 0; i < numPixels; i++) {
+            if (!convertPixelScalar(srcPtr, dstPtr)) {
+                if (srcPtr != dstPtr) {
+                    memcpy(dstPtr, srcPtr, 4 * sizeof(float));
+                }
+                outOfRangePixels[numOutOfRange++] = i;
+            }
+
+            srcPtr += 4;
+            dstPtr += 4;
+        }
+
+        return numOutOfRange;
+    }
+};
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+
+#include "KoStreamedMath.h"
+
+template<typename _impl>
+class KoMatrixShaperConverter<
+        _impl,
+        typename std::enable_if<!std::is_same<_impl, xsimd::generic>::value>::type> : public KoMatrixShaperConverterBase
+{
+    using int_v = typename KoStreamedMath<_impl>::int_v;
+    using float_v = typename KoStreamedMath<_impl>::float_v;
+    using float_m = typename float_v::batch_bool_type;
+
+public:
+    KoMatrixShaperConverter(const Params &params)
+        : KoMatrixShaperConverterBase(params)
+    {
+    }
+
+    int convertRgbaF32(const quint8 *src, quint8 *dst, int numPixels,
+                       int *outOfRangePixels) const override
+    {
+        const int block1 = numPixels / static_cast<int>(float_v::size);
+        const int block2 = numPixels % static_cast<int>(float_v::size);
+        const int vectorPixelStride = 4 * static_cast<int>(float_v::size) * static_cast<int>(sizeof(float));
+
+        const float_v m0(m_matrix[0]), m1(m_matrix[1]), m2(m_matrix[2]);
+        const float_v m3(m_matrix[3]), m4(m_matrix[4]), m5(m_matrix[5]);
+        const float_v m6(m_matrix[6]), m7(m_matrix[7]), m8(m_matrix[8]);
+
+        PixelWrapper<float, _impl> dataWrapper;
+
+        int numOutOfRange = 0;
+
+        for (int i = 0; i < block1; i++) {
+            float_v r, g, b, alpha;
+            dataWrapper.read(src, r, g, b, alpha);
+
+            float_m outOfRange(false);
+
+            const float_v lr = evaluateCurve(m_srcCurves[0], r, outOfRange);
+            const float_v lg = evaluateCurve(m_srcCurves[1], g, outOfRange);
+            const float_v lb = evaluateCurve(m_srcCurves[2], b, outOfRange);
+
+            float_v dr = m0 * lr + m1 * lg + m2 * lb;
+            float_v dg = m3 * lr + m4 * lg + m5 * lb;
+            float_v db = m6 * lr + m7 * lg + m8 * lb;
+
+            dr = evaluateCurve(m_dstCurves[0], dr, outOfRange);
+            dg = evaluateCurve(m_dstCurves[1], dg, outOfRange);
+            db = evaluateCurve(m_dstCurves[2], db, outOfRange);
+
+            if (xsimd::any(outOfRange)) {
+                dr = xsimd::select(outOfRange, r, dr);
+                dg = xsimd::select(outOfRange, g, dg);
+                db = xsimd::select(outOfRange, b, db);
+
+                alignas(64) float flags[float_v::size];
+                xsimd::select(outOfRange, float_v(1.0f), float_v(0.0f)).store_aligned(flags);
+
+                for (int j = 0; j < static_cast<int>(float_v::size); j++) {
+                    if (flags[j] != 0.0f) {
+                        outOfRangePixels[numOutOfRange++] = i * static_cast<int>(float_v::size) + j;
+                    }
+                }
+            }
+
+            dataWrapper.write(dst, dr, dg, db, alpha);
+
+            src += vectorPixelStride;
+            dst += vectorPixelStride;
+        }
+
+        const float *srcPtr = reinterpret_cast<const float*>(src);
+        float *dstPtr = reinterpret_cast<float*>(dst);
+
+        for (int i = 0; i < block2; i++) {
+            if (!convertPixelScalar(srcPtr, dstPtr)) {
+                if (srcPtr != dstPtr) {
+                    memcpy(dstPtr, srcPtr, 4 * sizeof(float));
+                }
+                outOfRangePixels[numOutOfRange++] = block1 * static_cast<int>(float_v::size) + i;
+            }
+
+            srcPtr += 4;
+            dstPtr += 4;
+        }
+
+        return numOutOfRange;
+    }
+
+private:
+    static ALWAYS_INLINE float_v evaluateCurve(const float *samples, const float_v &value, float_m &outOfRange)
+    {
+        if (!samples) return value;
+
+        // NaN values are not equal to themselves
+        const float_m isOutside =
+            (value < float_v(0.0f)) || (value > float_v(1.0f)) || (value != value);
+        outOfRange = outOfRange || isOutside;
+
+        // the out-of-range lanes are discarded anyway, just keep the
+        // indices inside the table
+        const float_v x = xsimd::select(isOutside, float_v(0.0f), value);
+
+        const float_v t = xsimd::sqrt(x) * float_v(float(numCurveIntervals));
+        const int_v index = xsimd::min(xsimd::to_int(t), int_v(numCurveIntervals - 1));
+        const float_v fraction = t - xsimd::to_float(index);
+
+        const float_v y0 = float_v::gather(samples, index);
+        const float_v y1 = float_v::gather(samples, index + 1);
+
+        return y0 + (y1 - y0) * fraction;
+    }
+};
+
+#endif /* defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) */
+
+#endif // KoMatrixShaperConverter_H
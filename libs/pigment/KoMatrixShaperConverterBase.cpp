@@ -0,0 +1,46 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoMatrixShaperConverterBase.h"
+
+#include <atomic>
+
+#include <kis_assert.h>
+
+namespace {
+std::atomic<int> s_numAliveConverters {0};
+
+const float* curveSamples(const KoMatrixShaperConverterBase::Curve &curve)
+{
+    if (curve.isLinear) return nullptr;
+
+    KIS_ASSERT(curve.samples.size() == KoMatrixShaperConverterBase::numCurveIntervals + 1);
+    return curve.samples.constData();
+}
+}
+
+KoMatrixShaperConverterBase::KoMatrixShaperConverterBase(const Params &params)
+    : m_params(params)
+{
+    for (int i = 0; i < 3; i++) {
+        m_srcCurves[i] = curveSamples(m_params.srcCurves[i]);
+        m_dstCurves[i] = curveSamples(m_params.dstCurves[i]);
+    }
+
+    m_matrix = m_params.matrix;
+
+    s_numAliveConverters++;
+}
+
+KoMatrixShaperConverterBase::~KoMatrixShaperConverterBase()
+{
+    s_numAliveConverters--;
+}
+
+int KoMatrixShaperConverterBase::testingNumAliveConverters()
+{
+    return s_numAliveConverters;
+}
@@ -0,0 +1,158 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoMatrixShaperConverterBase_H
+#define KoMatrixShaperConverterBase_H
+
+#include <cmath>
+
+#include <QtGlobal>
+#include <QVector>
+
+#include "kritapigment_export.h"
+
+/**
+ * @brief Converts RGBA F32 pixels between two RGB matrix-shaper profiles
+ *
+ * Conversion between two matrix-shaper profiles is a simple chain of
+ * operations: the tone curves of the source profile, a 3x3 matrix
+ * (the inverted colorants matrix of the destination profile multiplied
+ * by the colorants matrix of the source one) and the inverted tone
+ * curves of the destination profile. It is much cheaper to do it
+ * directly, in a vectorized way, than pushing every pixel through
+ * the generic pipeline of a color engine.
+ *
+ * The tone curves are sampled in the square-root domain, that is
+ * `samples[i] == curve(sq(i / numCurveIntervals))`, and linearly
+ * interpolated. The square-root domain keeps the interpolation
+ * precise for the power-like curves near zero, where their inverted
+ * versions are the steepest. The interpolated values stay within
+ * ~1e-6 of the curves in most of the range. Only very close to zero,
+ * the inverted pure power curves (without a linear segment) may
+ * deviate up to ~2e-5.
+ *
+ * The sampled curves are defined in [0, 1] range only. If the value of
+ * a channel goes outside this range, while it should be passed through
+ * a non-linear curve, the pixel is not converted, but just copied
+ * into the destination, and its index is reported to the caller. The
+ * caller is expected to convert such pixels with the color engine
+ * itself.
+ *
+ * The actual implementation is placed in class `KoMatrixShaperConverter`.
+ * To create a converter, call KoMatrixShaperConverterFactory, it will
+ * create a version of the converter optimized for your CPU architecture.
+ */
+class KRITAPIGMENT_EXPORT KoMatrixShaperConverterBase
+{
+public:
+    static const int numCurveIntervals = 4096;
+
+    struct Curve {
+        /// the curve is `y = x` for all the values, including the ones
+        /// outside [0, 1] range
+        bool isLinear = true;
+
+        /// numCurveIntervals + 1 samples of the curve in the
+        /// square-root domain, empty for the linear curves
+        QVector<float> samples;
+    };
+
+    struct Params {
+        Curve srcCurves[3];
+
+        /// row-major matrix converting the linearized source
+        /// colors into the linearized destination colors
+        float matrix[9] = {1.0f, 0.0f, 0.0f,
+                           0.0f, 1.0f, 0.0f,
+                           0.0f, 0.0f, 1.0f};
+
+        Curve dstCurves[3];
+    };
+
+public:
+    KoMatrixShaperConverterBase(const Params &params);
+    virtual ~KoMatrixShaperConverterBase();
+
+    /**
+     * Converts \p numPixels RGBA F32 pixels from \p src into \p dst.
+     * \p src and \p dst may point to the same buffer.
+     *
+     * The pixels that cannot be converted precisely are copied into
+     * \p dst unchanged and their indices are written into \p
+     * outOfRangePixels, which should have space for \p numPixels
+     * values.
+     *
+     * @return the number of pixels written into \p outOfRangePixels
+     */
+    virtual int convertRgbaF32(const quint8 *src, quint8 *dst, int numPixels,
+                               int *outOfRangePixels) const = 0;
+
+    /**
+     * The number of converters existing at the moment, used by the
+     * unit tests to check that the converter is actually used
+     */
+    static int testingNumAliveConverters();
+
+protected:
+    static inline bool isInRange(float value) {
+        // NaN values fail both the comparisons
+        return value >= 0.0f && value <= 1.0f;
+    }
+
+    static inline float evaluateCurve(const float *samples, float value) {
+        const float t = std::sqrt(value) * numCurveIntervals;
+        const int index = qMin(int(t), numCurveIntervals - 1);
+        const float fraction = t - float(index);
+
+        return samples[index] + (samples[index + 1] - samples[index]) * fraction;
+    }
+
+    /**
+     * Converts a single pixel with the scalar code
+     *
+     * @return false if the pixel is out of range and should be
+     *         converted by the caller
+     */
+    inline bool convertPixelScalar(const float *src, float *dst) const {
+        float c[3] = {src[0], src[1], src[2]};
+
+        for (int i = 0; i < 3; i++) {
+            if (!m_srcCurves[i]) continue;
+            if (!isInRange(c[i])) return false;
+            c[i] = evaluateCurve(m_srcCurves[i], c[i]);
+        }
+
+        float r[3];
+        for (int i = 0; i < 3; i++) {
+            r[i] = m_matrix[3 * i] * c[0] + m_matrix[3 * i + 1] * c[1] + m_matrix[3 * i + 2] * c[2];
+        }
+
+        for (int i = 0; i < 3; i++) {
+            if (!m_dstCurves[i]) continue;
+            if (!isInRange(r[i])) return false;
+            r[i] = evaluateCurve(m_dstCurves[i], r[i]);
+        }
+
+        const float alpha = src[3];
+
+        dst[0] = r[0];
+        dst[1] = r[1];
+        dst[2] = r[2];
+        dst[3] = alpha;
+
+        return true;
+    }
+
+protected:
+    Params m_params;
+
+    /// pointers into m_params samples, null for the linear curves
+    const float *m_srcCurves[3];
+    const float *m_dstCurves[3];
+    const float *m_matrix;
+};
+
+#endif // KoMatrixShaperConverterBase_H
@@ -0,0 +1,16 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoMatrixShaperConverterFactory.h"
+
+#include "KoMatrixShaperConverterFactoryImpl.h"
+
+
+KoMatrixShaperConverterBase *KoMatrixShaperConverterFactory::createConverter(const KoMatrixShaperConverterBase::Params &params)
+{
+    return createOptimizedClass<
+            KoMatrixShaperConverterFactoryImpl>(params);
+}
@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoMatrixShaperConverterFACTORY_H
+#define KoMatrixShaperConverterFACTORY_H
+
+#include "KoMatrixShaperConverterBase.h"
+
+/**
+ * \see KoMatrixShaperConverterBase
+ */
+class KRITAPIGMENT_EXPORT KoMatrixShaperConverterFactory
+{
+public:
+    static KoMatrixShaperConverterBase* createConverter(const KoMatrixShaperConverterBase::Params &params);
+};
+
+#endif // KoMatrixShaperConverterFACTORY_H
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoMatrixShaperConverterFactoryImpl.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+#include "KoMatrixShaperConverter.h"
+
+template<>
+KoMatrixShaperConverterBase *
+KoMatrixShaperConverterFactoryImpl::create<xsimd::current_arch>(
+    const KoMatrixShaperConverterBase::Params &params)
+{
+    return new KoMatrixShaperConverter<xsimd::current_arch>(params);
+}
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KoMatrixShaperConverterFACTORYIMPL_H
+#define KoMatrixShaperConverterFACTORYIMPL_H
+
+#include <KoMatrixShaperConverterBase.h>
+#include <KoMultiArchBuildSupport.h>
+
+class KRITAPIGMENT_EXPORT KoMatrixShaperConverterFactoryImpl
+{
+public:
+    template<typename _impl>
+    static KoMatrixShaperConverterBase* create(const KoMatrixShaperConverterBase::Params &params);
+};
+
+#endif // KoMatrixShaperConverterFACTORYIMPL_H
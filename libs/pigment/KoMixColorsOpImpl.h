@@ -313,6 +313,14 @@ public:
     {
     }
 
+    /**
+     * The accumulation is intentionally kept scalar. A vectorized version,
+     * accumulating the products in double lanes, was measured with AVX2
+     * on a 256x256 dab and lost to this loop for every depth: it ran at
+     * 0.23-0.44x of the speed for U8 and U16 and at 0.6-1.0x for F32. Even
+     * a hand-written kernel only ties with it, the loop is bound by the
+     * loads and the per-pixel alpha * weight product, not by the additions.
+     */
     void accumulate(const quint8 *data, const qint16 *weights, int weightSum, int nPixels) override
     {
         result.accumulateColors(PointerToArray(data, _CSTrait::pixelSize), WeightsWrapper(weights, weightSum), nPixels);
@@ -0,0 +1,114 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoMixColorsOpBenchmark.h"
+
+#include <random>
+
+#include <simpletest.h>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoMixColorsOp.h>
+
+// the number of pixels of a 256x256 dab
+const int numPixels = 256 * 256;
+
+namespace {
+
+QVector<qint16> generateWeights()
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    QVector<qint16> weights(numPixels);
+    for (auto it = weights.begin(); it != weights.end(); ++it) {
+        *it = qint16(distribution(generator));
+    }
+
+    return weights;
+}
+
+QByteArray generatePixels(int pixelSize)
+{
+    std::mt19937 generator(17);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    QByteArray pixels(numPixels * pixelSize, 0);
+    for (auto it = pixels.begin(); it != pixels.end(); ++it) {
+        *it = char(distribution(generator));
+    }
+
+    return pixels;
+}
+
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixer_data()
+{
+    QTest::addColumn<QString>("modelId");
+    QTest::addColumn<QString>("depthId");
+    QTest::addColumn<bool>("useWeights");
+
+    const QStringList models = {RGBAColorModelID.id(), GrayAColorModelID.id()};
+    const QStringList depths = {Integer8BitsColorDepthID.id(),
+                                Integer16BitsColorDepthID.id(),
+                                Float32BitsColorDepthID.id()};
+
+    Q_FOREACH (const QString &model, models) {
+        Q_FOREACH (const QString &depth, depths) {
+            for (bool useWeights : {true, false}) {
+                const QString name = QString("%1-%2-%3")
+                    .arg(model)
+                    .arg(depth)
+                    .arg(useWeights ? "weighted" : "average");
+
+                QTest::newRow(name.toLatin1()) << model << depth << useWeights;
+            }
+        }
+    }
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixer()
+{
+    QFETCH(QString, modelId);
+    QFETCH(QString, depthId);
+    QFETCH(bool, useWeights);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(modelId, depthId, 0);
+    QVERIFY(cs);
+
+    QByteArray pixels = generatePixels(cs->pixelSize());
+
+    if (depthId == Float32BitsColorDepthID.id()) {
+        // random bits make no sense for floating point channels
+        float *ptr = reinterpret_cast<float*>(pixels.data());
+        for (int i = 0; i < pixels.size() / int(sizeof(float)); i++) {
+            ptr[i] = float((i * 7919) % 1000) / 999.0f;
+        }
+    }
+
+    const QVector<qint16> weights = generateWeights();
+
+    QByteArray result(cs->pixelSize(), 0);
+
+    QBENCHMARK {
+        // a new mixer for every run, the totals would overflow otherwise
+        QScopedPointer<KoMixColorsOp::Mixer> mixer(cs->mixColorsOp()->createMixer());
+
+        if (useWeights) {
+            mixer->accumulate(reinterpret_cast<const quint8*>(pixels.constData()),
+                              weights.constData(), 255, numPixels);
+        } else {
+            mixer->accumulateAverage(reinterpret_cast<const quint8*>(pixels.constData()), numPixels);
+        }
+
+        mixer->computeMixedColor(reinterpret_cast<quint8*>(result.data()));
+    }
+}
+
+SIMPLE_TEST_MAIN(KoMixColorsOpBenchmark)
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOMIXCOLORSOPBENCHMARK_H
+#define KOMIXCOLORSOPBENCHMARK_H
+
+#include <QObject>
+
+class KoMixColorsOpBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchmarkMixer_data();
+    void benchmarkMixer();
+};
+
+#endif // KOMIXCOLORSOPBENCHMARK_H
@@ -39,9 +39,25 @@ struct AddGeneralOps
     static void add(KoColorSpace* cs) { Q_UNUSED(cs); }
 };
 
+template<class Traits, typename Functor>
+KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& category)
+{
+    if constexpr (std::is_base_of_v<KoCmykTraits<typename Traits::channels_type>, Traits>) {
+        if (useSubtractiveBlendingForCmykColorSpaces()) {
+            return new KoCompositeOpGenericSCFunctor<Traits, Functor, KoSubtractiveBlendingPolicy<Traits>>(cs, id, category);
+        } else {
+            return new KoCompositeOpGenericSCFunctor<Traits, Functor, KoAdditiveBlendingPolicy<Traits>>(cs, id, category);
+        }
+    } else {
+        return new KoCompositeOpGenericSCFunctor<Traits, Functor, KoAdditiveBlendingPolicy<Traits>>(cs, id, category);
+    }
+}
+
 template<class Traits>
-struct OptimizedOpsSelector
+struct GenericOpsSelector
 {
+    typedef typename Traits::channels_type Arg;
+
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         if (useCreamyAlphaDarken()) {
             return new KoCompositeOpAlphaDarken<Traits, KoAlphaDarkenParamsWrapperCreamy>(cs);
@@ -56,10 +72,28 @@ struct OptimizedOpsSelector
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return new KoCompositeOpCopy2<Traits>(cs);
     }
+
+    static KoCompositeOp* createMultiplyOp(const KoColorSpace *cs) {
+        return createGenericSCOp<Traits, detail::CompositeFunctionWrapper<Traits, &cfMultiply<Arg>>>(cs, COMPOSITE_MULT, KoCompositeOp::categoryArithmetic());
+    }
+    static KoCompositeOp* createScreenOp(const KoColorSpace *cs) {
+        return createGenericSCOp<Traits, detail::CompositeFunctionWrapper<Traits, &cfScreen<Arg>>>(cs, COMPOSITE_SCREEN, KoCompositeOp::categoryLight());
+    }
+    static KoCompositeOp* createOverlayOp(const KoColorSpace *cs) {
+        return createGenericSCOp<Traits, CFOverlay<Arg>>(cs, COMPOSITE_OVERLAY, KoCompositeOp::categoryMix());
+    }
+    static KoCompositeOp* createSoftLightOp(const KoColorSpace *cs) {
+        return createGenericSCOp<Traits, CFSoftLight<Arg>>(cs, COMPOSITE_SOFT_LIGHT_PHOTOSHOP, KoCompositeOp::categoryLight());
+    }
+};
+
+template<class Traits>
+struct OptimizedOpsSelector : GenericOpsSelector<Traits>
+{
 };
 
 template<>
-struct OptimizedOpsSelector<KoBgrU8Traits>
+struct OptimizedOpsSelector<KoBgrU8Traits> : GenericOpsSelector<KoBgrU8Traits>
 {
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return useCreamyAlphaDarken() ?
@@ -73,10 +107,22 @@ struct OptimizedOpsSelector<KoBgrU8Traits>
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createCopyOp32(cs);
     }
+    static KoCompositeOp* createMultiplyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createMultiplyOp32(cs);
+    }
+    static KoCompositeOp* createScreenOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createScreenOp32(cs);
+    }
+    static KoCompositeOp* createOverlayOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverlayOp32(cs);
+    }
+    static KoCompositeOp* createSoftLightOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createSoftLightOp32(cs);
+    }
 };
 
 template<>
-struct OptimizedOpsSelector<KoLabU8Traits>
+struct OptimizedOpsSelector<KoLabU8Traits> : GenericOpsSelector<KoLabU8Traits>
 {
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return useCreamyAlphaDarken() ?
@@ -92,7 +138,7 @@ struct OptimizedOpsSelector<KoLabU8Traits>
 };
 
 template<>
-struct OptimizedOpsSelector<KoRgbF32Traits>
+struct OptimizedOpsSelector<KoRgbF32Traits> : GenericOpsSelector<KoRgbF32Traits>
 {
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return useCreamyAlphaDarken() ?
@@ -106,10 +152,22 @@ struct OptimizedOpsSelector<KoRgbF32Traits>
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createCopyOp128(cs);
     }
+    static KoCompositeOp* createMultiplyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createMultiplyOp128(cs);
+    }
+    static KoCompositeOp* createScreenOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createScreenOp128(cs);
+    }
+    static KoCompositeOp* createOverlayOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverlayOp128(cs);
+    }
+    static KoCompositeOp* createSoftLightOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createSoftLightOp128(cs);
+    }
 };
 
 template<>
-struct OptimizedOpsSelector<KoBgrU16Traits>
+struct OptimizedOpsSelector<KoBgrU16Traits> : GenericOpsSelector<KoBgrU16Traits>
 {
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return useCreamyAlphaDarken() ?
@@ -123,6 +181,18 @@ struct OptimizedOpsSelector<KoBgrU16Traits>
     static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createCopyOpU64(cs);
     }
+    static KoCompositeOp* createMultiplyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createMultiplyOpU64(cs);
+    }
+    static KoCompositeOp* createScreenOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createScreenOpU64(cs);
+    }
+    static KoCompositeOp* createOverlayOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverlayOpU64(cs);
+    }
+    static KoCompositeOp* createSoftLightOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createSoftLightOpU64(cs);
+    }
 };
 
 
@@ -149,15 +219,7 @@ struct AddGeneralOps<Traits, true>
 
      template<typename Functor>
      static void add(KoColorSpace* cs, const QString& id, const QString& category) {
-         if constexpr (std::is_base_of_v<KoCmykTraits<typename Traits::channels_type>, Traits>) {
-             if (useSubtractiveBlendingForCmykColorSpaces()) {
-                 cs->addCompositeOp(new KoCompositeOpGenericSCFunctor<Traits, Functor, KoSubtractiveBlendingPolicy<Traits>>(cs, id, category));
-             } else {
-                 cs->addCompositeOp(new KoCompositeOpGenericSCFunctor<Traits, Functor, KoAdditiveBlendingPolicy<Traits>>(cs, id, category));
-             }
-         } else {
-             cs->addCompositeOp(new KoCompositeOpGenericSCFunctor<Traits, Functor, KoAdditiveBlendingPolicy<Traits>>(cs, id, category));
-         }
+         cs->addCompositeOp(createGenericSCOp<Traits, Functor>(cs, id, category));
      }
 
      static void add(KoColorSpace* cs) {
@@ -191,7 +253,7 @@ struct AddGeneralOps<Traits, true>
             cs->addCompositeOp(new KoCompositeOpGreater<Traits, KoAdditiveBlendingPolicy<Traits>>(cs));
          }
 
-         add<CFOverlay<Arg>        >(cs, COMPOSITE_OVERLAY       , KoCompositeOp::categoryMix());
+         cs->addCompositeOp(OptimizedOpsSelector<Traits>::createOverlayOp(cs));
          add<CFGrainMerge<Arg>     >(cs, COMPOSITE_GRAIN_MERGE   , KoCompositeOp::categoryMix());
          add<CFGrainExtract<Arg>   >(cs, COMPOSITE_GRAIN_EXTRACT , KoCompositeOp::categoryMix());
          add<FunctorWithSDRClampPolicy<CFHardMix, Arg>>(cs, COMPOSITE_HARD_MIX, KoCompositeOp::categoryMix());
@@ -216,7 +278,7 @@ struct AddGeneralOps<Traits, true>
          add<&cfPenumbraC<Arg>     >(cs, COMPOSITE_PENUMBRAC     , KoCompositeOp::categoryMix());
          add<&cfPenumbraD<Arg>     >(cs, COMPOSITE_PENUMBRAD     , KoCompositeOp::categoryMix());
 
-         add<&cfScreen<Arg>      >(cs, COMPOSITE_SCREEN      , KoCompositeOp::categoryLight());
+         cs->addCompositeOp(OptimizedOpsSelector<Traits>::createScreenOp(cs));
 
          add<FunctorWithSDRClampPolicy<CFColorDodge, Arg>>(cs, COMPOSITE_DODGE, KoCompositeOp::categoryLight());
          if constexpr (!IsIntegerSpace) {
@@ -229,7 +291,7 @@ struct AddGeneralOps<Traits, true>
          add<&cfSoftLightIFSIllusions<Arg>>(cs, COMPOSITE_SOFT_LIGHT_IFS_ILLUSIONS, KoCompositeOp::categoryLight());
          add<&cfSoftLightPegtopDelphi<Arg>>(cs, COMPOSITE_SOFT_LIGHT_PEGTOP_DELPHI, KoCompositeOp::categoryLight());
          add<CFSoftLightSvg<Arg> >(cs, COMPOSITE_SOFT_LIGHT_SVG, KoCompositeOp::categoryLight());
-         add<CFSoftLight<Arg>    >(cs, COMPOSITE_SOFT_LIGHT_PHOTOSHOP, KoCompositeOp::categoryLight());
+         cs->addCompositeOp(OptimizedOpsSelector<Traits>::createSoftLightOp(cs));
          add<CFGammaLight<Arg>   >(cs, COMPOSITE_GAMMA_LIGHT , KoCompositeOp::categoryLight());
          add<CFGammaIllumination<Arg>>(cs, COMPOSITE_GAMMA_ILLUMINATION, KoCompositeOp::categoryLight());
 
@@ -258,7 +320,7 @@ struct AddGeneralOps<Traits, true>
          add<&cfAddition<Arg>        >(cs, COMPOSITE_ADD             , KoCompositeOp::categoryArithmetic());
          add<&cfSubtract<Arg>        >(cs, COMPOSITE_SUBTRACT        , KoCompositeOp::categoryArithmetic());
          add<CFInverseSubtract<Arg>  >(cs, COMPOSITE_INVERSE_SUBTRACT, KoCompositeOp::categoryArithmetic());
-         add<&cfMultiply<Arg>        >(cs, COMPOSITE_MULT            , KoCompositeOp::categoryArithmetic());
+         cs->addCompositeOp(OptimizedOpsSelector<Traits>::createMultiplyOp(cs));
          add<CFDivide<Arg>           >(cs, COMPOSITE_DIVIDE          , KoCompositeOp::categoryArithmetic());
 
          add<&cfModulo<Arg>               >(cs, COMPOSITE_MOD                , KoCompositeOp::categoryModulo());
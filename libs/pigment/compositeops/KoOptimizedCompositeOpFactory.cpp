@@ -78,3 +78,63 @@ KoCompositeOp* KoOptimizedCompositeOpFactory::createCopyOpU64(const KoColorSpace
 {
     return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopyU64> >(cs);
 }
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createMultiplyOp32(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpMultiply32> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createScreenOp32(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpScreen32> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createOverlayOp32(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverlay32> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createSoftLightOp32(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpSoftLight32> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createMultiplyOpU64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpMultiplyU64> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createScreenOpU64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpScreenU64> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createOverlayOpU64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverlayU64> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createSoftLightOpU64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpSoftLightU64> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createMultiplyOp128(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpMultiply128> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createScreenOp128(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpScreen128> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createOverlayOp128(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverlay128> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createSoftLightOp128(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpSoftLight128> >(cs);
+}
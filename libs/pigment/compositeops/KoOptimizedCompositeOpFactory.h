@@ -39,6 +39,19 @@ public:
     static KoCompositeOp* createCopyOp32(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOpHardU64(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOpCreamyU64(const KoColorSpace *cs);
+
+    static KoCompositeOp* createMultiplyOp32(const KoColorSpace *cs);
+    static KoCompositeOp* createScreenOp32(const KoColorSpace *cs);
+    static KoCompositeOp* createOverlayOp32(const KoColorSpace *cs);
+    static KoCompositeOp* createSoftLightOp32(const KoColorSpace *cs);
+    static KoCompositeOp* createMultiplyOpU64(const KoColorSpace *cs);
+    static KoCompositeOp* createScreenOpU64(const KoColorSpace *cs);
+    static KoCompositeOp* createOverlayOpU64(const KoColorSpace *cs);
+    static KoCompositeOp* createSoftLightOpU64(const KoColorSpace *cs);
+    static KoCompositeOp* createMultiplyOp128(const KoColorSpace *cs);
+    static KoCompositeOp* createScreenOp128(const KoColorSpace *cs);
+    static KoCompositeOp* createOverlayOp128(const KoColorSpace *cs);
+    static KoCompositeOp* createSoftLightOp128(const KoColorSpace *cs);
 };
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORY_H */
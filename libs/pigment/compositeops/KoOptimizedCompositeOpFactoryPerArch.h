@@ -49,6 +49,53 @@ class KoOptimizedCompositeOpCopyU64;
 template<typename _impl>
 class KoOptimizedCompositeOpCopy32;
 
+namespace KoOptimizedBlendFunctions
+{
+struct Multiply;
+struct Screen;
+struct Overlay;
+struct SoftLight;
+}
+
+template<typename channels_type, typename BlendFunction, typename _impl>
+class KoOptimizedCompositeOpGenericSC;
+
+template<typename _impl>
+using KoOptimizedCompositeOpMultiply32 = KoOptimizedCompositeOpGenericSC<quint8, KoOptimizedBlendFunctions::Multiply, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpScreen32 = KoOptimizedCompositeOpGenericSC<quint8, KoOptimizedBlendFunctions::Screen, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpOverlay32 = KoOptimizedCompositeOpGenericSC<quint8, KoOptimizedBlendFunctions::Overlay, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpSoftLight32 = KoOptimizedCompositeOpGenericSC<quint8, KoOptimizedBlendFunctions::SoftLight, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpMultiplyU64 = KoOptimizedCompositeOpGenericSC<quint16, KoOptimizedBlendFunctions::Multiply, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpScreenU64 = KoOptimizedCompositeOpGenericSC<quint16, KoOptimizedBlendFunctions::Screen, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpOverlayU64 = KoOptimizedCompositeOpGenericSC<quint16, KoOptimizedBlendFunctions::Overlay, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpSoftLightU64 = KoOptimizedCompositeOpGenericSC<quint16, KoOptimizedBlendFunctions::SoftLight, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpMultiply128 = KoOptimizedCompositeOpGenericSC<float, KoOptimizedBlendFunctions::Multiply, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpScreen128 = KoOptimizedCompositeOpGenericSC<float, KoOptimizedBlendFunctions::Screen, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpOverlay128 = KoOptimizedCompositeOpGenericSC<float, KoOptimizedBlendFunctions::Overlay, _impl>;
+
+template<typename _impl>
+using KoOptimizedCompositeOpSoftLight128 = KoOptimizedCompositeOpGenericSC<float, KoOptimizedBlendFunctions::SoftLight, _impl>;
+
 template<template<typename I> class CompositeOp>
 struct KoOptimizedCompositeOpFactoryPerArch {
     template<typename _impl>
@@ -12,6 +12,10 @@
 #include "KoAlphaDarkenParamsWrapper.h"
 #include "KoCompositeOpOver.h"
 #include "KoCompositeOpCopy2.h"
+#include "KoCompositeOpGeneric.h"
+#include "KoCompositeOpFunctions.h"
+#include "KoColorSpaceBlendingPolicy.h"
+#include "KoCompositeOpRegistry.h"
 
 template<>
 template<>
@@ -121,3 +125,110 @@ KoCompositeOp *KoOptimizedCompositeOpFactoryPerArch<
     return new KoCompositeOpAlphaDarken<KoBgrU16Traits, KoAlphaDarkenParamsWrapperCreamy>(param);
 }
 
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpMultiply32>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSC<KoBgrU8Traits, &cfMultiply<KoBgrU8Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU8Traits>>(param, COMPOSITE_MULT, KoCompositeOp::categoryArithmetic());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpScreen32>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSC<KoBgrU8Traits, &cfScreen<KoBgrU8Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU8Traits>>(param, COMPOSITE_SCREEN, KoCompositeOp::categoryLight());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverlay32>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSCFunctor<KoBgrU8Traits, CFOverlay<KoBgrU8Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU8Traits>>(param, COMPOSITE_OVERLAY, KoCompositeOp::categoryMix());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpSoftLight32>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSCFunctor<KoBgrU8Traits, CFSoftLight<KoBgrU8Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU8Traits>>(param, COMPOSITE_SOFT_LIGHT_PHOTOSHOP, KoCompositeOp::categoryLight());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpMultiplyU64>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSC<KoBgrU16Traits, &cfMultiply<KoBgrU16Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU16Traits>>(param, COMPOSITE_MULT, KoCompositeOp::categoryArithmetic());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpScreenU64>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSC<KoBgrU16Traits, &cfScreen<KoBgrU16Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU16Traits>>(param, COMPOSITE_SCREEN, KoCompositeOp::categoryLight());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverlayU64>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSCFunctor<KoBgrU16Traits, CFOverlay<KoBgrU16Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU16Traits>>(param, COMPOSITE_OVERLAY, KoCompositeOp::categoryMix());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpSoftLightU64>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSCFunctor<KoBgrU16Traits, CFSoftLight<KoBgrU16Traits::channels_type>, KoAdditiveBlendingPolicy<KoBgrU16Traits>>(param, COMPOSITE_SOFT_LIGHT_PHOTOSHOP, KoCompositeOp::categoryLight());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpMultiply128>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSC<KoRgbF32Traits, &cfMultiply<KoRgbF32Traits::channels_type>, KoAdditiveBlendingPolicy<KoRgbF32Traits>>(param, COMPOSITE_MULT, KoCompositeOp::categoryArithmetic());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpScreen128>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSC<KoRgbF32Traits, &cfScreen<KoRgbF32Traits::channels_type>, KoAdditiveBlendingPolicy<KoRgbF32Traits>>(param, COMPOSITE_SCREEN, KoCompositeOp::categoryLight());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverlay128>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSCFunctor<KoRgbF32Traits, CFOverlay<KoRgbF32Traits::channels_type>, KoAdditiveBlendingPolicy<KoRgbF32Traits>>(param, COMPOSITE_OVERLAY, KoCompositeOp::categoryMix());
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpSoftLight128>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpGenericSCFunctor<KoRgbF32Traits, CFSoftLight<KoRgbF32Traits::channels_type>, KoAdditiveBlendingPolicy<KoRgbF32Traits>>(param, COMPOSITE_SOFT_LIGHT_PHOTOSHOP, KoCompositeOp::categoryLight());
+}
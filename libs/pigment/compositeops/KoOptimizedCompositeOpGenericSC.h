@@ -0,0 +1,389 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPGENERICSC_H_
+#define KOOPTIMIZEDCOMPOSITEOPGENERICSC_H_
+
+#include <cmath>
+#include <limits>
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+
+/**
+ * Blending functions for KoOptimizedCompositeOpGenericSC. Every
+ * function works on normalized channel values and is written once
+ * for both, a single float and xsimd::batch<float>, so the vector
+ * and the scalar paths of the compositor give the same result.
+ *
+ * The functions must match their counterparts in
+ * KoCompositeOpFunctions.h, including the clamping of the source and
+ * destination values (see KoCompositeOpGenericFunctorBase.h).
+ */
+namespace KoOptimizedBlendFunctions
+{
+
+template<typename M, typename T>
+ALWAYS_INLINE T select(const M &cond, const T &a, const T &b)
+{
+    return xsimd::select(cond, a, b);
+}
+
+ALWAYS_INLINE float select(bool cond, float a, float b)
+{
+    return cond ? a : b;
+}
+
+template<typename T>
+ALWAYS_INLINE T sqrt(const T &x)
+{
+    return xsimd::sqrt(x);
+}
+
+ALWAYS_INLINE float sqrt(float x)
+{
+    return std::sqrt(x);
+}
+
+/// \see cfMultiply
+struct Multiply {
+    static constexpr bool clampSource = false;
+    static constexpr bool clampDestination = false;
+
+    static QString id() { return COMPOSITE_MULT; }
+    static QString category() { return KoCompositeOp::categoryArithmetic(); }
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return src * dst;
+    }
+};
+
+/// \see cfScreen
+struct Screen {
+    static constexpr bool clampSource = false;
+    static constexpr bool clampDestination = false;
+
+    static QString id() { return COMPOSITE_SCREEN; }
+    static QString category() { return KoCompositeOp::categoryLight(); }
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        return src + dst - src * dst;
+    }
+};
+
+/// \see CFOverlay
+struct Overlay {
+    static constexpr bool clampSource = true;
+    static constexpr bool clampDestination = false;
+
+    static QString id() { return COMPOSITE_OVERLAY; }
+    static QString category() { return KoCompositeOp::categoryMix(); }
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        const T dst2 = dst + dst;
+        const T dst2m1 = dst2 - T(1.0f);
+
+        // hard light with swapped arguments
+        return select(dst > T(0.5f),
+                      dst2m1 + src - dst2m1 * src,
+                      dst2 * src);
+    }
+};
+
+/// \see CFSoftLight
+struct SoftLight {
+    static constexpr bool clampSource = true;
+    static constexpr bool clampDestination = true;
+
+    static QString id() { return COMPOSITE_SOFT_LIGHT_PHOTOSHOP; }
+    static QString category() { return KoCompositeOp::categoryLight(); }
+
+    template<typename T>
+    static ALWAYS_INLINE T blend(const T &src, const T &dst)
+    {
+        const T src2m1 = src + src - T(1.0f);
+
+        return select(src > T(0.5f),
+                      dst + src2m1 * (sqrt(dst) - dst),
+                      dst + src2m1 * dst * (T(1.0f) - dst));
+    }
+};
+
+}
+
+/**
+ * A compositor for separable blending modes, that is, the modes
+ * composing every color channel independently via \p BlendFunction.
+ * It implements the same formula as KoCompositeOpGenericSC does:
+ *
+ *     Ra = Sa + Da - Sa * Da
+ *     Rc = (Sa * (1 - Da) * Sc + Da * (1 - Sa) * Dc + Sa * Da * B(Sc, Dc)) / Ra
+ *
+ * All the math is done in floats with the color channels normalized
+ * into [0, 1] range for the integer color spaces.
+ */
+template<typename channels_type, typename BlendFunction, bool alphaLocked, bool allChannelsFlag>
+struct GenericSCCompositor128 {
+    struct ParamsWrapper {
+        ParamsWrapper(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags)
+        {
+        }
+        const QBitArray &channelFlags;
+    };
+
+    struct Pixel {
+        channels_type red;
+        channels_type green;
+        channels_type blue;
+        channels_type alpha;
+    };
+
+    static constexpr float channelMax =
+        std::numeric_limits<channels_type>::is_integer ?
+            float(std::numeric_limits<channels_type>::max()) : 1.0f;
+
+    template<typename T>
+    static ALWAYS_INLINE T clampToUnit(const T &value)
+    {
+        return xsimd::min(xsimd::max(value, T(0.0f)), T(1.0f));
+    }
+
+    static ALWAYS_INLINE float clampToUnit(float value)
+    {
+        return qBound(0.0f, value, 1.0f);
+    }
+
+    /**
+     * Clamping is a no-op for the integer color spaces, their values
+     * never leave [0, 1] range after normalization
+     */
+    template<typename T>
+    static ALWAYS_INLINE T prepareSource(const T &value)
+    {
+        return BlendFunction::clampSource && !std::numeric_limits<channels_type>::is_integer ?
+            clampToUnit(value) : value;
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T prepareDestination(const T &value)
+    {
+        return BlendFunction::clampDestination && !std::numeric_limits<channels_type>::is_integer ?
+            clampToUnit(value) : value;
+    }
+
+    template<typename T>
+    static ALWAYS_INLINE T composeChannel(const T &src, const T &dst,
+                                          const T &srcOnly, const T &dstOnly, const T &both)
+    {
+        const T s = prepareSource(src);
+        const T d = prepareDestination(dst);
+
+        return srcOnly * s + dstOnly * d + both * BlendFunction::blend(s, d);
+    }
+
+    // \see docs in AlphaDarkenCompositor32
+    template<bool haveMask, bool src_aligned, typename _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const ParamsWrapper &oparams)
+    {
+        using float_v = typename KoStreamedMath<_impl>::float_v;
+        using float_m = typename float_v::batch_bool_type;
+
+        Q_UNUSED(oparams);
+
+        float_v src_alpha;
+        float_v dst_alpha;
+
+        float_v src_c1;
+        float_v src_c2;
+        float_v src_c3;
+
+        PixelWrapper<channels_type, _impl> dataWrapper;
+        dataWrapper.read(src, src_c1, src_c2, src_c3, src_alpha);
+
+        src_alpha *= float_v(opacity);
+
+        if (haveMask) {
+            const float_v uint8MaxRec1((float)1.0 / 255);
+            float_v mask_vec = KoStreamedMath<_impl>::fetch_mask_8(mask);
+            src_alpha *= mask_vec * uint8MaxRec1;
+        }
+
+        const float_v zeroValue(0.0f);
+
+        // the source cannot change the destination, since it is fully transparent
+        if (xsimd::all(src_alpha == zeroValue)) {
+            return;
+        }
+
+        float_v dst_c1;
+        float_v dst_c2;
+        float_v dst_c3;
+
+        dataWrapper.read(dst, dst_c1, dst_c2, dst_c3, dst_alpha);
+
+        const float_v channelMaxRec1(1.0f / channelMax);
+
+        const float_v both = src_alpha * dst_alpha;
+        const float_v srcOnly = src_alpha - both;
+        const float_v dstOnly = dst_alpha - both;
+        const float_v new_alpha = src_alpha + dstOnly;
+
+        /**
+         * The pixels with transparent source should be kept
+         * untouched, though the value of new_alpha can be zero for
+         * them, which will result in NaN values while division.
+         */
+        const float_m keepDst = src_alpha == zeroValue;
+        const float_v scale = xsimd::set_zero(float_v(channelMax) / new_alpha, keepDst);
+
+        float_v c1 = composeChannel(src_c1 * channelMaxRec1, dst_c1 * channelMaxRec1, srcOnly, dstOnly, both) * scale;
+        float_v c2 = composeChannel(src_c2 * channelMaxRec1, dst_c2 * channelMaxRec1, srcOnly, dstOnly, both) * scale;
+        float_v c3 = composeChannel(src_c3 * channelMaxRec1, dst_c3 * channelMaxRec1, srcOnly, dstOnly, both) * scale;
+
+        if (xsimd::any(keepDst)) {
+            c1 = xsimd::select(keepDst, dst_c1, c1);
+            c2 = xsimd::select(keepDst, dst_c2, c2);
+            c3 = xsimd::select(keepDst, dst_c3, c3);
+        }
+
+        dataWrapper.write(dst, c1, c2, c3, xsimd::select(keepDst, dst_alpha, new_alpha));
+    }
+
+    template<bool haveMask, typename _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src,
+                                                      quint8 *dst,
+                                                      const quint8 *mask,
+                                                      float opacity,
+                                                      const ParamsWrapper &oparams)
+    {
+        using Wrapper = PixelWrapper<channels_type, _impl>;
+        const qint32 alpha_pos = 3;
+
+        const auto *s = reinterpret_cast<const channels_type*>(src);
+        auto *d = reinterpret_cast<channels_type*>(dst);
+
+        float srcAlpha = s[alpha_pos];
+        Wrapper::normalizeAlpha(srcAlpha);
+        srcAlpha *= opacity;
+
+        if (haveMask) {
+            const float uint8Rec1 = 1.0f / 255.0f;
+            srcAlpha *= float(*mask) * uint8Rec1;
+        }
+
+        if (srcAlpha == 0.0f) return;
+
+        float dstAlpha = d[alpha_pos];
+        Wrapper::normalizeAlpha(dstAlpha);
+
+        const float channelMaxRec1 = 1.0f / channelMax;
+        const QBitArray &channelFlags = oparams.channelFlags;
+
+        if (alphaLocked) {
+            if (dstAlpha == 0.0f) return;
+
+            for (int i = 0; i < alpha_pos; i++) {
+                if (allChannelsFlag || channelFlags.at(i)) {
+                    const float sc = prepareSource(float(s[i]) * channelMaxRec1);
+                    const float dc = prepareDestination(float(d[i]) * channelMaxRec1);
+                    const float result = dc + (BlendFunction::blend(sc, dc) - dc) * srcAlpha;
+
+                    d[i] = Wrapper::roundFloatToUint(result * channelMax);
+                }
+            }
+            return;
+        }
+
+        if (!allChannelsFlag && dstAlpha == 0.0f) {
+            KoStreamedMathFunctions::clearPixel<sizeof(Pixel)>(dst);
+        }
+
+        const float both = srcAlpha * dstAlpha;
+        const float srcOnly = srcAlpha - both;
+        const float dstOnly = dstAlpha - both;
+        float newAlpha = srcAlpha + dstOnly;
+        const float scale = channelMax / newAlpha;
+
+        for (int i = 0; i < alpha_pos; i++) {
+            if (allChannelsFlag || channelFlags.at(i)) {
+                const float result =
+                    composeChannel(float(s[i]) * channelMaxRec1, float(d[i]) * channelMaxRec1,
+                                   srcOnly, dstOnly, both);
+
+                d[i] = Wrapper::roundFloatToUint(result * scale);
+            }
+        }
+
+        Wrapper::denormalizeAlpha(newAlpha);
+        d[alpha_pos] = Wrapper::roundFloatToUint(newAlpha);
+    }
+};
+
+/**
+ * An optimized version of KoCompositeOpGenericSC for the use in RGBA
+ * colorspaces with 8-bit, 16-bit and 32-bit float channels, with alpha
+ * channel placed at the last position of the pixel: C1_C2_C3_A.
+ *
+ * The id and the category of the op are taken from \p BlendFunction
+ */
+template<typename channels_type, typename BlendFunction, typename _impl>
+class KoOptimizedCompositeOpGenericSC : public KoCompositeOp
+{
+    static const int pixelSize = 4 * sizeof(channels_type);
+
+    template<bool alphaLocked, bool allChannelsFlag>
+    using Compositor = GenericSCCompositor128<channels_type, BlendFunction, alphaLocked, allChannelsFlag>;
+
+public:
+    KoOptimizedCompositeOpGenericSC(const KoColorSpace* cs)
+        : KoCompositeOp(cs, BlendFunction::id(), BlendFunction::category()) {}
+
+    using KoCompositeOp::composite;
+
+    void composite(const KoCompositeOp::ParameterInfo& params) const override
+    {
+        if(params.maskRowStart) {
+            composite<true>(params);
+        } else {
+            composite<false>(params);
+        }
+    }
+
+    template <bool haveMask>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite<haveMask, false, Compositor<false, true>, pixelSize>(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite_novector<haveMask, false, Compositor<true, true>, pixelSize>(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite_novector<haveMask, false, Compositor<false, false>, pixelSize>(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite_novector<haveMask, false, Compositor<true, false>, pixelSize>(params);
+            }
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPGENERICSC_H_
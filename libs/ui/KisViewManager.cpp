@@ -89,6 +89,7 @@
 #include <kis_layer.h>
 #include "kis_mainwindow_observer.h"
 #include "kis_mask_manager.h"
+#include <kis_memory_statistics_server.h>
 #include "kis_mirror_manager.h"
 #include "kis_node_commands_adapter.h"
 #include "kis_node.h"
@@ -456,6 +457,9 @@ void KisViewManager::setCurrentView(KisView *view)
         /// because other dockers may request it to recalcualte stuff
         d->idleTasksManager.setImage(d->currentImageView->image());
 
+        /// the data of the other images will be swapped out first
+        KisMemoryStatisticsServer::instance()->setActiveImage(d->currentImageView->image());
+
         d->softProof->setChecked(imageView->softProofing());
         d->gamutCheck->setChecked(imageView->gamutCheck());
 
@@ -0,0 +1,245 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisFreehandStrokeRecorderTest.h"
+
+#include <simpletest.h>
+
+#include <QTemporaryDir>
+
+#include <KoColor.h>
+#include <KoCanvasResourceProvider.h>
+#include <KisGlobalResourcesInterface.h>
+#include <brushengine/kis_paintop_preset.h>
+
+#include "kis_image.h"
+#include "kis_paint_layer.h"
+#include "kis_surrogate_undo_store.h"
+#include "kis_resources_snapshot.h"
+#include "KisAsynchronousStrokeUpdateHelper.h"
+#include "KisFreehandStrokeRecorder.h"
+#include "strokes/freehand_stroke.h"
+#include "strokes/KisFreehandStrokeInfo.h"
+
+#include "stroke_testing_utils.h"
+#include "testutil.h"
+
+namespace {
+
+const QString PRESET_FILE_NAME("Basic_tip_default.kpp");
+
+QVector<KisFreehandStrokeRecorder::Job> createTestingJobs()
+{
+    using Job = KisFreehandStrokeRecorder::Job;
+
+    QVector<Job> jobs;
+
+    Job job;
+
+    job.type = Job::Point;
+    job.pi1 = KisPaintInformation(QPointF(20, 20), 0.3, 0.1, -0.2, 15.0);
+    jobs << job;
+
+    job.type = Job::Line;
+    job.pi1 = KisPaintInformation(QPointF(20, 20), 0.3);
+    job.pi2 = KisPaintInformation(QPointF(150, 60), 0.9);
+    jobs << job;
+
+    job.type = Job::Curve;
+    job.pi1 = KisPaintInformation(QPointF(150, 60), 0.9);
+    job.control1 = QPointF(180, 120);
+    job.control2 = QPointF(90, 170);
+    job.pi2 = KisPaintInformation(QPointF(40, 150), 0.5);
+    jobs << job;
+
+    return jobs;
+}
+
+void paintJobs(KisImageSP image, KisResourcesSnapshotSP resources,
+               const KisDistanceInitInfo &startDistInfo,
+               const QVector<KisFreehandStrokeRecorder::Job> &jobs)
+{
+    KisDistanceInitInfo distInfo = startDistInfo;
+    KisDistanceInformation startDist = distInfo.makeDistInfo();
+
+    QVector<KisFreehandStrokeInfo*> strokeInfos;
+    strokeInfos << new KisFreehandStrokeInfo(startDist);
+
+    KisStrokeId strokeId =
+        image->startStroke(new FreehandStrokeStrategy(resources, strokeInfos,
+                                                      kundo2_noi18n("recorder-test")));
+
+    Q_FOREACH (const KisFreehandStrokeRecorder::Job &job, jobs) {
+        FreehandStrokeStrategy::Data *data = 0;
+
+        switch (job.type) {
+        case KisFreehandStrokeRecorder::Job::Point:
+            data = new FreehandStrokeStrategy::Data(job.strokeInfoId, job.pi1);
+            break;
+        case KisFreehandStrokeRecorder::Job::Line:
+            data = new FreehandStrokeStrategy::Data(job.strokeInfoId, job.pi1, job.pi2);
+            break;
+        case KisFreehandStrokeRecorder::Job::Curve:
+            data = new FreehandStrokeStrategy::Data(job.strokeInfoId,
+                                                    job.pi1, job.control1,
+                                                    job.control2, job.pi2);
+            break;
+        }
+
+        image->addJob(strokeId, data);
+    }
+
+    image->addJob(strokeId, new KisAsynchronousStrokeUpdateHelper::UpdateData(true));
+    image->endStroke(strokeId);
+    image->waitForDone();
+}
+
+void comparePaintInformation(const KisPaintInformation &pi, const KisPaintInformation &ref)
+{
+    QCOMPARE(pi.pos(), ref.pos());
+    QCOMPARE(pi.pressure(), ref.pressure());
+    QCOMPARE(pi.xTilt(), ref.xTilt());
+    QCOMPARE(pi.yTilt(), ref.yTilt());
+    QCOMPARE(pi.rotation(), ref.rotation());
+}
+
+}
+
+void KisFreehandStrokeRecorderTest::testRoundTrip()
+{
+    using Job = KisFreehandStrokeRecorder::Job;
+
+    KisImageSP image = utils::createImage(new KisSurrogateUndoStore(), QSize(200, 200));
+    QScopedPointer<KoCanvasResourceProvider> manager(
+        utils::createResourceManager(image, 0, PRESET_FILE_NAME));
+
+    KisNodeSP node = image->root()->firstChild();
+
+    KisResourcesSnapshotSP resources =
+        new KisResourcesSnapshot(image, node, manager.data());
+    resources->setFGColorOverride(KoColor(Qt::red, image->colorSpace()));
+    resources->setOpacity(0.75);
+
+    const KisDistanceInitInfo startDistInfo(QPointF(10, 10), 0.5, 3);
+    const QVector<Job> jobs = createTestingJobs();
+
+    KisFreehandStrokeRecorder recorder;
+    recorder.setEnabled(true);
+
+    const int recordedStrokeId = recorder.startStroke(resources, startDistInfo, 1);
+    QCOMPARE(recordedStrokeId, 0);
+
+    Q_FOREACH (const Job &job, jobs) {
+        switch (job.type) {
+        case Job::Point:
+            recorder.addPoint(recordedStrokeId, job.strokeInfoId, job.pi1);
+            break;
+        case Job::Line:
+            recorder.addLine(recordedStrokeId, job.strokeInfoId, job.pi1, job.pi2);
+            break;
+        case Job::Curve:
+            recorder.addCurve(recordedStrokeId, job.strokeInfoId,
+                              job.pi1, job.control1, job.control2, job.pi2);
+            break;
+        }
+    }
+
+    recorder.endStroke(recordedStrokeId);
+    QCOMPARE(recorder.numStrokes(), 1);
+
+    paintJobs(image, resources, startDistInfo, jobs);
+
+    QTemporaryDir tempDir;
+    const QString fileName = tempDir.filePath("recording.xml");
+    QVERIFY(recorder.save(fileName));
+
+    bool ok = false;
+    QVector<KisFreehandStrokeRecorder::Stroke> strokes =
+        KisFreehandStrokeRecorder::load(fileName, KisGlobalResourcesInterface::instance(), &ok);
+
+    QVERIFY(ok);
+    QCOMPARE(strokes.size(), 1);
+
+    const KisFreehandStrokeRecorder::Stroke &stroke = strokes.first();
+
+    // resources
+    QCOMPARE(stroke.nodeName, node->name());
+    QCOMPARE(stroke.opacity, 0.75);
+    QCOMPARE(stroke.fgColor, resources->currentFgColor());
+    QCOMPARE(stroke.bgColor, resources->currentBgColor());
+    QVERIFY(stroke.preset);
+    QCOMPARE(stroke.preset->name(), resources->currentPaintOpPreset()->name());
+    QCOMPARE(stroke.preset->paintOp(), resources->currentPaintOpPreset()->paintOp());
+    QCOMPARE(stroke.startDistInfo, startDistInfo);
+    QCOMPARE(stroke.numStrokeInfos, 1);
+    QVERIFY(!stroke.cancelled);
+
+    // paint information
+    QCOMPARE(stroke.jobs.size(), jobs.size());
+
+    for (int i = 0; i < jobs.size(); i++) {
+        const Job &job = stroke.jobs[i];
+        const Job &ref = jobs[i];
+
+        QCOMPARE(job.type, ref.type);
+        QCOMPARE(job.strokeInfoId, ref.strokeInfoId);
+        QVERIFY(job.time >= 0);
+
+        comparePaintInformation(job.pi1, ref.pi1);
+
+        if (ref.type != Job::Point) {
+            comparePaintInformation(job.pi2, ref.pi2);
+        }
+
+        if (ref.type == Job::Curve) {
+            QCOMPARE(job.control1, ref.control1);
+            QCOMPARE(job.control2, ref.control2);
+        }
+    }
+
+    // replayed pixels
+    KisImageSP replayImage = utils::createImage(new KisSurrogateUndoStore(), QSize(200, 200));
+    KisNodeSP replayNode = replayImage->root()->firstChild();
+
+    KisResourcesSnapshotSP replayResources = new KisResourcesSnapshot(replayImage, replayNode);
+    replayResources->setBrush(stroke.preset);
+    replayResources->setFGColorOverride(stroke.fgColor);
+    replayResources->setBGColorOverride(stroke.bgColor);
+    replayResources->setOpacity(stroke.opacity);
+
+    paintJobs(replayImage, replayResources, stroke.startDistInfo, stroke.jobs);
+
+    QVERIFY(!node->paintDevice()->exactBounds().isEmpty());
+
+    QPoint errorPoint;
+    if (!TestUtil::comparePaintDevices(errorPoint, node->paintDevice(), replayNode->paintDevice())) {
+        QFAIL(QString("Replayed stroke differs from the original at %1,%2")
+              .arg(errorPoint.x()).arg(errorPoint.y()).toLatin1());
+    }
+}
+
+void KisFreehandStrokeRecorderTest::testDisabledRecorder()
+{
+    KisImageSP image = utils::createImage(new KisSurrogateUndoStore(), QSize(200, 200));
+    QScopedPointer<KoCanvasResourceProvider> manager(
+        utils::createResourceManager(image, 0, PRESET_FILE_NAME));
+
+    KisResourcesSnapshotSP resources =
+        new KisResourcesSnapshot(image, image->root()->firstChild(), manager.data());
+
+    KisFreehandStrokeRecorder recorder;
+    QVERIFY(!recorder.isEnabled());
+
+    const int recordedStrokeId = recorder.startStroke(resources, KisDistanceInitInfo(), 1);
+    QCOMPARE(recordedStrokeId, -1);
+
+    recorder.addPoint(recordedStrokeId, 0, KisPaintInformation(QPointF(10, 10)));
+    recorder.endStroke(recordedStrokeId);
+
+    QCOMPARE(recorder.numStrokes(), 0);
+}
+
+SIMPLE_TEST_MAIN(KisFreehandStrokeRecorderTest)
@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISFREEHANDSTROKERECORDERTEST_H
+#define KISFREEHANDSTROKERECORDERTEST_H
+
+#include <QObject>
+
+class KisFreehandStrokeRecorderTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRoundTrip();
+    void testDisabledRecorder();
+};
+
+#endif // KISFREEHANDSTROKERECORDERTEST_H
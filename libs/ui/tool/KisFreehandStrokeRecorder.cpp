@@ -0,0 +1,379 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisFreehandStrokeRecorder.h"
+
+#include <atomic>
+
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGlobalStatic>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <kis_debug.h>
+#include <kis_dom_utils.h>
+#include <brushengine/kis_paintop_preset.h>
+
+#include "kis_node.h"
+
+
+Q_GLOBAL_STATIC(KisFreehandStrokeRecorder, s_instance)
+
+namespace {
+
+const int FORMAT_VERSION = 1;
+
+QString jobTypeName(KisFreehandStrokeRecorder::Job::Type type)
+{
+    switch (type) {
+    case KisFreehandStrokeRecorder::Job::Point:
+        return "point";
+    case KisFreehandStrokeRecorder::Job::Line:
+        return "line";
+    case KisFreehandStrokeRecorder::Job::Curve:
+        return "curve";
+    }
+
+    return "point";
+}
+
+KisFreehandStrokeRecorder::Job::Type jobTypeFromName(const QString &name)
+{
+    return
+        name == "line" ? KisFreehandStrokeRecorder::Job::Line :
+        name == "curve" ? KisFreehandStrokeRecorder::Job::Curve :
+        KisFreehandStrokeRecorder::Job::Point;
+}
+
+void savePaintInformation(QDomDocument &doc, QDomElement &parent,
+                          const QString &tag, const KisPaintInformation &pi)
+{
+    QDomElement e = doc.createElement(tag);
+    pi.toXML(doc, e);
+    parent.appendChild(e);
+}
+
+void saveColor(QDomDocument &doc, QDomElement &parent,
+               const QString &tag, const KoColor &color)
+{
+    QDomElement e = doc.createElement(tag);
+    e.appendChild(doc.createTextNode(color.toXML()));
+    parent.appendChild(e);
+}
+
+}
+
+struct KisFreehandStrokeRecorder::Private
+{
+    Private()
+    {
+        resetDocument();
+    }
+
+    std::atomic<bool> enabled {false};
+
+    QMutex mutex;
+    QDomDocument document;
+    QVector<QDomElement> strokeElements;
+    QHash<int, QElapsedTimer> runningStrokes;
+
+    QString exitRecordFile;
+
+    void resetDocument() {
+        document = QDomDocument("strokeRecording");
+        QDomElement root = document.createElement("strokeRecording");
+        root.setAttribute("version", FORMAT_VERSION);
+        document.appendChild(root);
+
+        strokeElements.clear();
+        runningStrokes.clear();
+    }
+
+    /**
+     * Creates an element for a new job of the stroke, returns a null
+     * element if the stroke is not being recorded anymore
+     */
+    QDomElement addJobElement(int strokeId, Job::Type type, int strokeInfoId) {
+        auto it = runningStrokes.constFind(strokeId);
+        if (it == runningStrokes.constEnd()) return QDomElement();
+
+        QDomElement e = document.createElement("job");
+        e.setAttribute("type", jobTypeName(type));
+        e.setAttribute("strokeInfo", strokeInfoId);
+        e.setAttribute("time", KisDomUtils::toString(it->elapsed()));
+        strokeElements[strokeId].appendChild(e);
+
+        return e;
+    }
+
+    void finishStroke(int strokeId, bool cancelled) {
+        auto it = runningStrokes.find(strokeId);
+        if (it == runningStrokes.end()) return;
+
+        QDomElement strokeElement = strokeElements[strokeId];
+        strokeElement.setAttribute("duration", KisDomUtils::toString(it->elapsed()));
+        strokeElement.setAttribute("cancelled", int(cancelled));
+
+        runningStrokes.erase(it);
+    }
+};
+
+KisFreehandStrokeRecorder::KisFreehandStrokeRecorder()
+    : m_d(new Private)
+{
+    m_d->exitRecordFile = qEnvironmentVariable("KRITA_STROKE_RECORD_FILE");
+
+    if (!m_d->exitRecordFile.isEmpty()) {
+        setEnabled(true);
+    }
+}
+
+KisFreehandStrokeRecorder::~KisFreehandStrokeRecorder()
+{
+    if (!m_d->exitRecordFile.isEmpty()) {
+        save(m_d->exitRecordFile);
+    }
+}
+
+KisFreehandStrokeRecorder* KisFreehandStrokeRecorder::instance()
+{
+    return s_instance;
+}
+
+bool KisFreehandStrokeRecorder::isEnabled() const
+{
+    return m_d->enabled.load(std::memory_order_relaxed);
+}
+
+void KisFreehandStrokeRecorder::setEnabled(bool value)
+{
+    m_d->enabled.store(value, std::memory_order_relaxed);
+}
+
+int KisFreehandStrokeRecorder::startStroke(KisResourcesSnapshotSP resources,
+                                           const KisDistanceInitInfo &startDistInfo,
+                                           int numStrokeInfos)
+{
+    if (!isEnabled()) return -1;
+
+    KisPaintOpPresetSP preset = resources->currentPaintOpPreset();
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(preset, -1);
+
+    KisNodeSP node = resources->currentNode();
+
+    QMutexLocker l(&m_d->mutex);
+
+    QDomDocument &doc = m_d->document;
+
+    QDomElement strokeElement = doc.createElement("stroke");
+    strokeElement.setAttribute("node", node ? node->name() : QString());
+    strokeElement.setAttribute("opacity", KisDomUtils::toString(resources->opacity()));
+    strokeElement.setAttribute("strokeInfos", numStrokeInfos);
+
+    QDomElement presetElement = doc.createElement("preset");
+    preset->toXML(doc, presetElement);
+    strokeElement.appendChild(presetElement);
+
+    saveColor(doc, strokeElement, "fgColor", resources->currentFgColor());
+    saveColor(doc, strokeElement, "bgColor", resources->currentBgColor());
+
+    QDomElement distElement = doc.createElement("startDist");
+    startDistInfo.toXML(doc, distElement);
+    strokeElement.appendChild(distElement);
+
+    doc.documentElement().appendChild(strokeElement);
+
+    const int strokeId = m_d->strokeElements.size();
+    m_d->strokeElements.append(strokeElement);
+    m_d->runningStrokes[strokeId].start();
+
+    return strokeId;
+}
+
+void KisFreehandStrokeRecorder::addPoint(int strokeId, int strokeInfoId,
+                                         const KisPaintInformation &pi)
+{
+    if (strokeId < 0) return;
+
+    QMutexLocker l(&m_d->mutex);
+
+    QDomElement e = m_d->addJobElement(strokeId, Job::Point, strokeInfoId);
+    if (e.isNull()) return;
+
+    savePaintInformation(m_d->document, e, "pi1", pi);
+}
+
+void KisFreehandStrokeRecorder::addLine(int strokeId, int strokeInfoId,
+                                        const KisPaintInformation &pi1,
+                                        const KisPaintInformation &pi2)
+{
+    if (strokeId < 0) return;
+
+    QMutexLocker l(&m_d->mutex);
+
+    QDomElement e = m_d->addJobElement(strokeId, Job::Line, strokeInfoId);
+    if (e.isNull()) return;
+
+    savePaintInformation(m_d->document, e, "pi1", pi1);
+    savePaintInformation(m_d->document, e, "pi2", pi2);
+}
+
+void KisFreehandStrokeRecorder::addCurve(int strokeId, int strokeInfoId,
+                                         const KisPaintInformation &pi1,
+                                         const QPointF &control1,
+                                         const QPointF &control2,
+                                         const KisPaintInformation &pi2)
+{
+    if (strokeId < 0) return;
+
+    QMutexLocker l(&m_d->mutex);
+
+    QDomElement e = m_d->addJobElement(strokeId, Job::Curve, strokeInfoId);
+    if (e.isNull()) return;
+
+    savePaintInformation(m_d->document, e, "pi1", pi1);
+    savePaintInformation(m_d->document, e, "pi2", pi2);
+    KisDomUtils::saveValue(&e, "control1", control1);
+    KisDomUtils::saveValue(&e, "control2", control2);
+}
+
+void KisFreehandStrokeRecorder::endStroke(int strokeId)
+{
+    if (strokeId < 0) return;
+
+    QMutexLocker l(&m_d->mutex);
+    m_d->finishStroke(strokeId, false);
+}
+
+void KisFreehandStrokeRecorder::cancelStroke(int strokeId)
+{
+    if (strokeId < 0) return;
+
+    QMutexLocker l(&m_d->mutex);
+    m_d->finishStroke(strokeId, true);
+}
+
+int KisFreehandStrokeRecorder::numStrokes() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->strokeElements.size();
+}
+
+void KisFreehandStrokeRecorder::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->resetDocument();
+}
+
+QByteArray KisFreehandStrokeRecorder::toXML() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->document.toByteArray();
+}
+
+bool KisFreehandStrokeRecorder::save(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnTools << "KisFreehandStrokeRecorder: failed to open" << fileName;
+        return false;
+    }
+
+    file.write(toXML());
+    return true;
+}
+
+QVector<KisFreehandStrokeRecorder::Stroke>
+KisFreehandStrokeRecorder::load(const QString &fileName,
+                                KisResourcesInterfaceSP resourcesInterface,
+                                bool *ok)
+{
+    QVector<Stroke> strokes;
+    if (ok) *ok = false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        warnTools << "KisFreehandStrokeRecorder: failed to open" << fileName;
+        return strokes;
+    }
+
+    QDomDocument doc;
+    QString errorMessage;
+    if (!doc.setContent(&file, &errorMessage)) {
+        warnTools << "KisFreehandStrokeRecorder: failed to parse" << fileName << errorMessage;
+        return strokes;
+    }
+
+    QDomElement root = doc.documentElement();
+    if (root.tagName() != "strokeRecording" ||
+        root.attribute("version").toInt() != FORMAT_VERSION) {
+
+        warnTools << "KisFreehandStrokeRecorder: unsupported recording format" << fileName;
+        return strokes;
+    }
+
+    for (QDomElement strokeElement = root.firstChildElement("stroke");
+         !strokeElement.isNull();
+         strokeElement = strokeElement.nextSiblingElement("stroke")) {
+
+        Stroke stroke;
+        stroke.nodeName = strokeElement.attribute("node");
+        stroke.opacity = KisDomUtils::toDouble(strokeElement.attribute("opacity", "1.0"));
+        stroke.numStrokeInfos = qMax(1, strokeElement.attribute("strokeInfos", "1").toInt());
+        stroke.cancelled = strokeElement.attribute("cancelled", "0").toInt();
+
+        KisPaintOpPresetSP preset(new KisPaintOpPreset());
+        preset->fromXML(strokeElement.firstChildElement("preset"), resourcesInterface);
+        if (!preset->valid()) {
+            warnTools << "KisFreehandStrokeRecorder: skipping a stroke with an invalid preset"
+                      << preset->name();
+            continue;
+        }
+        stroke.preset = preset;
+
+        stroke.fgColor = KoColor::fromXML(strokeElement.firstChildElement("fgColor").text());
+        stroke.bgColor = KoColor::fromXML(strokeElement.firstChildElement("bgColor").text());
+        stroke.startDistInfo =
+            KisDistanceInitInfo::fromXML(strokeElement.firstChildElement("startDist"));
+
+        for (QDomElement jobElement = strokeElement.firstChildElement("job");
+             !jobElement.isNull();
+             jobElement = jobElement.nextSiblingElement("job")) {
+
+            Job job;
+            job.type = jobTypeFromName(jobElement.attribute("type"));
+            job.strokeInfoId = jobElement.attribute("strokeInfo", "0").toInt();
+            job.time = jobElement.attribute("time", "0").toLongLong();
+
+            job.pi1 = KisPaintInformation::fromXML(jobElement.firstChildElement("pi1"));
+
+            if (job.type != Job::Point) {
+                job.pi2 = KisPaintInformation::fromXML(jobElement.firstChildElement("pi2"));
+            }
+
+            if (job.type == Job::Curve) {
+                KisDomUtils::loadValue(jobElement, "control1", &job.control1);
+                KisDomUtils::loadValue(jobElement, "control2", &job.control2);
+            }
+
+            if (job.strokeInfoId < 0 || job.strokeInfoId >= stroke.numStrokeInfos) {
+                warnTools << "KisFreehandStrokeRecorder: skipping a job with invalid stroke info id"
+                          << job.strokeInfoId;
+                continue;
+            }
+
+            stroke.jobs.append(job);
+        }
+
+        strokes.append(stroke);
+    }
+
+    if (ok) *ok = true;
+    return strokes;
+}
@@ -0,0 +1,134 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISFREEHANDSTROKERECORDER_H
+#define KISFREEHANDSTROKERECORDER_H
+
+#include <QScopedPointer>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+#include <KoColor.h>
+#include <KisResourcesInterface.h>
+
+#include "kis_types.h"
+#include "kis_distance_information.h"
+#include <brushengine/kis_paint_information.h>
+#include "kis_resources_snapshot.h"
+#include "kritaui_export.h"
+
+/**
+ * Records the stream of freehand stroke jobs generated by
+ * KisToolFreehandHelper (and KisToolMultihandHelper), so that a real
+ * painting session could be replayed headlessly later, e.g. by
+ * KisStrokeReplayBenchmark.
+ *
+ * For every stroke the recorder saves the paintop preset, the colors,
+ * the opacity, the name of the painted node and the initial distance
+ * information, and then every dab job (point, line or curve) with the
+ * time it was emitted at, relative to the start of the stroke.
+ *
+ * The preset is serialized right at the start of the stroke, since
+ * its linked resources may be unavailable on application exit.
+ *
+ * The recording is disabled by default. It is enabled by setting
+ * KRITA_STROKE_RECORD_FILE environment variable, the recorded strokes
+ * are written into the passed file on application exit.
+ */
+class KRITAUI_EXPORT KisFreehandStrokeRecorder
+{
+public:
+    struct Job {
+        enum Type {
+            Point = 0,
+            Line,
+            Curve
+        };
+
+        Type type = Point;
+        int strokeInfoId = 0;
+        /// in milliseconds since the start of the stroke
+        qint64 time = 0;
+
+        KisPaintInformation pi1;
+        KisPaintInformation pi2;
+        QPointF control1;
+        QPointF control2;
+    };
+
+    struct Stroke {
+        QString nodeName;
+        KisPaintOpPresetSP preset;
+        KoColor fgColor;
+        KoColor bgColor;
+        qreal opacity = 1.0;
+
+        KisDistanceInitInfo startDistInfo;
+        int numStrokeInfos = 1;
+
+        QVector<Job> jobs;
+        bool cancelled = false;
+    };
+
+public:
+    KisFreehandStrokeRecorder();
+    ~KisFreehandStrokeRecorder();
+
+    static KisFreehandStrokeRecorder* instance();
+
+    bool isEnabled() const;
+    void setEnabled(bool value);
+
+    /**
+     * Starts recording a new stroke
+     *
+     * @return the id of the recorded stroke to be passed to the other
+     *         calls, or -1 if the recording is disabled
+     */
+    int startStroke(KisResourcesSnapshotSP resources,
+                    const KisDistanceInitInfo &startDistInfo,
+                    int numStrokeInfos);
+
+    void addPoint(int strokeId, int strokeInfoId,
+                  const KisPaintInformation &pi);
+
+    void addLine(int strokeId, int strokeInfoId,
+                 const KisPaintInformation &pi1,
+                 const KisPaintInformation &pi2);
+
+    void addCurve(int strokeId, int strokeInfoId,
+                  const KisPaintInformation &pi1,
+                  const QPointF &control1,
+                  const QPointF &control2,
+                  const KisPaintInformation &pi2);
+
+    void endStroke(int strokeId);
+    void cancelStroke(int strokeId);
+
+    /**
+     * The number of strokes recorded since the last clear()
+     */
+    int numStrokes() const;
+    void clear();
+
+    QByteArray toXML() const;
+    bool save(const QString &fileName) const;
+
+    /**
+     * Loads the strokes saved with save(). The presets are linked to
+     * \p resourcesInterface.
+     */
+    static QVector<Stroke> load(const QString &fileName,
+                                KisResourcesInterfaceSP resourcesInterface,
+                                bool *ok = 0);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISFREEHANDSTROKERECORDER_H
@@ -34,6 +34,7 @@
 #include "strokes/freehand_stroke.h"
 #include "strokes/KisFreehandStrokeInfo.h"
 #include "KisAsynchronousStrokeUpdateHelper.h"
+#include "KisFreehandStrokeRecorder.h"
 #include "kis_canvas_resource_provider.h"
 #include <KisOptimizedBrushOutline.h>
 
@@ -74,6 +75,7 @@ struct KisToolFreehandHelper::Private
     QVector<KisFreehandStrokeInfo*> strokeInfos;
     KisResourcesSnapshotSP resources;
     KisStrokeId strokeId;
+    int recordedStrokeId = -1;
 
     KisPaintInformation previousPaintInformation;
     KisPaintInformation olderPaintInformation;
@@ -310,6 +312,11 @@ void KisToolFreehandHelper::initPaintImpl(qreal startAngle,
 
     m_d->strokeId = m_d->strokesFacade->startStroke(stroke);
 
+    m_d->recordedStrokeId =
+        KisFreehandStrokeRecorder::instance()->startStroke(m_d->resources,
+                                                           startDistInfo,
+                                                           m_d->strokeInfos.size());
+
     m_d->history.clear();
     m_d->distanceHistory.clear();
     m_d->lastDrawnPixel = QPointF(-1.0, -1.0); 
@@ -701,6 +708,9 @@ void KisToolFreehandHelper::endPaint()
 
     m_d->strokesFacade->endStroke(m_d->strokeId);
     m_d->strokeId.clear();
+
+    KisFreehandStrokeRecorder::instance()->endStroke(m_d->recordedStrokeId);
+    m_d->recordedStrokeId = -1;
     m_d->infoBuilder->reset();
 }
 
@@ -732,6 +742,9 @@ void KisToolFreehandHelper::cancelPaint()
     m_d->strokesFacade->cancelStroke(m_d->strokeId);
     m_d->strokeId.clear();
 
+    KisFreehandStrokeRecorder::instance()->cancelStroke(m_d->recordedStrokeId);
+    m_d->recordedStrokeId = -1;
+
 }
 
 int KisToolFreehandHelper::elapsedStrokeTime() const
@@ -977,6 +990,8 @@ void KisToolFreehandHelper::paintAt(int strokeInfoId,
     m_d->strokesFacade->addJob(m_d->strokeId,
                                new FreehandStrokeStrategy::Data(strokeInfoId, pi));
 
+    KisFreehandStrokeRecorder::instance()->addPoint(m_d->recordedStrokeId, strokeInfoId, pi);
+
 }
 
 void KisToolFreehandHelper::paintLine(int strokeInfoId,
@@ -987,6 +1002,8 @@ void KisToolFreehandHelper::paintLine(int strokeInfoId,
     m_d->strokesFacade->addJob(m_d->strokeId,
                                new FreehandStrokeStrategy::Data(strokeInfoId, pi1, pi2));
 
+    KisFreehandStrokeRecorder::instance()->addLine(m_d->recordedStrokeId, strokeInfoId, pi1, pi2);
+
 }
 
 void KisToolFreehandHelper::paintBezierCurve(int strokeInfoId,
@@ -1025,6 +1042,9 @@ void KisToolFreehandHelper::paintBezierCurve(int strokeInfoId,
                                new FreehandStrokeStrategy::Data(strokeInfoId,
                                                                 pi1, control1, control2, pi2));
 
+    KisFreehandStrokeRecorder::instance()->addCurve(m_d->recordedStrokeId, strokeInfoId,
+                                                    pi1, control1, control2, pi2);
+
 }
 
 void KisToolFreehandHelper::createPainters(QVector<KisFreehandStrokeInfo*> &strokeInfos,
@@ -80,6 +80,8 @@ void KisPainterBasedStrokeStrategy::init()
 
     enableJob(KisSimpleStrokeStrategy::JOB_SUSPEND);
     enableJob(KisSimpleStrokeStrategy::JOB_RESUME);
+
+    setPriorityClass(KisStrokeStrategy::PRIORITY_INTERACTIVE);
 }
 
 KisPainterBasedStrokeStrategy::KisPainterBasedStrokeStrategy(const KisPainterBasedStrokeStrategy &rhs, int levelOfDetail)
@@ -7,13 +7,110 @@
 
 #include "IccColorSpaceEngine.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <QScopedPointer>
+#include <QVarLengthArray>
+
 #include <klocalizedstring.h>
 
+#include <KoColorConversionLut3D.h>
 #include <KoColorModelStandardIds.h>
+#include <KoMatrixShaperConverterFactory.h>
 #include <kis_assert.h>
 
 #include "LcmsColorSpace.h"
 
+namespace {
+
+/**
+ * The conversions involving LUT-based profiles (and the soft-proofing
+ * chains) are expensive enough to be baked into a 3D table. The tables
+ * are used only when enabled in the configuration and when lcms is
+ * allowed to optimize the transformation.
+ */
+bool shouldUseLut3D(const KoColorSpace *srcCs, const LcmsColorProfileContainer *srcProfile,
+                    const KoColorSpace *dstCs, const LcmsColorProfileContainer *dstProfile,
+                    KoColorConversionTransformation::Intent renderingIntent,
+                    KoColorConversionTransformation::ConversionFlags conversionFlags,
+                    bool isProofingTransformation)
+{
+    /**
+     * The gamut warning color should be painted exactly over the
+     * out-of-gamut pixels, the interpolation would smear it into the
+     * neighbouring colors
+     */
+    if (!KoColorConversionLut3D::options().enabled ||
+        conversionFlags.testFlag(KoColorConversionTransformation::NoOptimization) ||
+        conversionFlags.testFlag(KoColorConversionTransformation::GamutCheck) ||
+        !KoColorConversionLut3D::isSupported(srcCs, dstCs)) {
+
+        return false;
+    }
+
+    return isProofingTransformation ||
+        cmsIsCLUT(srcProfile->lcmsProfile(), renderingIntent, LCMS_USED_AS_INPUT) ||
+        cmsIsCLUT(dstProfile->lcmsProfile(), renderingIntent, LCMS_USED_AS_OUTPUT);
+}
+
+KoColorConversionLut3D* createLut3D(const KoColorSpace *srcCs, const KoColorSpace *dstCs,
+                                    const QByteArray &transformationKey,
+                                    cmsHTRANSFORM transform)
+{
+    const KoColorConversionLut3D::Options options = KoColorConversionLut3D::options();
+
+    return KoColorConversionLut3D::create(srcCs, dstCs, transformationKey, options.gridSize,
+        [transform] (const quint8 *src, quint8 *dst, int numPixels) {
+            cmsDoTransform(transform, const_cast<quint8 *>(src), dst, numPixels);
+        },
+        options.useDiskCache ? KoColorConversionLut3D::defaultCacheDirectory() : QString(),
+        qint64(options.maxDiskCacheSize) * 1024 * 1024);
+}
+
+/**
+ * Converts the pixels with the table, the pixels outside the grid
+ * are converted by lcms itself
+ */
+void transformWithLut3D(const KoColorConversionLut3D *lut, cmsHTRANSFORM transform,
+                        const quint8 *src, quint8 *dst, qint32 numPixels,
+                        int srcPixelSize, int dstPixelSize)
+{
+    const int maxChunkSize = 256;
+
+    int outOfRangePixels[maxChunkSize];
+    QVarLengthArray<quint8, 4096> srcData;
+    QVarLengthArray<quint8, 4096> dstData;
+
+    while (numPixels > 0) {
+        const int chunkSize = qMin(numPixels, maxChunkSize);
+
+        const int numOutOfRange = lut->transform(src, dst, chunkSize, outOfRangePixels);
+
+        if (numOutOfRange) {
+            srcData.resize(numOutOfRange * srcPixelSize);
+            dstData.resize(numOutOfRange * dstPixelSize);
+
+            for (int i = 0; i < numOutOfRange; i++) {
+                memcpy(srcData.data() + i * srcPixelSize, src + outOfRangePixels[i] * srcPixelSize, srcPixelSize);
+            }
+
+            cmsDoTransform(transform, srcData.data(), dstData.data(), numOutOfRange);
+
+            for (int i = 0; i < numOutOfRange; i++) {
+                memcpy(dst + outOfRangePixels[i] * dstPixelSize, dstData.constData() + i * dstPixelSize, dstPixelSize);
+            }
+        }
+
+        src += chunkSize * srcPixelSize;
+        dst += chunkSize * dstPixelSize;
+        numPixels -= chunkSize;
+    }
+}
+
+}
+
 // -- KoLcmsColorConversionTransformation --
 
 class KoLcmsColorConversionTransformation : public KoColorConversionTransformation
@@ -45,10 +142,24 @@ public:
                                          conversionFlags);
 
         Q_ASSERT(m_transform);
+
+        if (m_transform &&
+            shouldUseLut3D(srcCs, srcProfile, dstCs, dstProfile,
+                           renderingIntent, conversionFlags, false)) {
+
+            QByteArray key;
+            key += srcProfile->getProfileUniqueId();
+            key += dstProfile->getProfileUniqueId();
+            key += QByteArray::number(int(renderingIntent));
+            key += QByteArray::number(int(conversionFlags));
+
+            m_lut.reset(createLut3D(srcCs, dstCs, key, m_transform));
+        }
     }
 
     ~KoLcmsColorConversionTransformation() override
     {
+        m_lut.reset();
         cmsDeleteTransform(m_transform);
     }
 
@@ -58,11 +169,287 @@ public:
     {
         Q_ASSERT(m_transform);
 
+        if (m_lut) {
+            transformWithLut3D(m_lut.data(), m_transform, src, dst, numPixels,
+                               srcColorSpace()->pixelSize(), dstColorSpace()->pixelSize());
+            return;
+        }
+
         cmsDoTransform(m_transform, const_cast<quint8 *>(src), dst, numPixels);
 
     }
 private:
     mutable cmsHTRANSFORM m_transform;
+    QScopedPointer<KoColorConversionLut3D> m_lut;
+};
+
+// -- KoLcmsMatrixShaperColorConversionTransformation --
+
+namespace {
+
+/**
+ * The identity curve should keep the values outside [0, 1] range
+ * as well, which is not the case for the tabulated curves
+ */
+bool isIdentityCurve(const cmsToneCurve *curve)
+{
+    if (cmsEvalToneCurveFloat(curve, -0.5f) != -0.5f ||
+        cmsEvalToneCurveFloat(curve, 2.0f) != 2.0f) {
+
+        return false;
+    }
+
+    for (int i = 0; i <= KoMatrixShaperConverterBase::numCurveIntervals; i++) {
+        const float x = float(i) / KoMatrixShaperConverterBase::numCurveIntervals;
+        if (cmsEvalToneCurveFloat(curve, x) != x) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+KoMatrixShaperConverterBase::Curve sampleCurve(const cmsToneCurve *curve)
+{
+    KoMatrixShaperConverterBase::Curve result;
+
+    if (isIdentityCurve(curve)) return result;
+
+    result.isLinear = false;
+    result.samples.resize(KoMatrixShaperConverterBase::numCurveIntervals + 1);
+
+    for (int i = 0; i <= KoMatrixShaperConverterBase::numCurveIntervals; i++) {
+        const float x = float(i) / KoMatrixShaperConverterBase::numCurveIntervals;
+        result.samples[i] = cmsEvalToneCurveFloat(curve, x * x);
+    }
+
+    return result;
+}
+
+bool isRgbMatrixShaper(const LcmsColorProfileContainer *profile,
+                       cmsUInt32Number renderingIntent,
+                       cmsUInt32Number direction)
+{
+    const cmsHPROFILE lcmsProfile = profile->lcmsProfile();
+
+    // lcms prefers the LUT-based tags over the matrix-shaper ones
+    return profile->colorSpaceSignature() == cmsSigRgbData &&
+        cmsGetPCS(lcmsProfile) == cmsSigXYZData &&
+        cmsIsMatrixShaper(lcmsProfile) &&
+        !cmsIsCLUT(lcmsProfile, renderingIntent, direction);
+}
+
+/**
+ * Reads the RGB->XYZ matrix the same way as lcms does
+ */
+bool readColorantsMatrix(cmsHPROFILE profile, double matrix[9])
+{
+    const cmsCIEXYZ *red = static_cast<cmsCIEXYZ *>(cmsReadTag(profile, cmsSigRedColorantTag));
+    const cmsCIEXYZ *green = static_cast<cmsCIEXYZ *>(cmsReadTag(profile, cmsSigGreenColorantTag));
+    const cmsCIEXYZ *blue = static_cast<cmsCIEXYZ *>(cmsReadTag(profile, cmsSigBlueColorantTag));
+
+    if (!red || !green || !blue) return false;
+
+    const double values[9] = {red->X, green->X, blue->X,
+                              red->Y, green->Y, blue->Y,
+                              red->Z, green->Z, blue->Z};
+
+    std::copy(values, values + 9, matrix);
+    return true;
+}
+
+bool invertMatrix(const double m[9], double result[9])
+{
+    const double c0 = m[4] * m[8] - m[5] * m[7];
+    const double c1 = m[5] * m[6] - m[3] * m[8];
+    const double c2 = m[3] * m[7] - m[4] * m[6];
+
+    const double det = m[0] * c0 + m[1] * c1 + m[2] * c2;
+    if (std::abs(det) < 1e-8) return false;
+
+    result[0] = c0 / det;
+    result[1] = (m[2] * m[7] - m[1] * m[8]) / det;
+    result[2] = (m[1] * m[5] - m[2] * m[4]) / det;
+    result[3] = c1 / det;
+    result[4] = (m[0] * m[8] - m[2] * m[6]) / det;
+    result[5] = (m[2] * m[3] - m[0] * m[5]) / det;
+    result[6] = c2 / det;
+    result[7] = (m[1] * m[6] - m[0] * m[7]) / det;
+    result[8] = (m[0] * m[4] - m[1] * m[3]) / det;
+
+    return true;
+}
+
+/**
+ * lcms applies black point compensation when it is requested
+ * explicitly, or implicitly for V4 profiles in perceptual and
+ * saturation intents. It is a no-op when the black points of the
+ * profiles are equal, which is usually the case for the
+ * matrix-shaper profiles.
+ */
+bool needsBlackPointCompensation(cmsHPROFILE srcProfile, cmsHPROFILE dstProfile,
+                                 KoColorConversionTransformation::Intent renderingIntent,
+                                 KoColorConversionTransformation::ConversionFlags conversionFlags)
+{
+    bool bpc = conversionFlags.testFlag(KoColorConversionTransformation::BlackpointCompensation);
+
+    if ((renderingIntent == KoColorConversionTransformation::IntentPerceptual ||
+         renderingIntent == KoColorConversionTransformation::IntentSaturation) &&
+        (cmsGetEncodedICCversion(srcProfile) >= 0x4000000 ||
+         cmsGetEncodedICCversion(dstProfile) >= 0x4000000)) {
+
+        bpc = true;
+    }
+
+    if (!bpc) return false;
+
+    cmsCIEXYZ srcBlackPoint;
+    cmsCIEXYZ dstBlackPoint;
+
+    cmsDetectBlackPoint(&srcBlackPoint, srcProfile, renderingIntent, 0);
+    cmsDetectDestinationBlackPoint(&dstBlackPoint, dstProfile, renderingIntent, 0);
+
+    return srcBlackPoint.X != dstBlackPoint.X ||
+        srcBlackPoint.Y != dstBlackPoint.Y ||
+        srcBlackPoint.Z != dstBlackPoint.Z;
+}
+
+/**
+ * Creates a converter for the conversion between two RGB matrix-shaper
+ * profiles, which gives the same result as lcms itself. Returns null
+ * if the conversion cannot be expressed as a matrix-shaper one.
+ */
+KoMatrixShaperConverterBase* createMatrixShaperConverter(const LcmsColorProfileContainer *srcProfile,
+                                                         const LcmsColorProfileContainer *dstProfile,
+                                                         KoColorConversionTransformation::Intent renderingIntent,
+                                                         KoColorConversionTransformation::ConversionFlags conversionFlags)
+{
+    if (renderingIntent == KoColorConversionTransformation::IntentAbsoluteColorimetric ||
+        conversionFlags.testFlag(KoColorConversionTransformation::GamutCheck) ||
+        conversionFlags.testFlag(KoColorConversionTransformation::SoftProofing)) {
+
+        return nullptr;
+    }
+
+    if (!isRgbMatrixShaper(srcProfile, renderingIntent, LCMS_USED_AS_INPUT) ||
+        !isRgbMatrixShaper(dstProfile, renderingIntent, LCMS_USED_AS_OUTPUT)) {
+
+        return nullptr;
+    }
+
+    const cmsHPROFILE srcLcmsProfile = srcProfile->lcmsProfile();
+    const cmsHPROFILE dstLcmsProfile = dstProfile->lcmsProfile();
+
+    double srcMatrix[9];
+    double dstMatrix[9];
+    double dstInvertedMatrix[9];
+
+    if (!readColorantsMatrix(srcLcmsProfile, srcMatrix) ||
+        !readColorantsMatrix(dstLcmsProfile, dstMatrix) ||
+        !invertMatrix(dstMatrix, dstInvertedMatrix)) {
+
+        return nullptr;
+    }
+
+    if (needsBlackPointCompensation(srcLcmsProfile, dstLcmsProfile, renderingIntent, conversionFlags)) {
+        return nullptr;
+    }
+
+    const cmsTagSignature trcTags[3] = {cmsSigRedTRCTag, cmsSigGreenTRCTag, cmsSigBlueTRCTag};
+
+    KoMatrixShaperConverterBase::Params params;
+
+    for (int i = 0; i < 3; i++) {
+        const cmsToneCurve *srcCurve = static_cast<cmsToneCurve *>(cmsReadTag(srcLcmsProfile, trcTags[i]));
+        const cmsToneCurve *dstCurve = static_cast<cmsToneCurve *>(cmsReadTag(dstLcmsProfile, trcTags[i]));
+
+        if (!srcCurve || !dstCurve) return nullptr;
+
+        // lcms uses the reversed destination curves in the output pipeline
+        cmsToneCurve *reversedDstCurve = cmsReverseToneCurve(dstCurve);
+        if (!reversedDstCurve) return nullptr;
+
+        params.srcCurves[i] = sampleCurve(srcCurve);
+        params.dstCurves[i] = sampleCurve(reversedDstCurve);
+
+        cmsFreeToneCurve(reversedDstCurve);
+    }
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            double value = 0.0;
+
+            for (int k = 0; k < 3; k++) {
+                value += dstInvertedMatrix[3 * row + k] * srcMatrix[3 * k + col];
+            }
+
+            params.matrix[3 * row + col] = float(value);
+        }
+    }
+
+    return KoMatrixShaperConverterFactory::createConverter(params);
+}
+
+}
+
+/**
+ * Converts RGBA F32 pixels between two matrix-shaper profiles
+ * bypassing lcms. The pixels that go outside the range of the
+ * sampled tone curves are converted by lcms itself.
+ */
+class KoLcmsMatrixShaperColorConversionTransformation : public KoColorConversionTransformation
+{
+    static const int maxChunkSize = 256;
+    static const int pixelSize = 4 * sizeof(float);
+
+public:
+    KoLcmsMatrixShaperColorConversionTransformation(const KoColorSpace *srcCs,
+                                                    const KoColorSpace *dstCs,
+                                                    Intent renderingIntent,
+                                                    ConversionFlags conversionFlags,
+                                                    KoMatrixShaperConverterBase *converter,
+                                                    KoColorConversionTransformation *fallbackTransformation)
+        : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags)
+        , m_converter(converter)
+        , m_fallbackTransformation(fallbackTransformation)
+    {
+    }
+
+    void transform(const quint8 *src, quint8 *dst, qint32 numPixels) const override
+    {
+        int outOfRangePixels[maxChunkSize];
+        float outOfRangeData[4 * maxChunkSize];
+
+        while (numPixels > 0) {
+            const int chunkSize = qMin(numPixels, maxChunkSize);
+
+            const int numOutOfRange =
+                m_converter->convertRgbaF32(src, dst, chunkSize, outOfRangePixels);
+
+            if (numOutOfRange) {
+                // the out-of-range pixels are copied into dst unchanged
+                quint8 *dataPtr = reinterpret_cast<quint8 *>(outOfRangeData);
+
+                for (int i = 0; i < numOutOfRange; i++) {
+                    memcpy(dataPtr + i * pixelSize, dst + outOfRangePixels[i] * pixelSize, pixelSize);
+                }
+
+                m_fallbackTransformation->transform(dataPtr, dataPtr, numOutOfRange);
+
+                for (int i = 0; i < numOutOfRange; i++) {
+                    memcpy(dst + outOfRangePixels[i] * pixelSize, dataPtr + i * pixelSize, pixelSize);
+                }
+            }
+
+            src += chunkSize * pixelSize;
+            dst += chunkSize * pixelSize;
+            numPixels -= chunkSize;
+        }
+    }
+
+private:
+    QScopedPointer<KoMatrixShaperConverterBase> m_converter;
+    QScopedPointer<KoColorConversionTransformation> m_fallbackTransformation;
 };
 
 class KoLcmsColorProofingConversionTransformation : public KoColorProofingConversionTransformation
@@ -116,10 +503,29 @@ public:
         m_transform = cmsCreateExtendedTransform(cmsGetProfileContextID(srcProfile->lcmsProfile()), 4, profiles, bpc, intents, adaptation, proof, 1, srcColorSpaceType, dstColorSpaceType, displayConversionFlags);
 
         Q_ASSERT(m_transform);
+
+        if (m_transform &&
+            shouldUseLut3D(srcCs, srcProfile, dstCs, dstProfile,
+                           renderingIntent, displayConversionFlags, true)) {
+
+            QByteArray key;
+            key += srcProfile->getProfileUniqueId();
+            key += proofingSpace->profile()->uniqueId();
+            key += dstProfile->getProfileUniqueId();
+            key += QByteArray::number(int(renderingIntent));
+            key += QByteArray::number(int(proofingIntent));
+            key += QByteArray::number(int(bpcFirstTransform));
+            key += QByteArray::number(adaptationState);
+            key += QByteArray::number(int(displayConversionFlags));
+            key += QByteArray(reinterpret_cast<const char *>(gamutWarning), 3);
+
+            m_lut.reset(createLut3D(srcCs, dstCs, key, m_transform));
+        }
     }
 
     ~KoLcmsColorProofingConversionTransformation() override
     {
+        m_lut.reset();
         cmsDeleteTransform(m_transform);
     }
 
@@ -129,11 +535,18 @@ public:
     {
         Q_ASSERT(m_transform);
 
+        if (m_lut) {
+            transformWithLut3D(m_lut.data(), m_transform, src, dst, numPixels,
+                               srcColorSpace()->pixelSize(), dstColorSpace()->pixelSize());
+            return;
+        }
+
         cmsDoTransform(m_transform, const_cast<quint8 *>(src), dst, numPixels);
 
     }
 private:
     mutable cmsHTRANSFORM m_transform;
+    QScopedPointer<KoColorConversionLut3D> m_lut;
 };
 
 struct IccColorSpaceEngine::Private {
@@ -255,11 +668,29 @@ KoColorConversionTransformation *IccColorSpaceEngine::createColorTransformation(
     KIS_ASSERT(dynamic_cast<const IccColorProfile *>(srcColorSpace->profile()));
     KIS_ASSERT(dynamic_cast<const IccColorProfile *>(dstColorSpace->profile()));
 
-    return new KoLcmsColorConversionTransformation(
-                srcColorSpace, computeColorSpaceType(srcColorSpace),
-                dynamic_cast<const IccColorProfile *>(srcColorSpace->profile())->asLcms(), dstColorSpace, computeColorSpaceType(dstColorSpace),
-                dynamic_cast<const IccColorProfile *>(dstColorSpace->profile())->asLcms(), renderingIntent, conversionFlags);
+    LcmsColorProfileContainer *srcProfile = dynamic_cast<const IccColorProfile *>(srcColorSpace->profile())->asLcms();
+    LcmsColorProfileContainer *dstProfile = dynamic_cast<const IccColorProfile *>(dstColorSpace->profile())->asLcms();
+    const quint32 srcColorSpaceType = computeColorSpaceType(srcColorSpace);
+    const quint32 dstColorSpaceType = computeColorSpaceType(dstColorSpace);
+
+    KoColorConversionTransformation *transformation =
+        new KoLcmsColorConversionTransformation(
+                srcColorSpace, srcColorSpaceType, srcProfile,
+                dstColorSpace, dstColorSpaceType, dstProfile,
+                renderingIntent, conversionFlags);
+
+    if (srcColorSpaceType == TYPE_RGBA_FLT && dstColorSpaceType == TYPE_RGBA_FLT) {
+        KoMatrixShaperConverterBase *converter =
+            createMatrixShaperConverter(srcProfile, dstProfile, renderingIntent, conversionFlags);
+
+        if (converter) {
+            transformation = new KoLcmsMatrixShaperColorConversionTransformation(
+                        srcColorSpace, dstColorSpace, renderingIntent, conversionFlags,
+                        converter, transformation);
+        }
+    }
 
+    return transformation;
 }
 KoColorProofingConversionTransformation *IccColorSpaceEngine::createColorProofingTransformation(const KoColorSpace *srcColorSpace,
                                                                                                 const KoColorSpace *dstColorSpace,
@@ -0,0 +1,307 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "TestKoColorConversionLut3D.h"
+
+#include <simpletest.h>
+#include <testpigment.h>
+
+#include <limits>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include "KoColorConversionLut3D.h"
+#include "KoColorConversionTransformation.h"
+#include "KoColorSpace.h"
+#include "KoColorSpaceRegistry.h"
+#include "KoColorModelStandardIds.h"
+
+Q_DECLARE_METATYPE(const KoColorSpace*)
+
+namespace {
+
+KoColorConversionLut3D::SampleFunction sampleFunction(KoColorConversionTransformation *transformation)
+{
+    return [transformation] (const quint8 *src, quint8 *dst, int numPixels) {
+        transformation->transform(src, dst, numPixels);
+    };
+}
+
+/**
+ * Generates pixels off the grid nodes, with a random alpha
+ */
+QByteArray generatePixels(const KoColorSpace *cs, int numPixels)
+{
+    QByteArray pixels(numPixels * cs->pixelSize(), 0);
+
+    QVector<float> channels(cs->channelCount());
+
+    for (int i = 0; i < numPixels; i++) {
+        for (int c = 0; c < channels.size(); c++) {
+            channels[c] = float((i * 7919 + c * 104729) % 1000) / 999.0f;
+        }
+        cs->fromNormalisedChannelsValue(reinterpret_cast<quint8*>(pixels.data()) + i * cs->pixelSize(), channels);
+    }
+
+    return pixels;
+}
+
+}
+
+void TestKoColorConversionLut3D::testConversion_data()
+{
+    QTest::addColumn<const KoColorSpace*>("srcCS");
+    QTest::addColumn<const KoColorSpace*>("dstCS");
+    QTest::addColumn<double>("tolerance");
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+
+    const KoColorSpace *rgb8 = registry->rgb8();
+    const KoColorSpace *rgb16 = registry->rgb16();
+    const KoColorSpace *rgbF32 = registry->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), registry->p709SRGBProfile());
+    const KoColorSpace *lab16 = registry->lab16();
+    const KoColorSpace *cmyk8 = registry->colorSpace(CMYKAColorModelID.id(), Integer8BitsColorDepthID.id(), 0);
+    const KoColorSpace *cmykF32 = registry->colorSpace(CMYKAColorModelID.id(), Float32BitsColorDepthID.id(), 0);
+
+    // the tolerance is in the normalized channel values, CMYK profiles
+    // have kinks at the ink limits, so their tolerance is higher
+    QTest::newRow("rgb8 -> cmyk8") << rgb8 << cmyk8 << 0.05;
+    QTest::newRow("rgb16 -> lab16") << rgb16 << lab16 << 0.01;
+    QTest::newRow("rgbF32 -> cmykF32") << rgbF32 << cmykF32 << 0.05;
+}
+
+void TestKoColorConversionLut3D::testConversion()
+{
+    QFETCH(const KoColorSpace*, srcCS);
+    QFETCH(const KoColorSpace*, dstCS);
+    QFETCH(double, tolerance);
+
+    QVERIFY(srcCS);
+    QVERIFY(dstCS);
+    QVERIFY(KoColorConversionLut3D::isSupported(srcCS, dstCS));
+
+    QScopedPointer<KoColorConversionTransformation> transformation(
+        srcCS->createColorConverter(dstCS,
+                                    KoColorConversionTransformation::internalRenderingIntent(),
+                                    KoColorConversionTransformation::internalConversionFlags()));
+
+    QScopedPointer<KoColorConversionLut3D> lut(
+        KoColorConversionLut3D::create(srcCS, dstCS, QByteArray(), 52, sampleFunction(transformation.data())));
+
+    QVERIFY(lut);
+    QVERIFY(!lut->isLoadedFromCache());
+
+    const int numPixels = 1000;
+    const QByteArray src = generatePixels(srcCS, numPixels);
+
+    QByteArray result(numPixels * dstCS->pixelSize(), 0);
+    QByteArray reference(numPixels * dstCS->pixelSize(), 0);
+
+    QVector<int> outOfRangePixels(numPixels);
+    const int numOutOfRange =
+        lut->transform(reinterpret_cast<const quint8*>(src.constData()),
+                       reinterpret_cast<quint8*>(result.data()),
+                       numPixels, outOfRangePixels.data());
+
+    QCOMPARE(numOutOfRange, 0);
+
+    transformation->transform(reinterpret_cast<const quint8*>(src.constData()),
+                              reinterpret_cast<quint8*>(reference.data()),
+                              numPixels);
+
+    QVector<float> resultChannels(dstCS->channelCount());
+    QVector<float> referenceChannels(dstCS->channelCount());
+
+    for (int i = 0; i < numPixels; i++) {
+        dstCS->normalisedChannelsValue(reinterpret_cast<const quint8*>(result.constData()) + i * dstCS->pixelSize(), resultChannels);
+        dstCS->normalisedChannelsValue(reinterpret_cast<const quint8*>(reference.constData()) + i * dstCS->pixelSize(), referenceChannels);
+
+        for (int c = 0; c < resultChannels.size(); c++) {
+            if (qAbs(resultChannels[c] - referenceChannels[c]) > tolerance) {
+                qDebug() << "pixel" << i << "channel" << c
+                         << "result" << resultChannels[c] << "expected" << referenceChannels[c];
+                QFAIL("the result of the table differs from the transformation");
+            }
+        }
+    }
+}
+
+void TestKoColorConversionLut3D::testOutOfRangePixels()
+{
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+    const KoColorSpace *srcCS = registry->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), registry->p709SRGBProfile());
+    const KoColorSpace *dstCS = registry->lab16();
+
+    QScopedPointer<KoColorConversionTransformation> transformation(
+        srcCS->createColorConverter(dstCS,
+                                    KoColorConversionTransformation::internalRenderingIntent(),
+                                    KoColorConversionTransformation::internalConversionFlags()));
+
+    QScopedPointer<KoColorConversionLut3D> lut(
+        KoColorConversionLut3D::create(srcCS, dstCS, QByteArray(), 17, sampleFunction(transformation.data())));
+
+    QVERIFY(lut);
+    QCOMPARE(lut->gridSize(), 17);
+
+    const float src[] = {
+        0.5f, 0.5f, 0.5f, 1.0f,
+        -0.1f, 0.5f, 0.5f, 1.0f,
+        0.5f, 0.5f, 0.5f, 0.5f,
+        0.5f, 1.5f, 0.5f, 1.0f,
+        0.5f, 0.5f, std::numeric_limits<float>::quiet_NaN(), 1.0f
+    };
+
+    quint16 dst[5 * 4];
+    int outOfRangePixels[5];
+
+    const int numOutOfRange = lut->transform(reinterpret_cast<const quint8*>(src),
+                                             reinterpret_cast<quint8*>(dst),
+                                             5, outOfRangePixels);
+
+    QCOMPARE(numOutOfRange, 3);
+    QCOMPARE(outOfRangePixels[0], 1);
+    QCOMPARE(outOfRangePixels[1], 3);
+    QCOMPARE(outOfRangePixels[2], 4);
+
+    QCOMPARE(dst[3], quint16(0xffff));
+    QVERIFY(qAbs(int(dst[2 * 4 + 3]) - 0x7fff) <= 1);
+}
+
+void TestKoColorConversionLut3D::testDiskCache()
+{
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+    const KoColorSpace *srcCS = registry->rgb8();
+    const KoColorSpace *dstCS = registry->lab16();
+
+    QScopedPointer<KoColorConversionTransformation> transformation(
+        srcCS->createColorConverter(dstCS,
+                                    KoColorConversionTransformation::internalRenderingIntent(),
+                                    KoColorConversionTransformation::internalConversionFlags()));
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    // 51 intervals divide 255 evenly, so the requested size is kept
+    QScopedPointer<KoColorConversionLut3D> sampledLut(
+        KoColorConversionLut3D::create(srcCS, dstCS, "key", 52,
+                                       sampleFunction(transformation.data()), cacheDir.path()));
+
+    QVERIFY(sampledLut);
+    QVERIFY(!sampledLut->isLoadedFromCache());
+    QCOMPARE(sampledLut->gridSize(), 52);
+
+    int numCallsAfterCaching = 0;
+
+    QScopedPointer<KoColorConversionLut3D> loadedLut(
+        KoColorConversionLut3D::create(srcCS, dstCS, "key", 52,
+            [&numCallsAfterCaching] (const quint8 *, quint8 *, int) {
+                numCallsAfterCaching++;
+            },
+            cacheDir.path()));
+
+    QVERIFY(loadedLut);
+    QVERIFY(loadedLut->isLoadedFromCache());
+    QCOMPARE(numCallsAfterCaching, 0);
+
+    // a different transformation should not pick the cached table
+    QScopedPointer<KoColorConversionLut3D> otherLut(
+        KoColorConversionLut3D::create(srcCS, dstCS, "other key", 52,
+                                       sampleFunction(transformation.data()), cacheDir.path()));
+
+    QVERIFY(otherLut);
+    QVERIFY(!otherLut->isLoadedFromCache());
+
+    const int numPixels = 1000;
+    const QByteArray src = generatePixels(srcCS, numPixels);
+
+    QByteArray sampledResult(numPixels * dstCS->pixelSize(), 0);
+    QByteArray loadedResult(numPixels * dstCS->pixelSize(), 0);
+    QVector<int> outOfRangePixels(numPixels);
+
+    sampledLut->transform(reinterpret_cast<const quint8*>(src.constData()),
+                          reinterpret_cast<quint8*>(sampledResult.data()),
+                          numPixels, outOfRangePixels.data());
+
+    loadedLut->transform(reinterpret_cast<const quint8*>(src.constData()),
+                         reinterpret_cast<quint8*>(loadedResult.data()),
+                         numPixels, outOfRangePixels.data());
+
+    QCOMPARE(loadedResult, sampledResult);
+}
+
+void TestKoColorConversionLut3D::testDiskCacheSizeLimit()
+{
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+    const KoColorSpace *srcCS = registry->rgb8();
+    const KoColorSpace *dstCS = registry->lab16();
+
+    QScopedPointer<KoColorConversionTransformation> transformation(
+        srcCS->createColorConverter(dstCS,
+                                    KoColorConversionTransformation::internalRenderingIntent(),
+                                    KoColorConversionTransformation::internalConversionFlags()));
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+
+    auto cachedFiles = [&cacheDir] () {
+        return QDir(cacheDir.path()).entryList({"*.lut"}, QDir::Files);
+    };
+
+    auto createLut = [&] (const QByteArray &key, qint64 maxCacheSize) {
+        return KoColorConversionLut3D::create(srcCS, dstCS, key, 18,
+                                              sampleFunction(transformation.data()),
+                                              cacheDir.path(), maxCacheSize);
+    };
+
+    QScopedPointer<KoColorConversionLut3D> lut(createLut("a", -1));
+    QCOMPARE(cachedFiles().size(), 1);
+
+    const QString fileA = QDir(cacheDir.path()).filePath(cachedFiles().first());
+    const qint64 fileSize = QFileInfo(fileA).size();
+
+    lut.reset(createLut("b", -1));
+    QStringList files = cachedFiles();
+    QCOMPARE(files.size(), 2);
+    files.removeAll(QFileInfo(fileA).fileName());
+    const QString fileB = QDir(cacheDir.path()).filePath(files.first());
+
+    // make both the tables old, the table "b" being used more recently
+    const QDateTime now = QDateTime::currentDateTime();
+    {
+        QFile file(fileA);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(now.addSecs(-100), QFileDevice::FileModificationTime));
+    }
+    {
+        QFile file(fileB);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(now.addSecs(-50), QFileDevice::FileModificationTime));
+    }
+
+    // loading the table "a" marks it as recently used
+    lut.reset(createLut("a", -1));
+    QVERIFY(lut->isLoadedFromCache());
+
+    // there is space for two tables only, so the least recently used "b" goes
+    lut.reset(createLut("c", 2 * fileSize));
+    QVERIFY(!lut->isLoadedFromCache());
+    QCOMPARE(cachedFiles().size(), 2);
+    QVERIFY(QFileInfo::exists(fileA));
+    QVERIFY(!QFileInfo::exists(fileB));
+
+    lut.reset(createLut("a", 2 * fileSize));
+    QVERIFY(lut->isLoadedFromCache());
+
+    lut.reset(createLut("b", 2 * fileSize));
+    QVERIFY(!lut->isLoadedFromCache());
+    QCOMPARE(cachedFiles().size(), 2);
+}
+
+KISTEST_MAIN(TestKoColorConversionLut3D)
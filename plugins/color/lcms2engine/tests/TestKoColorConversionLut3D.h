@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TESTKOCOLORCONVERSIONLUT3D_H
+#define TESTKOCOLORCONVERSIONLUT3D_H
+
+#include <QObject>
+
+class TestKoColorConversionLut3D : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testConversion_data();
+    void testConversion();
+    void testOutOfRangePixels();
+    void testDiskCache();
+    void testDiskCacheSizeLimit();
+};
+
+#endif // TESTKOCOLORCONVERSIONLUT3D_H
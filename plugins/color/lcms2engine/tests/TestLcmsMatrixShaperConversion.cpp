@@ -0,0 +1,178 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "TestLcmsMatrixShaperConversion.h"
+
+#include <simpletest.h>
+#include <testpigment.h>
+#include <lcms2.h>
+
+#include <cmath>
+
+#include "KoColorProfile.h"
+#include "KoColorConversionTransformation.h"
+#include "KoMatrixShaperConverterBase.h"
+#include "KoColorSpaceRegistry.h"
+#include "KoColorModelStandardIds.h"
+
+Q_DECLARE_METATYPE(const KoColorProfile*)
+
+namespace {
+
+const KoColorProfile* rgbProfile(ColorPrimaries primaries, TransferCharacteristics trc)
+{
+    return KoColorSpaceRegistry::instance()->profileFor(QVector<double>(), primaries, trc);
+}
+
+QVector<float> generatePixels()
+{
+    QVector<float> pixels;
+
+    // an odd number of pixels to check the scalar tail of the converter
+    const int numSteps = 11;
+    for (int r = 0; r < numSteps; r++) {
+        for (int g = 0; g < numSteps; g++) {
+            for (int b = 0; b < numSteps; b++) {
+                pixels << float(r) / (numSteps - 1)
+                       << float(g) / (numSteps - 1)
+                       << float(b) / (numSteps - 1)
+                       << float(r + g + b) / (3 * (numSteps - 1));
+            }
+        }
+    }
+
+    // the values outside the range of the tone curves
+    pixels << -0.2f << 0.5f << 0.3f << 1.0f;
+    pixels << 1.5f << 0.7f << 0.3f << 0.5f;
+
+    return pixels;
+}
+
+/**
+ * The values close to zero, where the inverted power curves are the
+ * steepest and the interpolation of the sampled curves is the least
+ * precise
+ */
+QVector<float> generateNearZeroPixels()
+{
+    QVector<float> pixels;
+
+    for (int i = 4; i <= 28; i++) {
+        const float value = std::pow(10.0f, -0.25f * i);
+
+        pixels << value << value << value << 1.0f;
+        pixels << value << 0.0f << 0.0f << 1.0f;
+        pixels << 0.0f << value << 0.0f << 1.0f;
+        pixels << 0.0f << 0.0f << value << 1.0f;
+    }
+
+    return pixels;
+void compareWithReference(const KoColorConversionTransformation *transformation,
+                          cmsHTRANSFORM referenceTransform,
+                          const QVector<float> &src,
+                          float tolerance)
+{
+    const int numPixels = src.size() / 4;
+
+    QVector<float> dst(src.size());
+    transformation->transform(reinterpret_cast<const quint8*>(src.constData()),
+                              reinterpret_cast<quint8*>(dst.data()),
+                              numPixels);
+
+    QVector<float> reference(src.size());
+    cmsDoTransform(referenceTransform, src.constData(), reference.data(), numPixels);
+
+    for (int i = 0; i < src.size(); i++) {
+        const float error = qAbs(dst[i] - reference[i]) / qMax(1.0f, qAbs(reference[i]));
+
+        if (error > tolerance) {
+            qDebug() << "pixel" << i / 4 << "channel" << i % 4
+                     << "src" << src[i] << "result" << dst[i] << "expected" << reference[i]
+                     << "tolerance" << tolerance;
+            QFAIL("the result differs from lcms");
+        }
+    }
+}
+
+}
+
+void TestLcmsMatrixShaperConversion::testConversion_data()
+{
+    QTest::addColumn<const KoColorProfile*>("srcProfile");
+    QTest::addColumn<const KoColorProfile*>("dstProfile");
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+
+    const KoColorProfile *srgb = registry->p709SRGBProfile();
+    const KoColorProfile *linear709 = registry->p709G10Profile();
+    const KoColorProfile *linear2020 = registry->p2020G10Profile();
+    const KoColorProfile *gamma22 = rgbProfile(PRIMARIES_ITU_R_BT_2020_2_AND_2100_0, TRC_ITU_R_BT_470_6_SYSTEM_M);
+    const KoColorProfile *rec709 = rgbProfile(PRIMARIES_ADOBE_RGB_1998, TRC_ITU_R_BT_709_5);
+
+    QTest::newRow("srgb -> linear709") << srgb << linear709;
+    QTest::newRow("linear709 -> srgb") << linear709 << srgb;
+    QTest::newRow("linear709 -> linear2020") << linear709 << linear2020;
+    QTest::newRow("linear2020 -> linear709") << linear2020 << linear709;
+    QTest::newRow("srgb -> gamma22") << srgb << gamma22;
+    QTest::newRow("gamma22 -> srgb") << gamma22 << srgb;
+    QTest::newRow("rec709 -> linear2020") << rec709 << linear2020;
+    QTest::newRow("linear2020 -> rec709") << linear2020 << rec709;
+}
+
+void TestLcmsMatrixShaperConversion::testConversion()
+{
+    QFETCH(const KoColorProfile*, srcProfile);
+    QFETCH(const KoColorProfile*, dstProfile);
+
+    QVERIFY(srcProfile);
+    QVERIFY(dstProfile);
+
+    KoColorSpaceRegistry *registry = KoColorSpaceRegistry::instance();
+    const KoColorSpace *srcCS = registry->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), srcProfile);
+    const KoColorSpace *dstCS = registry->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), dstProfile);
+
+    QVERIFY(srcCS);
+    QVERIFY(dstCS);
+
+    const KoColorConversionTransformation::Intent intent = KoColorConversionTransformation::internalRenderingIntent();
+    const KoColorConversionTransformation::ConversionFlags flags = KoColorConversionTransformation::internalConversionFlags();
+
+    const int numConvertersBefore = KoMatrixShaperConverterBase::testingNumAliveConverters();
+
+    QScopedPointer<KoColorConversionTransformation> transformation(
+        srcCS->createColorConverter(dstCS, intent, flags));
+
+    // the conversion should go through the matrix-shaper converter
+    QCOMPARE(KoMatrixShaperConverterBase::testingNumAliveConverters(), numConvertersBefore + 1);
+
+    /**
+     * The reference transform is created by lcms directly, bypassing
+     * the color engine
+     */
+    const QByteArray srcData = srcProfile->rawData();
+    const QByteArray dstData = dstProfile->rawData();
+
+    cmsHPROFILE srcLcmsProfile = cmsOpenProfileFromMem(srcData.constData(), srcData.size());
+    cmsHPROFILE dstLcmsProfile = cmsOpenProfileFromMem(dstData.constData(), dstData.size());
+
+    QVERIFY(srcLcmsProfile);
+    QVERIFY(dstLcmsProfile);
+
+    cmsHTRANSFORM referenceTransform =
+        cmsCreateTransform(srcLcmsProfile, TYPE_RGBA_FLT,
+                           dstLcmsProfile, TYPE_RGBA_FLT,
+                           intent, cmsUInt32Number(flags) | cmsFLAGS_NOOPTIMIZE | cmsFLAGS_COPY_ALPHA);
+    QVERIFY(referenceTransform);
+
+    compareWithReference(transformation.data(), referenceTransform, generatePixels(), 5e-6f);
+    compareWithReference(transformation.data(), referenceTransform, generateNearZeroPixels(), 5e-5f);
+
+    cmsDeleteTransform(referenceTransform);
+    cmsCloseProfile(srcLcmsProfile);
+    cmsCloseProfile(dstLcmsProfile);
+}
+
+KISTEST_MAIN(TestLcmsMatrixShaperConversion)
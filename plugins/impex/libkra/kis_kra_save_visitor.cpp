@@ -48,6 +48,7 @@
 
 #include "kis_raster_keyframe_channel.h"
 #include "kis_paint_device_frames_interface.h"
+#include "tiles3/swap/kis_tile_file_mapping.h"
 
 #include "lazybrush/kis_lazy_fill_tools.h"
 #include <KoStoreDevice.h>
@@ -341,6 +342,14 @@ bool KisKraSaveVisitor::savePaintDevice(KisPaintDeviceSP device,
     KisConfig cfg(true);
     m_store->setCompressionEnabled(cfg.compressKra());
 
+    /**
+     * The pixels of the layers may still be mapped from the files we
+     * are going to overwrite, so detach them from the files first. A
+     * failure is not fatal: the file that cannot be replaced most
+     * probably cannot be overwritten either.
+     */
+    KisTileFileMapping::detachFromFiles();
+
     KisPaintDeviceFramesInterface *frameInterface = device->framesInterface();
     QList<int> frames;
 